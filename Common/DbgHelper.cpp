@@ -13,9 +13,34 @@
 //================================================================================
 #include "FuncHelper.h"
 #include "SysHelper.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <mutex>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <wchar.h>
 #include "../Library/DebugBreak/debugbreak.h"
+#if   defined(_MSC) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#elif defined(_GCC) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+#endif
+#if defined(_LINUX) && defined(__has_include)
+    #if __has_include(<linux/membarrier.h>)
+        #include <linux/membarrier.h>
+        #include <sys/syscall.h>
+        #define DBGLOG_MEMBARRIER_ENABLE 1 // Heavy barrier of the async rings is built (Used if the kernel supports it)
+    #endif
+#endif
 #if defined(_QT_FRAMEWORK_USED)
     #include <QApplication>
 #endif
@@ -29,6 +54,62 @@
  */
 #define DBGLOG_STRING_STEP_LENGTH 128
 
+/**
+ * @brief Debug log buffer initial length (Thread local buffer, grows on demand and never shrinks)
+ */
+#define DBGLOG_BUFFER_INIT_LENGTH 1024
+
+/**
+ * @brief Debug log specifier max length (Example: "%-+#012.6lld")
+ */
+#define DBGLOG_SPECIFIER_MAX_LENGTH 32
+
+/**
+ * @brief Debug log max precision of "%f" written natively (Higher precisions, values over 2^64 and compilers without 128 bits integers use snprintf)
+ */
+#define DBGLOG_FIXED_MAX_PRECISION 19
+
+/**
+ * @brief Debug log async consumer idle wait time (Milliseconds; Producers wake the consumer earlier when they queue a log)
+ */
+#define DBGLOG_ASYNC_IDLE_TIMEOUT 50
+
+/**
+ * @brief Debug log async consumer batch length (Blocked producers are notified after every batch)
+ */
+#define DBGLOG_ASYNC_BATCH_LENGTH 64
+
+/**
+ * @brief Debug log async consumer gather delay (Microseconds; A woken consumer lets the producers queue a batch before draining, instead of being woken for every log)
+ */
+#define DBGLOG_ASYNC_GATHER_DELAY 100
+
+/**
+ * @brief Debug log async ring bytes per queue slot (The ring of a thread is sized to hold a full queue of records this long)
+ */
+#define DBGLOG_ASYNC_RING_SLOT 64
+
+/**
+ * @brief Debug log cache line length (Keeps the producer and the consumer positions of an async ring apart)
+ */
+#define DBGLOG_CACHE_LINE 64
+
+/**
+ * @brief Debug log routing tables (The current table and the replaced tables whose sinks may still run; A route change waits for a free one)
+ */
+#define DBGLOG_ROUTE_TABLES 4
+
+/**
+ * @brief Debug log dump kernels (SSSE3/AVX2 kernels are selected at runtime on x86; Other platforms use the scalar kernels)
+ */
+#if   defined(_MSC) && (defined(_M_X64) || defined(_M_IX86))
+    #define DBGLOG_DUMP_SIMD          1
+    #define DBGLOG_DUMP_TARGET(isa)
+#elif defined(_GCC) && (defined(__x86_64__) || defined(__i386__))
+    #define DBGLOG_DUMP_SIMD          1
+    #define DBGLOG_DUMP_TARGET(isa)   __attribute__((target(isa)))
+#endif
+
 //================================================================================
 // Define inside type
 //================================================================================
@@ -80,353 +161,4032 @@ public:
 };
 #endif
 
-//================================================================================
-// Initialize inside variable
-//================================================================================
-#if (defined(_MSC) && defined(_CRTDBG_MAP_ALLOC)) || defined(_QT_FRAMEWORK_USED)
-static DebugHelperPrivate __DebugHelperPrivate;
-#endif
+/**
+ * @brief Debug log buffer (Thread local; Reused by every log call of the owner thread)
+ */
+struct DbgLogBuffer
+{
+    char * datas    = nullptr; // Buffer datas (Always end with '\0')
+    size_t length   = 0;       // Used length (Without terminator '\0')
+    size_t capacity = 0;       // Allocated length (With terminator '\0')
+
+    ~DbgLogBuffer() { free(this->datas); }
+
+    /**
+     * @brief Make sure the buffer can append more datas
+     *
+     * @param addLength     Will to append length (Without terminator '\0')
+     * @return bool         Whether to the buffer have enough space
+     */
+    bool reserve(const size_t addLength) noexcept { return this->length + addLength < this->capacity || this->grow(addLength); }
+
+    /**
+     * @brief Grow the buffer (Slow path of reserve)
+     *
+     * @param addLength     Will to append length (Without terminator '\0')
+     * @return bool         Whether to the buffer have enough space
+     */
+    bool grow(const size_t addLength) noexcept;
+
+    /**
+     * @brief Append datas
+     *
+     * @param addDatas      Append datas
+     * @param addLength     Append length
+     */
+    void append(const char * addDatas, const size_t addLength) noexcept
+    {
+        if (!this->reserve(addLength)) return;
+        memcpy(this->datas + this->length, addDatas, addLength);
+        this->length              += addLength;
+        this->datas[this->length]  = '\0';
+    }
+
+    /**
+     * @brief Append string
+     *
+     * @param addString     Append string (Must end with '\\0')
+     */
+    void append(const char * addString) noexcept { this->append(addString, strlen(addString)); }
+
+    /**
+     * @brief Append character
+     *
+     * @param addChar       Append character
+     */
+    void append(const char addChar) noexcept
+    {
+        if (!this->reserve(1)) return;
+        this->datas[this->length++] = addChar;
+        this->datas[this->length]   = '\0';
+    }
+
+    /**
+     * @brief Append format string (Formats directly into the free space of the buffer)
+     *
+     * @param fmtString     Format string (Reference sprintf() specifier)
+     * @param ...           Format arguments
+     */
+    void appendFormat(const char * fmtString, ...) noexcept;
+
+    /**
+     * @brief Swap buffers (Hands over the datas without copying)
+     *
+     * @param otherBuffer   Other buffer
+     */
+    void swap(DbgLogBuffer & otherBuffer) noexcept
+    {
+        std::swap(this->datas, otherBuffer.datas);
+        std::swap(this->length, otherBuffer.length);
+        std::swap(this->capacity, otherBuffer.capacity);
+    }
+};
 
 /**
- * @brief Inner mutex
+ * @brief Debug log thread buffer (Marks the thread exiting when destroyed, the logs of the later thread destructors use buffers of their own)
  */
-static std::mutex __InnerMutex;
+struct DbgThreadBuffer final : DbgLogBuffer
+{
+    ~DbgThreadBuffer();
+};
 
 /**
- * @brief Debug log infomation handling function
+ * @brief Debug log context (Collected before formatting, used to dispatch the log)
  */
-static dbg_log_handle_t __DbgLogHandle = nullptr;
+struct DbgLogContext final
+{
+    int                      errorCode  = 0;          // Errno at the time of the call
+    ulong                    lastError  = 0;          // Windows last error at the time of the call
+    const char *             logLabel   = nullptr;    // Log label (Example: "[INFO]")
+    char                     logDate[9] = "19000101"; // Log local date (Format: "yyyyMMdd")
+    int64_t                  logTime    = 0;          // Log time (Nanoseconds since epoch)
+    int                      logEncoder = 0;          // Log encoder of the log content (Use DBGLOG_ENCODER_* macros)
+    size_t                   msgOffset  = 0;          // Message offset in the log content (JSON and logfmt: the message is escaped when the log ends)
+    const dbg_log_module_t * logModule  = nullptr;    // Log module (Used to route the log; Nullptr: default module)
+    dbg_log_route_cache_t *  routeCache = nullptr;    // Route cache of the call site (Nullptr: resolve the routes on every log)
+};
 
-//================================================================================
-// Implementation inside method
-//================================================================================
 /**
- * @brief Format debug log
- *
- * @param outString     Output string
- * @param fmtString     Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
- * @param fmtArgs       Format arguments ("%X|%x|%B|%b" must be use a parameter in the format of std::make_unique<dbg_log_datas_t>("xxx", 3).get())
+ * @brief Debug log route (Added by DbgAddRoute())
  */
-static void __DbgFormatLog(std::string & outString, char ** fmtString, va_list fmtArgs)
+struct DbgLogRoute final
 {
-    char * specifier_begin = *fmtString;
-    char * specifier_end   = nullptr;
+    int            levelMask   = 0;       // Log levels of the route
+    bool           isAny       = false;   // Whether to match every module
+    std::string    moduleName;            // Module name (Unused if matching every module)
+    dbg_log_sink_t logSink     = nullptr; // Routing sink function (Nullptr: free route)
+    void *         sinkContext = nullptr; // Sink context
+};
 
-    if (!specifier_begin) return;
+/**
+ * @brief Debug log routing table (Never changed while published; A route change publishes a changed copy)
+ */
+struct DbgRouteTable final
+{
+    std::atomic<size_t> activeCount;                   // Logs matching the routes or calling the sinks of the table
+    uint32_t            routeGeneration = 0;           // Routing table generation (Compared with the route caches of the call sites)
+    DbgLogRoute         logRoutes[DBGLOG_ROUTE_COUNT]; // Routes (Index: route ID)
 
-    while ((specifier_begin = strchr(specifier_begin, '%')))
-    {
-        if (specifier_begin[1] == '%')
-        {
-            specifier_begin = specifier_begin + 2;
-            continue;
-        }
+    DbgRouteTable() noexcept : activeCount(0) {}
+};
 
-        specifier_end = specifier_begin + 1;
-        while (*specifier_end != '\0' && !strchr("diuoxXfFeEgGaAcspn%Bb", *specifier_end)) specifier_end++;
+/**
+ * @brief Debug log async queue slot
+ */
+struct DbgAsyncSlot final
+{
+    std::atomic<size_t> sequence;           // Slot sequence (Position: free; Position + 1: queued)
+    DbgLogBuffer        logContent;         // Log content (Swapped with the producer and consumer buffers)
+    DbgLogContext       logContext;         // Log context (Unused by binary records)
+    int                 logType  = 0;       // Log type
+    bool                isRecord = false;   // Whether to the log content is a binary record (Deferred mode)
+};
 
-        if (*specifier_end == '%')
-        {
-            specifier_begin = specifier_end;
-            continue;
-        }
-        if (*specifier_end == '\0') specifier_end = nullptr;
+/**
+ * @brief Debug log async ring entry head (Followed by the binary record, or by the log context and the formatted log)
+ */
+struct DbgRingEntry final
+{
+    uint32_t entryLength; // Entry length (Head included, a multiple of the head length)
+    int32_t  logType;     // Log type
+    uint32_t isRecord;    // Whether to the entry is a binary record (0xffffffff: padding up to the ring end)
+    uint32_t dataLength;  // Datas length after the head
+};
 
-        break;
-    }
+/**
+ * @brief Debug log async ring (Single-producer ring of one thread, drained by the consumer thread; Producers write it without any shared read-modify-write)
+ */
+struct DbgAsyncRing final
+{
+    std::atomic<size_t> writePos;                       // Written end (Stored by the owner thread only)
+    std::atomic<bool>   isWriting;                      // Whether the owner thread is writing an entry (Waited by stop())
+    std::atomic<bool>   isClosed;                       // Whether the owner thread exited (The ring is reused by a new thread once output)
+    size_t              readCache;                      // Read position last loaded by the owner thread
+    char *              ringDatas;                      // Ring datas
+    size_t              ringMask;                       // Ring length - 1
+    DbgAsyncRing *      nextRing;                       // Next ring (Changed only by stop(), while no consumer runs)
+    char                linePadding[DBGLOG_CACHE_LINE]; // Keeps the consumer positions off the cache line of the producer
+    std::atomic<size_t> readPos;                        // Read end, the datas before it are free (Stored by the consumer thread only)
+    std::atomic<size_t> donePos;                        // Output end (Stored by the consumer thread only)
 
-    if (specifier_end)
-    {
-        if (*specifier_end == 'X' || *specifier_end == 'x' || *specifier_end == 'B' || *specifier_end == 'b')
-        {
-            if (specifier_begin != *fmtString)
-            {
-                char old_char = specifier_begin[0];
+    DbgAsyncRing() noexcept : writePos(0), isWriting(false), isClosed(false), readCache(0), ringDatas(nullptr), ringMask(0), nextRing(nullptr), readPos(0), donePos(0) {}
+    ~DbgAsyncRing() { delete[] this->ringDatas; }
+};
 
-                specifier_begin[0] = '\0';
-                {
-                    size_t                  add_length  = snprintf(NULL, 0, *fmtString, 0);
-                    std::unique_ptr<char[]> temp_strptr = std::make_unique<char[]>(add_length + 1);
+/**
+ * @brief Debug log async ring owner (Async ring of current thread; Closed when the thread exits)
+ */
+struct DbgAsyncRingOwner final
+{
+    DbgAsyncRing * asyncRing      = nullptr; // Async ring (Nullptr: not attached)
+    uint           forkGeneration = 0;       // Fork generation of the ring (The rings of the parent process are abandoned in the child)
+    bool           isExited       = false;   // Whether the owner is destroyed (The logs of the later thread destructors use the queue)
 
-                    snprintf(temp_strptr.get(), add_length + 1, *fmtString, 0);
-                    if (outString.capacity() - outString.size() < add_length) outString.reserve(outString.capacity() + MAX(add_length, DBGLOG_STRING_STEP_LENGTH));
-                    outString += temp_strptr.get();
-                }
-                specifier_begin[0] = old_char;
-            }
+    ~DbgAsyncRingOwner();
+};
 
-            if (*specifier_end == 'X' || *specifier_end == 'x')
-            {
-                const char *      HEX_TABLE_UPPER = "0123456789ABCDEF";
-                const char *      HEX_TABLE_LOWER = "0123456789abcdef";
-                dbg_log_datas_t * hex_arg         = va_arg(fmtArgs, dbg_log_datas_t *);
-                const char *      hex_bytes_pos   = hex_arg->datas;
-                size_t            add_length      = (hex_arg->length == 0 ? 0 : (hex_arg->length * 3 - 1));
+/**
+ * @brief Debug log suppress reporter (Reports the pending suppressed counts at exit)
+ */
+struct DbgSuppressReporter final
+{
+    ~DbgSuppressReporter();
+};
 
-                if (outString.capacity() - outString.size() < add_length) outString.reserve(outString.capacity() + MAX(add_length, DBGLOG_STRING_STEP_LENGTH));
+/**
+ * @brief Debug log async queue (Bounded lock-free queue of formatted logs and the async rings of the threads, drained by one consumer thread)
+ */
+struct DbgAsyncQueue final
+{
+    std::atomic<bool>           isRunning;      // Whether to accept logs
+    std::atomic<bool>           isSleeping;     // Whether the consumer is waiting for logs
+    std::atomic<size_t>         inflightCount;  // Producers inside push()
+    std::atomic<size_t>         enqueuePos;     // Next enqueue position
+    std::atomic<size_t>         dequeuePos;     // Next dequeue position
+    std::atomic<size_t>         doneCount;      // Queued logs that have been output or overwritten
+    DbgAsyncSlot *              slots;          // Queue slots
+    size_t                      slotMask;       // Slots count - 1
+    int                         overflowPolicy; // Overflow policy (Use DBGLOG_ASYNC_* macros)
+    bool                        isStopping;     // Whether the consumer should exit (Protected by waitMutex)
+    std::mutex                  waitMutex;      // Wait mutex
+    std::condition_variable     wakeCond;       // Wakes the consumer
+    std::condition_variable     idleCond;       // Wakes flushing and blocked producers
+    std::thread *               consumerThread; // Consumer thread (Abandoned in the child process after fork)
+    std::atomic<DbgAsyncRing *> ringList;       // Async rings of the threads (New rings are linked at the head; A ring is only freed by stop())
+    std::mutex                  ringMutex;      // Ring attach mutex
+    DbgAsyncRing *              ringCursor;     // Ring the consumer drains (Owned by the consumer thread)
 
-                for (uint loop_idx = 0; loop_idx < hex_arg->length; loop_idx++)
-                {
-                    if (loop_idx != 0)
-                    {
-                        hex_bytes_pos++;
-                        outString += ' ';
-                    }
-                    outString += (*specifier_end == 'X' ? HEX_TABLE_UPPER[(*hex_bytes_pos & 0xf0) >> 4] : HEX_TABLE_LOWER[(*hex_bytes_pos & 0xf0) >> 4]);
-                    outString += (*specifier_end == 'X' ? HEX_TABLE_UPPER[(*hex_bytes_pos & 0x0f) >> 0] : HEX_TABLE_LOWER[(*hex_bytes_pos & 0x0f) >> 0]);
-                }
-            }
-            else if (*specifier_end == 'B' || *specifier_end == 'b')
-            {
-                dbg_log_datas_t * bit_arg         = va_arg(fmtArgs, dbg_log_datas_t *);
-                const char *      bit_bytes_pos   = bit_arg->datas;
-                uint              bit_bytes_count = (bit_arg->length / 8) + (bit_arg->length % 8 == 0 ? 0 : 1);
-                size_t            add_length      = bit_arg->length + (bit_bytes_count - 1);
+    DbgAsyncQueue() noexcept : isRunning(false), isSleeping(false), inflightCount(0), enqueuePos(0), dequeuePos(0), doneCount(0), slots(nullptr), slotMask(0), overflowPolicy(DBGLOG_ASYNC_BLOCK), isStopping(false), consumerThread(nullptr), ringList(nullptr), ringCursor(nullptr) {}
+    ~DbgAsyncQueue() { this->stop(); }
 
-                if (outString.capacity() - outString.size() < add_length) outString.reserve(outString.capacity() + MAX(add_length, DBGLOG_STRING_STEP_LENGTH));
+    /**
+     * @brief Start async mode (Stops the running consumer first)
+     *
+     * @param queueCapacity     Queue capacity (Rounded up to a power of two)
+     * @param overflowPolicy    Overflow policy (Use DBGLOG_ASYNC_* macros)
+     * @return bool             Whether to start successfully
+     */
+    bool start(const size_t queueCapacity, const int overflowPolicy) noexcept;
 
-                for (uint loop_bytes_idx = 0; loop_bytes_idx < bit_bytes_count; loop_bytes_idx++)
-                {
-                    if (loop_bytes_idx != 0)
-                    {
-                        bit_bytes_pos++;
-                        outString += ' ';
-                    }
-
-                    for (uint loop_bits_idx = 0; loop_bits_idx < 8 && loop_bytes_idx * 8 + loop_bits_idx < bit_arg->length; loop_bits_idx++)
-                    {
-                        outString += ((*bit_bytes_pos >> (7 - loop_bits_idx)) & 0x01 ? '1' : '0');
-                    }
-                }
-            }
-        }
-        else
-        {
-            char old_char = specifier_end[1];
+    /**
+     * @brief Stop async mode (Outputs every queued log, then joins the consumer thread)
+     */
+    void stop() noexcept;
 
-            specifier_end[1] = '\0';
-            {
-                size_t                  add_length  = vsnprintf(NULL, 0, *fmtString, fmtArgs);
-                std::unique_ptr<char[]> temp_strptr = std::make_unique<char[]>(add_length + 1);
+    /**
+     * @brief Queue a log (Takes over the datas of the log content buffer; Binary records, and every log of a thread that queued one, go through the async ring of the thread)
+     *
+     * @param logContent    Log content buffer
+     * @param logContext    Log context (Nullptr: the log content is a binary record)
+     * @param logType       Log type
+     * @return bool         Whether to the log is queued or dropped (False: output it synchronously)
+     */
+    bool push(DbgLogBuffer & logContent, const DbgLogContext * logContext, const int logType) noexcept;
 
-                vsnprintf(temp_strptr.get(), add_length + 1, *fmtString, fmtArgs);
-                if (outString.capacity() - outString.size() < add_length) outString.reserve(outString.capacity() + MAX(add_length, DBGLOG_STRING_STEP_LENGTH));
-                outString += temp_strptr.get();
-            }
-            specifier_end[1] = old_char;
-        }
+    /**
+     * @brief Queue a log into the async ring of current thread (Copies the log content; The consumer is only woken if it sleeps, once per burst)
+     *
+     * @param asyncRing     Async ring of current thread
+     * @param logContent    Log content buffer
+     * @param logContext    Log context (Nullptr: the log content is a binary record)
+     * @param logType       Log type
+     * @return bool         Whether to the log is queued or dropped (False: the queue stopped, or the log is longer than a quarter of the ring)
+     */
+    bool pushRing(DbgAsyncRing * asyncRing, const DbgLogBuffer & logContent, const DbgLogContext * logContext, const int logType) noexcept;
 
-        *fmtString = specifier_end + 1;
-    }
-    else
-    {
-        size_t                  add_length  = vsnprintf(NULL, 0, *fmtString, fmtArgs);
-        std::unique_ptr<char[]> temp_strptr = std::make_unique<char[]>(add_length + 1);
+    /**
+     * @brief Wait until every log queued before the call is output
+     */
+    void flush() noexcept;
 
-        vsnprintf(temp_strptr.get(), add_length + 1, *fmtString, fmtArgs);
-        if (outString.capacity() - outString.size() < add_length) outString.reserve(outString.capacity() + MAX(add_length, DBGLOG_STRING_STEP_LENGTH));
-        outString += temp_strptr.get();
+    /**
+     * @brief Reset the queue in the child process after fork (The consumer thread does not exist in the child, falls back to synchronous mode)
+     */
+    void resetAfterFork() noexcept;
 
-        *fmtString = nullptr;
-    }
-}
+    /**
+     * @brief Claim a free slot
+     *
+     * @param slotPos           Output slot position
+     * @return DbgAsyncSlot*    Claimed slot (Nullptr: queue is full)
+     */
+    DbgAsyncSlot * tryEnqueue(size_t & slotPos) noexcept;
+
+    /**
+     * @brief Claim a queued slot
+     *
+     * @param slotPos           Output slot position
+     * @return DbgAsyncSlot*    Claimed slot (Nullptr: queue is empty)
+     */
+    DbgAsyncSlot * tryDequeue(size_t & slotPos) noexcept;
+
+    /**
+     * @brief Attach an async ring to current thread (Reuses the output ring of an exited thread)
+     *
+     * @return DbgAsyncRing*    Async ring of current thread (Nullptr: out of memory)
+     */
+    DbgAsyncRing * attachRing() noexcept;
+
+    /**
+     * @brief Take the next log from the queue or the async rings (Frees its slot or ring space at once)
+     *
+     * @param logContent    Output log content
+     * @param logContext    Output log context (Unused by binary records)
+     * @param logType       Output log type
+     * @param isRecord      Output whether to the log content is a binary record
+     * @param logRing       Output async ring of the log (Nullptr: queue slot)
+     * @param ringEnd       Output end of the log in its async ring
+     * @return bool         Whether to take a log (False: the queue and the rings are empty)
+     */
+    bool takeLog(DbgLogBuffer & logContent, DbgLogContext & logContext, int & logType, bool & isRecord, DbgAsyncRing *& logRing, size_t & ringEnd) noexcept;
+
+    /**
+     * @brief Mark a taken log as output
+     *
+     * @param logRing       Async ring of the log (Nullptr: queue slot)
+     * @param ringEnd       End of the log in its async ring
+     */
+    void doneLog(DbgAsyncRing * logRing, const size_t ringEnd) noexcept;
+
+    /**
+     * @brief Check whether the queue and the async rings are empty
+     *
+     * @return bool         Whether to be empty
+     */
+    bool isDrained() noexcept;
+
+    /**
+     * @brief Wake the consumer if it is waiting for logs
+     */
+    void wakeConsumer() noexcept;
+
+    /**
+     * @brief Consumer thread routine
+     */
+    void consume() noexcept;
+};
 
-//================================================================================
-// Implementation export method
-//================================================================================
 /**
- * @brief Set debug error infomation handling function (Thread safe)
- *
- * @param errHandle     Debug error infomation handling function
+ * @brief Debug log time cache (Broken-down time is recomputed only when the second changes)
  */
-void DbgSetHandle(const dbg_log_handle_t errHandle) noexcept
+struct DbgLogTimeCache final
 {
-    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+    std::time_t cacheSecond    = -1;                        // Cached second since epoch (-1: not cached)
+    char        timeString[24] = "1900-01-01 00:00:00.000"; // Cached time (Format: "yyyy-MM-dd hh:mm:ss.zzz"; Milliseconds are patched per call)
+    char        dateString[9]  = "19000101";                // Cached date (Format: "yyyyMMdd")
+};
 
-    __DbgLogHandle = errHandle;
-}
+/**
+ * @brief Debug log self IDs cache (Process and thread ID of current thread; Fetched again after fork)
+ */
+struct DbgSelfIds final
+{
+    uint      forkGeneration = 0; // Fork generation of the cached IDs (0: not cached)
+    pid_t     processId      = 0; // Process ID
+    pthread_t threadId       = 0; // Native thread ID
+};
 
 /**
- * @brief Output debug log (Thread safe; Direct use is not recommended)
- *
- * @param filePath      File path (Debug mode: DBG_OUTPUTLOG_FILE; Release mode: nullptr)
- * @param fileLine      File line (Debug mode: DBG_OUTPUTLOG_LINE; Release mode: 0)
- * @param fileFunc      File function (Debug mode: DBG_OUTPUTLOG_FUNC; Release mode: nullptr)
- * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
- * @param fmtString     Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
- * @param fmtArgsCount  Format arguments count
- * @param ...           Format arguments ("%X|%x|%B|%b" must be use a parameter in the format of std::make_unique<dbg_log_datas_t>("xxx", 3).get())
+ * @brief Debug log binary stream state (Owned by the consumer thread in deferred mode)
  */
-void DbgOutputLog(const char * filePath, const int fileLine, const char * fileFunc, const int logType, const char * fmtString, const int fmtArgsCount, ...) noexcept
+struct DbgStreamState final
 {
-    int error_code = errno;
-#if defined(_MSC)
-    DWORD last_error = ::GetLastError();
-#endif
-    const char * log_label   = nullptr;
-    tm           log_time    = {0, 0, 0, 1, 0, 0, 0, 0, 0};
-    std::string  log_content = "";
+    dbg_log_write_t                            streamWrite = nullptr; // Writing function of the current stream (Nullptr: stream not started)
+    std::unordered_set<const dbg_log_site_t *> writtenSites;          // Call sites written to the current stream
+    DbgLogBuffer                               entryDatas;            // Stream head and call site entry buffer
+};
 
-    if ((logType & 0x0100))
-        log_label = "[ASSERT]";
-    else if ((logType & 0x0200))
-        log_label = "[VERIFY]";
-    else if ((logType & ESL_DEBUG))
-        log_label = "[DEBUG]";
-    else if ((logType & ESL_INFOMATION))
-        log_label = "[INFO]";
-    else if ((logType & ESL_WARNING))
-        log_label = "[WARNING]";
-    else if ((logType & ESL_ERROR))
-        log_label = "[ERROR]";
-    else if ((logType & ESL_FATAL))
-        log_label = "[FATAL]";
+/**
+ * @brief Debug log decoded call site (Points into the decoding stream datas)
+ */
+struct DbgDecodeSite final
+{
+    dbg_log_site_t            logSite; // Call site
+    std::vector<dbg_log_op_t> fmtOps;  // Format operations (Compiled at runtime)
+};
 
-    {
-        char time_str[] = "1900-01-01 00:00:00.000";
+/**
+ * @brief Hex dump kernel (Writes "XX " for every source byte, 3 * srcLength characters in total)
+ *
+ * @param outDatas      Output datas (At least 3 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ * @param isUpper       Whether to use uppercase digits
+ */
+typedef void (*dbg_dump_hex_t)(char * outDatas, const uchar * srcDatas, const size_t srcLength, const bool isUpper);
 
-        {
-            std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> time_now    = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
-            std::time_t                                                                   time_total  = time_now.time_since_epoch().count();
-            std::time_t                                                                   time_stamp  = time_total / 1000LL;
-            int                                                                           time_millis = (int)(time_total % 1000LL);
+/**
+ * @brief Binary dump kernel (Writes "XXXXXXXX " for every source byte, 9 * srcLength characters in total)
+ *
+ * @param outDatas      Output datas (At least 9 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ */
+typedef void (*dbg_dump_bit_t)(char * outDatas, const uchar * srcDatas, const size_t srcLength);
 
-#if defined(_MSC)
-            if (localtime_s(&log_time, &time_stamp) == ESV_SUCCESS)
-#elif defined(_GCC)
-            if (localtime_r(&time_stamp, &log_time))
-#endif
-            {
-                snprintf(time_str, sizeof(log_time), "%04d-%02d-%02d %02d:%02d:%02d.%03d", log_time.tm_year + 1900, log_time.tm_mon + 1, log_time.tm_mday, log_time.tm_hour, log_time.tm_min, log_time.tm_sec, time_millis);
-            }
-        }
+/**
+ * @brief Binary dump table (Maps the 144 characters of 16 dumped bytes to their source byte and bit; Used by the SIMD kernels)
+ */
+struct DbgDumpBitTable final
+{
+    uchar spreadIdx[144]; // Source byte index of each character
+    uchar bitMask[144];   // Source bit mask of each character (0: space)
+    uchar charBase[144];  // Character base (The compare result 0 or -1 is subtracted: '0' for bits, ' ' - 1 for spaces)
 
+    constexpr DbgDumpBitTable() noexcept : spreadIdx(), bitMask(), charBase()
+    {
+        for (uint char_idx = 0; char_idx < 144; char_idx++)
         {
-            const char *            fmt_header  = "%-10sTime: %s, ProcessID: %u, ThreadID: %lu, File: %s:%d, Function: %s\r\n%10s";
-            pid_t                   process_id  = SELF_PROCESS_ID;
-            pthread_t               thread_id   = SELF_NATIVE_THREAD_ID;
-            const char *            file_path   = (filePath ? filePath : "-");
-            int                     file_line   = (filePath ? fileLine : 0);
-            const char *            file_func   = (fileFunc ? fileFunc : "-");
-            size_t                  str_length  = snprintf(NULL, 0, fmt_header, log_label, time_str, process_id, thread_id, file_path, file_line, file_func, "");
-            std::unique_ptr<char[]> temp_strptr = std::make_unique<char[]>(PATH_MAX + 1);
-
-            snprintf(temp_strptr.get(), str_length + 1, fmt_header, log_label, time_str, process_id, thread_id, file_path, file_line, file_func, "");
-            if (log_content.capacity() < str_length) log_content.reserve(log_content.capacity() + MAX(str_length, DBGLOG_STRING_STEP_LENGTH));
-            log_content += temp_strptr.get();
+            this->spreadIdx[char_idx] = (uchar)(char_idx / 9);
+            this->bitMask[char_idx]   = (uchar)(char_idx % 9 == 8 ? 0 : (0x80 >> (char_idx % 9)));
+            this->charBase[char_idx]  = (uchar)(char_idx % 9 == 8 ? ' ' - 1 : '0');
         }
     }
+};
 
-    if (fmtArgsCount > 0)
-    {
-        size_t                  fmt_strlen = strlen(fmtString);
-        std::unique_ptr<char[]> fmt_strptr = std::make_unique<char[]>(fmt_strlen + 1);
-        char *                  fmt_strval = fmt_strptr.get();
-        va_list                 arg_list;
+/**
+ * @brief Debug log format arguments reader (Reads from variable argument list)
+ */
+struct DbgVaArgsReader final
+{
+    va_list args; // Variable argument list
 
-        memcpy(fmt_strval, fmtString, fmt_strlen + 1);
+    DbgVaArgsReader(va_list srcArgs) noexcept { va_copy(this->args, srcArgs); }
+    ~DbgVaArgsReader() { va_end(this->args); }
 
-        va_start(arg_list, fmtArgsCount);
-        while (arg_list) __DbgFormatLog(log_content, &fmt_strval, arg_list);
-        va_end(arg_list);
-    }
-    else
+    int                     readInt() noexcept { return va_arg(this->args, int); }
+    wint_t                  readWideChar() noexcept { return va_arg(this->args, wint_t); }
+    double                  readDouble() noexcept { return va_arg(this->args, double); }
+    long double             readLongDouble() noexcept { return va_arg(this->args, long double); }
+    const char *            readString() noexcept { return va_arg(this->args, const char *); }
+    const wchar_t *         readWideString() noexcept { return va_arg(this->args, const wchar_t *); }
+    const void *            readPointer() noexcept { return va_arg(this->args, const void *); }
+    const dbg_log_datas_t * readDatas() noexcept { return va_arg(this->args, const dbg_log_datas_t *); }
+
+    longlong readSigned(const char lengthMod) noexcept
     {
-        log_content += fmtString;
+        switch (lengthMod)
+        {
+            case 'H': return (signed char)va_arg(this->args, int);
+            case 'h': return (short)va_arg(this->args, int);
+            case 'l': return va_arg(this->args, long);
+            case 'L': return va_arg(this->args, longlong);
+            case 'j': return va_arg(this->args, intmax_t);
+            case 'z': return va_arg(this->args, ssize_t);
+            case 't': return va_arg(this->args, ptrdiff_t);
+            default:  return va_arg(this->args, int);
+        }
     }
 
-    if ((logType & 0x0400))
+    ulonglong readUnsigned(const char lengthMod) noexcept
     {
-        std::unique_ptr<char[]> errno_str = std::make_unique<char[]>(0xFF);
-        errno_str[0]                      = '\0';
+        switch (lengthMod)
+        {
+            case 'H': return (uchar)va_arg(this->args, uint);
+            case 'h': return (unsigned short)va_arg(this->args, uint);
+            case 'l': return va_arg(this->args, ulong);
+            case 'L': return va_arg(this->args, ulonglong);
+            case 'j': return va_arg(this->args, uintmax_t);
+            case 'z': return va_arg(this->args, size_t);
+            case 't': return (ulonglong)va_arg(this->args, ptrdiff_t);
+            default:  return va_arg(this->args, uint);
+        }
+    }
+};
 
-#if defined(_MSC)
-        if (error_code)
-            strerror_s(errno_str.get(), 0xFF, error_code);
-        else if (last_error)
-            ::FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, error_code, 0, (LPTSTR)errno_str.get(), 0xFF, NULL);
-        if (errno_str[0] == '\0') sprintf(errno_str.get(), error_code ? "Unknow error code (%d)." : "Unknow error code (%lu).", error_code ? error_code : last_error);
-#elif defined(_GCC)
-        if (error_code) strerror_r(error_code, errno_str.get(), 0xFF);
-        if (errno_str[0] == '\0') sprintf(errno_str.get(), "Unknow error code (%d).", error_code);
-#endif
+/**
+ * @brief Debug log format arguments reader (Reads from binary record, see DBGLOG_ENTRY_RECORD; Reads past the end return zero values)
+ */
+struct DbgRecordArgsReader final
+{
+    const uchar *   argsPos;    // Current position
+    const uchar *   argsEnd;    // End of the arguments
+    dbg_log_datas_t datasArg;   // Datas argument (Points into the arguments)
+    DbgLogBuffer    wideString; // Wide string argument (Copied out for alignment)
 
-        log_content += " ";
-        log_content += errno_str.get();
+    DbgRecordArgsReader(const uchar * argsDatas, const size_t argsLength) noexcept : argsPos(argsDatas), argsEnd(argsDatas + argsLength), datasArg(nullptr, 0) {}
+
+    /**
+     * @brief Whether to an integer with the length modifier is recorded as int64
+     *
+     * @param lengthMod     Length modifier
+     * @return bool         True: int64; False: int32
+     */
+    static bool isWideInteger(const char lengthMod) noexcept
+    {
+        dbg_log_spec_t int_spec;
+
+        int_spec.conversion = 'd';
+        int_spec.lengthMod  = lengthMod;
+        return DbgFormatSpecClass(int_spec) == DBGLOG_ARG_INT64;
     }
 
+    const uchar * readBytes(const size_t readLength) noexcept
     {
-        std::unique_lock<std::mutex> inner_locker(__InnerMutex);
+        const uchar * read_pos = this->argsPos;
 
-        if (__DbgLogHandle)
+        if ((size_t)(this->argsEnd - this->argsPos) < readLength)
         {
-            inner_locker.unlock();
-
-            char date_str[] = "00000000";
-            snprintf(date_str, sizeof(log_time), "%04d%02d%02d", log_time.tm_year + 1900, log_time.tm_mon + 1, log_time.tm_mday);
-            log_content += "\r\n";
-            __DbgLogHandle(date_str, log_content.c_str(), log_content.size());
+            this->argsPos = this->argsEnd;
+            return nullptr;
         }
-        else
-        {
-#if defined(_WINDOWS)
-            HANDLE                     output_handle = GetStdHandle(STD_ERROR_HANDLE);
-            CONSOLE_SCREEN_BUFFER_INFO buffer_info;
-            if (!output_handle || output_handle == INVALID_HANDLE_VALUE || !GetConsoleScreenBufferInfo(output_handle, &buffer_info))
-            {
-                output_handle = nullptr;
-            }
-#endif
 
-            switch (logType & 0xff)
-            {
-                case ESL_FATAL:
-                case ESL_ERROR:
-#if defined(_WINDOWS)
-                    if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_GREEN | FOREGROUND_RED) | (BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
-                    fprintf(stderr, "%s", log_label);
-#elif defined(_LINUX)
-                    fprintf(stderr, "\033[41;33m%s\033[0m", log_label);
-#endif
-                    break;
-                case ESL_WARNING:
-#if defined(_WINDOWS)
-                    if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_BLUE) | (BACKGROUND_GREEN | BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
-                    fprintf(stderr, "%s", log_label);
-#elif defined(_LINUX)
-                    fprintf(stderr, "\033[43;34m%s\033[0m", log_label);
-#endif
-                    break;
-                default:
-#if defined(_WINDOWS)
-                    if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_BLUE & FOREGROUND_GREEN & FOREGROUND_RED) | (BACKGROUND_BLUE | BACKGROUND_GREEN | BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
-                    fprintf(stderr, "%s", log_label);
-#elif defined(_LINUX)
-                    fprintf(stderr, "\033[47;30m%s\033[0m", log_label);
-#endif
-                    break;
-            }
-            fflush(stderr);
+        this->argsPos += readLength;
+        return read_pos;
+    }
 
-#if defined(_WINDOWS)
-            if (output_handle) SetConsoleTextAttribute(output_handle, buffer_info.wAttributes);
-#endif
+    template <typename TValue>
+    TValue readValue() noexcept
+    {
+        TValue        read_value = TValue();
+        const uchar * read_pos   = this->readBytes(sizeof(TValue));
 
-            fprintf(stderr, "%s\r\n\r\n", log_content.c_str() + strlen(log_label));
-            fflush(stderr);
-        }
+        if (read_pos) memcpy(&read_value, read_pos, sizeof(TValue));
+        return read_value;
     }
 
-#ifdef _DEBUG
-    if ((logType & ESL_WARNING) || (logType & ESL_ERROR) || (logType & ESL_FATAL)) debug_break();
-#endif
+    int          readInt() noexcept { return this->readValue<int32_t>(); }
+    wint_t       readWideChar() noexcept { return (wint_t)this->readValue<int32_t>(); }
+    double       readDouble() noexcept { return this->readValue<double>(); }
+    long double  readLongDouble() noexcept { return this->readValue<long double>(); }
+    const void * readPointer() noexcept { return (const void *)(uintptr_t)this->readValue<uint64_t>(); }
 
-    if (logType & ESL_FATAL)
+    const char * readString() noexcept
     {
-#if defined(_MSC)
-        ExitProcess(STATUS_FATAL_APP_EXIT);
+        uint32_t      str_length = this->readValue<uint32_t>();
+        const uchar * str_datas  = nullptr;
+
+        if (str_length == 0xffffffff) return nullptr;
+
+        str_datas = this->readBytes((size_t)str_length + 1);
+        return (str_datas && str_datas[str_length] == '\0' ? (const char *)str_datas : "");
+    }
+
+    const wchar_t * readWideString() noexcept
+    {
+        uint32_t      str_count = this->readValue<uint32_t>();
+        const uchar * str_datas = nullptr;
+        wchar_t       str_end   = L'\0';
+
+        if (str_count == 0xffffffff) return nullptr;
+
+        str_datas = this->readBytes(((size_t)str_count + 1) * sizeof(wchar_t));
+        if (str_datas) memcpy(&str_end, str_datas + (size_t)str_count * sizeof(wchar_t), sizeof(wchar_t));
+        if (!str_datas || str_end != L'\0' || !this->wideString.reserve(((size_t)str_count + 1) * sizeof(wchar_t))) return L"";
+
+        memcpy(this->wideString.datas, str_datas, ((size_t)str_count + 1) * sizeof(wchar_t));
+        return (const wchar_t *)this->wideString.datas;
+    }
+
+    const dbg_log_datas_t * readDatas() noexcept
+    {
+        uint32_t      datas_length = this->readValue<uint32_t>();
+        uint32_t      datas_bytes  = this->readValue<uint32_t>();
+        const uchar * datas_pos    = this->readBytes(datas_bytes);
+
+        this->datasArg.datas  = (const char *)datas_pos;
+        this->datasArg.length = (datas_pos ? datas_length : 0);
+        return &this->datasArg;
+    }
+
+    longlong readSigned(const char lengthMod) noexcept
+    {
+        longlong int_value = (DbgRecordArgsReader::isWideInteger(lengthMod) ? this->readValue<int64_t>() : this->readValue<int32_t>());
+
+        switch (lengthMod)
+        {
+            case 'H': return (signed char)int_value;
+            case 'h': return (short)int_value;
+            case 'l': return (long)int_value;
+            case 'j': return (intmax_t)int_value;
+            case 'z': return (ssize_t)int_value;
+            case 't': return (ptrdiff_t)int_value;
+            default:  return int_value;
+        }
+    }
+
+    ulonglong readUnsigned(const char lengthMod) noexcept
+    {
+        ulonglong int_value = (DbgRecordArgsReader::isWideInteger(lengthMod) ? this->readValue<uint64_t>() : this->readValue<uint32_t>());
+
+        switch (lengthMod)
+        {
+            case 'H': return (uchar)int_value;
+            case 'h': return (unsigned short)int_value;
+            case 'l': return (ulong)int_value;
+            case 'j': return (uintmax_t)int_value;
+            case 'z': return (size_t)int_value;
+            case 't': return (ulonglong)(ptrdiff_t)int_value;
+            default:  return int_value;
+        }
+    }
+};
+
+//================================================================================
+// Initialize inside variable
+//================================================================================
+#if (defined(_MSC) && defined(_CRTDBG_MAP_ALLOC)) || defined(_QT_FRAMEWORK_USED)
+static DebugHelperPrivate __DebugHelperPrivate;
+#endif
+
+/**
+ * @brief Inner mutex
+ */
+static std::mutex __InnerMutex;
+
+/**
+ * @brief Debug log infomation handling function
+ */
+static dbg_log_handle_t __DbgLogHandle = nullptr;
+
+/**
+ * @brief Debug log batch handling function (Exclusive with __DbgLogHandle)
+ */
+static dbg_log_batch_t __DbgLogBatchHandle = nullptr;
+
+/**
+ * @brief Debug log routing table generation (Increased by every route change, invalidates the route caches of every call site; Protected by __InnerMutex)
+ */
+static uint32_t __DbgRouteGeneration = 1;
+
+/**
+ * @brief Debug log current routing table (Nullptr: no route was added yet; Read by the logs without a lock)
+ */
+static std::atomic<DbgRouteTable *> __DbgRouteTable(nullptr);
+
+/**
+ * @brief Debug log routing tables held by current thread (Index: table index; A sink may log or change the routes again)
+ */
+static thread_local size_t __DbgRouteHolds[DBGLOG_ROUTE_TABLES] = {0};
+
+/**
+ * @brief Debug log routes count (Logs skip the routing table while it is empty)
+ */
+static std::atomic<int> __DbgRouteCount(0);
+
+/**
+ * @brief Debug log buffer allocate count (Counts every heap allocation made by the log buffers)
+ */
+static std::atomic<size_t> __DbgLogAllocCount(0);
+
+/**
+ * @brief Debug log buffer of current thread
+ */
+static thread_local DbgThreadBuffer __DbgLogBuffer;
+
+/**
+ * @brief Debug format buffer of current thread (Used by DbgFormatString())
+ */
+static thread_local DbgThreadBuffer __DbgFormatBuffer;
+
+/**
+ * @brief Whether the thread buffers of current thread are destroyed (Set by the exiting thread)
+ */
+static thread_local bool __DbgLogExited = false;
+
+/**
+ * @brief Debug log nesting depth of current thread (Nested calls from a log handler use their own buffer)
+ */
+static thread_local int __DbgLogDepth = 0;
+
+/**
+ * @brief Debug log drop count (Counts logs dropped by the async overflow policies)
+ */
+static std::atomic<size_t> __DbgLogDropCount(0);
+
+/**
+ * @brief Whether current thread is the async consumer (Logs from the consumer thread are output synchronously)
+ */
+static thread_local bool __DbgLogIsConsumer = false;
+
+/**
+ * @brief Call site whose suppressed count is reported by the next log of current thread (Set by DbgCheckLimit())
+ */
+static thread_local const dbg_log_site_t * __DbgSuppressSite = nullptr;
+
+/**
+ * @brief Suppressed count reported by the next log of current thread
+ */
+static thread_local uint32_t __DbgSuppressCount = 0;
+
+/**
+ * @brief Log limits with suppressed counts not reported yet (Reported by a summary log once their second is over)
+ */
+static std::atomic<dbg_log_limit_t *> __DbgSuppressPending(nullptr);
+
+/**
+ * @brief Second of the last pending check in synchronous mode (Units: seconds of the log time; The logs check the list once per second)
+ */
+static std::atomic<int64_t> __DbgSuppressChecked(0);
+
+/**
+ * @brief Debug log async queue
+ */
+static DbgAsyncQueue __DbgAsyncQueue;
+
+/**
+ * @brief Debug log suppress reporter (Destroyed before the async queue)
+ */
+static DbgSuppressReporter __DbgSuppressReporter;
+
+/**
+ * @brief Debug log async ring owner of current thread
+ */
+static thread_local DbgAsyncRingOwner __DbgAsyncRingOwner;
+
+/**
+ * @brief Whether the consumer runs the heavy barrier (Registered by DbgAsyncQueue::start(); False: the producers of the async rings run a full fence instead)
+ */
+static std::atomic<bool> __DbgHeavyBarrier(false);
+
+/**
+ * @brief Debug log time cache of current thread
+ */
+static thread_local DbgLogTimeCache __DbgLogTimeCache;
+
+/**
+ * @brief Fork generation (Increased in the child process after fork, invalidates the self IDs of every thread)
+ */
+static std::atomic<uint> __DbgForkGeneration(1);
+
+/**
+ * @brief Debug log self IDs of current thread
+ */
+static thread_local DbgSelfIds __DbgSelfIds;
+
+/**
+ * @brief Debug log registered modules (Protected by __InnerMutex)
+ */
+static dbg_log_module_t * __DbgLogModules = nullptr;
+
+/**
+ * @brief Whether to defer formatting to the async consumer thread
+ */
+static std::atomic<bool> __DbgDeferredMode(false);
+
+/**
+ * @brief Debug log binary stream writing function (Protected by __InnerMutex)
+ */
+static dbg_log_write_t __DbgStreamWrite = nullptr;
+
+/**
+ * @brief Debug log encoder (Use DBGLOG_ENCODER_* macros)
+ */
+static std::atomic<int> __DbgLogEncoder(DBGLOG_ENCODER_TEXT);
+
+/**
+ * @brief Decimal digit pairs ("00" to "99")
+ */
+static const char __DbgDigitsTable[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/**
+ * @brief Binary dump table
+ */
+static constexpr DbgDumpBitTable __DbgDumpBitTable;
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Grow the buffer (Slow path of reserve)
+ *
+ * @param addLength     Will to append length (Without terminator '\0')
+ * @return bool         Whether to the buffer have enough space
+ */
+bool DbgLogBuffer::grow(const size_t addLength) noexcept
+{
+    size_t new_capacity = MAX(this->capacity * 2, (size_t)DBGLOG_BUFFER_INIT_LENGTH);
+    while (new_capacity <= this->length + addLength) new_capacity += MAX(new_capacity / 2, (size_t)DBGLOG_STRING_STEP_LENGTH);
+
+    char * new_datas = static_cast<char *>(realloc(this->datas, new_capacity));
+    if (!new_datas) return false;
+
+    __DbgLogAllocCount.fetch_add(1, std::memory_order_relaxed);
+    if (!this->datas) new_datas[0] = '\0';
+    this->datas    = new_datas;
+    this->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Append format string (Formats directly into the free space of the buffer)
+ *
+ * @param fmtString     Format string (Reference sprintf() specifier)
+ * @param ...           Format arguments
+ */
+void DbgLogBuffer::appendFormat(const char * fmtString, ...) noexcept
+{
+    va_list arg_list;
+    int     add_length = 0;
+
+    if (!this->reserve(DBGLOG_STRING_STEP_LENGTH)) return;
+
+    va_start(arg_list, fmtString);
+    add_length = vsnprintf(this->datas + this->length, this->capacity - this->length, fmtString, arg_list);
+    va_end(arg_list);
+    if (add_length < 0) return;
+
+    if ((size_t)add_length >= this->capacity - this->length)
+    {
+        if (!this->reserve(add_length)) return;
+
+        va_start(arg_list, fmtString);
+        vsnprintf(this->datas + this->length, this->capacity - this->length, fmtString, arg_list);
+        va_end(arg_list);
+    }
+    this->length += add_length;
+}
+
+/**
+ * @brief Fill character
+ *
+ * @param outBuffer     Output buffer
+ * @param fillChar      Fill character
+ * @param fillCount     Fill count
+ */
+static inline void __DbgWriteFill(DbgLogBuffer & outBuffer, const char fillChar, const size_t fillCount) noexcept
+{
+    if (fillCount == 0 || !outBuffer.reserve(fillCount)) return;
+    memset(outBuffer.datas + outBuffer.length, fillChar, fillCount);
+    outBuffer.length                   += fillCount;
+    outBuffer.datas[outBuffer.length]   = '\0';
+}
+
+/**
+ * @brief Write text with field width
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param textDatas     Text datas
+ * @param textLength    Text length
+ */
+static void __DbgWriteText(DbgLogBuffer & outBuffer, const dbg_log_spec_t & fmtSpec, const char * textDatas, const size_t textLength) noexcept
+{
+    size_t pad_length = ((size_t)fmtSpec.width > textLength ? fmtSpec.width - textLength : 0);
+
+    if (!(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+    outBuffer.append(textDatas, textLength);
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+}
+
+/**
+ * @brief Write fixed width decimal digits (Zero padded, without terminator)
+ *
+ * @param outDatas      Output datas (At least digitsCount characters)
+ * @param digitsValue   Digits value (Less than 10 ^ digitsCount)
+ * @param digitsCount   Digits count
+ */
+static inline void __DbgWriteDigits(char * outDatas, uint digitsValue, const uint digitsCount) noexcept
+{
+    char * digits_pos = outDatas + digitsCount;
+
+    while (digits_pos - outDatas >= 2)
+    {
+        const char * digits_pair = &__DbgDigitsTable[(digitsValue % 100) * 2];
+        digitsValue             /= 100;
+        *--digits_pos            = digits_pair[1];
+        *--digits_pos            = digits_pair[0];
+    }
+    if (digits_pos != outDatas) *--digits_pos = (char)('0' + digitsValue % 10);
+}
+
+/**
+ * @brief Update the time cache of current thread (Calls localtime only when the second changes)
+ *
+ * @param timeTotal                 Log time (Milliseconds since epoch)
+ * @return const DbgLogTimeCache&   Time cache of current thread (Valid until the next call on the same thread)
+ */
+static const DbgLogTimeCache & __DbgUpdateTimeCache(const long long timeTotal) noexcept
+{
+    DbgLogTimeCache & time_cache  = __DbgLogTimeCache;
+    std::time_t       time_stamp  = (std::time_t)(timeTotal / 1000LL);
+    uint              time_millis = (uint)(timeTotal % 1000LL);
+
+    if (time_stamp != time_cache.cacheSecond)
+    {
+        tm log_time = {};
+
+        log_time.tm_mday = 1;
+
+#if defined(_MSC)
+        if (localtime_s(&log_time, &time_stamp) == ESV_SUCCESS)
 #elif defined(_GCC)
-        abort();
+        if (localtime_r(&time_stamp, &log_time))
+#endif
+        {
+            char * time_str = time_cache.timeString;
+
+            __DbgWriteDigits(time_str,      (uint)(log_time.tm_year + 1900) % 10000, 4);
+            __DbgWriteDigits(time_str + 5,  (uint)(log_time.tm_mon + 1), 2);
+            __DbgWriteDigits(time_str + 8,  (uint)log_time.tm_mday, 2);
+            __DbgWriteDigits(time_str + 11, (uint)log_time.tm_hour, 2);
+            __DbgWriteDigits(time_str + 14, (uint)log_time.tm_min, 2);
+            __DbgWriteDigits(time_str + 17, (uint)log_time.tm_sec, 2);
+
+            memcpy(time_cache.dateString,     time_str,     4);
+            memcpy(time_cache.dateString + 4, time_str + 5, 2);
+            memcpy(time_cache.dateString + 6, time_str + 8, 2);
+        }
+        time_cache.cacheSecond = time_stamp;
+    }
+    __DbgWriteDigits(time_cache.timeString + 20, time_millis, 3);
+
+    return time_cache;
+}
+
+/**
+ * @brief Get debug log routing tables (DBGLOG_ROUTE_TABLES tables; Never freed, a log may still hold a replaced table)
+ *
+ * @return DbgRouteTable*   Routing tables
+ */
+static DbgRouteTable * __DbgRouteTables() noexcept
+{
+    static DbgRouteTable route_tables[DBGLOG_ROUTE_TABLES];
+    return route_tables;
+}
+
+/**
+ * @brief Reset the debug log routing tables in the child process after fork (The logs of the threads that are gone never let their tables go)
+ */
+static void __DbgResetRoutes() noexcept
+{
+    DbgRouteTable * route_tables = __DbgRouteTables();
+
+    for (int table_idx = 0; table_idx < DBGLOG_ROUTE_TABLES; table_idx++) route_tables[table_idx].activeCount.store(__DbgRouteHolds[table_idx]);
+}
+
+/**
+ * @brief Reset the debug log state in the child process after fork
+ */
+static void __DbgAtForkChild() noexcept
+{
+    // Only the forking thread exists in the child, the inner mutex may be held by a thread that is gone
+    new (&__InnerMutex) std::mutex();
+    __DbgForkGeneration.fetch_add(1);
+    __DbgResetRoutes();
+    __DbgAsyncQueue.resetAfterFork();
+}
+
+/**
+ * @brief Register the fork handler (Once per process)
+ */
+static void __DbgRegisterAtFork() noexcept
+{
+#if defined(_LINUX)
+    static const int atfork_result = pthread_atfork(nullptr, nullptr, __DbgAtForkChild);
+    (void)atfork_result;
+#endif
+}
+
+/**
+ * @brief Register the heavy barrier (Linux: membarrier() private expedited, 4.14 and later; Windows: FlushProcessWriteBuffers())
+ *
+ * @return bool         Whether to the heavy barrier is available
+ */
+static bool __DbgRegisterHeavyBarrier() noexcept
+{
+#if defined(_MSC)
+    return true;
+#elif defined(DBGLOG_MEMBARRIER_ENABLE) && defined(__NR_membarrier)
+    return syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+    return false;
 #endif
+}
+
+/**
+ * @brief Run a full barrier on every thread of the process (Pairs with the compiler barrier of the ring producers, see __DbgRingBarrier())
+ */
+static void __DbgRunHeavyBarrier() noexcept
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!__DbgHeavyBarrier.load(std::memory_order_relaxed)) return;
+
+#if defined(_MSC)
+    FlushProcessWriteBuffers();
+#elif defined(DBGLOG_MEMBARRIER_ENABLE) && defined(__NR_membarrier)
+    syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+#endif
+}
+
+/**
+ * @brief Order the ring producer store before its next load (A compiler barrier if the consumer runs the heavy barrier, a full fence otherwise)
+ */
+static inline void __DbgRingBarrier() noexcept
+{
+    if (__DbgHeavyBarrier.load(std::memory_order_relaxed))
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/**
+ * @brief Get the self IDs of current thread (Fetched once per thread, and again after fork)
+ *
+ * @return const DbgSelfIds&    Self IDs of current thread
+ */
+static const DbgSelfIds & __DbgGetSelfIds() noexcept
+{
+    DbgSelfIds & self_ids        = __DbgSelfIds;
+    uint         fork_generation = __DbgForkGeneration.load(std::memory_order_relaxed);
+
+    if (self_ids.forkGeneration != fork_generation)
+    {
+        __DbgRegisterAtFork();
+        self_ids.processId      = SELF_PROCESS_ID;
+        self_ids.threadId       = SELF_NATIVE_THREAD_ID;
+        self_ids.forkGeneration = fork_generation;
     }
+
+    return self_ids;
+}
+
+/**
+ * @brief Destruct function (The exiting thread does not use the thread buffers any more)
+ */
+DbgThreadBuffer::~DbgThreadBuffer()
+{
+    __DbgLogExited = true;
 }
+
+/**
+ * @brief Close the async ring of the exiting thread (The consumer still outputs its logs, then a new thread may reuse it)
+ */
+DbgAsyncRingOwner::~DbgAsyncRingOwner()
+{
+    if (this->asyncRing && this->forkGeneration == __DbgForkGeneration.load(std::memory_order_relaxed)) this->asyncRing->isClosed.store(true, std::memory_order_release);
+
+    // Logs of the later thread destructors use the queue, the closed ring may be reused by a new thread meanwhile
+    this->asyncRing = nullptr;
+    this->isExited  = true;
+}
+
+/**
+ * @brief Write integer
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param absValue      Absolute value
+ * @param signChar      Sign character ('\0': without sign)
+ * @param valueRadix    Value radix (8 or 10)
+ */
+static void __DbgWriteInteger(DbgLogBuffer & outBuffer, const dbg_log_spec_t & fmtSpec, ulonglong absValue, const char signChar, const uint valueRadix) noexcept
+{
+    char   digits_str[24];
+    char * digits_end = digits_str + sizeof(digits_str);
+    char * digits_pos = digits_end;
+    size_t digits_len = 0;
+    size_t zeros_len  = 0;
+    size_t total_len  = 0;
+    size_t pad_length = 0;
+
+    if (absValue == 0)
+    {
+        if (fmtSpec.precision != 0) *--digits_pos = '0';
+    }
+    else if (valueRadix == 10)
+    {
+        while (absValue >= 100)
+        {
+            const char * digits_pair = &__DbgDigitsTable[(absValue % 100) * 2];
+            absValue                /= 100;
+            *--digits_pos            = digits_pair[1];
+            *--digits_pos            = digits_pair[0];
+        }
+        if (absValue >= 10)
+        {
+            *--digits_pos = __DbgDigitsTable[absValue * 2 + 1];
+            *--digits_pos = __DbgDigitsTable[absValue * 2];
+        }
+        else
+        {
+            *--digits_pos = (char)('0' + absValue);
+        }
+    }
+    else
+    {
+        while (absValue)
+        {
+            *--digits_pos  = (char)('0' + (absValue & 0x07));
+            absValue     >>= 3;
+        }
+        if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ALT)) *--digits_pos = '0';
+    }
+    if (valueRadix == 8 && (fmtSpec.flags & DBGLOG_SPEC_FLAG_ALT) && digits_pos == digits_end) *--digits_pos = '0';
+
+    digits_len = digits_end - digits_pos;
+    if (fmtSpec.precision >= 0 && (size_t)fmtSpec.precision > digits_len)
+        zeros_len = fmtSpec.precision - digits_len;
+    else if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ZERO) && !(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT) && fmtSpec.precision < 0 && (size_t)fmtSpec.width > digits_len + (signChar ? 1 : 0))
+        zeros_len = fmtSpec.width - digits_len - (signChar ? 1 : 0);
+    total_len  = (signChar ? 1 : 0) + zeros_len + digits_len;
+    pad_length = ((size_t)fmtSpec.width > total_len ? fmtSpec.width - total_len : 0);
+
+    if (!outBuffer.reserve(total_len + pad_length)) return;
+    if (!(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+    if (signChar) outBuffer.datas[outBuffer.length++] = signChar;
+    __DbgWriteFill(outBuffer, '0', zeros_len);
+    outBuffer.append(digits_pos, digits_len);
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+}
+
+/**
+ * @brief Write pointer (Format: "0x" + lowercase hex digits, precision and zero flag pad the digits like "%#x"; Nullptr: "(nil)" padded to the width)
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param ptrValue      Pointer value
+ */
+static void __DbgWritePointer(DbgLogBuffer & outBuffer, const dbg_log_spec_t & fmtSpec, const void * ptrValue) noexcept
+{
+    char      digits_str[sizeof(void *) * 2];
+    char *    digits_end = digits_str + sizeof(digits_str);
+    char *    digits_pos = digits_end;
+    uintptr_t ptr_value  = (uintptr_t)ptrValue;
+    char      sign_char  = ((fmtSpec.flags & DBGLOG_SPEC_FLAG_PLUS) ? '+' : ((fmtSpec.flags & DBGLOG_SPEC_FLAG_SPACE) ? ' ' : '\0'));
+    size_t    prefix_len = (sign_char ? 3 : 2);
+    size_t    digits_len = 0;
+    size_t    zeros_len  = 0;
+    size_t    total_len  = 0;
+    size_t    pad_length = 0;
+
+    if (!ptrValue)
+    {
+        __DbgWriteText(outBuffer, fmtSpec, "(nil)", 5);
+        return;
+    }
+
+    while (ptr_value)
+    {
+        *--digits_pos   = "0123456789abcdef"[ptr_value & 0x0f];
+        ptr_value     >>= 4;
+    }
+
+    digits_len = digits_end - digits_pos;
+    if (fmtSpec.precision >= 0 && (size_t)fmtSpec.precision > digits_len)
+        zeros_len = fmtSpec.precision - digits_len;
+    else if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ZERO) && !(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT) && fmtSpec.precision < 0 && (size_t)fmtSpec.width > digits_len + prefix_len)
+        zeros_len = fmtSpec.width - digits_len - prefix_len;
+    total_len  = prefix_len + zeros_len + digits_len;
+    pad_length = ((size_t)fmtSpec.width > total_len ? fmtSpec.width - total_len : 0);
+
+    if (!outBuffer.reserve(total_len + pad_length)) return;
+    if (!(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+    if (sign_char) outBuffer.datas[outBuffer.length++] = sign_char;
+    outBuffer.append("0x", 2);
+    __DbgWriteFill(outBuffer, '0', zeros_len);
+    outBuffer.append(digits_pos, digits_len);
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+}
+
+/**
+ * @brief Write double in fixed-point notation ("%f" and "%F"; Digits are exact and rounded half to even like glibc)
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param argValue      Format argument
+ * @return true         Written
+ * @return false        Not supported (Infinite, not a number, over 2^64 or over DBGLOG_FIXED_MAX_PRECISION; Use the standard formatter)
+ */
+static bool __DbgWriteFixed(DbgLogBuffer & outBuffer, const dbg_log_spec_t & fmtSpec, const double argValue) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    static const uint64_t POW10_TABLE[DBGLOG_FIXED_MAX_PRECISION + 1] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+                                                                         10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+                                                                         1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+                                                                         10000000000000000000ULL};
+    int      precision  = (fmtSpec.precision < 0 ? 6 : fmtSpec.precision);
+    uint64_t value_bits = 0;
+    uint64_t mantissa   = 0;
+    int      exp_bits   = 0;
+    int      frac_shift = 0; // Value is mantissa / 2^frac_shift
+    uint64_t int_part   = 0;
+    uint64_t frac_part  = 0;
+    uint64_t frac_value = 0; // Fraction digits as an integer
+    char     sign_char  = '\0';
+    char     digits_str[24 + DBGLOG_FIXED_MAX_PRECISION];
+    char *   digits_end = digits_str + sizeof(digits_str);
+    char *   digits_pos = digits_end;
+    size_t   digits_len = 0;
+    size_t   zeros_len  = 0;
+    size_t   pad_length = 0;
+
+    memcpy(&value_bits, &argValue, sizeof(value_bits));
+    exp_bits = (int)((value_bits >> 52) & 0x7ff);
+    mantissa = value_bits & ((1ULL << 52) - 1);
+    if (exp_bits == 0x7ff || precision > DBGLOG_FIXED_MAX_PRECISION) return false;
+    if (exp_bits) mantissa |= (1ULL << 52);
+    frac_shift = (exp_bits ? 1075 - exp_bits : 1074);
+    if (frac_shift < -11) return false;
+
+    if (frac_shift <= 0)
+    {
+        int_part = mantissa << -frac_shift;
+    }
+    else
+    {
+        int_part  = (frac_shift < 64 ? mantissa >> frac_shift : 0);
+        frac_part = (frac_shift < 64 ? mantissa & ((1ULL << frac_shift) - 1) : mantissa);
+
+        // Past 2^-128 the fraction digits round to zero, the scaled fraction is below half a unit
+        if (frac_shift < 128)
+        {
+            unsigned __int128 frac_scaled = (unsigned __int128)frac_part * POW10_TABLE[precision];
+            unsigned __int128 rest_value  = frac_scaled & (((unsigned __int128)1 << frac_shift) - 1);
+            unsigned __int128 half_value  = (unsigned __int128)1 << (frac_shift - 1);
+
+            frac_value = (uint64_t)(frac_scaled >> frac_shift);
+            if (rest_value > half_value || (rest_value == half_value && ((precision ? frac_value : int_part) & 1))) frac_value++;
+            if (frac_value == POW10_TABLE[precision])
+            {
+                frac_value = 0;
+                int_part++;
+            }
+        }
+    }
+
+    // Digits are written backwards: fraction, point, integer part
+    for (int digit_idx = 0; digit_idx < precision; digit_idx++)
+    {
+        *--digits_pos  = (char)('0' + frac_value % 10);
+        frac_value    /= 10;
+    }
+    if (precision || (fmtSpec.flags & DBGLOG_SPEC_FLAG_ALT)) *--digits_pos = '.';
+    do
+    {
+        *--digits_pos  = (char)('0' + int_part % 10);
+        int_part      /= 10;
+    } while (int_part);
+
+    sign_char  = ((value_bits >> 63) ? '-' : ((fmtSpec.flags & DBGLOG_SPEC_FLAG_PLUS) ? '+' : ((fmtSpec.flags & DBGLOG_SPEC_FLAG_SPACE) ? ' ' : '\0')));
+    digits_len = digits_end - digits_pos;
+    if ((size_t)fmtSpec.width > digits_len + (sign_char ? 1 : 0))
+    {
+        if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ZERO) && !(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT))
+            zeros_len = fmtSpec.width - digits_len - (sign_char ? 1 : 0);
+        else
+            pad_length = fmtSpec.width - digits_len - (sign_char ? 1 : 0);
+    }
+
+    if (!outBuffer.reserve((sign_char ? 1 : 0) + zeros_len + digits_len + pad_length)) return true;
+    if (!(fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+    if (sign_char) outBuffer.datas[outBuffer.length++] = sign_char;
+    __DbgWriteFill(outBuffer, '0', zeros_len);
+    outBuffer.append(digits_pos, digits_len);
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT)) __DbgWriteFill(outBuffer, ' ', pad_length);
+
+    return true;
+#else
+    (void)outBuffer;
+    (void)fmtSpec;
+    (void)argValue;
+    return false;
+#endif
+}
+
+/**
+ * @brief Write value by the standard formatter (Used to floating point and wide character conversions)
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param argValue      Format argument (Type matches the conversion: wint_t, const wchar_t *, double or long double)
+ */
+template <typename TValue>
+static void __DbgWriteStandard(DbgLogBuffer & outBuffer, const dbg_log_spec_t & fmtSpec, const TValue argValue) noexcept
+{
+    char   spec_str[DBGLOG_SPECIFIER_MAX_LENGTH];
+    size_t spec_len = 0;
+    int    add_len  = 0;
+
+    spec_str[spec_len++] = '%';
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_LEFT))  spec_str[spec_len++] = '-';
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_PLUS))  spec_str[spec_len++] = '+';
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_SPACE)) spec_str[spec_len++] = ' ';
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ALT))   spec_str[spec_len++] = '#';
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_ZERO))  spec_str[spec_len++] = '0';
+    spec_str[spec_len++] = '*';
+    spec_str[spec_len++] = '.';
+    spec_str[spec_len++] = '*';
+    if (fmtSpec.lengthMod == 'L' || fmtSpec.lengthMod == 'l') spec_str[spec_len++] = fmtSpec.lengthMod;
+    spec_str[spec_len++] = fmtSpec.conversion;
+    spec_str[spec_len]   = '\0';
+
+    if (!outBuffer.reserve(DBGLOG_STRING_STEP_LENGTH)) return;
+
+    // The value is the only argument after width and precision, its type is fixed by the caller
+    for (int loop_idx = 0; loop_idx < 2; loop_idx++)
+    {
+        add_len = snprintf(outBuffer.datas + outBuffer.length, outBuffer.capacity - outBuffer.length, spec_str, fmtSpec.width, fmtSpec.precision, argValue);
+
+        if (add_len < 0) return;
+        if ((size_t)add_len < outBuffer.capacity - outBuffer.length) break;
+        if (!outBuffer.reserve(add_len)) return;
+    }
+    outBuffer.length += add_len;
+}
+
+/**
+ * @brief Hex dump kernel (Scalar)
+ *
+ * @param outDatas      Output datas (At least 3 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ * @param isUpper       Whether to use uppercase digits
+ */
+static void __DbgDumpHexScalar(char * outDatas, const uchar * srcDatas, const size_t srcLength, const bool isUpper)
+{
+    const char * HEX_TABLE = (isUpper ? "0123456789ABCDEF" : "0123456789abcdef");
+
+    for (size_t loop_idx = 0; loop_idx < srcLength; loop_idx++)
+    {
+        outDatas[0]  = HEX_TABLE[srcDatas[loop_idx] >> 4];
+        outDatas[1]  = HEX_TABLE[srcDatas[loop_idx] & 0x0f];
+        outDatas[2]  = ' ';
+        outDatas    += 3;
+    }
+}
+
+/**
+ * @brief Binary dump kernel (Scalar; Spreads the 8 bits of a byte into 8 characters with one multiply)
+ *
+ * @param outDatas      Output datas (At least 9 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ */
+static void __DbgDumpBitScalar(char * outDatas, const uchar * srcDatas, const size_t srcLength)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    const uint64_t BIT_MASK = 0x8040201008040201ULL; // Most significant bit in the first character
+#else
+    const uint64_t BIT_MASK = 0x0102040810204080ULL; // Most significant bit in the first character
+#endif
+
+    for (size_t loop_idx = 0; loop_idx < srcLength; loop_idx++)
+    {
+        uint64_t bit_chars = (srcDatas[loop_idx] * 0x0101010101010101ULL) & BIT_MASK;
+
+        bit_chars = (((bit_chars + 0x7f7f7f7f7f7f7f7fULL) >> 7) & 0x0101010101010101ULL) | 0x3030303030303030ULL;
+        memcpy(outDatas, &bit_chars, 8);
+        outDatas[8]  = ' ';
+        outDatas    += 9;
+    }
+}
+
+#if defined(DBGLOG_DUMP_SIMD)
+/**
+ * @brief Hex dump kernel (SSSE3; 16 source bytes per loop)
+ *
+ * @param outDatas      Output datas (At least 3 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ * @param isUpper       Whether to use uppercase digits
+ */
+DBGLOG_DUMP_TARGET("ssse3")
+static void __DbgDumpHexSsse3(char * outDatas, const uchar * srcDatas, const size_t srcLength, const bool isUpper)
+{
+    const __m128i hex_table  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(isUpper ? "0123456789ABCDEF" : "0123456789abcdef"));
+    const __m128i low_mask   = _mm_set1_epi8(0x0f);
+    // Spread 16 digit pairs (Two registers) into 48 characters "XX XX ...": -1 selects zero, the space is or-ed in afterwards
+    const __m128i spread_0a  = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m128i spread_1a  = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i spread_1b  = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+    const __m128i spread_2b  = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+    const __m128i space_0    = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m128i space_1    = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+    const __m128i space_2    = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ');
+    size_t        loop_idx   = 0;
+
+    for (; loop_idx + 16 <= srcLength; loop_idx += 16)
+    {
+        __m128i src_bytes  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcDatas + loop_idx));
+        __m128i high_chars = _mm_shuffle_epi8(hex_table, _mm_and_si128(_mm_srli_epi16(src_bytes, 4), low_mask));
+        __m128i low_chars  = _mm_shuffle_epi8(hex_table, _mm_and_si128(src_bytes, low_mask));
+        __m128i pairs_a    = _mm_unpacklo_epi8(high_chars, low_chars);
+        __m128i pairs_b    = _mm_unpackhi_epi8(high_chars, low_chars);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas),      _mm_or_si128(_mm_shuffle_epi8(pairs_a, spread_0a), space_0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + 16), _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(pairs_a, spread_1a), _mm_shuffle_epi8(pairs_b, spread_1b)), space_1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + 32), _mm_or_si128(_mm_shuffle_epi8(pairs_b, spread_2b), space_2));
+        outDatas += 48;
+    }
+
+    __DbgDumpHexScalar(outDatas, srcDatas + loop_idx, srcLength - loop_idx, isUpper);
+}
+
+/**
+ * @brief Hex dump kernel (AVX2; 32 source bytes per loop, each 128 bits lane spreads its own 16 bytes)
+ *
+ * @param outDatas      Output datas (At least 3 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ * @param isUpper       Whether to use uppercase digits
+ */
+DBGLOG_DUMP_TARGET("avx2")
+static void __DbgDumpHexAvx2(char * outDatas, const uchar * srcDatas, const size_t srcLength, const bool isUpper)
+{
+    const __m256i hex_table  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(isUpper ? "0123456789ABCDEF" : "0123456789abcdef")));
+    const __m256i low_mask   = _mm256_set1_epi8(0x0f);
+    const __m256i spread_0a  = _mm256_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+    const __m256i spread_1a  = _mm256_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, 11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i spread_1b  = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, -1, 2, 3, -1, 4, 5);
+    const __m256i spread_2b  = _mm256_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1, -1, 6, 7, -1, 8, 9, -1, 10, 11, -1, 12, 13, -1, 14, 15, -1);
+    const __m256i space_0    = _mm256_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0);
+    const __m256i space_1    = _mm256_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0);
+    const __m256i space_2    = _mm256_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ');
+    size_t        loop_idx   = 0;
+
+    for (; loop_idx + 32 <= srcLength; loop_idx += 32)
+    {
+        __m256i src_bytes  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcDatas + loop_idx));
+        __m256i high_chars = _mm256_shuffle_epi8(hex_table, _mm256_and_si256(_mm256_srli_epi16(src_bytes, 4), low_mask));
+        __m256i low_chars  = _mm256_shuffle_epi8(hex_table, _mm256_and_si256(src_bytes, low_mask));
+        __m256i pairs_a    = _mm256_unpacklo_epi8(high_chars, low_chars); // Lane 0: bytes 0-7, lane 1: bytes 16-23
+        __m256i pairs_b    = _mm256_unpackhi_epi8(high_chars, low_chars); // Lane 0: bytes 8-15, lane 1: bytes 24-31
+        __m256i chars_0    = _mm256_or_si256(_mm256_shuffle_epi8(pairs_a, spread_0a), space_0);
+        __m256i chars_1    = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(pairs_a, spread_1a), _mm256_shuffle_epi8(pairs_b, spread_1b)), space_1);
+        __m256i chars_2    = _mm256_or_si256(_mm256_shuffle_epi8(pairs_b, spread_2b), space_2);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(outDatas),      _mm256_permute2x128_si256(chars_0, chars_1, 0x20));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + 32),    _mm256_castsi256_si128(chars_2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(outDatas + 48), _mm256_permute2x128_si256(chars_0, chars_1, 0x31));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + 80),    _mm256_extracti128_si256(chars_2, 1));
+        outDatas += 96;
+    }
+
+    __DbgDumpHexScalar(outDatas, srcDatas + loop_idx, srcLength - loop_idx, isUpper);
+}
+
+/**
+ * @brief Binary dump kernel (SSSE3; 16 source bytes per loop, written as 9 full vectors)
+ *
+ * @param outDatas      Output datas (At least 9 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ */
+DBGLOG_DUMP_TARGET("ssse3")
+static void __DbgDumpBitSsse3(char * outDatas, const uchar * srcDatas, const size_t srcLength)
+{
+    size_t loop_idx = 0;
+
+    for (; loop_idx + 16 <= srcLength; loop_idx += 16)
+    {
+        __m128i src_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcDatas + loop_idx));
+
+        for (uint vec_idx = 0; vec_idx < 9; vec_idx++)
+        {
+            __m128i spread_idx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.spreadIdx + vec_idx * 16));
+            __m128i bit_mask   = _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.bitMask + vec_idx * 16));
+            __m128i char_base  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.charBase + vec_idx * 16));
+            __m128i bit_chars  = _mm_and_si128(_mm_shuffle_epi8(src_bytes, spread_idx), bit_mask);
+
+            bit_chars = _mm_sub_epi8(char_base, _mm_cmpeq_epi8(bit_chars, bit_mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + vec_idx * 16), bit_chars);
+        }
+        outDatas += 144;
+    }
+
+    __DbgDumpBitScalar(outDatas, srcDatas + loop_idx, srcLength - loop_idx);
+}
+
+/**
+ * @brief Binary dump kernel (AVX2; 16 source bytes per loop in both lanes, written as 4.5 full vectors)
+ *
+ * @param outDatas      Output datas (At least 9 * srcLength characters)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source datas length
+ */
+DBGLOG_DUMP_TARGET("avx2")
+static void __DbgDumpBitAvx2(char * outDatas, const uchar * srcDatas, const size_t srcLength)
+{
+    size_t loop_idx = 0;
+
+    for (; loop_idx + 16 <= srcLength; loop_idx += 16)
+    {
+        __m256i src_bytes = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcDatas + loop_idx)));
+        __m128i bit_half;
+
+        for (uint vec_idx = 0; vec_idx < 4; vec_idx++)
+        {
+            __m256i spread_idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(__DbgDumpBitTable.spreadIdx + vec_idx * 32));
+            __m256i bit_mask   = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(__DbgDumpBitTable.bitMask + vec_idx * 32));
+            __m256i char_base  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(__DbgDumpBitTable.charBase + vec_idx * 32));
+            __m256i bit_chars  = _mm256_and_si256(_mm256_shuffle_epi8(src_bytes, spread_idx), bit_mask);
+
+            bit_chars = _mm256_sub_epi8(char_base, _mm256_cmpeq_epi8(bit_chars, bit_mask));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(outDatas + vec_idx * 32), bit_chars);
+        }
+
+        bit_half = _mm_and_si128(_mm_shuffle_epi8(_mm256_castsi256_si128(src_bytes), _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.spreadIdx + 128))),
+                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.bitMask + 128)));
+        bit_half = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.charBase + 128)),
+                                _mm_cmpeq_epi8(bit_half, _mm_loadu_si128(reinterpret_cast<const __m128i *>(__DbgDumpBitTable.bitMask + 128))));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(outDatas + 128), bit_half);
+        outDatas += 144;
+    }
+
+    __DbgDumpBitScalar(outDatas, srcDatas + loop_idx, srcLength - loop_idx);
+}
+
+/**
+ * @brief Check whether the processor supports an instruction set
+ *
+ * @param isAvx2        True: AVX2; False: SSSE3
+ * @return true         Supported
+ * @return false        Not supported
+ */
+static bool __DbgCpuSupports(const bool isAvx2) noexcept
+{
+#if defined(_MSC)
+    int cpu_info[4] = {0};
+
+    __cpuid(cpu_info, 0);
+    if (cpu_info[0] < (isAvx2 ? 7 : 1)) return false;
+    __cpuid(cpu_info, 1);
+    if (!isAvx2) return (cpu_info[2] & (1 << 9)) != 0;
+    if ((cpu_info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x06) != 0x06) return false; // OSXSAVE, XMM and YMM state enabled
+    __cpuidex(cpu_info, 7, 0);
+    return (cpu_info[1] & (1 << 5)) != 0;
+#elif defined(_GCC)
+    __builtin_cpu_init();
+    return (isAvx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3"));
+#endif
+}
+#endif
+
+/**
+ * @brief Get hex dump kernel (Selected once by processor features)
+ *
+ * @return dbg_dump_hex_t   Hex dump kernel
+ */
+static dbg_dump_hex_t __DbgGetDumpHex() noexcept
+{
+#if defined(DBGLOG_DUMP_SIMD)
+    static const dbg_dump_hex_t dump_hex = (__DbgCpuSupports(true) ? __DbgDumpHexAvx2 : (__DbgCpuSupports(false) ? __DbgDumpHexSsse3 : __DbgDumpHexScalar));
+#else
+    static const dbg_dump_hex_t dump_hex = __DbgDumpHexScalar;
+#endif
+
+    return dump_hex;
+}
+
+/**
+ * @brief Get binary dump kernel (Selected once by processor features)
+ *
+ * @return dbg_dump_bit_t   Binary dump kernel
+ */
+static dbg_dump_bit_t __DbgGetDumpBit() noexcept
+{
+#if defined(DBGLOG_DUMP_SIMD)
+    static const dbg_dump_bit_t dump_bit = (__DbgCpuSupports(true) ? __DbgDumpBitAvx2 : (__DbgCpuSupports(false) ? __DbgDumpBitSsse3 : __DbgDumpBitScalar));
+#else
+    static const dbg_dump_bit_t dump_bit = __DbgDumpBitScalar;
+#endif
+
+    return dump_bit;
+}
+
+/**
+ * @brief Write hex datas (Format: "XX XX XX")
+ *
+ * @param outBuffer     Output buffer
+ * @param hexArg        Hex datas argument
+ * @param isUpper       Whether to use uppercase digits
+ */
+static void __DbgWriteHexDatas(DbgLogBuffer & outBuffer, const dbg_log_datas_t * hexArg, const bool isUpper) noexcept
+{
+    size_t add_length = (hexArg->length == 0 ? 0 : ((size_t)hexArg->length * 3 - 1));
+
+    // The kernel writes a trailing space, reserve() keeps one more character for the terminator which overwrites it
+    if (add_length == 0 || !outBuffer.reserve(add_length)) return;
+
+    __DbgGetDumpHex()(outBuffer.datas + outBuffer.length, reinterpret_cast<const uchar *>(hexArg->datas), hexArg->length, isUpper);
+    outBuffer.length                  += add_length;
+    outBuffer.datas[outBuffer.length]  = '\0';
+}
+
+/**
+ * @brief Write binary datas (Format: "XXXXXXXX XXXXXXXX XXX")
+ *
+ * @param outBuffer     Output buffer
+ * @param bitArg        Binary datas argument (Length is the count of bits)
+ */
+static void __DbgWriteBitDatas(DbgLogBuffer & outBuffer, const dbg_log_datas_t * bitArg) noexcept
+{
+    const uchar * bit_bytes_pos   = reinterpret_cast<const uchar *>(bitArg->datas);
+    uint          bit_bytes_count = (bitArg->length / 8) + (bitArg->length % 8 == 0 ? 0 : 1);
+    size_t        add_length      = (bitArg->length == 0 ? 0 : (size_t)bitArg->length + (bit_bytes_count - 1));
+    char *        out_pos         = nullptr;
+
+    // Full bytes are written with a trailing space, reserve() keeps one more character for the terminator which overwrites it
+    if (add_length == 0 || !outBuffer.reserve(add_length)) return;
+
+    out_pos = outBuffer.datas + outBuffer.length;
+    __DbgGetDumpBit()(out_pos, bit_bytes_pos, bitArg->length / 8);
+    out_pos += (size_t)(bitArg->length / 8) * 9;
+    for (uint loop_bits_idx = 0; loop_bits_idx < bitArg->length % 8; loop_bits_idx++)
+    {
+        *out_pos++ = ((bit_bytes_pos[bitArg->length / 8] >> (7 - loop_bits_idx)) & 0x01 ? '1' : '0');
+    }
+    outBuffer.length                  += add_length;
+    outBuffer.datas[outBuffer.length]  = '\0';
+}
+
+/**
+ * @brief Format one value
+ *
+ * @tparam TArgsReader  Format arguments reader type
+ * @param outBuffer     Output buffer
+ * @param fmtSpec       Format specifier
+ * @param argsReader    Format arguments reader
+ */
+template <typename TArgsReader>
+static void __DbgFormatValue(DbgLogBuffer & outBuffer, dbg_log_spec_t fmtSpec, TArgsReader & argsReader) noexcept
+{
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_STARWIDTH))
+    {
+        fmtSpec.width = argsReader.readInt();
+        if (fmtSpec.width < 0)
+        {
+            fmtSpec.flags |= DBGLOG_SPEC_FLAG_LEFT;
+            fmtSpec.width  = -fmtSpec.width;
+        }
+    }
+    if ((fmtSpec.flags & DBGLOG_SPEC_FLAG_STARPRECISION))
+    {
+        fmtSpec.precision = argsReader.readInt();
+        if (fmtSpec.precision < 0) fmtSpec.precision = -1;
+    }
+
+    switch (fmtSpec.conversion)
+    {
+        case 'd':
+        case 'i':
+        {
+            longlong int_value = argsReader.readSigned(fmtSpec.lengthMod);
+            char     sign_char = (int_value < 0 ? '-' : ((fmtSpec.flags & DBGLOG_SPEC_FLAG_PLUS) ? '+' : ((fmtSpec.flags & DBGLOG_SPEC_FLAG_SPACE) ? ' ' : '\0')));
+            __DbgWriteInteger(outBuffer, fmtSpec, (int_value < 0 ? 0ULL - (ulonglong)int_value : (ulonglong)int_value), sign_char, 10);
+        }
+        break;
+        case 'u':
+            __DbgWriteInteger(outBuffer, fmtSpec, argsReader.readUnsigned(fmtSpec.lengthMod), '\0', 10);
+            break;
+        case 'o':
+            __DbgWriteInteger(outBuffer, fmtSpec, argsReader.readUnsigned(fmtSpec.lengthMod), '\0', 8);
+            break;
+        case 'c':
+            if (fmtSpec.lengthMod == 'l')
+            {
+                __DbgWriteStandard(outBuffer, fmtSpec, argsReader.readWideChar());
+            }
+            else
+            {
+                char char_value = (char)argsReader.readInt();
+                __DbgWriteText(outBuffer, fmtSpec, &char_value, 1);
+            }
+            break;
+        case 's':
+            if (fmtSpec.lengthMod == 'l')
+            {
+                __DbgWriteStandard(outBuffer, fmtSpec, argsReader.readWideString());
+            }
+            else
+            {
+                const char * str_value = argsReader.readString();
+                // Like glibc: a null string is written as "(null)" only if the precision can hold it
+                if (!str_value) str_value = ((fmtSpec.precision < 0 || fmtSpec.precision >= 6) ? "(null)" : "");
+                __DbgWriteText(outBuffer, fmtSpec, str_value, (fmtSpec.precision >= 0 ? strnlen(str_value, fmtSpec.precision) : strlen(str_value)));
+            }
+            break;
+        case 'p':
+            __DbgWritePointer(outBuffer, fmtSpec, argsReader.readPointer());
+            break;
+        case 'n':
+            argsReader.readPointer();
+            break;
+        case 'X':
+        case 'x':
+            __DbgWriteHexDatas(outBuffer, argsReader.readDatas(), fmtSpec.conversion == 'X');
+            break;
+        case 'B':
+        case 'b':
+            __DbgWriteBitDatas(outBuffer, argsReader.readDatas());
+            break;
+        case '%':
+            // Like glibc: flags, width and precision of "%%" are ignored, a '*' still takes its argument
+            outBuffer.append('%');
+            break;
+        case 'f':
+        case 'F':
+            if (fmtSpec.lengthMod == 'L')
+            {
+                __DbgWriteStandard(outBuffer, fmtSpec, argsReader.readLongDouble());
+            }
+            else
+            {
+                double double_value = argsReader.readDouble();
+                if (!__DbgWriteFixed(outBuffer, fmtSpec, double_value)) __DbgWriteStandard(outBuffer, fmtSpec, double_value);
+            }
+            break;
+        default:
+            if (fmtSpec.lengthMod == 'L')
+                __DbgWriteStandard(outBuffer, fmtSpec, argsReader.readLongDouble());
+            else
+                __DbgWriteStandard(outBuffer, fmtSpec, argsReader.readDouble());
+            break;
+    }
+}
+
+/**
+ * @brief Format debug log
+ *
+ * @param outBuffer     Output buffer
+ * @param fmtString     Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
+ * @param fmtArgs       Format arguments ("%X|%x|%B|%b" must be use a parameter in the format of std::make_unique<dbg_log_datas_t>("xxx", 3).get())
+ */
+static void __DbgFormatLog(DbgLogBuffer & outBuffer, const char * fmtString, va_list fmtArgs)
+{
+    DbgVaArgsReader args_reader(fmtArgs);
+    const char *    fmt_pos = fmtString;
+
+    while (*fmt_pos)
+    {
+        const char *   literal_end = strchr(fmt_pos, '%');
+        const char *   spec_end    = nullptr;
+        dbg_log_spec_t fmt_spec;
+
+        if (!literal_end)
+        {
+            outBuffer.append(fmt_pos);
+            break;
+        }
+        if (literal_end != fmt_pos) outBuffer.append(fmt_pos, literal_end - fmt_pos);
+
+        if (literal_end[1] == '%')
+        {
+            outBuffer.append('%');
+            fmt_pos = literal_end + 2;
+            continue;
+        }
+
+        spec_end = DbgParseSpec(literal_end + 1, fmt_spec);
+        if (!spec_end)
+        {
+            outBuffer.append('%');
+            fmt_pos = literal_end + 1;
+            continue;
+        }
+
+        __DbgFormatValue(outBuffer, fmt_spec, args_reader);
+        fmt_pos = spec_end;
+    }
+}
+
+/**
+ * @brief Format debug log with precompiled format operations
+ *
+ * @tparam TArgsReader  Format arguments reader (DbgVaArgsReader or DbgRecordArgsReader)
+ * @param outBuffer     Output buffer
+ * @param fmtString     Format string (Literal source of the format operations)
+ * @param fmtOps        Format operations (Compiled by DbgFormatCompile())
+ * @param opsCount      Format operations count
+ * @param argsReader    Format arguments reader (Checked at compile time by dbg_log_types_t::check())
+ */
+template <typename TArgsReader>
+static void __DbgFormatOps(DbgLogBuffer & outBuffer, const char * fmtString, const dbg_log_op_t * fmtOps, const size_t opsCount, TArgsReader & argsReader)
+{
+    for (size_t ops_index = 0; ops_index < opsCount; ops_index++)
+    {
+        const dbg_log_op_t & fmt_op = fmtOps[ops_index];
+
+        if (fmt_op.literalLength) outBuffer.append(fmtString + fmt_op.literalOffset, fmt_op.literalLength);
+        if (fmt_op.fmtSpec.conversion) __DbgFormatValue(outBuffer, fmt_op.fmtSpec, argsReader);
+    }
+}
+
+/**
+ * @brief Append a value to binary record
+ *
+ * @tparam TValue       Value type
+ * @param outBuffer     Output buffer
+ * @param recordValue   Record value
+ */
+template <typename TValue>
+static inline void __DbgRecordValue(DbgLogBuffer & outBuffer, const TValue recordValue) noexcept
+{
+    outBuffer.append((const char *)&recordValue, sizeof(TValue));
+}
+
+/**
+ * @brief Write the suppressed count of call site
+ *
+ * @param outBuffer     Output buffer
+ * @param suppressCount Suppressed logs count (0: write nothing)
+ */
+static void __DbgWriteSuppressed(DbgLogBuffer & outBuffer, const uint32_t suppressCount) noexcept
+{
+    if (suppressCount) outBuffer.appendFormat(" (Suppressed %u similar messages)", suppressCount);
+}
+
+/**
+ * @brief Encode debug log into binary record (Copies the arguments only, see DBGLOG_ENTRY_RECORD)
+ *
+ * @param outBuffer     Output buffer (Whole DBGLOG_ENTRY_RECORD entry)
+ * @param logSite       Log call site
+ * @param suppressCount Suppressed logs count reported by the record
+ * @param fmtArgs       Format arguments (Checked at compile time by dbg_log_types_t::check())
+ * @return true         Success
+ * @return false        Failure (Out of memory)
+ */
+static bool __DbgEncodeRecord(DbgLogBuffer & outBuffer, const dbg_log_site_t * logSite, const uint32_t suppressCount, va_list fmtArgs) noexcept
+{
+    DbgVaArgsReader        args_reader(fmtArgs);
+    const DbgSelfIds &     self_ids    = __DbgGetSelfIds();
+    dbg_log_entry_t        entry_head  = {0, DBGLOG_ENTRY_RECORD, 0};
+    dbg_log_record_entry_t record_head = {0, 0, 0, 0, 0};
+
+    outBuffer.length = 0;
+    if (!outBuffer.reserve(DBGLOG_BUFFER_INIT_LENGTH - 1)) return false;
+
+    record_head.siteId        = (uint64_t)(uintptr_t)logSite;
+    record_head.logTime       = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record_head.threadId      = (uint64_t)self_ids.threadId;
+    record_head.processId     = (uint32_t)self_ids.processId;
+    record_head.suppressCount = suppressCount;
+    __DbgRecordValue(outBuffer, entry_head);
+    __DbgRecordValue(outBuffer, record_head);
+
+    for (size_t ops_index = 0; ops_index < logSite->opsCount; ops_index++)
+    {
+        const dbg_log_spec_t & fmt_spec      = logSite->fmtOps[ops_index].fmtSpec;
+        int                    fmt_precision = fmt_spec.precision;
+
+        if (!fmt_spec.conversion) continue;
+        if ((fmt_spec.flags & DBGLOG_SPEC_FLAG_STARWIDTH)) __DbgRecordValue(outBuffer, (int32_t)args_reader.readInt());
+        if ((fmt_spec.flags & DBGLOG_SPEC_FLAG_STARPRECISION))
+        {
+            fmt_precision = args_reader.readInt();
+            __DbgRecordValue(outBuffer, (int32_t)fmt_precision);
+        }
+
+        switch (DbgFormatSpecClass(fmt_spec))
+        {
+            case DBGLOG_ARG_INT:
+                if (fmt_spec.conversion == 'd' || fmt_spec.conversion == 'i')
+                    __DbgRecordValue(outBuffer, (int32_t)args_reader.readSigned(fmt_spec.lengthMod));
+                else if (fmt_spec.conversion == 'u' || fmt_spec.conversion == 'o')
+                    __DbgRecordValue(outBuffer, (uint32_t)args_reader.readUnsigned(fmt_spec.lengthMod));
+                else
+                    __DbgRecordValue(outBuffer, (int32_t)args_reader.readInt());
+                break;
+            case DBGLOG_ARG_INT64:
+                if (fmt_spec.conversion == 'd' || fmt_spec.conversion == 'i')
+                    __DbgRecordValue(outBuffer, (int64_t)args_reader.readSigned(fmt_spec.lengthMod));
+                else
+                    __DbgRecordValue(outBuffer, (uint64_t)args_reader.readUnsigned(fmt_spec.lengthMod));
+                break;
+            case DBGLOG_ARG_DOUBLE:
+                __DbgRecordValue(outBuffer, args_reader.readDouble());
+                break;
+            case DBGLOG_ARG_LDOUBLE:
+                __DbgRecordValue(outBuffer, args_reader.readLongDouble());
+                break;
+            case DBGLOG_ARG_POINTER:
+                __DbgRecordValue(outBuffer, (uint64_t)(uintptr_t)args_reader.readPointer());
+                break;
+            case DBGLOG_ARG_STRING:
+            {
+                const char * str_value = args_reader.readString();
+                size_t       str_len   = (!str_value ? 0 : (fmt_precision >= 0 ? strnlen(str_value, fmt_precision) : strlen(str_value)));
+
+                __DbgRecordValue(outBuffer, (uint32_t)(str_value ? str_len : 0xffffffff));
+                if (str_value)
+                {
+                    outBuffer.append(str_value, str_len);
+                    outBuffer.append('\0');
+                }
+            }
+            break;
+            case DBGLOG_ARG_WSTRING:
+            {
+                const wchar_t * str_value = args_reader.readWideString();
+                size_t          str_count = (str_value ? wcslen(str_value) : 0);
+
+                __DbgRecordValue(outBuffer, (uint32_t)(str_value ? str_count : 0xffffffff));
+                if (str_value) outBuffer.append((const char *)str_value, (str_count + 1) * sizeof(wchar_t));
+            }
+            break;
+            case DBGLOG_ARG_DATAS:
+            {
+                const dbg_log_datas_t * datas_arg   = args_reader.readDatas();
+                uint32_t                datas_bytes = (fmt_spec.conversion == 'X' || fmt_spec.conversion == 'x' ? datas_arg->length : (datas_arg->length + 7) / 8);
+
+                __DbgRecordValue(outBuffer, (uint32_t)datas_arg->length);
+                __DbgRecordValue(outBuffer, datas_bytes);
+                outBuffer.append(datas_arg->datas, datas_bytes);
+            }
+            break;
+        }
+    }
+
+    entry_head.entryLength = (uint32_t)outBuffer.length;
+    memcpy(outBuffer.datas, &entry_head, sizeof(entry_head));
+
+    return true;
+}
+
+/**
+ * @brief Get debug log label
+ *
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ * @return const char*  Log label (Example: "[INFO]"; Nullptr: unknown log type)
+ */
+static const char * __DbgLogLabel(const int logType) noexcept
+{
+    if ((logType & 0x0100))
+        return "[ASSERT]";
+    else if ((logType & 0x0200))
+        return "[VERIFY]";
+    else if ((logType & ESL_DEBUG))
+        return "[DEBUG]";
+    else if ((logType & ESL_INFOMATION))
+        return "[INFO]";
+    else if ((logType & ESL_WARNING))
+        return "[WARNING]";
+    else if ((logType & ESL_ERROR))
+        return "[ERROR]";
+    else if ((logType & ESL_FATAL))
+        return "[FATAL]";
+
+    return nullptr;
+}
+
+/**
+ * @brief Escape character of JSON string (logfmt quoted values use the same escapes)
+ *
+ * @param srcChar       Source character
+ * @param outChars      Output escaped characters (At least 6 characters; Unused if no escape is needed)
+ * @return size_t       Escaped length (0: no escape is needed)
+ */
+static inline size_t __DbgEscapeChar(const uchar srcChar, char * outChars) noexcept
+{
+    if (srcChar >= 0x20 && srcChar != '"' && srcChar != '\\') return 0;
+
+    outChars[0] = '\\';
+    switch (srcChar)
+    {
+        case '"':  outChars[1] = '"';  return 2;
+        case '\\': outChars[1] = '\\'; return 2;
+        case '\n': outChars[1] = 'n';  return 2;
+        case '\r': outChars[1] = 'r';  return 2;
+        case '\t': outChars[1] = 't';  return 2;
+        default:                       break;
+    }
+    outChars[1] = 'u';
+    outChars[2] = '0';
+    outChars[3] = '0';
+    outChars[4] = "0123456789abcdef"[srcChar >> 4];
+    outChars[5] = "0123456789abcdef"[srcChar & 0x0f];
+    return 6;
+}
+
+/**
+ * @brief Write escaped string (Without quotes)
+ *
+ * @param outBuffer     Output buffer
+ * @param srcDatas      Source string
+ * @param srcLength     Source string length
+ */
+static void __DbgWriteEscaped(DbgLogBuffer & outBuffer, const char * srcDatas, const size_t srcLength) noexcept
+{
+    const char * run_begin = srcDatas;
+    const char * src_end   = srcDatas + srcLength;
+
+    for (const char * src_pos = srcDatas; src_pos < src_end; src_pos++)
+    {
+        char   escape_chars[6];
+        size_t escape_len = __DbgEscapeChar((uchar)*src_pos, escape_chars);
+
+        if (!escape_len) continue;
+        outBuffer.append(run_begin, src_pos - run_begin);
+        outBuffer.append(escape_chars, escape_len);
+        run_begin = src_pos + 1;
+    }
+    outBuffer.append(run_begin, src_end - run_begin);
+}
+
+/**
+ * @brief Escape the tail of the buffer in place (Used to the message formatted after the JSON and logfmt header)
+ *
+ * @param outBuffer     Output buffer
+ * @param tailOffset    Tail offset (The characters from it to the end are escaped)
+ */
+static void __DbgEscapeTail(DbgLogBuffer & outBuffer, const size_t tailOffset) noexcept
+{
+    size_t escape_len = 0;
+    char * src_pos    = nullptr;
+    char * out_pos    = nullptr;
+
+    for (size_t char_idx = tailOffset; char_idx < outBuffer.length; char_idx++)
+    {
+        char   escape_chars[6];
+        size_t char_len = __DbgEscapeChar((uchar)outBuffer.datas[char_idx], escape_chars);
+
+        if (char_len) escape_len += char_len - 1;
+    }
+    if (!escape_len) return;
+
+    if (!outBuffer.reserve(escape_len))
+    {
+        outBuffer.length            = tailOffset;
+        outBuffer.datas[tailOffset] = '\0';
+        return;
+    }
+
+    // Move the characters backwards from the end, so that the tail is escaped without a second buffer
+    src_pos                            = outBuffer.datas + outBuffer.length;
+    out_pos                            = src_pos + escape_len;
+    outBuffer.length                  += escape_len;
+    outBuffer.datas[outBuffer.length]  = '\0';
+    while (src_pos > outBuffer.datas + tailOffset)
+    {
+        char   escape_chars[6];
+        size_t char_len = __DbgEscapeChar((uchar)*--src_pos, escape_chars);
+
+        if (!char_len)
+        {
+            *--out_pos = *src_pos;
+            continue;
+        }
+        out_pos -= char_len;
+        memcpy(out_pos, escape_chars, char_len);
+    }
+}
+
+/**
+ * @brief Write signed decimal integer
+ *
+ * @param outBuffer     Output buffer
+ * @param intValue      Integer value
+ */
+static inline void __DbgWriteDecimal(DbgLogBuffer & outBuffer, const int64_t intValue) noexcept
+{
+    if (intValue < 0)
+        __DbgWriteInteger(outBuffer, dbg_log_spec_t(), (ulonglong)(-(intValue + 1)) + 1, '-', 10);
+    else
+        __DbgWriteInteger(outBuffer, dbg_log_spec_t(), (ulonglong)intValue, '\0', 10);
+}
+
+/**
+ * @brief Write string value by the encoder (JSON: always quoted; logfmt and text: quoted if it is empty or has spaces, '=', '"' or control characters)
+ *
+ * @param outBuffer     Output buffer
+ * @param logEncoder    Log encoder (Use DBGLOG_ENCODER_* macros)
+ * @param srcDatas      Source string
+ * @param srcLength     Source string length
+ */
+static void __DbgWriteString(DbgLogBuffer & outBuffer, const int logEncoder, const char * srcDatas, const size_t srcLength) noexcept
+{
+    bool is_quoted = (logEncoder == DBGLOG_ENCODER_JSON || srcLength == 0);
+
+    for (size_t char_idx = 0; !is_quoted && char_idx < srcLength; char_idx++)
+    {
+        uchar src_char = (uchar)srcDatas[char_idx];
+        is_quoted      = (src_char <= ' ' || src_char == '=' || src_char == '"' || src_char == '\\' || src_char == 0x7f);
+    }
+
+    if (!is_quoted)
+    {
+        outBuffer.append(srcDatas, srcLength);
+        return;
+    }
+
+    outBuffer.append('"');
+    __DbgWriteEscaped(outBuffer, srcDatas, srcLength);
+    outBuffer.append('"');
+}
+
+/**
+ * @brief Write field key by the encoder (JSON: ",\"key\":"; logfmt and text: " key=")
+ *
+ * @param outBuffer     Output buffer
+ * @param logEncoder    Log encoder (Use DBGLOG_ENCODER_* macros)
+ * @param fieldKey      Field key
+ */
+static void __DbgWriteKey(DbgLogBuffer & outBuffer, const int logEncoder, const char * fieldKey) noexcept
+{
+    const char * field_key = (fieldKey ? fieldKey : "");
+
+    if (logEncoder == DBGLOG_ENCODER_JSON)
+    {
+        outBuffer.append(",\"", 2);
+        __DbgWriteEscaped(outBuffer, field_key, strlen(field_key));
+        outBuffer.append("\":", 2);
+    }
+    else
+    {
+        outBuffer.append(' ');
+        outBuffer.append(field_key);
+        outBuffer.append('=');
+    }
+}
+
+/**
+ * @brief Write structured fields by the encoder
+ *
+ * @param outBuffer     Output buffer
+ * @param logEncoder    Log encoder (Use DBGLOG_ENCODER_* macros)
+ * @param logFields     Structured fields
+ * @param fieldsCount   Structured fields count
+ */
+static void __DbgWriteFields(DbgLogBuffer & outBuffer, const int logEncoder, const dbg_log_field_t * logFields, const size_t fieldsCount) noexcept
+{
+    for (size_t field_idx = 0; field_idx < fieldsCount; field_idx++)
+    {
+        const dbg_log_field_t & log_field = logFields[field_idx];
+
+        __DbgWriteKey(outBuffer, logEncoder, log_field.fieldKey);
+        switch (log_field.fieldType)
+        {
+            case DBGLOG_FIELD_INT:
+                __DbgWriteDecimal(outBuffer, log_field.intValue);
+                break;
+            case DBGLOG_FIELD_UINT:
+                __DbgWriteInteger(outBuffer, dbg_log_spec_t(), (ulonglong)log_field.uintValue, '\0', 10);
+                break;
+            case DBGLOG_FIELD_DOUBLE:
+                if (std::isfinite(log_field.doubleValue))
+                {
+                    dbg_log_spec_t fmt_spec;
+
+                    fmt_spec.conversion = 'g';
+                    fmt_spec.precision  = 17;
+                    __DbgWriteStandard(outBuffer, fmt_spec, log_field.doubleValue);
+                }
+                else
+                {
+                    outBuffer.append("null", 4);
+                }
+                break;
+            case DBGLOG_FIELD_BOOL:
+                if (log_field.intValue)
+                    outBuffer.append("true", 4);
+                else
+                    outBuffer.append("false", 5);
+                break;
+            case DBGLOG_FIELD_STRING:
+                if (log_field.stringValue)
+                    __DbgWriteString(outBuffer, logEncoder, log_field.stringValue, (log_field.stringLength == SIZE_MAX ? strlen(log_field.stringValue) : log_field.stringLength));
+                else
+                    outBuffer.append("null", 4);
+                break;
+            default:
+                outBuffer.append("null", 4);
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Write debug log header (Text: human-readable header; JSON and logfmt: header keys, then the opening quote of the message)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Label and encoder are used; Message offset is output)
+ * @param timeString    Log local time (Format: "yyyy-MM-dd hh:mm:ss.zzz")
+ * @param processId     Process ID
+ * @param threadId      Native thread ID
+ * @param filePath      File path (Nullptr: release mode, the file, line and function keys are omitted)
+ * @param fileLine      File line
+ * @param fileFunc      File function (Nullptr: release mode)
+ */
+static void __DbgWriteHeader(DbgLogBuffer & logContent, DbgLogContext & logContext, const char * timeString, const pid_t processId, const ulong threadId, const char * filePath, const int fileLine, const char * fileFunc) noexcept
+{
+    const char * log_label = logContext.logLabel;
+    int          encoder   = logContext.logEncoder;
+
+    if (encoder == DBGLOG_ENCODER_TEXT)
+    {
+        const char * fmt_header = "%-10sTime: %s, ProcessID: %u, ThreadID: %lu, File: %s:%d, Function: %s\r\n%10s";
+        const char * file_path  = (filePath ? filePath : "-");
+        int          file_line  = (filePath ? fileLine : 0);
+        const char * file_func  = (fileFunc ? fileFunc : "-");
+
+        logContent.appendFormat(fmt_header, log_label, timeString, processId, threadId, file_path, file_line, file_func, "");
+        logContext.msgOffset = logContent.length;
+        return;
+    }
+
+    if (encoder == DBGLOG_ENCODER_JSON)
+        logContent.append("{\"time\":\"", 9);
+    else
+        logContent.append("time=\"", 6);
+    logContent.append(timeString);
+    logContent.append('"');
+    // The level is the label without brackets (Example: "[INFO]" -> "INFO")
+    __DbgWriteKey(logContent, encoder, "level");
+    if (log_label && log_label[0] == '[')
+        __DbgWriteString(logContent, encoder, log_label + 1, strlen(log_label) - 2);
+    else
+        __DbgWriteString(logContent, encoder, "", 0);
+    __DbgWriteKey(logContent, encoder, "pid");
+    __DbgWriteInteger(logContent, dbg_log_spec_t(), (ulonglong)processId, '\0', 10);
+    __DbgWriteKey(logContent, encoder, "tid");
+    __DbgWriteInteger(logContent, dbg_log_spec_t(), (ulonglong)threadId, '\0', 10);
+    if (filePath)
+    {
+        __DbgWriteKey(logContent, encoder, "file");
+        __DbgWriteString(logContent, encoder, filePath, strlen(filePath));
+        __DbgWriteKey(logContent, encoder, "line");
+        __DbgWriteDecimal(logContent, fileLine);
+    }
+    if (fileFunc)
+    {
+        __DbgWriteKey(logContent, encoder, "func");
+        __DbgWriteString(logContent, encoder, fileFunc, strlen(fileFunc));
+    }
+    __DbgWriteKey(logContent, encoder, "msg");
+    logContent.append('"');
+    logContext.msgOffset = logContent.length;
+}
+
+/**
+ * @brief Finish debug log (Text: structured fields follow the message; JSON and logfmt: escape and close the message, then write the structured fields)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Collected by __DbgWriteHeader())
+ * @param logFields     Structured fields (Nullptr: no field)
+ * @param fieldsCount   Structured fields count
+ */
+static void __DbgFinishLog(DbgLogBuffer & logContent, const DbgLogContext & logContext, const dbg_log_field_t * logFields, const size_t fieldsCount) noexcept
+{
+    if (logContext.logEncoder != DBGLOG_ENCODER_TEXT)
+    {
+        __DbgEscapeTail(logContent, logContext.msgOffset);
+        logContent.append('"');
+    }
+
+    __DbgWriteFields(logContent, logContext.logEncoder, logFields, fieldsCount);
+    if (logContext.logEncoder == DBGLOG_ENCODER_JSON) logContent.append('}');
+}
+
+/**
+ * @brief Begin debug log (Collect the context and write the log header)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Output log context
+ * @param filePath      File path (Nullptr: release mode)
+ * @param fileLine      File line
+ * @param fileFunc      File function (Nullptr: release mode)
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ * @return true         Success
+ * @return false        Failure (Out of memory)
+ */
+static bool __DbgBeginLog(DbgLogBuffer & logContent, DbgLogContext & logContext, const char * filePath, const int fileLine, const char * fileFunc, const int logType) noexcept
+{
+    logContext.logLabel   = __DbgLogLabel(logType);
+    logContext.logEncoder = __DbgLogEncoder.load(std::memory_order_relaxed);
+
+    logContent.length = 0;
+    if (!logContent.reserve(DBGLOG_BUFFER_INIT_LENGTH - 1)) return false;
+
+    {
+        int64_t                 time_nanos = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const DbgLogTimeCache & time_cache = __DbgUpdateTimeCache((long long)(time_nanos / 1000000LL));
+        const DbgSelfIds &      self_ids   = __DbgGetSelfIds();
+
+        logContext.logTime = time_nanos;
+        memcpy(logContext.logDate, time_cache.dateString, sizeof(logContext.logDate));
+        __DbgWriteHeader(logContent, logContext, time_cache.timeString, self_ids.processId, (ulong)self_ids.threadId, filePath, fileLine, fileFunc);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Render binary record into debug log (Same output as __DbgBeginLog() and __DbgFormatOps())
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Output log context (Label, local date and time)
+ * @param logSite       Log call site
+ * @param recordHead    Record head
+ * @param argsDatas     Record arguments
+ * @param argsLength    Record arguments length
+ * @return true         Success
+ * @return false        Failure (Out of memory)
+ */
+static bool __DbgRenderRecord(DbgLogBuffer & logContent, DbgLogContext & logContext, const dbg_log_site_t & logSite, const dbg_log_record_entry_t & recordHead, const uchar * argsDatas, const size_t argsLength) noexcept
+{
+    DbgRecordArgsReader     args_reader(argsDatas, argsLength);
+    long long               time_total = (long long)(recordHead.logTime / 1000000LL);
+    const DbgLogTimeCache & time_cache = __DbgUpdateTimeCache(time_total);
+    const char *            log_label  = __DbgLogLabel(logSite.logType);
+
+    logContext.logLabel   = (log_label ? log_label : "");
+    logContext.logTime    = recordHead.logTime;
+    logContext.logEncoder = __DbgLogEncoder.load(std::memory_order_relaxed);
+    logContext.logModule  = logSite.logModule;
+    logContext.routeCache = logSite.routeCache;
+
+    logContent.length = 0;
+    if (!logContent.reserve(DBGLOG_BUFFER_INIT_LENGTH - 1)) return false;
+
+    memcpy(logContext.logDate, time_cache.dateString, sizeof(logContext.logDate));
+    __DbgWriteHeader(logContent, logContext, time_cache.timeString, (pid_t)recordHead.processId, (ulong)recordHead.threadId, logSite.filePath, logSite.fileLine, logSite.fileFunc);
+    __DbgFormatOps(logContent, logSite.fmtString, logSite.fmtOps, logSite.opsCount, args_reader);
+    __DbgWriteSuppressed(logContent, recordHead.suppressCount);
+    __DbgFinishLog(logContent, logContext, nullptr, 0);
+
+    return true;
+}
+
+/**
+ * @brief Hold the current debug log routing table (The table is not changed until it is let go)
+ *
+ * @return DbgRouteTable*   Current routing table (Nullptr: no route was added yet)
+ */
+static DbgRouteTable * __DbgHoldRoutes() noexcept
+{
+    DbgRouteTable * route_table = __DbgRouteTable.load();
+
+    // A table replaced between the load and the count may be reused by the next route change, it is let go unread
+    while (route_table)
+    {
+        route_table->activeCount.fetch_add(1);
+        if (__DbgRouteTable.load() == route_table) break;
+        route_table->activeCount.fetch_sub(1);
+        route_table = __DbgRouteTable.load();
+    }
+    if (route_table) __DbgRouteHolds[route_table - __DbgRouteTables()]++;
+
+    return route_table;
+}
+
+/**
+ * @brief Let go the debug log routing table held by __DbgHoldRoutes()
+ *
+ * @param routeTable    Routing table
+ */
+static void __DbgFreeRoutes(DbgRouteTable * routeTable) noexcept
+{
+    __DbgRouteHolds[routeTable - __DbgRouteTables()]--;
+    routeTable->activeCount.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Change the debug log routes (Must hold __InnerMutex; Copies the current table into a free one, changes and publishes it)
+ *
+ * @param routeId       Changed route ID
+ * @param logRoute      Changed route (Without sink: the route is removed)
+ */
+static void __DbgChangeRoutes(const int routeId, const DbgLogRoute & logRoute) noexcept
+{
+    DbgRouteTable * route_tables  = __DbgRouteTables();
+    DbgRouteTable * current_table = __DbgRouteTable.load(std::memory_order_relaxed);
+    DbgRouteTable * next_table    = nullptr;
+
+    // Replaced tables are free once their logs and sinks returned (Route changes are rare, a held table is skipped)
+    while (!next_table)
+    {
+        for (int table_idx = 0; table_idx < DBGLOG_ROUTE_TABLES && !next_table; table_idx++)
+        {
+            if (&route_tables[table_idx] != current_table && route_tables[table_idx].activeCount.load() == 0) next_table = &route_tables[table_idx];
+        }
+        if (!next_table) std::this_thread::yield();
+    }
+
+    for (int route_id = 0; route_id < DBGLOG_ROUTE_COUNT; route_id++) next_table->logRoutes[route_id] = (current_table ? current_table->logRoutes[route_id] : DbgLogRoute());
+    next_table->logRoutes[routeId] = logRoute;
+    if (++__DbgRouteGeneration == 0) __DbgRouteGeneration = 1;
+    next_table->routeGeneration = __DbgRouteGeneration;
+    __DbgRouteTable.store(next_table);
+}
+
+/**
+ * @brief Wait until the replaced debug log routing tables are let go (The sinks of the removed routes returned; The tables held by current thread are not waited for)
+ */
+static void __DbgWaitRoutes() noexcept
+{
+    DbgRouteTable * route_tables = __DbgRouteTables();
+
+    for (int table_idx = 0; table_idx < DBGLOG_ROUTE_TABLES; table_idx++)
+    {
+        DbgRouteTable * route_table = &route_tables[table_idx];
+
+        while (route_table != __DbgRouteTable.load() && route_table->activeCount.load(std::memory_order_acquire) > __DbgRouteHolds[table_idx]) std::this_thread::yield();
+    }
+}
+
+/**
+ * @brief Match debug log routes
+ *
+ * @param routeTable    Routing table (Held by the caller)
+ * @param logModule     Log module (Nullptr: default module)
+ * @param logLevel      Log level (Use execute status level)
+ * @return uint32_t     Matched routes mask (Bit index: route ID; The routes of the module replace the routes of every module)
+ */
+static uint32_t __DbgMatchRoutes(const DbgRouteTable & routeTable, const dbg_log_module_t * logModule, const int logLevel) noexcept
+{
+    const DbgLogRoute * log_routes  = routeTable.logRoutes;
+    const char *        module_name = (logModule ? logModule->moduleName : nullptr);
+    uint32_t            any_mask    = 0;
+    uint32_t            module_mask = 0;
+
+    for (int route_id = 0; route_id < DBGLOG_ROUTE_COUNT; route_id++)
+    {
+        const DbgLogRoute & log_route = log_routes[route_id];
+
+        if (!log_route.logSink || !(log_route.levelMask & logLevel)) continue;
+
+        if (log_route.isAny)
+            any_mask |= (1U << route_id);
+        else if (module_name && log_route.moduleName == module_name)
+            module_mask |= (1U << route_id);
+    }
+
+    return (module_mask ? module_mask : any_mask);
+}
+
+/**
+ * @brief Route debug log (Calls every sink of the matched routes with the same record)
+ *
+ * @param logContent    Log content buffer (Appends "\r\n" if routed)
+ * @param logContext    Log context (Module and route cache of the call site)
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ * @return true         The log is routed
+ * @return false        No route matches the log, dispatch it as usual
+ */
+static bool __DbgRouteLog(DbgLogBuffer & logContent, const DbgLogContext & logContext, const int logType) noexcept
+{
+    DbgRouteTable *  route_table = nullptr;
+    uint64_t         route_state = 0;
+    uint32_t         route_mask  = 0;
+    dbg_log_record_t log_record;
+
+    if (__DbgRouteCount.load(std::memory_order_relaxed) == 0 || !(route_table = __DbgHoldRoutes())) return false;
+
+    // The call site resolves its routes once, until the routing table changes
+    route_state = (logContext.routeCache ? logContext.routeCache->routeState.load(std::memory_order_relaxed) : 0);
+    route_mask  = (uint32_t)route_state;
+    if ((uint32_t)(route_state >> 32) != route_table->routeGeneration)
+    {
+        route_mask = __DbgMatchRoutes(*route_table, logContext.logModule, logType & 0xff);
+        if (logContext.routeCache) logContext.routeCache->routeState.store(((uint64_t)route_table->routeGeneration << 32) | route_mask, std::memory_order_relaxed);
+    }
+
+    if (route_mask)
+    {
+        // Formatted once, every sink receives the same record
+        logContent.append("\r\n", 2);
+        log_record.logContent = logContent.datas;
+        log_record.logLength  = logContent.length;
+        log_record.logDate    = logContext.logDate;
+        log_record.logTime    = logContext.logTime;
+        log_record.logType    = logType;
+        for (int route_id = 0; route_id < DBGLOG_ROUTE_COUNT; route_id++)
+        {
+            const DbgLogRoute & log_route = route_table->logRoutes[route_id];
+
+            if (route_mask & (1U << route_id)) log_route.logSink(log_route.sinkContext, &log_record);
+        }
+    }
+    __DbgFreeRoutes(route_table);
+
+    return route_mask != 0;
+}
+
+/**
+ * @brief Dispatch debug log (Calls the sinks of the matched routes, the handling function or the batch handling function, or writes to stderr)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Label, local date and time)
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ */
+static void __DbgDispatchLog(DbgLogBuffer & logContent, const DbgLogContext & logContext, const int logType) noexcept
+{
+    if (__DbgRouteLog(logContent, logContext, logType)) return;
+
+    std::unique_lock<std::mutex> inner_locker(__InnerMutex);
+    const char *                 log_label = logContext.logLabel;
+
+    if (__DbgLogHandle)
+    {
+        dbg_log_handle_t log_handle = __DbgLogHandle;
+
+        inner_locker.unlock();
+
+        logContent.append("\r\n", 2);
+        log_handle(logContext.logDate, logContent.datas, logContent.length);
+    }
+    else if (__DbgLogBatchHandle)
+    {
+        dbg_log_batch_t  batch_handle = __DbgLogBatchHandle;
+        dbg_log_record_t log_record;
+
+        inner_locker.unlock();
+
+        logContent.append("\r\n", 2);
+        log_record.logContent = logContent.datas;
+        log_record.logLength  = logContent.length;
+        log_record.logDate    = logContext.logDate;
+        log_record.logTime    = logContext.logTime;
+        log_record.logType    = logType;
+        batch_handle(&log_record, 1);
+    }
+    else if (logContext.logEncoder != DBGLOG_ENCODER_TEXT)
+    {
+        fprintf(stderr, "%s\r\n", logContent.datas);
+        fflush(stderr);
+    }
+    else
+    {
+#if defined(_WINDOWS)
+        HANDLE                     output_handle = GetStdHandle(STD_ERROR_HANDLE);
+        CONSOLE_SCREEN_BUFFER_INFO buffer_info;
+        if (!output_handle || output_handle == INVALID_HANDLE_VALUE || !GetConsoleScreenBufferInfo(output_handle, &buffer_info))
+        {
+            output_handle = nullptr;
+        }
+#endif
+
+        switch (logType & 0xff)
+        {
+            case ESL_FATAL:
+            case ESL_ERROR:
+#if defined(_WINDOWS)
+                if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_GREEN | FOREGROUND_RED) | (BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
+                fprintf(stderr, "%s", log_label);
+#elif defined(_LINUX)
+                fprintf(stderr, "\033[41;33m%s\033[0m", log_label);
+#endif
+                break;
+            case ESL_WARNING:
+#if defined(_WINDOWS)
+                if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_BLUE) | (BACKGROUND_GREEN | BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
+                fprintf(stderr, "%s", log_label);
+#elif defined(_LINUX)
+                fprintf(stderr, "\033[43;34m%s\033[0m", log_label);
+#endif
+                break;
+            default:
+#if defined(_WINDOWS)
+                if (output_handle) SetConsoleTextAttribute(output_handle, (FOREGROUND_BLUE & FOREGROUND_GREEN & FOREGROUND_RED) | (BACKGROUND_BLUE | BACKGROUND_GREEN | BACKGROUND_RED) | FOREGROUND_INTENSITY | BACKGROUND_INTENSITY);
+                fprintf(stderr, "%s", log_label);
+#elif defined(_LINUX)
+                fprintf(stderr, "\033[47;30m%s\033[0m", log_label);
+#endif
+                break;
+        }
+        fflush(stderr);
+
+#if defined(_WINDOWS)
+        if (output_handle) SetConsoleTextAttribute(output_handle, buffer_info.wAttributes);
+#endif
+
+        fprintf(stderr, "%s\r\n\r\n", logContent.datas + strlen(log_label));
+        fflush(stderr);
+    }
+}
+
+/**
+ * @brief Put the log limit of call site on the pending list (Called by the first suppressed log since the last report)
+ *
+ * @param logSite       Log call site
+ */
+static void __DbgPendSuppressed(const dbg_log_site_t * logSite) noexcept
+{
+    dbg_log_limit_t * log_limit    = logSite->logLimit;
+    dbg_log_limit_t * pending_head = nullptr;
+
+    if (log_limit->isPending.exchange(true)) return;
+
+    log_limit->pendingSite = logSite;
+    pending_head           = __DbgSuppressPending.load(std::memory_order_relaxed);
+    do
+    {
+        log_limit->pendingNext = pending_head;
+    } while (!__DbgSuppressPending.compare_exchange_weak(pending_head, log_limit, std::memory_order_release, std::memory_order_relaxed));
+}
+
+/**
+ * @brief Output the summary logs of the suppressed counts whose second is over (Reports the counts no later log of the call site passed the limit for)
+ *
+ * @param isAll         Whether to report every pending count (Exit; The summaries are output by the calling thread, after the queued logs)
+ */
+static void __DbgFlushSuppressed(const bool isAll) noexcept
+{
+    dbg_log_limit_t * log_limit    = __DbgSuppressPending.exchange(nullptr, std::memory_order_acquire);
+    uint64_t          limit_second = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count() & 0xffffffffffULL;
+
+    while (log_limit)
+    {
+        dbg_log_limit_t *      next_limit     = log_limit->pendingNext;
+        const dbg_log_site_t * log_site       = log_limit->pendingSite;
+        uint64_t               suppress_count = 0;
+
+        // The second is still running, the next log of the call site may report the count
+        if (!isAll && (log_limit->limitState.load(std::memory_order_relaxed) >> 24) == limit_second)
+        {
+            log_limit->isPending.store(false);
+            if (log_limit->suppressCount.load()) __DbgPendSuppressed(log_site);
+            log_limit = next_limit;
+            continue;
+        }
+
+        // A log suppressed meanwhile puts the limit on the list again, its count is taken by this summary or the next one (Pairs with the count and the flag of DbgCheckLimit())
+        log_limit->isPending.store(false);
+        suppress_count = log_limit->suppressCount.exchange(0);
+        if (suppress_count)
+        {
+            DbgLogContext  log_context;
+            DbgLogBuffer   nested_buffer;
+            DbgLogBuffer & log_content = (__DbgLogDepth++ == 0 && !__DbgLogExited && !isAll ? __DbgLogBuffer : nested_buffer);
+
+            log_context.logModule  = log_site->logModule;
+            log_context.routeCache = log_site->routeCache;
+            if (__DbgBeginLog(log_content, log_context, log_site->filePath, log_site->fileLine, log_site->fileFunc, log_site->logType))
+            {
+                log_content.appendFormat("Suppressed %llu similar messages: %s", (unsigned long long)suppress_count, log_site->fmtString);
+                __DbgFinishLog(log_content, log_context, nullptr, 0);
+                if (isAll || !__DbgAsyncQueue.push(log_content, &log_context, log_site->logType)) __DbgDispatchLog(log_content, log_context, log_site->logType);
+            }
+            __DbgLogDepth--;
+        }
+        log_limit = next_limit;
+    }
+}
+
+/**
+ * @brief Destruct function (The thread buffers of the exiting thread are gone, the summaries are output by the exiting thread)
+ */
+DbgSuppressReporter::~DbgSuppressReporter()
+{
+    if (!__DbgSuppressPending.load()) return;
+
+    DbgFlush();
+    __DbgFlushSuppressed(true);
+}
+
+/**
+ * @brief Output binary record (Consumer thread; Writes the binary stream if a writing function is set, otherwise formats the record)
+ *
+ * @param logRecord     Log record (Whole DBGLOG_ENTRY_RECORD entry)
+ * @param logContent    Output log content (Formatted record)
+ * @param logContext    Output log context (Formatted record)
+ * @param streamState   Binary stream state
+ * @return true         The record is formatted into the log content, dispatch it
+ * @return false        The record is written to the binary stream, or failed to format
+ */
+static bool __DbgOutputRecord(const DbgLogBuffer & logRecord, DbgLogBuffer & logContent, DbgLogContext & logContext, DbgStreamState & streamState) noexcept
+{
+    dbg_log_record_entry_t record_head;
+    const dbg_log_site_t * log_site     = nullptr;
+    dbg_log_write_t        stream_write = nullptr;
+    size_t                 head_length  = sizeof(dbg_log_entry_t) + sizeof(dbg_log_record_entry_t);
+
+    memcpy(&record_head, logRecord.datas + sizeof(dbg_log_entry_t), sizeof(record_head));
+    log_site = (const dbg_log_site_t *)(uintptr_t)record_head.siteId;
+
+    {
+        std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+        stream_write = __DbgStreamWrite;
+    }
+
+    if (!stream_write) return __DbgRenderRecord(logContent, logContext, *log_site, record_head, (const uchar *)logRecord.datas + head_length, logRecord.length - head_length);
+
+    // A new writing function starts a new stream
+    if (stream_write != streamState.streamWrite)
+    {
+        dbg_log_entry_t  entry_head  = {(uint32_t)(sizeof(dbg_log_entry_t) + sizeof(dbg_log_stream_t)), DBGLOG_ENTRY_STREAM, 0};
+        dbg_log_stream_t stream_head = {DBGLOG_STREAM_MAGIC, DBGLOG_STREAM_VERSION, (uint32_t)sizeof(long double), (uint32_t)sizeof(wchar_t)};
+
+        streamState.streamWrite = stream_write;
+        streamState.writtenSites.clear();
+        streamState.entryDatas.length = 0;
+        __DbgRecordValue(streamState.entryDatas, entry_head);
+        __DbgRecordValue(streamState.entryDatas, stream_head);
+        stream_write(streamState.entryDatas.datas, streamState.entryDatas.length);
+    }
+
+    if (streamState.writtenSites.insert(log_site).second)
+    {
+        dbg_log_entry_t      entry_head = {0, DBGLOG_ENTRY_SITE, 0};
+        dbg_log_site_entry_t site_head  = {record_head.siteId, (int32_t)log_site->fileLine, (int32_t)log_site->logType};
+        DbgLogBuffer &       site_entry = streamState.entryDatas;
+
+        site_entry.length = 0;
+        __DbgRecordValue(site_entry, entry_head);
+        __DbgRecordValue(site_entry, site_head);
+        site_entry.append(log_site->filePath ? log_site->filePath : "");
+        site_entry.append('\0');
+        site_entry.append(log_site->fileFunc ? log_site->fileFunc : "");
+        site_entry.append('\0');
+        site_entry.append(log_site->fmtString);
+        site_entry.append('\0');
+        if (site_entry.length < sizeof(entry_head)) return false;
+
+        entry_head.entryLength = (uint32_t)site_entry.length;
+        memcpy(site_entry.datas, &entry_head, sizeof(entry_head));
+        stream_write(site_entry.datas, site_entry.length);
+    }
+
+    stream_write(logRecord.datas, logRecord.length);
+    return false;
+}
+
+/**
+ * @brief Start async mode (Stops the running consumer first)
+ *
+ * @param queueCapacity     Queue capacity (Rounded up to a power of two)
+ * @param overflowPolicy    Overflow policy (Use DBGLOG_ASYNC_* macros)
+ * @return bool             Whether to start successfully
+ */
+bool DbgAsyncQueue::start(const size_t queueCapacity, const int overflowPolicy) noexcept
+{
+    size_t slots_count = 2;
+
+    this->stop();
+
+    while (slots_count < queueCapacity) slots_count <<= 1;
+    this->slots = new (std::nothrow) DbgAsyncSlot[slots_count];
+    if (!this->slots) return false;
+
+    for (size_t loop_idx = 0; loop_idx < slots_count; loop_idx++) this->slots[loop_idx].sequence.store(loop_idx, std::memory_order_relaxed);
+    this->slotMask       = slots_count - 1;
+    this->overflowPolicy = overflowPolicy;
+    this->isStopping     = false;
+    this->enqueuePos.store(0, std::memory_order_relaxed);
+    this->dequeuePos.store(0, std::memory_order_relaxed);
+    this->doneCount.store(0, std::memory_order_relaxed);
+    this->ringCursor     = nullptr;
+    __DbgHeavyBarrier.store(__DbgRegisterHeavyBarrier());
+
+    try
+    {
+        this->consumerThread = new std::thread(&DbgAsyncQueue::consume, this);
+    }
+    catch (...)
+    {
+        delete[] this->slots;
+        this->slots = nullptr;
+        return false;
+    }
+
+    __DbgRegisterAtFork();
+    this->isRunning.store(true);
+    return true;
+}
+
+/**
+ * @brief Stop async mode (Outputs every queued log, then joins the consumer thread)
+ */
+void DbgAsyncQueue::stop() noexcept
+{
+    DbgAsyncRing * ring_list  = nullptr;
+    DbgAsyncRing * async_ring = nullptr;
+
+    if (!this->isRunning.exchange(false)) return;
+
+    // Either a ring producer sees the queue stopped, or its entry is waited for here
+    __DbgRunHeavyBarrier();
+    while (this->inflightCount.load() != 0) std::this_thread::yield();
+    for (async_ring = this->ringList.load(std::memory_order_acquire); async_ring; async_ring = async_ring->nextRing)
+    {
+        while (async_ring->isWriting.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    this->flush();
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        this->isStopping = true;
+    }
+    this->wakeCond.notify_one();
+    this->consumerThread->join();
+
+    delete this->consumerThread;
+    this->consumerThread = nullptr;
+    delete[] this->slots;
+    this->slots = nullptr;
+
+    // Free the output rings of the exited threads, the others stay with their threads
+    std::lock_guard<std::mutex> ring_locker(this->ringMutex);
+    async_ring = this->ringList.load(std::memory_order_acquire);
+    while (async_ring)
+    {
+        DbgAsyncRing * next_ring = async_ring->nextRing;
+
+        if (async_ring->isClosed.load(std::memory_order_acquire))
+        {
+            delete async_ring;
+        }
+        else
+        {
+            async_ring->nextRing = ring_list;
+            ring_list            = async_ring;
+        }
+        async_ring = next_ring;
+    }
+    this->ringList.store(ring_list, std::memory_order_release);
+}
+
+/**
+ * @brief Queue a log (Takes over the datas of the log content buffer)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Nullptr: the log content is a binary record)
+ * @param logType       Log type
+ * @return bool         Whether to the log is queued or dropped (False: output it synchronously)
+ */
+bool DbgAsyncQueue::push(DbgLogBuffer & logContent, const DbgLogContext * logContext, const int logType) noexcept
+{
+    DbgAsyncSlot *      log_slot   = nullptr;
+    size_t              slot_pos   = 0;
+    DbgAsyncRingOwner & ring_owner = __DbgAsyncRingOwner;
+    DbgAsyncRing *      async_ring = nullptr;
+
+    if (__DbgLogIsConsumer || !this->isRunning.load(std::memory_order_relaxed)) return false;
+
+    // Binary records, and the later logs of their thread to keep its order, go through the ring of the thread
+    if (ring_owner.forkGeneration == __DbgForkGeneration.load(std::memory_order_relaxed)) async_ring = ring_owner.asyncRing;
+    if (!async_ring && !logContext && !ring_owner.isExited && (async_ring = this->attachRing()))
+    {
+        ring_owner.asyncRing      = async_ring;
+        ring_owner.forkGeneration = __DbgForkGeneration.load(std::memory_order_relaxed);
+    }
+    if (async_ring)
+    {
+        if (this->pushRing(async_ring, logContent, logContext, logType)) return true;
+
+        // Too long for the ring, queue it once the consumer took the earlier logs of the thread
+        while (this->isRunning.load(std::memory_order_relaxed) && async_ring->readPos.load(std::memory_order_acquire) != async_ring->writePos.load(std::memory_order_relaxed))
+        {
+            std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+            this->wakeCond.notify_one();
+            this->idleCond.wait_for(wait_locker, std::chrono::milliseconds(1));
+        }
+    }
+
+    this->inflightCount.fetch_add(1);
+    if (!this->isRunning.load())
+    {
+        this->inflightCount.fetch_sub(1);
+        return false;
+    }
+
+    while (!(log_slot = this->tryEnqueue(slot_pos)))
+    {
+        if (this->overflowPolicy == DBGLOG_ASYNC_DROP)
+        {
+            __DbgLogDropCount.fetch_add(1, std::memory_order_relaxed);
+            this->inflightCount.fetch_sub(1);
+            return true;
+        }
+        else if (this->overflowPolicy == DBGLOG_ASYNC_OVERWRITE)
+        {
+            size_t         old_pos  = 0;
+            DbgAsyncSlot * old_slot = this->tryDequeue(old_pos);
+
+            if (old_slot)
+            {
+                old_slot->sequence.store(old_pos + this->slotMask + 1, std::memory_order_release);
+                this->doneCount.fetch_add(1);
+                __DbgLogDropCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        else
+        {
+            std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+            this->wakeCond.notify_one();
+            this->idleCond.wait_for(wait_locker, std::chrono::milliseconds(1));
+        }
+    }
+
+    log_slot->logContent.swap(logContent);
+    log_slot->logType  = logType;
+    log_slot->isRecord = !logContext;
+    if (logContext) log_slot->logContext = *logContext;
+    log_slot->sequence.store(slot_pos + 1, std::memory_order_release);
+    this->inflightCount.fetch_sub(1);
+
+    this->wakeConsumer();
+    return true;
+}
+
+/**
+ * @brief Queue a log into the async ring of current thread (Copies the log content; The consumer is only woken if it sleeps, once per burst)
+ *
+ * @param asyncRing     Async ring of current thread
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Nullptr: the log content is a binary record)
+ * @param logType       Log type
+ * @return bool         Whether to the log is queued or dropped (False: the queue stopped, or the log is longer than a quarter of the ring)
+ */
+bool DbgAsyncQueue::pushRing(DbgAsyncRing * asyncRing, const DbgLogBuffer & logContent, const DbgLogContext * logContext, const int logType) noexcept
+{
+    size_t       ring_length  = asyncRing->ringMask + 1;
+    size_t       data_length  = (logContext ? sizeof(DbgLogContext) : 0) + logContent.length;
+    size_t       entry_length = (sizeof(DbgRingEntry) + data_length + sizeof(DbgRingEntry) - 1) / sizeof(DbgRingEntry) * sizeof(DbgRingEntry);
+    size_t       write_pos    = asyncRing->writePos.load(std::memory_order_relaxed);
+    size_t       pad_length   = 0;
+    char *       entry_datas  = nullptr;
+    DbgRingEntry entry_head   = {(uint32_t)entry_length, (int32_t)logType, (logContext ? 0U : 1U), (uint32_t)data_length};
+
+    if (entry_length > ring_length / 4) return false;
+
+    // Pairs with the heavy barrier of stop(): either stop() waits for this entry, or the entry sees the queue stopped
+    asyncRing->isWriting.store(true, std::memory_order_relaxed);
+    __DbgRingBarrier();
+    if (!this->isRunning.load(std::memory_order_relaxed))
+    {
+        asyncRing->isWriting.store(false, std::memory_order_release);
+        return false;
+    }
+
+    // An entry never wraps, the space up to the ring end is padded
+    if (ring_length - (write_pos & asyncRing->ringMask) < entry_length) pad_length = ring_length - (write_pos & asyncRing->ringMask);
+    while (write_pos + pad_length + entry_length - asyncRing->readCache > ring_length)
+    {
+        asyncRing->readCache = asyncRing->readPos.load(std::memory_order_acquire);
+        if (write_pos + pad_length + entry_length - asyncRing->readCache <= ring_length) break;
+
+        if (this->overflowPolicy != DBGLOG_ASYNC_BLOCK)
+        {
+            // Only the consumer frees ring entries, the overwrite policy drops the new log as well
+            __DbgLogDropCount.fetch_add(1, std::memory_order_relaxed);
+            asyncRing->isWriting.store(false, std::memory_order_release);
+            return true;
+        }
+        else
+        {
+            std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+            this->wakeCond.notify_one();
+            this->idleCond.wait_for(wait_locker, std::chrono::milliseconds(1));
+        }
+    }
+
+    if (pad_length)
+    {
+        DbgRingEntry pad_head = {(uint32_t)pad_length, 0, 0xffffffff, 0};
+
+        memcpy(asyncRing->ringDatas + (write_pos & asyncRing->ringMask), &pad_head, sizeof(pad_head));
+        write_pos += pad_length;
+    }
+    entry_datas = asyncRing->ringDatas + (write_pos & asyncRing->ringMask);
+    memcpy(entry_datas, &entry_head, sizeof(entry_head));
+    entry_datas += sizeof(entry_head);
+    if (logContext)
+    {
+        memcpy(entry_datas, logContext, sizeof(DbgLogContext));
+        entry_datas += sizeof(DbgLogContext);
+    }
+    memcpy(entry_datas, logContent.datas, logContent.length);
+    asyncRing->writePos.store(write_pos + entry_length, std::memory_order_release);
+    asyncRing->isWriting.store(false, std::memory_order_release);
+
+    // Pairs with the heavy barrier of consume(): either the consumer sees the entry, or the producer sees it sleeping (Only the first entry after it sleeps notifies)
+    __DbgRingBarrier();
+    if (this->isSleeping.load(std::memory_order_relaxed) && this->isSleeping.exchange(false))
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        this->wakeCond.notify_one();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wait until every log queued before the call is output
+ */
+void DbgAsyncQueue::flush() noexcept
+{
+    size_t flush_pos = this->enqueuePos.load();
+
+    if (__DbgLogIsConsumer) return;
+
+    while (this->doneCount.load() < flush_pos)
+    {
+        std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+        this->wakeCond.notify_one();
+        this->idleCond.wait_for(wait_locker, std::chrono::milliseconds(1));
+    }
+
+    // Then the ring entries written before the call
+    for (DbgAsyncRing * async_ring = this->ringList.load(std::memory_order_acquire); async_ring; async_ring = async_ring->nextRing)
+    {
+        size_t flush_end = async_ring->writePos.load(std::memory_order_acquire);
+
+        while (async_ring->donePos.load(std::memory_order_acquire) < flush_end)
+        {
+            std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+            this->wakeCond.notify_one();
+            this->idleCond.wait_for(wait_locker, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+/**
+ * @brief Reset the queue in the child process after fork (The consumer thread does not exist in the child, falls back to synchronous mode)
+ */
+void DbgAsyncQueue::resetAfterFork() noexcept
+{
+    if (!this->consumerThread) return;
+
+    // The wait mutex may be held by the consumer thread, the consumer thread object and the queued logs are abandoned
+    new (&this->waitMutex) std::mutex();
+    new (&this->wakeCond) std::condition_variable();
+    new (&this->idleCond) std::condition_variable();
+    new (&this->ringMutex) std::mutex();
+    this->ringList.store(nullptr);
+    this->ringCursor = nullptr;
+    this->isRunning.store(false);
+    this->isSleeping.store(false);
+    this->inflightCount.store(0);
+    this->doneCount.store(this->enqueuePos.load());
+    this->consumerThread = nullptr;
+    this->slots          = nullptr;
+}
+
+/**
+ * @brief Claim a free slot
+ *
+ * @param slotPos           Output slot position
+ * @return DbgAsyncSlot*    Claimed slot (Nullptr: queue is full)
+ */
+DbgAsyncSlot * DbgAsyncQueue::tryEnqueue(size_t & slotPos) noexcept
+{
+    size_t slot_pos = this->enqueuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        DbgAsyncSlot * log_slot = &this->slots[slot_pos & this->slotMask];
+        intptr_t       seq_diff = (intptr_t)log_slot->sequence.load(std::memory_order_acquire) - (intptr_t)slot_pos;
+
+        if (seq_diff == 0)
+        {
+            if (this->enqueuePos.compare_exchange_weak(slot_pos, slot_pos + 1, std::memory_order_relaxed))
+            {
+                slotPos = slot_pos;
+                return log_slot;
+            }
+        }
+        else if (seq_diff < 0)
+        {
+            return nullptr;
+        }
+        else
+        {
+            slot_pos = this->enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Claim a queued slot
+ *
+ * @param slotPos           Output slot position
+ * @return DbgAsyncSlot*    Claimed slot (Nullptr: queue is empty)
+ */
+DbgAsyncSlot * DbgAsyncQueue::tryDequeue(size_t & slotPos) noexcept
+{
+    size_t slot_pos = this->dequeuePos.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        DbgAsyncSlot * log_slot = &this->slots[slot_pos & this->slotMask];
+        intptr_t       seq_diff = (intptr_t)log_slot->sequence.load(std::memory_order_acquire) - (intptr_t)(slot_pos + 1);
+
+        if (seq_diff == 0)
+        {
+            if (this->dequeuePos.compare_exchange_weak(slot_pos, slot_pos + 1, std::memory_order_relaxed))
+            {
+                slotPos = slot_pos;
+                return log_slot;
+            }
+        }
+        else if (seq_diff < 0)
+        {
+            return nullptr;
+        }
+        else
+        {
+            slot_pos = this->dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Attach an async ring to current thread (Reuses the output ring of an exited thread)
+ *
+ * @return DbgAsyncRing*    Async ring of current thread (Nullptr: out of memory)
+ */
+DbgAsyncRing * DbgAsyncQueue::attachRing() noexcept
+{
+    std::lock_guard<std::mutex> ring_locker(this->ringMutex);
+    DbgAsyncRing *              async_ring  = nullptr;
+    size_t                      ring_length = sizeof(DbgRingEntry);
+
+    for (async_ring = this->ringList.load(std::memory_order_acquire); async_ring; async_ring = async_ring->nextRing)
+    {
+        if (async_ring->isClosed.load(std::memory_order_acquire) && async_ring->donePos.load(std::memory_order_acquire) == async_ring->writePos.load(std::memory_order_relaxed))
+        {
+            async_ring->isClosed.store(false, std::memory_order_relaxed);
+            return async_ring;
+        }
+    }
+
+    while (ring_length < (this->slotMask + 1) * DBGLOG_ASYNC_RING_SLOT) ring_length <<= 1;
+    if (!(async_ring = new (std::nothrow) DbgAsyncRing())) return nullptr;
+    if (!(async_ring->ringDatas = new (std::nothrow) char[ring_length]))
+    {
+        delete async_ring;
+        return nullptr;
+    }
+
+    async_ring->ringMask = ring_length - 1;
+    async_ring->nextRing = this->ringList.load(std::memory_order_relaxed);
+    this->ringList.store(async_ring, std::memory_order_release);
+
+    return async_ring;
+}
+
+/**
+ * @brief Take the next log from the queue or the async rings (Frees its slot or ring space at once)
+ *
+ * @param logContent    Output log content
+ * @param logContext    Output log context (Unused by binary records)
+ * @param logType       Output log type
+ * @param isRecord      Output whether to the log content is a binary record
+ * @param logRing       Output async ring of the log (Nullptr: queue slot)
+ * @param ringEnd       Output end of the log in its async ring
+ * @return bool         Whether to take a log (False: the queue and the rings are empty)
+ */
+bool DbgAsyncQueue::takeLog(DbgLogBuffer & logContent, DbgLogContext & logContext, int & logType, bool & isRecord, DbgAsyncRing *& logRing, size_t & ringEnd) noexcept
+{
+    DbgAsyncSlot * log_slot   = nullptr;
+    size_t         slot_pos   = 0;
+    DbgAsyncRing * ring_list  = this->ringList.load(std::memory_order_acquire);
+    DbgAsyncRing * first_ring = nullptr;
+
+    logRing = nullptr;
+    if ((log_slot = this->tryDequeue(slot_pos)))
+    {
+        logContent.swap(log_slot->logContent);
+        logType  = log_slot->logType;
+        isRecord = log_slot->isRecord;
+        if (!isRecord) logContext = log_slot->logContext;
+        log_slot->sequence.store(slot_pos + this->slotMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Drain the rings in turn, starting from the ring of the last log
+    if (!this->ringCursor) this->ringCursor = ring_list;
+    first_ring = this->ringCursor;
+    while (this->ringCursor)
+    {
+        DbgAsyncRing * async_ring = this->ringCursor;
+        size_t         read_pos   = async_ring->readPos.load(std::memory_order_relaxed);
+
+        while (read_pos != async_ring->writePos.load(std::memory_order_acquire))
+        {
+            DbgRingEntry entry_head;
+            const char * entry_datas = async_ring->ringDatas + (read_pos & async_ring->ringMask);
+            size_t       data_length = 0;
+
+            memcpy(&entry_head, entry_datas, sizeof(entry_head));
+            read_pos += entry_head.entryLength;
+            if (entry_head.isRecord == 0xffffffff) continue;
+
+            entry_datas += sizeof(entry_head);
+            data_length  = entry_head.dataLength;
+            logType      = entry_head.logType;
+            isRecord     = (entry_head.isRecord != 0);
+            if (!isRecord)
+            {
+                memcpy(&logContext, entry_datas, sizeof(DbgLogContext));
+                entry_datas += sizeof(DbgLogContext);
+                data_length -= sizeof(DbgLogContext);
+            }
+            logContent.length = 0;
+            if (!logContent.reserve(data_length))
+            {
+                async_ring->readPos.store(read_pos, std::memory_order_release);
+                async_ring->donePos.store(read_pos, std::memory_order_release);
+                __DbgLogDropCount.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            logContent.append(entry_datas, data_length);
+            async_ring->readPos.store(read_pos, std::memory_order_release);
+
+            logRing = async_ring;
+            ringEnd = read_pos;
+            return true;
+        }
+
+        this->ringCursor = (async_ring->nextRing ? async_ring->nextRing : ring_list);
+        if (this->ringCursor == first_ring) break;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Mark a taken log as output
+ *
+ * @param logRing       Async ring of the log (Nullptr: queue slot)
+ * @param ringEnd       End of the log in its async ring
+ */
+void DbgAsyncQueue::doneLog(DbgAsyncRing * logRing, const size_t ringEnd) noexcept
+{
+    if (logRing)
+        logRing->donePos.store(ringEnd, std::memory_order_release);
+    else
+        this->doneCount.fetch_add(1);
+}
+
+/**
+ * @brief Check whether the queue and the async rings are empty
+ *
+ * @return bool         Whether to be empty
+ */
+bool DbgAsyncQueue::isDrained() noexcept
+{
+    if (this->enqueuePos.load(std::memory_order_relaxed) != this->dequeuePos.load(std::memory_order_relaxed)) return false;
+    for (DbgAsyncRing * async_ring = this->ringList.load(std::memory_order_acquire); async_ring; async_ring = async_ring->nextRing)
+    {
+        if (async_ring->readPos.load(std::memory_order_relaxed) != async_ring->writePos.load(std::memory_order_relaxed)) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Wake the consumer if it is waiting for logs
+ */
+void DbgAsyncQueue::wakeConsumer() noexcept
+{
+    // Pairs with the fence in consume(): either the consumer sees the new position, or the producer sees it sleeping (Only the first producer notifies, the consumer may not run before the next logs)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->isSleeping.load(std::memory_order_relaxed) && this->isSleeping.exchange(false))
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        this->wakeCond.notify_one();
+    }
+}
+
+/**
+ * @brief Consumer thread routine
+ */
+void DbgAsyncQueue::consume() noexcept
+{
+    DbgLogBuffer     log_record;
+    DbgStreamState   stream_state;
+    DbgLogBuffer     batch_contents[DBGLOG_ASYNC_BATCH_LENGTH];
+    DbgLogContext    batch_contexts[DBGLOG_ASYNC_BATCH_LENGTH];
+    dbg_log_record_t batch_records[DBGLOG_ASYNC_BATCH_LENGTH];
+    DbgAsyncRing *   batch_rings[DBGLOG_ASYNC_BATCH_LENGTH];
+    size_t           batch_ends[DBGLOG_ASYNC_BATCH_LENGTH];
+    bool             is_woken = false;
+
+    __DbgLogIsConsumer = true;
+
+    for (;;)
+    {
+        DbgAsyncRing *  log_ring     = nullptr;
+        size_t          ring_end     = 0;
+        int             log_type     = 0;
+        bool            is_record    = false;
+        size_t          output_count = 0;
+        size_t          batch_count  = 0;
+        dbg_log_batch_t batch_handle = nullptr;
+
+        // Producers do not wake the consumer meanwhile, a burst costs them one wake-up instead of one per log (On a single core, the consumer no longer preempts the producer after every log)
+        if (is_woken && this->enqueuePos.load(std::memory_order_relaxed) - this->dequeuePos.load(std::memory_order_relaxed) < DBGLOG_ASYNC_BATCH_LENGTH)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(DBGLOG_ASYNC_GATHER_DELAY));
+        }
+        is_woken = false;
+
+        {
+            std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+            batch_handle = __DbgLogBatchHandle;
+        }
+
+        // The slot or the ring space is released before the slow output, so that the producers never wait on it
+        while (this->takeLog(batch_contents[batch_count], batch_contexts[batch_count], log_type, is_record, log_ring, ring_end))
+        {
+            DbgLogBuffer &  log_content = batch_contents[batch_count];
+            DbgLogContext & log_context = batch_contexts[batch_count];
+
+            if (is_record)
+            {
+                log_record.swap(log_content);
+                if (!__DbgOutputRecord(log_record, log_content, log_context, stream_state))
+                {
+                    this->doneLog(log_ring, ring_end);
+                    continue;
+                }
+            }
+
+            if (!batch_handle)
+            {
+                __DbgDispatchLog(log_content, log_context, log_type);
+                this->doneLog(log_ring, ring_end);
+                if (++output_count % DBGLOG_ASYNC_BATCH_LENGTH != 0) continue;
+            }
+            else if (__DbgRouteLog(log_content, log_context, log_type))
+            {
+                this->doneLog(log_ring, ring_end);
+                if (++output_count % DBGLOG_ASYNC_BATCH_LENGTH != 0) continue;
+            }
+            else
+            {
+                log_content.append("\r\n", 2);
+                batch_records[batch_count].logContent = log_content.datas;
+                batch_records[batch_count].logLength  = log_content.length;
+                batch_records[batch_count].logDate    = log_context.logDate;
+                batch_records[batch_count].logTime    = log_context.logTime;
+                batch_records[batch_count].logType    = log_type;
+                batch_rings[batch_count]              = log_ring;
+                batch_ends[batch_count]               = ring_end;
+                if (++batch_count < DBGLOG_ASYNC_BATCH_LENGTH) continue;
+            }
+
+            // The partial batch goes to the handling function it was collected for (Routed logs may have ended the batch)
+            if (batch_count)
+            {
+                batch_handle(batch_records, batch_count);
+                for (size_t batch_idx = 0; batch_idx < batch_count; batch_idx++) this->doneLog(batch_rings[batch_idx], batch_ends[batch_idx]);
+                batch_count = 0;
+            }
+
+            // Notify the blocked producers after every batch, and pick up the current handling function for the next one
+            this->idleCond.notify_all();
+            {
+                std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+                batch_handle = __DbgLogBatchHandle;
+            }
+        }
+
+        // The queue is drained, deliver the partial batch
+        if (batch_count)
+        {
+            batch_handle(batch_records, batch_count);
+            for (size_t batch_idx = 0; batch_idx < batch_count; batch_idx++) this->doneLog(batch_rings[batch_idx], batch_ends[batch_idx]);
+        }
+        this->idleCond.notify_all();
+
+        // The suppressed counts no later log reported are summarized once their second is over (The consumer wakes every DBGLOG_ASYNC_IDLE_TIMEOUT)
+        if (__DbgSuppressPending.load(std::memory_order_relaxed)) __DbgFlushSuppressed(false);
+
+        {
+            std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+            if (this->isStopping) break;
+
+            // Pairs with the fence of the queue producers and the barrier of the ring producers, the heavy barrier lets the ring producers run none
+            this->isSleeping.store(true, std::memory_order_relaxed);
+            __DbgRunHeavyBarrier();
+            if (this->isDrained())
+            {
+                is_woken = (this->wakeCond.wait_for(wait_locker, std::chrono::milliseconds(DBGLOG_ASYNC_IDLE_TIMEOUT)) == std::cv_status::no_timeout && !this->isStopping);
+            }
+            this->isSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief End debug log (Append the errno message and the structured fields, dispatch the log, then break or abort by log type)
+ *
+ * @param logContent    Log content buffer
+ * @param logContext    Log context (Collected by __DbgBeginLog())
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ * @param logFields     Structured fields (Nullptr: no field)
+ * @param fieldsCount   Structured fields count
+ */
+static void __DbgEndLog(DbgLogBuffer & logContent, const DbgLogContext & logContext, const int logType, const dbg_log_field_t * logFields, const size_t fieldsCount) noexcept
+{
+    int          error_code = logContext.errorCode;
+#if defined(_MSC)
+    DWORD        last_error = (DWORD)logContext.lastError;
+#endif
+
+    if ((logType & 0x0400))
+    {
+        char         errno_str[0xFF] = "";
+        const char * errno_msg       = errno_str;
+
+#if defined(_MSC)
+        if (error_code)
+            strerror_s(errno_str, sizeof(errno_str), error_code);
+        else if (last_error)
+            ::FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS, NULL, error_code, 0, (LPTSTR)errno_str, sizeof(errno_str), NULL);
+        if (errno_str[0] == '\0') snprintf(errno_str, sizeof(errno_str), error_code ? "Unknow error code (%d)." : "Unknow error code (%lu).", error_code ? error_code : last_error);
+#elif defined(_GCC)
+        if (error_code) errno_msg = strerror_r(error_code, errno_str, sizeof(errno_str));
+        if (!errno_msg || errno_msg[0] == '\0')
+        {
+            snprintf(errno_str, sizeof(errno_str), "Unknow error code (%d).", error_code);
+            errno_msg = errno_str;
+        }
+#endif
+
+        logContent.append(' ');
+        logContent.append(errno_msg);
+    }
+    __DbgFinishLog(logContent, logContext, logFields, fieldsCount);
+
+    if ((logType & ESL_FATAL)) __DbgAsyncQueue.flush();
+    if ((logType & ESL_FATAL) || !__DbgAsyncQueue.push(logContent, &logContext, logType)) __DbgDispatchLog(logContent, logContext, logType);
+
+    __DbgLogDepth--;
+
+    // Synchronous mode has no consumer, the first log of any call site in a second summarizes the suppressed counts whose second is over
+    if (__DbgLogDepth == 0 && __DbgSuppressPending.load(std::memory_order_relaxed) && !__DbgAsyncQueue.isRunning.load(std::memory_order_relaxed))
+    {
+        int64_t log_second = logContext.logTime / 1000000000LL;
+
+        if (__DbgSuppressChecked.exchange(log_second, std::memory_order_relaxed) != log_second) __DbgFlushSuppressed(false);
+    }
+
+#ifdef _DEBUG
+    if ((logType & ESL_WARNING) || (logType & ESL_ERROR) || (logType & ESL_FATAL)) debug_break();
+#endif
+
+    if (logType & ESL_FATAL)
+    {
+#if defined(_MSC)
+        ExitProcess(STATUS_FATAL_APP_EXIT);
+#elif defined(_GCC)
+        abort();
+#endif
+    }
+}
+
+/**
+ * @brief Get debug log module levels (Set by DbgSetModuleLevel(); Protected by __InnerMutex)
+ *
+ * @return std::unordered_map<std::string, int>&    Module levels (Key: module name)
+ */
+static std::unordered_map<std::string, int> & __DbgModuleLevels() noexcept
+{
+    static std::unordered_map<std::string, int> module_levels;
+    return module_levels;
+}
+
+/**
+ * @brief Clamp debug log level (Between ESL_DEBUG and ESL_FATAL, FATAL logs are always enabled)
+ *
+ * @param minLevel      Minimum enabled log level
+ * @return int          Clamped log level
+ */
+static inline int __DbgClampLevel(const int minLevel) noexcept
+{
+    return (minLevel < ESL_DEBUG ? ESL_DEBUG : (minLevel > ESL_FATAL ? ESL_FATAL : minLevel));
+}
+
+/**
+ * @brief Refresh the level of a registered module (Must hold __InnerMutex)
+ *
+ * @param logModule     Log module
+ */
+static void __DbgRefreshModule(dbg_log_module_t * logModule) noexcept
+{
+    std::unordered_map<std::string, int> &               module_levels = __DbgModuleLevels();
+    std::unordered_map<std::string, int>::const_iterator level_iter    = module_levels.find(logModule->moduleName);
+
+    logModule->minLevel.store(level_iter != module_levels.end() ? level_iter->second : DbgDefaultModule.minLevel.load());
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+/**
+ * @brief Debug log default module
+ */
+dbg_log_module_t DbgDefaultModule;
+
+/**
+ * @brief Construct and register a named module
+ *
+ * @param moduleName    Module name (Must be a string literal)
+ */
+dbg_log_module_t::dbg_log_module_t(const char * moduleName) noexcept : moduleName(moduleName), minLevel(ESL_DEBUG), nextModule(nullptr)
+{
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    __DbgRefreshModule(this);
+    this->nextModule = __DbgLogModules;
+    __DbgLogModules  = this;
+}
+
+/**
+ * @brief Unregister the module
+ */
+dbg_log_module_t::~dbg_log_module_t()
+{
+    if (!this->moduleName) return;
+
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    for (dbg_log_module_t ** module_link = &__DbgLogModules; *module_link; module_link = &(*module_link)->nextModule)
+    {
+        if (*module_link == this)
+        {
+            *module_link = this->nextModule;
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Set debug error infomation handling function (Thread safe; Replaces the batch handling function)
+ *
+ * @param errHandle     Debug error infomation handling function (Nullptr: output to stderr)
+ */
+void DbgSetHandle(const dbg_log_handle_t errHandle) noexcept
+{
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    __DbgLogHandle      = errHandle;
+    __DbgLogBatchHandle = nullptr;
+}
+
+/**
+ * @brief Set debug log batch handling function (Thread safe; Replaces the handling function)
+ *
+ * @param batchHandle   Debug log batch handling function (Nullptr: output to stderr)
+ */
+void DbgSetBatchHandle(const dbg_log_batch_t batchHandle) noexcept
+{
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    __DbgLogHandle      = nullptr;
+    __DbgLogBatchHandle = batchHandle;
+}
+
+/**
+ * @brief Add debug log route (Thread safe; Logs matched by any route go to the sinks of the matched routes instead of the handling function)
+ *
+ * @param levelMask     Log levels of the route (Bitwise OR of execute status levels)
+ * @param moduleName    Module name (Same as DBGLOG_MODULE; Nullptr: every module without own routes for the level)
+ * @param logSink       Routing sink function
+ * @param sinkContext   Sink context (Must stay valid until DbgRemoveRoute() returns)
+ * @return int          Route ID (-1: the routing table is full or the sink is nullptr)
+ */
+int DbgAddRoute(const int levelMask, const char * moduleName, const dbg_log_sink_t logSink, void * sinkContext) noexcept
+{
+    if (!logSink) return -1;
+
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+    DbgRouteTable *             route_table = __DbgRouteTable.load(std::memory_order_relaxed);
+
+    for (int route_id = 0; route_id < DBGLOG_ROUTE_COUNT; route_id++)
+    {
+        DbgLogRoute log_route;
+
+        if (route_table && route_table->logRoutes[route_id].logSink) continue;
+
+        log_route.levelMask   = levelMask;
+        log_route.isAny       = !moduleName;
+        log_route.moduleName  = (moduleName ? moduleName : "");
+        log_route.logSink     = logSink;
+        log_route.sinkContext = sinkContext;
+        __DbgChangeRoutes(route_id, log_route);
+        __DbgRouteCount.fetch_add(1);
+        return route_id;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Remove debug log route (Thread safe; Blocks until the sinks of the route running in other threads return, a sink may remove its own route)
+ *
+ * @param routeId       Route ID (Returned by DbgAddRoute())
+ */
+void DbgRemoveRoute(const int routeId) noexcept
+{
+    if (routeId < 0 || routeId >= DBGLOG_ROUTE_COUNT) return;
+
+    {
+        std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+        DbgRouteTable *             route_table = __DbgRouteTable.load(std::memory_order_relaxed);
+
+        if (!route_table || !route_table->logRoutes[routeId].logSink) return;
+
+        __DbgChangeRoutes(routeId, DbgLogRoute());
+        __DbgRouteCount.fetch_sub(1);
+    }
+
+    // The logs that matched the route hold a replaced table, the sink context may be freed once they let it go
+    __DbgWaitRoutes();
+}
+
+/**
+ * @brief Get debug log buffer allocate count (Thread safe)
+ *
+ * @return size_t       Heap allocations made by the log buffers since the process started (Stays unchanged in steady state)
+ */
+size_t DbgGetAllocCount() noexcept
+{
+    return __DbgLogAllocCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set debug log async mode (Call it before and after the logging threads run; FATAL, ASSERT and VERIFY logs are always output synchronously; Text logs are still formatted by the callers, synchronous mode costs them less if the output is cheaper than the hand-off, about 100 ns, or if the consumer thread shares one core with them)
+ *
+ * @param queueCapacity     Queue capacity (0: synchronous mode; Other: rounded up to a power of two)
+ * @param overflowPolicy    Overflow policy when the queue is full (Use DBGLOG_ASYNC_* macros)
+ * @return true             Success
+ * @return false            Failure (Out of memory or unable to create the consumer thread; Stays in synchronous mode)
+ */
+bool DbgSetAsyncMode(const size_t queueCapacity, const int overflowPolicy) noexcept
+{
+    if (queueCapacity == 0)
+    {
+        __DbgAsyncQueue.stop();
+        return true;
+    }
+
+    return __DbgAsyncQueue.start(queueCapacity, overflowPolicy);
+}
+
+/**
+ * @brief Wait until every log queued before the call is output (Thread safe; Returns immediately in synchronous mode)
+ */
+void DbgFlush() noexcept
+{
+    if (__DbgAsyncQueue.isRunning.load()) __DbgAsyncQueue.flush();
+}
+
+/**
+ * @brief Get debug log drop count (Thread safe)
+ *
+ * @return size_t       Logs dropped by the DBGLOG_ASYNC_DROP and DBGLOG_ASYNC_OVERWRITE policies since the process started
+ */
+size_t DbgGetDropCount() noexcept
+{
+    return __DbgLogDropCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Set debug log default level (Thread safe; Applies to the default module and the modules without module level)
+ *
+ * @param minLevel      Minimum enabled log level (Use execute status level; FATAL logs are always enabled)
+ */
+void DbgSetLogLevel(const int minLevel) noexcept
+{
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    DbgDefaultModule.minLevel.store(__DbgClampLevel(minLevel));
+    for (dbg_log_module_t * log_module = __DbgLogModules; log_module; log_module = log_module->nextModule) __DbgRefreshModule(log_module);
+}
+
+/**
+ * @brief Set debug log module level (Thread safe; Applies to the modules registered before and after the call)
+ *
+ * @param moduleName    Module name (Same as DBGLOG_MODULE)
+ * @param minLevel      Minimum enabled log level (Use execute status level; 0: use the default level)
+ */
+void DbgSetModuleLevel(const char * moduleName, const int minLevel) noexcept
+{
+    if (!moduleName) return;
+
+    std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+
+    if (minLevel == 0)
+        __DbgModuleLevels().erase(moduleName);
+    else
+        __DbgModuleLevels()[moduleName] = __DbgClampLevel(minLevel);
+
+    for (dbg_log_module_t * log_module = __DbgLogModules; log_module; log_module = log_module->nextModule)
+    {
+        if (strcmp(log_module->moduleName, moduleName) == 0) __DbgRefreshModule(log_module);
+    }
+}
+
+/**
+ * @brief Set debug log encoder (Thread safe; Applies to every log formatted after the call, including the records formatted by DbgDecodeStream())
+ *
+ * @param logEncoder    Log encoder (Use DBGLOG_ENCODER_* macros)
+ */
+void DbgSetEncoder(const int logEncoder) noexcept
+{
+    if (logEncoder < DBGLOG_ENCODER_TEXT || logEncoder > DBGLOG_ENCODER_LOGFMT) return;
+
+    __DbgLogEncoder.store(logEncoder, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Output debug log (Thread safe; Direct use is not recommended)
+ *
+ * @param filePath      File path (Debug mode: DBG_OUTPUTLOG_FILE; Release mode: nullptr)
+ * @param fileLine      File line (Debug mode: DBG_OUTPUTLOG_LINE; Release mode: 0)
+ * @param fileFunc      File function (Debug mode: DBG_OUTPUTLOG_FUNC; Release mode: nullptr)
+ * @param logType       Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+ * @param fmtString     Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
+ * @param fmtArgsCount  Format arguments count
+ * @param ...           Format arguments ("%X|%x|%B|%b" must be use a parameter in the format of std::make_unique<dbg_log_datas_t>("xxx", 3).get())
+ */
+void DbgOutputLog(const char * filePath, const int fileLine, const char * fileFunc, const int logType, const char * fmtString, const int fmtArgsCount, ...) noexcept
+{
+    // ASSERT and VERIFY logs are always output, other logs follow the default level
+    if (!(logType & 0x0300) && (logType & 0xff) < DbgDefaultModule.minLevel.load(std::memory_order_relaxed)) return;
+
+    DbgLogContext  log_context;
+    DbgLogBuffer   nested_buffer;
+    DbgLogBuffer & log_content = (__DbgLogDepth++ == 0 && !__DbgLogExited ? __DbgLogBuffer : nested_buffer);
+
+    log_context.errorCode = errno;
+#if defined(_MSC)
+    log_context.lastError = ::GetLastError();
+#endif
+
+    if (!__DbgBeginLog(log_content, log_context, filePath, fileLine, fileFunc, logType))
+    {
+        __DbgLogDepth--;
+        return;
+    }
+
+    if (fmtArgsCount > 0)
+    {
+        va_list arg_list;
+
+        va_start(arg_list, fmtArgsCount);
+        __DbgFormatLog(log_content, fmtString, arg_list);
+        va_end(arg_list);
+    }
+    else
+    {
+        log_content.append(fmtString);
+    }
+
+    __DbgEndLog(log_content, log_context, logType, nullptr, 0);
+}
+
+/**
+ * @brief Output structured debug log (Thread safe; Use DBGLOG_FIELDS() instead of direct use; Formatted immediately, also in deferred mode)
+ *
+ * @param filePath      File path (Debug mode: DBG_OUTPUTLOG_FILE; Release mode: nullptr)
+ * @param fileLine      File line (Debug mode: DBG_OUTPUTLOG_LINE; Release mode: 0)
+ * @param fileFunc      File function (Debug mode: DBG_OUTPUTLOG_FUNC; Release mode: nullptr)
+ * @param logType       Log type (Use execute status level)
+ * @param logMessage    Log message (Written as is, not a format string; Nullptr: empty message)
+ * @param logFields     Structured fields (Written after the message in order)
+ * @param fieldsCount   Structured fields count
+ * @param logModule     Log module (Used to route the log; Nullptr: default module)
+ */
+void DbgOutputFields(const char * filePath, const int fileLine, const char * fileFunc, const int logType, const char * logMessage, const dbg_log_field_t * logFields, const size_t fieldsCount, const dbg_log_module_t * logModule) noexcept
+{
+    DbgLogContext  log_context;
+    DbgLogBuffer   nested_buffer;
+    DbgLogBuffer & log_content = (__DbgLogDepth++ == 0 && !__DbgLogExited ? __DbgLogBuffer : nested_buffer);
+
+    log_context.logModule = logModule;
+
+    if (!__DbgBeginLog(log_content, log_context, filePath, fileLine, fileFunc, logType))
+    {
+        __DbgLogDepth--;
+        return;
+    }
+
+    if (logMessage) log_content.append(logMessage);
+
+    __DbgEndLog(log_content, log_context, logType, logFields, fieldsCount);
+}
+
+/**
+ * @brief Check debug log limit of call site (Thread safe; Use DBGLOG_LIMITED() instead of direct use)
+ *
+ * @param logSite       Log call site (Its log limit must not be nullptr)
+ * @return true         Output the log (DbgOutputFormat() of the same thread reports the suppressed count)
+ * @return false        Suppress the log
+ */
+bool DbgCheckLimit(const dbg_log_site_t * logSite) noexcept
+{
+    dbg_log_limit_t * log_limit   = logSite->logLimit;
+    uint64_t          limit_count = (log_limit->limitCount ? log_limit->limitCount : 1);
+
+    if (log_limit->limitPolicy == DBGLOG_LIMIT_RATE)
+    {
+        uint64_t limit_second = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count() & 0xffffffffffULL;
+        uint64_t limit_state  = log_limit->limitState.load(std::memory_order_relaxed);
+        uint64_t new_state    = 0;
+
+        if (limit_count > 0xffffff) limit_count = 0xffffff;
+
+        do
+        {
+            if ((limit_state >> 24) != limit_second)
+            {
+                new_state = (limit_second << 24) | 1;
+            }
+            else if ((limit_state & 0xffffff) < limit_count)
+            {
+                new_state = limit_state + 1;
+            }
+            else
+            {
+                if (log_limit->suppressCount.fetch_add(1) == 0) __DbgPendSuppressed(logSite);
+                return false;
+            }
+        } while (!log_limit->limitState.compare_exchange_weak(limit_state, new_state, std::memory_order_relaxed));
+
+        // The first log of a new second reports the logs suppressed before it
+        if ((new_state & 0xffffff) == 1)
+        {
+            uint64_t suppress_count = log_limit->suppressCount.exchange(0, std::memory_order_relaxed);
+
+            __DbgSuppressSite  = logSite;
+            __DbgSuppressCount = (uint32_t)(suppress_count > 0xffffffffULL ? 0xffffffffULL : suppress_count);
+        }
+        return true;
+    }
+    else if (log_limit->limitPolicy == DBGLOG_LIMIT_EVERY)
+    {
+        return log_limit->limitState.fetch_add(1, std::memory_order_relaxed) % limit_count == 0;
+    }
+    else if (log_limit->limitPolicy == DBGLOG_LIMIT_FIRST)
+    {
+        // Stop counting once the limit is reached, so that the count never wraps
+        return log_limit->limitState.load(std::memory_order_relaxed) < limit_count && log_limit->limitState.fetch_add(1, std::memory_order_relaxed) < limit_count;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Output debug log with precompiled format program (Thread safe; Use DBGLOG_OUTPUT_FORMAT() instead of direct use)
+ *
+ * @param logSite       Log call site (Static descriptor defined by DBGLOG_OUTPUT_FORMAT())
+ * @param ...           Format arguments (Checked at compile time by dbg_log_types_t::check())
+ */
+void DbgOutputFormat(const dbg_log_site_t * logSite, ...) noexcept
+{
+    DbgLogContext  log_context;
+    DbgLogBuffer   nested_buffer;
+    DbgLogBuffer & log_content    = (__DbgLogDepth++ == 0 && !__DbgLogExited ? __DbgLogBuffer : nested_buffer);
+    uint32_t       suppress_count = (__DbgSuppressSite == logSite ? __DbgSuppressCount : 0);
+    va_list        arg_list;
+
+    __DbgSuppressSite = nullptr;
+
+    // Deferred mode: copy the arguments only, the consumer thread formats the record
+    if (!(logSite->logType & ESL_FATAL) && __DbgDeferredMode.load(std::memory_order_relaxed) && __DbgAsyncQueue.isRunning.load(std::memory_order_relaxed) && !__DbgLogIsConsumer)
+    {
+        bool is_encoded = false;
+
+        va_start(arg_list, logSite);
+        is_encoded = __DbgEncodeRecord(log_content, logSite, suppress_count, arg_list);
+        va_end(arg_list);
+
+        if (is_encoded && !__DbgAsyncQueue.push(log_content, nullptr, logSite->logType))
+        {
+            DbgLogBuffer           log_record;
+            DbgLogContext          log_context;
+            dbg_log_record_entry_t record_head;
+            size_t                 head_length = sizeof(dbg_log_entry_t) + sizeof(dbg_log_record_entry_t);
+
+            // The queue stopped meanwhile, format the record here
+            log_record.swap(log_content);
+            memcpy(&record_head, log_record.datas + sizeof(dbg_log_entry_t), sizeof(record_head));
+            if (__DbgRenderRecord(log_content, log_context, *logSite, record_head, (const uchar *)log_record.datas + head_length, log_record.length - head_length))
+            {
+                __DbgDispatchLog(log_content, log_context, logSite->logType);
+            }
+        }
+
+        __DbgLogDepth--;
+
+#ifdef _DEBUG
+        if ((logSite->logType & ESL_WARNING) || (logSite->logType & ESL_ERROR)) debug_break();
+#endif
+        return;
+    }
+
+    log_context.errorCode  = errno;
+#if defined(_MSC)
+    log_context.lastError  = ::GetLastError();
+#endif
+    log_context.logModule  = logSite->logModule;
+    log_context.routeCache = logSite->routeCache;
+
+    if (!__DbgBeginLog(log_content, log_context, logSite->filePath, logSite->fileLine, logSite->fileFunc, logSite->logType))
+    {
+        __DbgLogDepth--;
+        return;
+    }
+
+    va_start(arg_list, logSite);
+    {
+        DbgVaArgsReader args_reader(arg_list);
+        __DbgFormatOps(log_content, logSite->fmtString, logSite->fmtOps, logSite->opsCount, args_reader);
+    }
+    __DbgWriteSuppressed(log_content, suppress_count);
+    va_end(arg_list);
+
+    __DbgEndLog(log_content, log_context, logSite->logType, nullptr, 0);
+}
+
+/**
+ * @brief Set debug log deferred mode (DBGLOG_* calls only copy their arguments into a binary record; Takes effect while async mode runs; Records go through a ring of the calling thread without shared read-modify-write, a call costs the caller about 90 ns of which about 40 ns is the clock)
+ *
+ * @param isDeferred    Whether to defer formatting (FATAL logs and logs of the consumer thread are always formatted immediately)
+ * @param streamWrite   Binary stream writing function (Nullptr: the consumer thread formats the records and outputs them as usual; Other: receives the binary stream, decode it with DbgDecodeStream())
+ */
+void DbgSetDeferredMode(const bool isDeferred, const dbg_log_write_t streamWrite) noexcept
+{
+    {
+        std::lock_guard<std::mutex> inner_locker(__InnerMutex);
+        __DbgStreamWrite = streamWrite;
+    }
+
+    __DbgDeferredMode.store(isDeferred);
+}
+
+/**
+ * @brief Decode debug log binary stream (Formats every record the same as the deferred consumer thread)
+ *
+ * @param streamDatas   Stream datas (One or more streams written in deferred mode)
+ * @param streamLength  Stream datas length
+ * @param decodeHandle  Receives every decoded log (Same as the handling function)
+ * @return size_t       Decoded records count (Stops at the first truncated or invalid entry)
+ */
+size_t DbgDecodeStream(const void * streamDatas, const size_t streamLength, const dbg_log_handle_t decodeHandle) noexcept
+{
+    std::unordered_map<uint64_t, DbgDecodeSite> decode_sites;
+    DbgLogBuffer                                log_content;
+    const uchar *                               stream_pos    = (const uchar *)streamDatas;
+    const uchar *                               stream_end    = stream_pos + streamLength;
+    bool                                        is_started    = false;
+    size_t                                      records_count = 0;
+
+    while ((size_t)(stream_end - stream_pos) >= sizeof(dbg_log_entry_t))
+    {
+        dbg_log_entry_t entry_head;
+        const uchar *   entry_body  = stream_pos + sizeof(dbg_log_entry_t);
+        size_t          body_length = 0;
+
+        memcpy(&entry_head, stream_pos, sizeof(entry_head));
+        if (entry_head.entryLength < sizeof(entry_head) || entry_head.entryLength > (size_t)(stream_end - stream_pos)) break;
+        body_length  = entry_head.entryLength - sizeof(entry_head);
+        stream_pos  += entry_head.entryLength;
+
+        if (entry_head.entryType == DBGLOG_ENTRY_STREAM)
+        {
+            dbg_log_stream_t stream_head;
+
+            if (body_length < sizeof(stream_head)) break;
+            memcpy(&stream_head, entry_body, sizeof(stream_head));
+            if (stream_head.streamMagic != DBGLOG_STREAM_MAGIC || stream_head.streamVersion != DBGLOG_STREAM_VERSION) break;
+            if (stream_head.longDoubleSize != sizeof(long double) || stream_head.wideCharSize != sizeof(wchar_t)) break;
+
+            decode_sites.clear();
+            is_started = true;
+        }
+        else if (entry_head.entryType == DBGLOG_ENTRY_SITE)
+        {
+            dbg_log_site_entry_t site_head;
+            const char *         site_strings[3] = {nullptr, nullptr, nullptr};
+            const char *         string_pos      = (const char *)entry_body + sizeof(site_head);
+            const char *         string_end      = (const char *)entry_body + body_length;
+            DbgDecodeSite *      decode_site     = nullptr;
+
+            if (!is_started || body_length < sizeof(site_head)) break;
+            memcpy(&site_head, entry_body, sizeof(site_head));
+
+            for (int string_idx = 0; string_idx < 3 && string_pos < string_end; string_idx++)
+            {
+                const char * string_term = (const char *)memchr(string_pos, '\0', string_end - string_pos);
+
+                if (!string_term) break;
+                site_strings[string_idx] = string_pos;
+                string_pos               = string_term + 1;
+            }
+            if (!site_strings[2]) break;
+
+            decode_site = &decode_sites[site_head.siteId];
+            decode_site->fmtOps.resize(DbgFormatOpsCount(site_strings[2]));
+            if (!DbgFormatCompileOps(site_strings[2], decode_site->fmtOps.data())) break;
+
+            decode_site->logSite.filePath   = (site_strings[0][0] ? site_strings[0] : nullptr);
+            decode_site->logSite.fileLine   = site_head.fileLine;
+            decode_site->logSite.fileFunc   = (site_strings[1][0] ? site_strings[1] : nullptr);
+            decode_site->logSite.logType    = site_head.logType;
+            decode_site->logSite.fmtString  = site_strings[2];
+            decode_site->logSite.fmtOps     = decode_site->fmtOps.data();
+            decode_site->logSite.opsCount   = decode_site->fmtOps.size();
+            decode_site->logSite.logLimit   = nullptr;
+            decode_site->logSite.logModule  = nullptr;
+            decode_site->logSite.routeCache = nullptr;
+        }
+        else if (entry_head.entryType == DBGLOG_ENTRY_RECORD)
+        {
+            dbg_log_record_entry_t record_head;
+            DbgLogContext          log_context;
+
+            if (!is_started || body_length < sizeof(record_head)) break;
+            memcpy(&record_head, entry_body, sizeof(record_head));
+
+            std::unordered_map<uint64_t, DbgDecodeSite>::const_iterator site_iter = decode_sites.find(record_head.siteId);
+            if (site_iter == decode_sites.end()) break;
+
+            if (!__DbgRenderRecord(log_content, log_context, site_iter->second.logSite, record_head, entry_body + sizeof(record_head), body_length - sizeof(record_head))) break;
+            log_content.append("\r\n", 2);
+            if (decodeHandle) decodeHandle(log_context.logDate, log_content.datas, log_content.length);
+            records_count++;
+        }
+    }
+
+    return records_count;
+}
+
+/**
+ * @brief Format string by the debug log formatter (Thread safe; Same specifiers as DbgOutputLog(); Used by the logging modules)
+ *
+ * @param fmtLength     Output formatted string length
+ * @param fmtString     Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
+ * @param fmtArgs       Format arguments ("%X|%x|%B|%b" must be use a dbg_log_datas_t * argument)
+ * @return const char*  Formatted string (Buffer of current thread, valid until the next call on the same thread; Nullptr: out of memory, or called by a thread destructor after the buffer is gone)
+ */
+const char * DbgFormatString(size_t & fmtLength, const char * fmtString, va_list fmtArgs) noexcept
+{
+    if (__DbgLogExited) return nullptr;
+
+    __DbgFormatBuffer.length = 0;
+    if (!__DbgFormatBuffer.reserve(DBGLOG_BUFFER_INIT_LENGTH - 1)) return nullptr;
+    __DbgFormatBuffer.datas[0] = '\0';
+
+    __DbgFormatLog(__DbgFormatBuffer, fmtString, fmtArgs);
+
+    fmtLength = __DbgFormatBuffer.length;
+    return __DbgFormatBuffer.datas;
+}
\ No newline at end of file
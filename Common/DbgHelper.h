@@ -16,6 +16,10 @@
 #include "../Base/BaseDefine.h"
 #include "../Base/GlobalErrno.h"
 #include "../Base/GlobalType.h"
+#include <atomic>
+#include <stdarg.h>
+#include <stdint.h>
+#include <type_traits>
 #if defined(_MSC) && defined(_CRTDBG_MAP_ALLOC)
     #include <crtdbg.h>
 #endif
@@ -90,20 +94,158 @@
     #define DBG_PERROR(type, str)   DbgOutputLog(nullptr,            0,                  nullptr,            0x0400 | type, str, 0)
 #endif
 
-// Output custom infomation
+// Format specifier flags (Used to dbg_log_spec_t)
+#define DBGLOG_SPEC_FLAG_LEFT          0x01 // '-': Left-justify within the field width
+#define DBGLOG_SPEC_FLAG_PLUS          0x02 // '+': Always print the sign of signed numbers
+#define DBGLOG_SPEC_FLAG_SPACE         0x04 // ' ': Print a space before positive signed numbers
+#define DBGLOG_SPEC_FLAG_ALT           0x08 // '#': Alternative form
+#define DBGLOG_SPEC_FLAG_ZERO          0x10 // '0': Pad numbers with leading zeros
+#define DBGLOG_SPEC_FLAG_STARWIDTH     0x20 // '*': Width is given by argument
+#define DBGLOG_SPEC_FLAG_STARPRECISION 0x40 // '.*': Precision is given by argument
+
+// Format argument classes (Used to check format arguments at compile time)
+#define DBGLOG_ARG_INT     0x0001 // Integer promoted to int
+#define DBGLOG_ARG_INT64   0x0002 // 64 bits integer
+#define DBGLOG_ARG_DOUBLE  0x0004 // Double (Or float promoted to double)
+#define DBGLOG_ARG_LDOUBLE 0x0008 // Long double
+#define DBGLOG_ARG_STRING  0x0010 // Character string
+#define DBGLOG_ARG_WSTRING 0x0020 // Wide character string
+#define DBGLOG_ARG_POINTER 0x0040 // Pointer
+#define DBGLOG_ARG_DATAS   0x0080 // Hex or binary datas (dbg_log_datas_t *)
+
+// Async log overflow policy (Used to DbgSetAsyncMode())
+#define DBGLOG_ASYNC_BLOCK     0 // Wait until the consumer thread frees a slot
+#define DBGLOG_ASYNC_DROP      1 // Drop the new log
+#define DBGLOG_ASYNC_OVERWRITE 2 // Drop the oldest queued log (A full ring of a deferred logging thread drops the new one)
+
+// Log limit policy (Used to DBGLOG_LIMITED())
+#define DBGLOG_LIMIT_NONE  0 // No limit
+#define DBGLOG_LIMIT_RATE  1 // At most N logs per second (The first log of a new second reports the suppressed count, or a summary log once the second is over)
+#define DBGLOG_LIMIT_EVERY 2 // Every Nth occurrence (1st, N+1th, 2N+1th...)
+#define DBGLOG_LIMIT_FIRST 3 // First N occurrences only
+
+// Debug log routing table (Used to DbgAddRoute())
+#define DBGLOG_ROUTE_COUNT 32 // Max routes (Route IDs are 0 to DBGLOG_ROUTE_COUNT - 1)
+
+// Debug log encoder (Used to DbgSetEncoder(); Header fields are written as the keys "time", "level", "pid", "tid", "file", "line", "func" and "msg")
+#define DBGLOG_ENCODER_TEXT   0 // Human-readable header and message, structured fields follow the message as key=value
+#define DBGLOG_ENCODER_JSON   1 // JSON lines (Example: {"time":"2020-01-01 00:00:00.000","level":"INFO","pid":1,"tid":2,"msg":"Done","status":200})
+#define DBGLOG_ENCODER_LOGFMT 2 // logfmt (Example: time="2020-01-01 00:00:00.000" level=INFO pid=1 tid=2 msg="Done" status=200)
+
+// Structured field type (Used to dbg_log_field_t)
+#define DBGLOG_FIELD_INT    0 // Signed integer
+#define DBGLOG_FIELD_UINT   1 // Unsigned integer
+#define DBGLOG_FIELD_DOUBLE 2 // Floating point (NaN and infinity are written as null)
+#define DBGLOG_FIELD_BOOL   3 // Boolean
+#define DBGLOG_FIELD_STRING 4 // Character string (Nullptr is written as null)
+
+// Debug log binary stream (Written in deferred mode; Stream: DBGLOG_ENTRY_STREAM entry, then DBGLOG_ENTRY_SITE and DBGLOG_ENTRY_RECORD entries)
+#define DBGLOG_STREAM_MAGIC   0x474c4244 // Stream magic ("DBLG")
+#define DBGLOG_STREAM_VERSION 1          // Stream version
+#define DBGLOG_ENTRY_STREAM   0          // Stream head: dbg_log_entry_t + dbg_log_stream_t
+#define DBGLOG_ENTRY_SITE     1          // Call site: dbg_log_entry_t + dbg_log_site_entry_t + filePath '\0' + fileFunc '\0' + fmtString '\0'
+#define DBGLOG_ENTRY_RECORD   2          // Log record: dbg_log_entry_t + dbg_log_record_entry_t + arguments in format order:
+                                         //   DBGLOG_ARG_INT ('*' width and precision too): int32
+                                         //   DBGLOG_ARG_INT64:   int64
+                                         //   DBGLOG_ARG_DOUBLE:  double
+                                         //   DBGLOG_ARG_LDOUBLE: long double (dbg_log_stream_t::longDoubleSize bytes)
+                                         //   DBGLOG_ARG_POINTER: uint64 ("%p" and "%n")
+                                         //   DBGLOG_ARG_STRING:  uint32 length (0xffffffff: nullptr; Cut by the precision) + characters + '\0'
+                                         //   DBGLOG_ARG_WSTRING: uint32 count (0xffffffff: nullptr) + wide characters + L'\0'
+                                         //   DBGLOG_ARG_DATAS:   uint32 dbg_log_datas_t::length + uint32 datas bytes + datas
+
+// Debug log compile level (DBGLOG_* logs below it expand to nothing; FATAL logs are always compiled; Define it before including this file to override)
+#ifndef DBGLOG_COMPILE_LEVEL
+    #ifdef _DEBUG
+        #define DBGLOG_COMPILE_LEVEL ESL_DEBUG
+    #else
+        #define DBGLOG_COMPILE_LEVEL ESL_INFOMATION
+    #endif
+#endif
+
+// Debug log module of current source file (Define DBGLOG_MODULE as the module name string before including this file to use a module level)
+#if defined(DBGLOG_MODULE)
+    #define DBGLOG_CURRENT_MODULE DbgCurrentModule
+#else
+    #define DBGLOG_CURRENT_MODULE DbgDefaultModule
+#endif
+
+// Debug log call site infomation (Release mode: file, line and function are not recorded)
 #ifdef _DEBUG
-    #define DBGLOG_DEBUG(fmt, ...)      DbgOutputLog(DBG_OUTPUTLOG_FILE, DBG_OUTPUTLOG_LINE, DBG_OUTPUTLOG_FUNC, ESL_DEBUG,      fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output debug log
-    #define DBGLOG_INFOMATION(fmt, ...) DbgOutputLog(DBG_OUTPUTLOG_FILE, DBG_OUTPUTLOG_LINE, DBG_OUTPUTLOG_FUNC, ESL_INFOMATION, fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output infomation log
-    #define DBGLOG_WARNING(fmt, ...)    DbgOutputLog(DBG_OUTPUTLOG_FILE, DBG_OUTPUTLOG_LINE, DBG_OUTPUTLOG_FUNC, ESL_WARNING,    fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output warning log
-    #define DBGLOG_ERROR(fmt, ...)      DbgOutputLog(DBG_OUTPUTLOG_FILE, DBG_OUTPUTLOG_LINE, DBG_OUTPUTLOG_FUNC, ESL_ERROR,      fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output error log
-    #define DBGLOG_FATAL(fmt, ...)      DbgOutputLog(DBG_OUTPUTLOG_FILE, DBG_OUTPUTLOG_LINE, DBG_OUTPUTLOG_FUNC, ESL_FATAL,      fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output fatal log
+    #define DBGLOG_SITE_FILE DBG_OUTPUTLOG_FILE
+    #define DBGLOG_SITE_LINE DBG_OUTPUTLOG_LINE
+    #define DBGLOG_SITE_FUNC DBG_OUTPUTLOG_FUNC
+#else
+    #define DBGLOG_SITE_FILE nullptr
+    #define DBGLOG_SITE_LINE 0
+    #define DBGLOG_SITE_FUNC nullptr
+#endif
+
+// Format check result (Used to check format arguments at compile time)
+#define DBGLOG_FMT_OK          0 // Format string matches its arguments
+#define DBGLOG_FMT_E_SPECIFIER 1 // Format string has an incomplete or unknown specifier
+#define DBGLOG_FMT_E_COUNT     2 // Arguments count does not match the format string
+#define DBGLOG_FMT_E_TYPE      3 // Argument type does not match its specifier
+
+// Output log with compile-time parsed format (Format must be a string literal; Checks the arguments and precompiles the format program of the call site; Arguments are evaluated only if the log level is enabled and the log limit passes; An expression of void type, the statics live in a lambda called in place)
+// The caller function is passed into the lambda, inside it the function name is the lambda's (Release mode: the nullptr function keeps the site constant-initialized)
+#define DBGLOG_OUTPUT_LIMITED(filePath, fileLine, fileFunc, logType, limitPolicy, limitCount, fmt, ...)                                                                    \
+    [&](const char * dbg_log_func)                                                                                                                                         \
+    {                                                                                                                                                                      \
+        typedef decltype(DbgFormatTypes(__VA_ARGS__)) dbg_fmt_types_t;                                                                                                     \
+        static_assert(dbg_fmt_types_t::check(fmt) != DBGLOG_FMT_E_SPECIFIER, "DBGLOG: the format string has an incomplete or unknown specifier.");                         \
+        static_assert(dbg_fmt_types_t::check(fmt) != DBGLOG_FMT_E_COUNT,     "DBGLOG: the count of format arguments does not match the format string.");                   \
+        static_assert(dbg_fmt_types_t::check(fmt) != DBGLOG_FMT_E_TYPE,      "DBGLOG: the type of format argument does not match its specifier.");                         \
+        static constexpr dbg_log_program_t<DbgFormatOpsCount(fmt)> dbg_fmt_program = DbgFormatCompile<DbgFormatOpsCount(fmt)>(fmt);                                        \
+        static dbg_log_limit_t       dbg_log_limit(limitPolicy, limitCount);                                                                                               \
+        static dbg_log_route_cache_t dbg_log_route;                                                                                                                        \
+        static const dbg_log_site_t  dbg_log_site = {filePath, fileLine, (fileFunc ? dbg_log_func : nullptr), logType, fmt, dbg_fmt_program.fmtOps,                        \
+                                                     DbgFormatOpsCount(fmt), &dbg_log_limit, &DBGLOG_CURRENT_MODULE, &dbg_log_route};                                      \
+        if ((logType) >= DBGLOG_CURRENT_MODULE.minLevel.load(std::memory_order_relaxed) && ((limitPolicy) == DBGLOG_LIMIT_NONE || DbgCheckLimit(&dbg_log_site)))           \
+            DbgOutputFormat(&dbg_log_site, ##__VA_ARGS__);                                                                                                                 \
+    }(fileFunc)
+#define DBGLOG_OUTPUT_FORMAT(filePath, fileLine, fileFunc, logType, fmt, ...) DBGLOG_OUTPUT_LIMITED(filePath, fileLine, fileFunc, logType, DBGLOG_LIMIT_NONE, 0, fmt, ##__VA_ARGS__)
+
+// Output custom infomation (Format must be a string literal; Use DbgOutputLog() for runtime format string; Levels below DBGLOG_COMPILE_LEVEL expand to nothing)
+#if DBGLOG_COMPILE_LEVEL <= ESL_DEBUG
+    #define DBGLOG_DEBUG(fmt, ...)      DBGLOG_OUTPUT_FORMAT(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, ESL_DEBUG,      fmt, ##__VA_ARGS__) // Output debug log
 #else
-    #define DBGLOG_DEBUG(fmt, ...)                                                                                                                                          // Output debug log
-    #define DBGLOG_INFOMATION(fmt, ...) DbgOutputLog(nullptr,            0,                  nullptr,            ESL_INFOMATION, fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output infomation log
-    #define DBGLOG_WARNING(fmt, ...)    DbgOutputLog(nullptr,            0,                  nullptr,            ESL_WARNING,    fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output warning log
-    #define DBGLOG_ERROR(fmt, ...)      DbgOutputLog(nullptr,            0,                  nullptr,            ESL_ERROR,      fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output error log
-    #define DBGLOG_FATAL(fmt, ...)      DbgOutputLog(nullptr,            0,                  nullptr,            ESL_FATAL,      fmt, VA_COUNT(__VA_ARGS__), ##__VA_ARGS__) // Output fatal log
+    #define DBGLOG_DEBUG(fmt, ...)      ((void)0)                                                                                                      // Output debug log
 #endif
+#if DBGLOG_COMPILE_LEVEL <= ESL_INFOMATION
+    #define DBGLOG_INFOMATION(fmt, ...) DBGLOG_OUTPUT_FORMAT(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, ESL_INFOMATION, fmt, ##__VA_ARGS__) // Output infomation log
+#else
+    #define DBGLOG_INFOMATION(fmt, ...) ((void)0)                                                                                                      // Output infomation log
+#endif
+#if DBGLOG_COMPILE_LEVEL <= ESL_WARNING
+    #define DBGLOG_WARNING(fmt, ...)    DBGLOG_OUTPUT_FORMAT(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, ESL_WARNING,    fmt, ##__VA_ARGS__) // Output warning log
+#else
+    #define DBGLOG_WARNING(fmt, ...)    ((void)0)                                                                                                      // Output warning log
+#endif
+#if DBGLOG_COMPILE_LEVEL <= ESL_ERROR
+    #define DBGLOG_ERROR(fmt, ...)      DBGLOG_OUTPUT_FORMAT(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, ESL_ERROR,      fmt, ##__VA_ARGS__) // Output error log
+#else
+    #define DBGLOG_ERROR(fmt, ...)      ((void)0)                                                                                                      // Output error log
+#endif
+#define DBGLOG_FATAL(fmt, ...)          DBGLOG_OUTPUT_FORMAT(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, ESL_FATAL,      fmt, ##__VA_ARGS__) // Output fatal log
+
+// Output custom infomation with log limit (Example: DBGLOG_LIMITED(ESL_WARNING, DBGLOG_LIMIT_RATE, 10, "Bad packet from %s", peer_name); Levels below DBGLOG_COMPILE_LEVEL are never evaluated)
+#define DBGLOG_LIMITED(logType, limitPolicy, limitCount, fmt, ...)                                                                                                         \
+    (((logType) >= DBGLOG_COMPILE_LEVEL || (logType) == ESL_FATAL)                                                                                                         \
+         ? DBGLOG_OUTPUT_LIMITED(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, DBGLOG_SITE_FUNC, logType, limitPolicy, limitCount, fmt, ##__VA_ARGS__)                               \
+         : (void)0)
+
+// Output structured log (Example: DBGLOG_FIELDS(ESL_INFOMATION, "Request done", {"status", 200}, {"path", url_path}); At least one field; Levels below DBGLOG_COMPILE_LEVEL are never evaluated)
+#define DBGLOG_FIELDS(logType, logMessage, ...)                                                                                                                            \
+    [&](const char * dbg_log_func)                                                                                                                                         \
+    {                                                                                                                                                                      \
+        if (((logType) >= DBGLOG_COMPILE_LEVEL || (logType) == ESL_FATAL) && (logType) >= DBGLOG_CURRENT_MODULE.minLevel.load(std::memory_order_relaxed))                  \
+        {                                                                                                                                                                  \
+            const dbg_log_field_t dbg_log_fields[] = {__VA_ARGS__};                                                                                                        \
+            DbgOutputFields(DBGLOG_SITE_FILE, DBGLOG_SITE_LINE, dbg_log_func, logType, logMessage, dbg_log_fields, sizeof(dbg_log_fields) / sizeof(*dbg_log_fields),       \
+                            &DBGLOG_CURRENT_MODULE);                                                                                                                       \
+        }                                                                                                                                                                  \
+    }(DBGLOG_SITE_FUNC)
 
 //================================================================================
 // Define export type
@@ -117,6 +259,42 @@
  */
 typedef void (*dbg_log_handle_t)(const char *logDate, const char *logContent, const size_t logLength);
 
+/**
+ * @brief Debug log record (Delivered to the batch handling function; Valid until the function returns)
+ */
+struct dbg_log_record_t
+{
+    const char * logContent; // Log content (Ends with "\r\n" and '\0')
+    size_t       logLength;  // Log content length (Without terminator '\0')
+    const char * logDate;    // Log local date (Format: "yyyyMMdd")
+    int64_t      logTime;    // Log time (Nanoseconds since epoch)
+    int          logType;    // Log type (0x0100: ASSERT; 0x0200: VERIFY; 0x0400: PERROR; Other: use execute status level)
+};
+
+/**
+ * @brief Debug log batch handling function (Thread safe; Async mode delivers the queued logs in batches, synchronous mode delivers one record per call)
+ *
+ * @param logRecords    Log records (In output order)
+ * @param recordsCount  Log records count
+ */
+typedef void (*dbg_log_batch_t)(const dbg_log_record_t *logRecords, const size_t recordsCount);
+
+/**
+ * @brief Debug log routing sink function (Thread safe; Every sink of the matched routes receives the same formatted record)
+ *
+ * @param sinkContext   Sink context (Passed to DbgAddRoute())
+ * @param logRecord     Log record (Valid until the function returns)
+ */
+typedef void (*dbg_log_sink_t)(void *sinkContext, const dbg_log_record_t *logRecord);
+
+/**
+ * @brief Debug log binary stream writing function (Deferred mode; Called by the async consumer thread only)
+ *
+ * @param streamDatas   Stream datas (One or more whole entries)
+ * @param streamLength  Stream datas length
+ */
+typedef void (*dbg_log_write_t)(const void *streamDatas, const size_t streamLength);
+
 /**
  * @brief Debug log format datas argument (Used to format "%X|%x|%B|%b")
  */
@@ -134,16 +312,628 @@ struct dbg_log_datas_t
     dbg_log_datas_t(const void *datas, const int length) : datas(static_cast<const char *>(datas)), length(length) {}
 };
 
+/**
+ * @brief Debug log structured field (Key and typed value; Written by the current encoder without intermediate string)
+ */
+struct dbg_log_field_t
+{
+    const char * fieldKey;        // Field key (Should be a plain identifier, logfmt writes it as is)
+    int          fieldType;       // Field type (Use DBGLOG_FIELD_* macros)
+    union
+    {
+        int64_t      intValue;    // DBGLOG_FIELD_INT and DBGLOG_FIELD_BOOL value
+        uint64_t     uintValue;   // DBGLOG_FIELD_UINT value
+        double       doubleValue; // DBGLOG_FIELD_DOUBLE value
+        const char * stringValue; // DBGLOG_FIELD_STRING value
+    };
+    size_t       stringLength;    // DBGLOG_FIELD_STRING value length (SIZE_MAX: ends with '\0')
+
+    /**
+     * @brief Construct signed integer field
+     */
+    template <typename TValue, typename std::enable_if<std::is_integral<TValue>::value && std::is_signed<TValue>::value, int>::type = 0>
+    dbg_log_field_t(const char *fieldKey, const TValue fieldValue) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_INT), intValue(fieldValue), stringLength(0) {}
+
+    /**
+     * @brief Construct unsigned integer field
+     */
+    template <typename TValue, typename std::enable_if<std::is_integral<TValue>::value && std::is_unsigned<TValue>::value && !std::is_same<TValue, bool>::value, int>::type = 0>
+    dbg_log_field_t(const char *fieldKey, const TValue fieldValue) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_UINT), uintValue(fieldValue), stringLength(0) {}
+
+    /**
+     * @brief Construct floating point field
+     */
+    template <typename TValue, typename std::enable_if<std::is_floating_point<TValue>::value, int>::type = 0>
+    dbg_log_field_t(const char *fieldKey, const TValue fieldValue) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_DOUBLE), doubleValue((double)fieldValue), stringLength(0) {}
+
+    /**
+     * @brief Construct boolean field
+     */
+    dbg_log_field_t(const char *fieldKey, const bool fieldValue) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_BOOL), intValue(fieldValue ? 1 : 0), stringLength(0) {}
+
+    /**
+     * @brief Construct string field
+     *
+     * @param fieldKey      Field key
+     * @param fieldValue    String value (Must end with '\0'; Nullptr: null)
+     */
+    dbg_log_field_t(const char *fieldKey, const char *fieldValue) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_STRING), stringValue(fieldValue), stringLength(SIZE_MAX) {}
+
+    /**
+     * @brief Construct string field with length
+     *
+     * @param fieldKey      Field key
+     * @param fieldValue    String value (Need not end with '\0')
+     * @param valueLength   String value length
+     */
+    dbg_log_field_t(const char *fieldKey, const char *fieldValue, const size_t valueLength) noexcept : fieldKey(fieldKey), fieldType(DBGLOG_FIELD_STRING), stringValue(fieldValue), stringLength(valueLength) {}
+};
+
+/**
+ * @brief Debug log format specifier (Parsed from "%[flags][width][.precision][length]conversion")
+ */
+struct dbg_log_spec_t
+{
+    uchar flags      = 0;    // Specifier flags (Use DBGLOG_SPEC_FLAG_* macros)
+    char  lengthMod  = '\0'; // Length modifier ('H'="hh", 'h', 'l', 'L'="ll|L|q", 'j', 'z', 't')
+    char  conversion = '\0'; // Conversion character ('\0': no conversion)
+    int   width      = 0;    // Minimum field width
+    int   precision  = -1;   // Precision (-1: not specified)
+};
+
+/**
+ * @brief Debug log format operation (Copy a literal, then format one argument)
+ */
+struct dbg_log_op_t
+{
+    uint           literalOffset = 0; // Literal offset in the format string
+    uint           literalLength = 0; // Literal length
+    dbg_log_spec_t fmtSpec;           // Format specifier (conversion='\0': literal only)
+};
+
+/**
+ * @brief Debug log format program (Precompiled format string of a call site)
+ *
+ * @tparam OpsCount     Operations count
+ */
+template <size_t OpsCount>
+struct dbg_log_program_t
+{
+    dbg_log_op_t fmtOps[OpsCount]; // Format operations
+};
+
+struct dbg_log_site_t;
+
+/**
+ * @brief Debug log call site limit (Static state of a DBGLOG_* call site; Updated with atomics only)
+ */
+struct dbg_log_limit_t
+{
+    int                    limitPolicy;   // Limit policy (Use DBGLOG_LIMIT_* macros)
+    uint                   limitCount;    // Limit count (DBGLOG_LIMIT_RATE: logs per second; DBGLOG_LIMIT_EVERY: sampling interval; DBGLOG_LIMIT_FIRST: logs in total)
+    std::atomic<uint64_t>  limitState;    // Limit state (DBGLOG_LIMIT_RATE: second << 24 | logs in the second; Other: occurrences count)
+    std::atomic<uint64_t>  suppressCount; // Suppressed logs since the last report (DBGLOG_LIMIT_RATE only)
+    std::atomic<bool>      isPending;     // Whether the limit is on the pending list (Its suppressed count is reported by a summary once the second rolls over)
+    const dbg_log_site_t * pendingSite;   // Call site of the limit (Set when it joins the pending list)
+    dbg_log_limit_t *      pendingNext;   // Next limit on the pending list
+
+    constexpr dbg_log_limit_t(const int limitPolicy, const uint limitCount) noexcept
+        : limitPolicy(limitPolicy), limitCount(limitCount), limitState(0), suppressCount(0), isPending(false), pendingSite(nullptr), pendingNext(nullptr)
+    {
+    }
+};
+
+/**
+ * @brief Debug log call site route cache (Static state of a DBGLOG_* call site; Resolved by the first log after the routing table changes)
+ */
+struct dbg_log_route_cache_t
+{
+    std::atomic<uint64_t> routeState; // Route state (Routing table generation << 32 | matched routes mask; 0: not resolved)
+
+    constexpr dbg_log_route_cache_t() noexcept : routeState(0) {}
+};
+
+struct dbg_log_module_t;
+
+/**
+ * @brief Debug log call site (Static descriptor of a DBGLOG_* call site; Its address identifies the call site)
+ */
+struct dbg_log_site_t
+{
+    const char *             filePath;   // File path (Release mode: nullptr)
+    int                      fileLine;   // File line (Release mode: 0)
+    const char *             fileFunc;   // File function (Release mode: nullptr)
+    int                      logType;    // Log type (Use execute status level)
+    const char *             fmtString;  // Format string
+    const dbg_log_op_t *     fmtOps;     // Format operations
+    size_t                   opsCount;   // Format operations count
+    dbg_log_limit_t *        logLimit;   // Log limit (Nullptr: no limit)
+    const dbg_log_module_t * logModule;  // Log module (Nullptr: default module)
+    dbg_log_route_cache_t *  routeCache; // Route cache (Nullptr: resolve the routes on every log)
+};
+
+/**
+ * @brief Debug log module (Holds the runtime log level checked by the DBGLOG_* call sites of the module)
+ */
+struct dbg_log_module_t
+{
+    const char *       moduleName; // Module name (Nullptr: default module)
+    std::atomic<int>   minLevel;   // Minimum enabled log level (Use execute status level; Module level if set, otherwise default level)
+    dbg_log_module_t * nextModule; // Next registered module
+
+    /**
+     * @brief Construct the default module
+     */
+    constexpr dbg_log_module_t() noexcept : moduleName(nullptr), minLevel(ESL_DEBUG), nextModule(nullptr) {}
+
+    /**
+     * @brief Construct and register a named module
+     *
+     * @param moduleName    Module name (Must be a string literal)
+     */
+    explicit dbg_log_module_t(const char *moduleName) noexcept;
+
+    /**
+     * @brief Unregister the module
+     */
+    ~dbg_log_module_t();
+
+    dbg_log_module_t(const dbg_log_module_t &)             = delete;
+    dbg_log_module_t & operator=(const dbg_log_module_t &) = delete;
+};
+
+/**
+ * @brief Debug log binary stream entry head (Every entry starts with it; All fields use native byte order)
+ */
+struct dbg_log_entry_t
+{
+    uint32_t entryLength; // Entry length (With this head)
+    uint16_t entryType;   // Entry type (Use DBGLOG_ENTRY_* macros)
+    uint16_t entryFlags;  // Entry flags (Reserved, 0)
+};
+
+/**
+ * @brief Debug log binary stream head (Body of DBGLOG_ENTRY_STREAM; Starts a stream, the call site dictionary is reset)
+ */
+struct dbg_log_stream_t
+{
+    uint32_t streamMagic;    // Stream magic (DBGLOG_STREAM_MAGIC)
+    uint32_t streamVersion;  // Stream version (DBGLOG_STREAM_VERSION)
+    uint32_t longDoubleSize; // sizeof(long double) of the writer
+    uint32_t wideCharSize;   // sizeof(wchar_t) of the writer
+};
+
+/**
+ * @brief Debug log binary call site entry (Body of DBGLOG_ENTRY_SITE; Followed by filePath, fileFunc and fmtString, each ends with '\0')
+ */
+struct dbg_log_site_entry_t
+{
+    uint64_t siteId;   // Call site ID (Referenced by dbg_log_record_entry_t::siteId)
+    int32_t  fileLine; // File line
+    int32_t  logType;  // Log type
+};
+
+/**
+ * @brief Debug log binary record entry (Body of DBGLOG_ENTRY_RECORD; Followed by the raw format arguments, see DBGLOG_ENTRY_RECORD)
+ */
+struct dbg_log_record_entry_t
+{
+    uint64_t siteId;        // Call site ID (Written by a DBGLOG_ENTRY_SITE entry before the first record of the call site)
+    int64_t  logTime;       // Log time (Nanoseconds since epoch)
+    uint64_t threadId;      // Thread ID
+    uint32_t processId;     // Process ID
+    uint32_t suppressCount; // Suppressed logs of the call site reported by this record (DBGLOG_LIMIT_RATE; Saturates at 0xffffffff)
+};
+
+//================================================================================
+// Define export variable
+//================================================================================
+/**
+ * @brief Debug log default module (Used by the source files that do not define DBGLOG_MODULE)
+ */
+extern dbg_log_module_t DbgDefaultModule;
+
+#if defined(DBGLOG_MODULE)
+/**
+ * @brief Debug log module of current source file
+ */
+static dbg_log_module_t DbgCurrentModule(DBGLOG_MODULE);
+#endif
+
+//================================================================================
+// Define export constexpr method
+//================================================================================
+/**
+ * @brief Parse format specifier
+ *
+ * @param specBegin     Specifier begin (The character after '%')
+ * @param outSpec       Output format specifier
+ * @return const char*  Specifier end (The character after conversion; Nullptr: incomplete or unknown specifier)
+ */
+constexpr const char *DbgParseSpec(const char *specBegin, dbg_log_spec_t &outSpec) noexcept
+{
+    const char *spec_pos = specBegin;
+
+    outSpec = dbg_log_spec_t();
+
+    for (bool is_flag = true; is_flag;)
+    {
+        switch (*spec_pos)
+        {
+            case '-': outSpec.flags |= DBGLOG_SPEC_FLAG_LEFT;  spec_pos++; break;
+            case '+': outSpec.flags |= DBGLOG_SPEC_FLAG_PLUS;  spec_pos++; break;
+            case ' ': outSpec.flags |= DBGLOG_SPEC_FLAG_SPACE; spec_pos++; break;
+            case '#': outSpec.flags |= DBGLOG_SPEC_FLAG_ALT;   spec_pos++; break;
+            case '0': outSpec.flags |= DBGLOG_SPEC_FLAG_ZERO;  spec_pos++; break;
+            default:  is_flag = false;                                     break;
+        }
+    }
+
+    if (*spec_pos == '*')
+    {
+        outSpec.flags |= DBGLOG_SPEC_FLAG_STARWIDTH;
+        spec_pos++;
+    }
+    else
+    {
+        while (*spec_pos >= '0' && *spec_pos <= '9') outSpec.width = outSpec.width * 10 + (*spec_pos++ - '0');
+    }
+
+    if (*spec_pos == '.')
+    {
+        spec_pos++;
+        outSpec.precision = 0;
+        if (*spec_pos == '*')
+        {
+            outSpec.flags |= DBGLOG_SPEC_FLAG_STARPRECISION;
+            spec_pos++;
+        }
+        else
+        {
+            while (*spec_pos >= '0' && *spec_pos <= '9') outSpec.precision = outSpec.precision * 10 + (*spec_pos++ - '0');
+        }
+    }
+
+    switch (*spec_pos)
+    {
+        case 'h':
+        case 'l':
+            outSpec.lengthMod = *spec_pos++;
+            if (*spec_pos == outSpec.lengthMod)
+            {
+                outSpec.lengthMod = (char)(outSpec.lengthMod - 0x20); // "hh" -> 'H', "ll" -> 'L'
+                spec_pos++;
+            }
+            break;
+        case 'L':
+        case 'q':
+            outSpec.lengthMod = 'L';
+            spec_pos++;
+            break;
+        case 'j':
+        case 'z':
+        case 't':
+            outSpec.lengthMod = *spec_pos++;
+            break;
+    }
+
+    switch (*spec_pos)
+    {
+        case 'd': case 'i': case 'u': case 'o': case 'c': case 's': case 'p': case 'n':
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        case 'X': case 'x': case 'B': case 'b': case '%':
+            outSpec.conversion = *spec_pos;
+            return spec_pos + 1;
+        default:
+            return nullptr;
+    }
+}
+
+/**
+ * @brief Get the argument class required by a format specifier
+ *
+ * @param fmtSpec       Format specifier
+ * @return uint         Argument class (Use DBGLOG_ARG_* macros; 0: no argument)
+ */
+constexpr uint DbgFormatSpecClass(const dbg_log_spec_t &fmtSpec) noexcept
+{
+    switch (fmtSpec.conversion)
+    {
+        case '%':
+            return 0;
+        case 'd': case 'i': case 'u': case 'o':
+            switch (fmtSpec.lengthMod)
+            {
+                case 'l':           return (sizeof(long) == 8 ? DBGLOG_ARG_INT64 : DBGLOG_ARG_INT);
+                case 'L': case 'j': return DBGLOG_ARG_INT64;
+                case 'z': case 't': return (sizeof(size_t) == 8 ? DBGLOG_ARG_INT64 : DBGLOG_ARG_INT);
+                default:            return DBGLOG_ARG_INT;
+            }
+        case 'c':
+            return DBGLOG_ARG_INT;
+        case 's':
+            return (fmtSpec.lengthMod == 'l' ? DBGLOG_ARG_WSTRING : DBGLOG_ARG_STRING);
+        case 'p': case 'n':
+            return DBGLOG_ARG_POINTER;
+        case 'X': case 'x': case 'B': case 'b':
+            return DBGLOG_ARG_DATAS;
+        default:
+            return (fmtSpec.lengthMod == 'L' ? DBGLOG_ARG_LDOUBLE : DBGLOG_ARG_DOUBLE);
+    }
+}
+
+/**
+ * @brief Get the argument classes accepted by an argument type
+ *
+ * @tparam TArg         Argument type (Decayed)
+ * @return uint         Argument classes (Use DBGLOG_ARG_* macros)
+ */
+template <typename TArg>
+constexpr uint DbgFormatArgClass() noexcept
+{
+    return (std::is_same<TArg, dbg_log_datas_t *>::value || std::is_same<TArg, const dbg_log_datas_t *>::value) ? (DBGLOG_ARG_DATAS | DBGLOG_ARG_POINTER)
+         : (std::is_same<TArg, char *>::value || std::is_same<TArg, const char *>::value)                       ? (DBGLOG_ARG_STRING | DBGLOG_ARG_POINTER)
+         : (std::is_same<TArg, wchar_t *>::value || std::is_same<TArg, const wchar_t *>::value)                 ? (DBGLOG_ARG_WSTRING | DBGLOG_ARG_POINTER)
+         : (std::is_pointer<TArg>::value || std::is_null_pointer<TArg>::value)                                  ? DBGLOG_ARG_POINTER
+         : (std::is_same<TArg, long double>::value)                                                             ? DBGLOG_ARG_LDOUBLE
+         : (std::is_floating_point<TArg>::value)                                                                ? DBGLOG_ARG_DOUBLE
+         : (std::is_integral<TArg>::value || std::is_enum<TArg>::value)                                         ? (sizeof(TArg) <= sizeof(int) ? DBGLOG_ARG_INT : (sizeof(TArg) == 8 ? DBGLOG_ARG_INT64 : 0))
+                                                                                                                : 0;
+}
+
+/**
+ * @brief Debug log format argument types (Used to check format arguments at compile time)
+ *
+ * @tparam TArgs        Argument types (Decayed)
+ */
+template <typename... TArgs>
+struct dbg_log_types_t
+{
+    /**
+     * @brief Get the argument classes accepted by an argument
+     *
+     * @param argIndex      Argument index
+     * @return uint         Argument classes (Out of range: 0)
+     */
+    static constexpr uint argClass(const size_t argIndex) noexcept
+    {
+        const uint arg_classes[] = {DbgFormatArgClass<TArgs>()..., 0};
+        return (argIndex < sizeof...(TArgs) ? arg_classes[argIndex] : 0);
+    }
+
+    /**
+     * @brief Check the format string against the argument types
+     *
+     * @param fmtString     Format string
+     * @return int          Check result (Use DBGLOG_FMT_* macros)
+     */
+    static constexpr int check(const char *fmtString) noexcept
+    {
+        size_t arg_index = 0;
+
+        for (const char *fmt_pos = fmtString; *fmt_pos;)
+        {
+            dbg_log_spec_t fmt_spec;
+
+            if (*fmt_pos != '%')
+            {
+                fmt_pos++;
+                continue;
+            }
+            if (fmt_pos[1] == '%')
+            {
+                fmt_pos += 2;
+                continue;
+            }
+
+            fmt_pos = DbgParseSpec(fmt_pos + 1, fmt_spec);
+            if (!fmt_pos) return DBGLOG_FMT_E_SPECIFIER;
+
+            if ((fmt_spec.flags & DBGLOG_SPEC_FLAG_STARWIDTH))
+            {
+                if (arg_index >= sizeof...(TArgs)) return DBGLOG_FMT_E_COUNT;
+                if (!(argClass(arg_index++) & DBGLOG_ARG_INT)) return DBGLOG_FMT_E_TYPE;
+            }
+            if ((fmt_spec.flags & DBGLOG_SPEC_FLAG_STARPRECISION))
+            {
+                if (arg_index >= sizeof...(TArgs)) return DBGLOG_FMT_E_COUNT;
+                if (!(argClass(arg_index++) & DBGLOG_ARG_INT)) return DBGLOG_FMT_E_TYPE;
+            }
+            if (fmt_spec.conversion == '%') continue;
+            if (arg_index >= sizeof...(TArgs)) return DBGLOG_FMT_E_COUNT;
+            if (!(argClass(arg_index++) & DbgFormatSpecClass(fmt_spec))) return DBGLOG_FMT_E_TYPE;
+        }
+
+        return (arg_index == sizeof...(TArgs) ? DBGLOG_FMT_OK : DBGLOG_FMT_E_COUNT);
+    }
+};
+
+/**
+ * @brief Get format argument types (Only used in unevaluated context)
+ *
+ * @tparam TArgs                    Argument types
+ * @return dbg_log_types_t<TArgs...> Format argument types
+ */
+template <typename... TArgs>
+dbg_log_types_t<TArgs...> DbgFormatTypes(TArgs...) noexcept;
+
+/**
+ * @brief Get format operations count
+ *
+ * @param fmtString     Format string
+ * @return size_t       Operations count
+ */
+constexpr size_t DbgFormatOpsCount(const char *fmtString) noexcept
+{
+    size_t ops_count = 1;
+
+    for (const char *fmt_pos = fmtString; *fmt_pos; fmt_pos++)
+    {
+        if (*fmt_pos != '%') continue;
+        if (fmt_pos[1] == '%') fmt_pos++;
+        ops_count++;
+    }
+
+    return ops_count;
+}
+
+/**
+ * @brief Compile format string into format operations (Also used at runtime to compile a format string read from a binary stream)
+ *
+ * @param fmtString     Format string
+ * @param outOps        Output format operations (At least DbgFormatOpsCount(fmtString) operations)
+ * @return true         Success
+ * @return false        Failure (Incomplete or unknown specifier)
+ */
+constexpr bool DbgFormatCompileOps(const char *fmtString, dbg_log_op_t *outOps) noexcept
+{
+    size_t       ops_index   = 0;
+    const char * literal_pos = fmtString;
+    const char * fmt_pos     = fmtString;
+
+    while (*fmt_pos)
+    {
+        dbg_log_spec_t fmt_spec;
+        const char *   spec_end = nullptr;
+
+        if (*fmt_pos != '%')
+        {
+            fmt_pos++;
+            continue;
+        }
+
+        if (fmt_pos[1] == '%')
+        {
+            outOps[ops_index].literalOffset = (uint)(literal_pos - fmtString);
+            outOps[ops_index].literalLength = (uint)(fmt_pos + 1 - literal_pos);
+            outOps[ops_index].fmtSpec       = dbg_log_spec_t();
+            ops_index++;
+            fmt_pos     += 2;
+            literal_pos  = fmt_pos;
+            continue;
+        }
+
+        spec_end = DbgParseSpec(fmt_pos + 1, fmt_spec);
+        if (!spec_end) return false;
+
+        outOps[ops_index].literalOffset = (uint)(literal_pos - fmtString);
+        outOps[ops_index].literalLength = (uint)(fmt_pos - literal_pos);
+        outOps[ops_index].fmtSpec       = fmt_spec;
+        ops_index++;
+        fmt_pos     = spec_end;
+        literal_pos = fmt_pos;
+    }
+
+    outOps[ops_index].literalOffset = (uint)(literal_pos - fmtString);
+    outOps[ops_index].literalLength = (uint)(fmt_pos - literal_pos);
+    outOps[ops_index].fmtSpec       = dbg_log_spec_t();
+
+    return true;
+}
+
+/**
+ * @brief Compile format string into format program
+ *
+ * @tparam OpsCount                     Operations count (Use DbgFormatOpsCount())
+ * @param fmtString                     Format string (Must be checked by dbg_log_types_t::check())
+ * @return dbg_log_program_t<OpsCount>  Format program
+ */
+template <size_t OpsCount>
+constexpr dbg_log_program_t<OpsCount> DbgFormatCompile(const char *fmtString) noexcept
+{
+    dbg_log_program_t<OpsCount> fmt_program = {};
+
+    DbgFormatCompileOps(fmtString, fmt_program.fmtOps);
+
+    return fmt_program;
+}
+
 //================================================================================
 // Define export method
 //================================================================================
 /**
- * @brief Set debug error infomation handling function (Thread safe)
+ * @brief Set debug error infomation handling function (Thread safe; Replaces the batch handling function)
  *
- * @param errHandle     Debug error infomation handling function
+ * @param errHandle     Debug error infomation handling function (Nullptr: output to stderr)
  */
 void DbgSetHandle(const dbg_log_handle_t errHandle) noexcept;
 
+/**
+ * @brief Set debug log batch handling function (Thread safe; Replaces the handling function)
+ *
+ * @param batchHandle   Debug log batch handling function (Nullptr: output to stderr)
+ */
+void DbgSetBatchHandle(const dbg_log_batch_t batchHandle) noexcept;
+
+/**
+ * @brief Add debug log route (Thread safe; Logs matched by any route go to the sinks of the matched routes instead of the handling function)
+ *
+ * @param levelMask     Log levels of the route (Bitwise OR of execute status levels)
+ * @param moduleName    Module name (Same as DBGLOG_MODULE; Nullptr: every module without own routes for the level)
+ * @param logSink       Routing sink function
+ * @param sinkContext   Sink context (Must stay valid until DbgRemoveRoute() returns)
+ * @return int          Route ID (-1: the routing table is full or the sink is nullptr)
+ */
+int DbgAddRoute(const int levelMask, const char *moduleName, const dbg_log_sink_t logSink, void *sinkContext) noexcept;
+
+/**
+ * @brief Remove debug log route (Thread safe; Blocks until the sinks of the route running in other threads return, a sink may remove its own route)
+ *
+ * @param routeId       Route ID (Returned by DbgAddRoute())
+ */
+void DbgRemoveRoute(const int routeId) noexcept;
+
+/**
+ * @brief Get debug log buffer allocate count (Thread safe)
+ *
+ * @return size_t       Heap allocations made by the log buffers since the process started (Stays unchanged in steady state)
+ */
+size_t DbgGetAllocCount() noexcept;
+
+/**
+ * @brief Set debug log async mode (Call it before and after the logging threads run; FATAL, ASSERT and VERIFY logs are always output synchronously; Text logs are still formatted by the callers, synchronous mode costs them less if the output is cheaper than the hand-off, about 100 ns, or if the consumer thread shares one core with them)
+ *
+ * @param queueCapacity     Queue capacity (0: synchronous mode; Other: rounded up to a power of two)
+ * @param overflowPolicy    Overflow policy when the queue is full (Use DBGLOG_ASYNC_* macros)
+ * @return true             Success
+ * @return false            Failure (Out of memory or unable to create the consumer thread; Stays in synchronous mode)
+ */
+bool DbgSetAsyncMode(const size_t queueCapacity, const int overflowPolicy) noexcept;
+
+/**
+ * @brief Wait until every log queued before the call is output (Thread safe; Returns immediately in synchronous mode)
+ */
+void DbgFlush() noexcept;
+
+/**
+ * @brief Get debug log drop count (Thread safe)
+ *
+ * @return size_t       Logs dropped by the DBGLOG_ASYNC_DROP and DBGLOG_ASYNC_OVERWRITE policies since the process started
+ */
+size_t DbgGetDropCount() noexcept;
+
+/**
+ * @brief Set debug log default level (Thread safe; Applies to the default module and the modules without module level)
+ *
+ * @param minLevel      Minimum enabled log level (Use execute status level; FATAL logs are always enabled)
+ */
+void DbgSetLogLevel(const int minLevel) noexcept;
+
+/**
+ * @brief Set debug log module level (Thread safe; Applies to the modules registered before and after the call)
+ *
+ * @param moduleName    Module name (Same as DBGLOG_MODULE)
+ * @param minLevel      Minimum enabled log level (Use execute status level; 0: use the default level)
+ */
+void DbgSetModuleLevel(const char *moduleName, const int minLevel) noexcept;
+
+/**
+ * @brief Set debug log encoder (Thread safe; Applies to every log formatted after the call, including the records formatted by DbgDecodeStream())
+ *
+ * @param logEncoder    Log encoder (Use DBGLOG_ENCODER_* macros)
+ */
+void DbgSetEncoder(const int logEncoder) noexcept;
+
 /**
  * @brief Output debug log (Thread safe; Direct use is not recommended)
  *
@@ -156,3 +946,62 @@ void DbgSetHandle(const dbg_log_handle_t errHandle) noexcept;
  * @param ...           Format arguments ("%X|%x|%B|%b" must be use a parameter in the format of std::make_unique<dbg_log_datas_t>("xxx", 3).get())
  */
 void DbgOutputLog(const char *filePath, const int fileLine, const char *fileFunc, const int logType, const char *fmtString, const int fmtArgsCount, ...) noexcept;
+
+/**
+ * @brief Output structured debug log (Thread safe; Use DBGLOG_FIELDS() instead of direct use; Formatted immediately, also in deferred mode)
+ *
+ * @param filePath      File path (Debug mode: DBG_OUTPUTLOG_FILE; Release mode: nullptr)
+ * @param fileLine      File line (Debug mode: DBG_OUTPUTLOG_LINE; Release mode: 0)
+ * @param fileFunc      File function (Debug mode: DBG_OUTPUTLOG_FUNC; Release mode: nullptr)
+ * @param logType       Log type (Use execute status level)
+ * @param logMessage    Log message (Written as is, not a format string; Nullptr: empty message)
+ * @param logFields     Structured fields (Written after the message in order)
+ * @param fieldsCount   Structured fields count
+ * @param logModule     Log module (Used to route the log; Nullptr: default module)
+ */
+void DbgOutputFields(const char *filePath, const int fileLine, const char *fileFunc, const int logType, const char *logMessage, const dbg_log_field_t *logFields, const size_t fieldsCount, const dbg_log_module_t *logModule) noexcept;
+
+/**
+ * @brief Check debug log limit of call site (Thread safe; Use DBGLOG_LIMITED() instead of direct use)
+ *
+ * @param logSite       Log call site (Its log limit must not be nullptr)
+ * @return true         Output the log (DbgOutputFormat() of the same thread reports the suppressed count)
+ * @return false        Suppress the log
+ */
+bool DbgCheckLimit(const dbg_log_site_t *logSite) noexcept;
+
+/**
+ * @brief Output debug log with precompiled format program (Thread safe; Use DBGLOG_OUTPUT_FORMAT() instead of direct use)
+ *
+ * @param logSite       Log call site (Static descriptor defined by DBGLOG_OUTPUT_FORMAT())
+ * @param ...           Format arguments (Checked at compile time by dbg_log_types_t::check())
+ */
+void DbgOutputFormat(const dbg_log_site_t *logSite, ...) noexcept;
+
+/**
+ * @brief Set debug log deferred mode (DBGLOG_* calls only copy their arguments into a binary record; Takes effect while async mode runs; Records go through a ring of the calling thread without shared read-modify-write, a call costs the caller about 90 ns of which about 40 ns is the clock)
+ *
+ * @param isDeferred    Whether to defer formatting (FATAL logs and logs of the consumer thread are always formatted immediately)
+ * @param streamWrite   Binary stream writing function (Nullptr: the consumer thread formats the records and outputs them as usual; Other: receives the binary stream, decode it with DbgDecodeStream())
+ */
+void DbgSetDeferredMode(const bool isDeferred, const dbg_log_write_t streamWrite) noexcept;
+
+/**
+ * @brief Decode debug log binary stream (Formats every record the same as the deferred consumer thread)
+ *
+ * @param streamDatas   Stream datas (One or more streams written in deferred mode)
+ * @param streamLength  Stream datas length
+ * @param decodeHandle  Receives every decoded log (Same as the handling function)
+ * @return size_t       Decoded records count (Stops at the first truncated or invalid entry)
+ */
+size_t DbgDecodeStream(const void *streamDatas, const size_t streamLength, const dbg_log_handle_t decodeHandle) noexcept;
+
+/**
+ * @brief Format string by the debug log formatter (Thread safe; Same specifiers as DbgOutputLog(); Used by the logging modules)
+ *
+ * @param fmtLength     Output formatted string length
+ * @param fmtString     Format string (Must end with '\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
+ * @param fmtArgs       Format arguments ("%X|%x|%B|%b" must be use a dbg_log_datas_t * argument)
+ * @return const char*  Formatted string (Buffer of current thread, valid until the next call on the same thread; Nullptr: out of memory, or called by a thread destructor after the buffer is gone)
+ */
+const char *DbgFormatString(size_t &fmtLength, const char *fmtString, va_list fmtArgs) noexcept;
\ No newline at end of file
@@ -7,4 +7,3205 @@
  * @copyright Copyright (c) 2020-2022 ZyTech Team
  * @par Changelog:
  * Date                 Version     Author          Description
- */
\ No newline at end of file
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include "../Base/BaseDefine.h"
+#include "../Common/DbgHelper.h"
+#include "../Common/FileHelper.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(_LINUX)
+    #include <dirent.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <spawn.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #include <sys/wait.h>
+#endif
+#if defined(_LINUX) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #include <linux/io_uring.h>
+        #include <sys/syscall.h>
+        #define LOGGING_URING_ENABLE 1 // io_uring writer is built (Used if the kernel supports it)
+    #endif
+#endif
+#include "LoggingFile.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define LOGGING_BUFFER_LENGTH  (1024 * 1024) // Output buffer length (A full buffer is handed to the writer thread)
+#define LOGGING_BUFFER_COUNT   4             // Output buffers count (One is filled by the outputs, others wait for or are written by the writer thread)
+#define LOGGING_FLUSH_INTERVAL 1000          // Flush interval (Milliseconds; The writer thread takes a partly filled buffer when it is idle so long)
+#define LOGGING_FLUSH_LEVEL    ESL_ERROR     // Lines at or above the level hand the buffer to the writer thread immediately
+#define LOGGING_HEAD_LENGTH    48            // Line head max length ("yyyy-MM-dd hh:mm:ss.zzz [WARNING] ")
+#define LOGGING_PATH_LENGTH    4096          // File path max length
+#define LOGGING_COMPRESS_COUNT 4             // Max running compressions of an instance
+#define LOGGING_COMPRESS_DELAY 10000         // Rotated files are compressed when unmodified so long (Milliseconds; Other processes may still append their last buffer)
+#define LOGGING_MAPPED_CHUNK   0x1000000     // Mapped chunk length (WM_MAPPED; The file grows by a preallocated chunk when the mapped one is full)
+#define LOGGING_MAPPED_RING    4             // Mapped chunks kept by a process (WM_MAPPED; Ring by chunk generation)
+#define LOGGING_LOST_COUNT     16            // Lost ticket ranges kept by an instance (The two oldest are merged when full, lines between them are reported lost too)
+#define LOGGING_MAPPED_SHIFT   48            // Chunk generation shift in the reservation cursor (WM_MAPPED; Low bits are the reserved length)
+#define LOGGING_MAPPED_MASK   ((1ULL << LOGGING_MAPPED_SHIFT) - 1) // Reserved length mask of the reservation cursor (WM_MAPPED)
+#define LOGGING_MAPPED_CLOSED (1ULL << (LOGGING_MAPPED_SHIFT - 1)) // Added to the reserved length when the chunk is switched (Later reservations are over the chunk end)
+#define LOGGING_FRAME_MAGIC    0x184D2204    // LZ4 frame magic number (CF_LZ4)
+#define LOGGING_FRAME_BLOCK    0x100000      // LZ4 frame block max length (CF_LZ4; Block max size ID 6 in the frame descriptor, a buffer is one block)
+#define LOGGING_FRAME_HASH     12            // LZ4 match finder hash bits (CF_LZ4; 4096 positions, small enough to stay in the L1 cache)
+#define LOGGING_FRAME_SKIP     6             // LZ4 match finder skip shift (CF_LZ4; The step grows every 64 missed positions, text without matches is passed quickly)
+#if defined(_LINUX)
+    #define LOGGING_INVALID_HANDLE -1                   // Invalid file handle
+#elif defined(_WINDOWS)
+    #define LOGGING_INVALID_HANDLE INVALID_HANDLE_VALUE // Invalid file handle
+#endif
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Logging buffer
+ */
+struct LoggingBuffer
+{
+    char * bufferDatas   = nullptr; // Buffer datas (Allocated when the buffer is filled first)
+    size_t bufferLength  = 0;       // Buffered length
+    char   bufferDate[9] = "";      // Local date of the buffered lines (Format: "yyyyMMdd"; Selects the file in NR_DATE rule)
+    size_t firstTicket   = 0;       // Ticket of the first buffered line
+    size_t lineTicket    = 0;       // Ticket of the last buffered line (Written lines are synced up to it)
+    char * frameDatas    = nullptr; // Compressed frame (CF_LZ4; Allocated by the writer when the buffer is written first)
+    size_t frameLength   = 0;       // Compressed frame length (0: the buffered lines are written as they are)
+};
+
+/**
+ * @brief Lost ticket range (Lines whose write or sync failed)
+ */
+struct LoggingLostRange
+{
+    size_t firstTicket; // Ticket of the first lost line
+    size_t lastTicket;  // Ticket of the last lost line
+};
+
+/**
+ * @brief Logging time cache (Broken-down time is recomputed only when the second changes)
+ */
+struct LoggingTimeCache
+{
+    time_t cacheSecond    = -1;                        // Cached second since epoch (-1: not cached)
+    char   timeString[24] = "1900-01-01 00:00:00.000"; // Cached time (Format: "yyyy-MM-dd hh:mm:ss.zzz"; Milliseconds are patched per line)
+    char   dateString[9]  = "19000101";                // Cached date (Format: "yyyyMMdd")
+};
+
+/**
+ * @brief Rotated file (Used by the rotated files maintenance)
+ */
+struct LoggingRotated
+{
+    char      fileName[256]; // File name
+    long long modifyTime;    // Last modification time (Nanoseconds since epoch)
+    size_t    fileSize;      // File size
+};
+
+#if defined(_LINUX)
+/**
+ * @brief Mapped chunk view (WM_MAPPED; Mapping of one chunk in a process)
+ */
+struct LoggingMappedView
+{
+    uint32_t            chunkGen   = 0;       // Chunk generation
+    char *              mapDatas   = nullptr; // Mapped region (Starts at a page boundary before the chunk)
+    size_t              mapLength  = 0;       // Mapped region length
+    char *              chunkDatas = nullptr; // Chunk datas in the mapped region
+    LoggingMappedView * nextView   = nullptr; // Next retired view
+};
+
+/**
+ * @brief Mapped state (WM_MAPPED; Anonymous shared memory, processes forked later reserve in the same chunks)
+ */
+struct LoggingMappedState
+{
+    std::atomic<uint64_t> reserveCursor;                      // Reservation cursor (High bits: chunk generation; Low bits: reserved length of the chunk)
+    std::atomic<uint64_t> fileDate;                           // Date of the current file ("yyyyMMdd" bytes; NR_DATE only)
+    std::atomic<int>      attachCount;                        // Processes using the state (The last one cuts the unused part of the chunk)
+    uint32_t              chunkGens[LOGGING_MAPPED_RING];     // Chunk generations (Published by the reservation cursor)
+    uint32_t              chunkSerials[LOGGING_MAPPED_RING];  // File serials of the chunks
+    uint64_t              chunkOffsets[LOGGING_MAPPED_RING];  // File offsets of the chunks
+    uint64_t              chunkLengths[LOGGING_MAPPED_RING];  // Chunk lengths
+    uint64_t              closedLength;                       // Reserved length of the current chunk when it was closed (Switch mutex)
+    uint32_t              fileSerial;                         // Serial of the current file (Increased when the file is switched; Switch mutex)
+    char                  filePath[LOGGING_PATH_LENGTH];      // Path of the current file (Switch mutex)
+    pthread_mutex_t       switchMutex;                        // Switch mutex (Process shared; Serializes the chunk switches)
+};
+
+/**
+ * @brief Mapped file (WM_MAPPED; Chunks mapped by a process)
+ */
+struct LoggingMappedFile
+{
+    LoggingMappedState *             mappedState  = nullptr;                // Mapped state
+    std::atomic<LoggingMappedView *> chunkViews[LOGGING_MAPPED_RING];       // Chunk views (Ring by chunk generation)
+    LoggingMappedView *              retiredViews = nullptr;                // Replaced views, unmapped when no other output copies (Map mutex)
+    std::atomic<int>                 copyCount;                             // Outputs copying into the chunks
+    std::atomic<size_t>              lineCount;                             // Copied lines count
+    std::mutex                       mapMutex;                              // Map mutex (Maps the chunks)
+    int                              mapHandle    = LOGGING_INVALID_HANDLE; // File descriptor of the chunk views (Map mutex)
+    uint32_t                         mapSerial    = 0;                      // File serial of the map handle (Map mutex)
+    uint32_t                         fileSerial   = 0;                      // File serial of the file handle (Switch mutex)
+};
+#endif
+
+#if defined(LOGGING_URING_ENABLE)
+/**
+ * @brief Writer io_uring (WM_URING; Rings are shared with the kernel, only the writer thread uses them)
+ */
+struct LoggingUring
+{
+    int                   ringHandle    = -1;      // Ring file descriptor
+    void *                ringDatas     = nullptr; // Submission and completion rings (One mapping)
+    size_t                ringLength    = 0;       // Rings mapping length
+    struct io_uring_sqe * sqEntries     = nullptr; // Submission entries
+    size_t                sqLength      = 0;       // Submission entries mapping length
+    unsigned *            sqTail        = nullptr; // Submission ring tail (Written by the writer thread)
+    unsigned *            sqMask        = nullptr; // Submission ring mask
+    unsigned *            sqArray       = nullptr; // Submission ring indexes
+    unsigned *            cqHead        = nullptr; // Completion ring head (Written by the writer thread)
+    unsigned *            cqTail        = nullptr; // Completion ring tail (Written by the kernel)
+    unsigned *            cqMask        = nullptr; // Completion ring mask
+    struct io_uring_cqe * cqEntries     = nullptr; // Completion entries
+    unsigned              preparedCount = 0;       // Writes prepared but not submitted (Writer thread)
+    unsigned              inflightCount = 0;       // Writes submitted but not completed (Writer thread)
+};
+#endif
+
+/**
+ * @brief Logging file private (Outputs fill the active buffer under the safe mutex and hand it to the writer thread, only the writer thread waits for the disk)
+ */
+class ZYLoggingFilePrivate final
+{
+public:
+    ZYLoggingFile *             fileOwner;                                  // Logging file instance
+#if defined(_LINUX)
+    int                         fileHandle     = LOGGING_INVALID_HANDLE;    // File descriptor (Not opened: LOGGING_INVALID_HANDLE; Used by the writer thread)
+#elif defined(_WINDOWS)
+    HANDLE                      fileHandle     = LOGGING_INVALID_HANDLE;    // File handle (Not opened: LOGGING_INVALID_HANDLE; Used by the writer thread)
+#endif
+    char                        fileDate[9]    = "";                        // Date of the opened file (Format: "yyyyMMdd"; NR_DATE only)
+    char                        filePath[LOGGING_PATH_LENGTH] = "";         // Path of the opened file (Writer thread)
+    size_t                      fileSize       = 0;                         // Size of the opened file (Writer thread)
+#if defined(_LINUX)
+    ino_t                       fileInode      = 0;                         // Inode of the opened file (Detects the rotation of other processes; Writer thread)
+    int                         lockHandle     = LOGGING_INVALID_HANDLE;    // Lock file descriptor (Record locks: byte 0 rotates the file, byte 1 maintains the rotated files; Writer thread)
+    bool                        maintainLocked = false;                     // Whether the maintenance lock is held (Writer thread)
+    bool                        dirSynced      = true;                      // Whether the directory entry of the opened file is synced (Writer thread)
+    pid_t                       compressPids[LOGGING_COMPRESS_COUNT];       // Running compression processes (Writer thread)
+    int                         compressCount  = 0;                         // Running compressions count (Writer thread)
+    LoggingMappedFile *         mappedFile     = nullptr;                   // Mapped file (WM_MAPPED only; Nullptr: lines are buffered; Set before the first output)
+#endif
+#if defined(LOGGING_URING_ENABLE)
+    LoggingUring *              writerUring    = nullptr;                   // Writer io_uring (WM_URING only; Nullptr: blocking writes; Set under the safe and wait mutexes)
+#endif
+    bool                        uringWanted    = false;                     // Whether the io_uring writer is wanted (Opened again in the child process after fork; Safe mutex)
+    int                         compressFormat = 0;                         // File compression format (ZYLoggingFile::COMPRESS_FORMAT; Set before the first output)
+    long long                   maintainTime   = 0;                         // Next maintenance time of the rotated files (Milliseconds since epoch; 0: none; Writer thread)
+    bool                        fileSync       = false;                     // Whether the file is synced before it is closed (Copied from the durability level; Writer thread)
+    bool                        syncLost       = false;                     // Whether the sync before closing a file failed (Reported by the next sync; Writer thread)
+    LoggingBuffer               logBuffers[LOGGING_BUFFER_COUNT];           // Output buffers
+    int                         activeIndex    = 0;                         // Index of the buffer filled by the outputs (Safe mutex)
+    size_t                      lineCount      = 0;                         // Output lines count (Safe mutex)
+    LoggingTimeCache            timeCache;                                  // Time cache (Safe mutex)
+    std::mutex                  fileMutex;                                  // File mutex (Held by the writer thread to reap, sync or maintain without a waiting buffer, and by the outputs writing an oversized line)
+    std::mutex                  waitMutex;                                  // Wait mutex (Protects the members below)
+    std::condition_variable     wakeCond;                                   // Wakes the writer thread
+    std::condition_variable     idleCond;                                   // Wakes flushing and stalled outputs
+    int                         pendingIndexes[LOGGING_BUFFER_COUNT];       // Indexes of the buffers waiting for the writer thread (Ring)
+    int                         pendingHead    = 0;                         // Ring head of the waiting buffers
+    int                         pendingCount   = 0;                         // Waiting buffers count
+    int                         freeIndexes[LOGGING_BUFFER_COUNT];          // Indexes of the free buffers
+    int                         freeCount      = 0;                         // Free buffers count
+    size_t                      submitCount    = 0;                         // Buffers handed to the writer thread
+    size_t                      writtenCount   = 0;                         // Buffers written by the writer thread
+    size_t                      writtenTicket  = 0;                         // Ticket of the last written line (Line tickets are the output lines count)
+    size_t                      syncedTicket   = 0;                         // Ticket of the last line covered by a sync
+    size_t                      syncTicket     = 0;                         // Ticket waited by the callers (DL_GROUP; Synced if over the synced ticket)
+    LoggingLostRange            lostRanges[LOGGING_LOST_COUNT];             // Lost ticket ranges (Ordered by the loss)
+    int                         lostCount      = 0;                         // Lost ticket ranges count
+    int                         syncLevel      = 0;                         // Durability level (ZYLoggingFile::DURABILITY_LEVEL)
+    int                         syncInterval   = 0;                         // Sync interval (DL_PERIODIC; Milliseconds)
+    long long                   syncDue        = 0;                         // Next periodic sync time (DL_PERIODIC; Milliseconds since epoch)
+    bool                        writerStop     = false;                     // Whether to stop the writer thread
+    bool                        writerStart    = false;                     // Whether the next output starts the writer thread (Set in the child process after fork; Safe mutex)
+    std::thread *               writerThread   = nullptr;                   // Writer thread (Nullptr: buffers are written by the output that hands them)
+    ZYLoggingFile::WriterStats  writerStats;                                // Writer statistics (Line count is kept by the safe mutex)
+    ZYLoggingFile::RotatePolicy rotatePolicy;                               // Rotation policy
+    bool                        maintainNeeded = false;                     // Whether the rotated files need maintenance (Rotation policy changed or a mapped chunk rotated the file; Done by the writer thread)
+    ZYLoggingFilePrivate *      prevPrivate    = nullptr;                   // Previous instance in the instances list
+    ZYLoggingFilePrivate *      nextPrivate    = nullptr;                   // Next instance in the instances list
+
+public:
+    /**
+     * @brief Construct function (Starts the writer thread)
+     *
+     * @param fileOwner     Logging file instance
+     */
+    explicit ZYLoggingFilePrivate(ZYLoggingFile * fileOwner) noexcept;
+
+    /**
+     * @brief Destruct function (Writes the buffered lines, stops the writer thread and closes the file)
+     */
+    ~ZYLoggingFilePrivate();
+
+    /**
+     * @brief Start the writer thread (Buffers are written by the outputs if it fails)
+     */
+    void startWriter() noexcept;
+
+    /**
+     * @brief Reset the instance in the child process after fork (The writer thread does not exist in the child, lines buffered by the parent are left to it)
+     */
+    void resetAfterFork() noexcept;
+
+    /**
+     * @brief Append one line (Locks the safe mutex)
+     *
+     * @param logLevel      Log level (Use execute status level macros)
+     * @param lineDatas     Line content (Without line break)
+     * @param lineLength    Line content length
+     * @param hasHead       Whether to write the line head (Lines formatted by the debug log have their own head)
+     * @return size_t       Line ticket (0: the line is not buffered)
+     */
+    size_t appendLine(const int logLevel, const char * lineDatas, const size_t lineLength, const bool hasHead) noexcept;
+
+#if defined(_LINUX)
+    /**
+     * @brief Switch to the mapped mode (Safe mutex must be locked; The first chunk is mapped at the valid end of the file)
+     *
+     * @return true         Success
+     * @return false        Failure (Lines were output)
+     */
+    bool openMapped() noexcept;
+
+    /**
+     * @brief Close the mapped mode (The last process cuts the unused part of the chunk)
+     */
+    void closeMapped() noexcept;
+
+    /**
+     * @brief Append one line to a mapped chunk (Lock free, the bytes are reserved by the reservation cursor)
+     *
+     * @param logLevel      Log level (Use execute status level macros)
+     * @param lineDatas     Line content (Without line break)
+     * @param lineLength    Line content length
+     * @param hasHead       Whether to write the line head
+     */
+    void appendMapped(const int logLevel, const char * lineDatas, const size_t lineLength, const bool hasHead) noexcept;
+
+    /**
+     * @brief Get the mapped chunk of the generation (Maps it in this process if not mapped yet)
+     *
+     * @param chunkGen      Chunk generation
+     * @return char*        Chunk datas (Nullptr: failure)
+     */
+    char * mapChunk(const uint32_t chunkGen) noexcept;
+
+    /**
+     * @brief Switch from the full chunk to the next one (Rotates the file if it is over the size, or if the date changed in NR_DATE rule)
+     *
+     * @param chunkGen      Generation of the full chunk
+     * @param minLength     Min length of the next chunk
+     * @param fileDate      Date of the line (Format: "yyyyMMdd")
+     * @return true         Switched (By this or another output)
+     * @return false        Failure
+     */
+    bool switchChunk(const uint32_t chunkGen, const size_t minLength, const char * fileDate) noexcept;
+
+    /**
+     * @brief Preallocate the next chunk and publish it to the outputs (Switch mutex must be locked, or the state is not shared yet)
+     *
+     * @param chunkGen      Chunk generation
+     * @param chunkOffset   File offset of the chunk
+     * @param chunkLength   Chunk length
+     * @return true         Success
+     * @return false        Failure
+     */
+    bool allocChunk(const uint32_t chunkGen, const uint64_t chunkOffset, const uint64_t chunkLength) noexcept;
+#endif
+
+    /**
+     * @brief Open the io_uring of the writer thread (Safe mutex must be locked; Every buffer is allocated and registered)
+     *
+     * @return true         Success
+     * @return false        Failure (Buffers are written by blocking writes)
+     */
+    bool openUring() noexcept;
+
+    /**
+     * @brief Close the io_uring of the writer thread (The writes must be completed, or the process is the child after fork)
+     */
+    void closeUring() noexcept;
+
+    /**
+     * @brief Queue one buffer to the io_uring (Called by the writer thread; The buffer is freed by its completion)
+     *
+     * @param bufferIndex   Buffer index
+     * @param rotatePolicy  Rotation policy
+     * @return true         Queued
+     * @return false        Not queued (Write it by blocking write)
+     */
+    bool queueBuffer(const int bufferIndex, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept;
+
+    /**
+     * @brief Submit the queued buffers and free the written ones (Called by the writer thread without the wait mutex)
+     *
+     * @param isAll         Whether to wait for every write (Otherwise waits for one)
+     */
+    void reapUring(const bool isAll) noexcept;
+
+    /**
+     * @brief Hand the active buffer to the writer thread and take a free one (Safe mutex must be locked; Waits if no buffer is free)
+     *
+     * @return size_t       Submitted buffers count including the active buffer (Used to wait for it)
+     */
+    size_t submitBuffer() noexcept;
+
+    /**
+     * @brief Queue the active buffer for the writer thread (Safe and wait mutexes must be locked; The caller takes the next active buffer)
+     */
+    void pendBuffer() noexcept;
+
+    /**
+     * @brief Wait until the writer thread has written the buffers
+     *
+     * @param submitCount   Submitted buffers count to wait for
+     */
+    void waitWritten(const size_t submitCount) noexcept;
+
+    /**
+     * @brief Account one written buffer (Wait mutex must be locked)
+     *
+     * @param logBuffer     Written buffer
+     * @param bufferLength  Buffered length before the write
+     * @param writeBytes    Written bytes
+     */
+    void doneBuffer(LoggingBuffer & logBuffer, const size_t bufferLength, const size_t writeBytes) noexcept;
+
+    /**
+     * @brief Record lost lines (Wait mutex must be locked)
+     *
+     * @param firstTicket   Ticket of the first lost line
+     * @param lastTicket    Ticket of the last lost line
+     */
+    void loseTickets(const size_t firstTicket, const size_t lastTicket) noexcept;
+
+    /**
+     * @brief Check whether a line is lost (Wait mutex must be locked)
+     *
+     * @param lineTicket    Line ticket
+     * @return true         The write or sync of the line failed
+     * @return false        No loss recorded for the line
+     */
+    bool isLost(const size_t lineTicket) const noexcept;
+
+    /**
+     * @brief Compress the buffered lines into one frame (Called by the writer before the buffer is written; CF_LZ4 only)
+     *
+     * @param logBuffer     Output buffer
+     * @return true         Success
+     * @return false        Failure (Out of memory; The lines are dropped, a text buffer would corrupt the file)
+     */
+    bool packBuffer(LoggingBuffer & logBuffer) noexcept;
+
+    /**
+     * @brief Hand the active buffer to the writer thread and wait until it is written (Locks the safe mutex)
+     */
+    void flush() noexcept;
+
+    /**
+     * @brief Wait until the line is synced (Locks the safe mutex)
+     *
+     * @param lineTicket    Line ticket
+     * @return true         The line is on the disk
+     * @return false        The line may be lost
+     */
+    bool waitDurable(const size_t lineTicket) noexcept;
+
+    /**
+     * @brief Sync the written lines (Called by the writer thread without the wait mutex, or by the outputs if it failed to start)
+     */
+    void syncFile() noexcept;
+
+    /**
+     * @brief Writer thread (Writes the waiting buffers in order)
+     */
+    void writeLoop() noexcept;
+
+    /**
+     * @brief Copy the rotation policy for the writer thread (Wait mutex must be locked)
+     *
+     * @param rotatePolicy  Output rotation policy
+     */
+    void takePolicy(ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept;
+
+    /**
+     * @brief Make sure the file for the next part of the buffer is opened (Rotates it if the part makes it over the size)
+     *
+     * @param logBuffer     Output buffer
+     * @param partDatas     Part datas (Rest of the buffered lines, or the compressed frame)
+     * @param partLength    Part length (Cut to the lines that fit the file; A frame is not cut)
+     * @param rotatePolicy  Rotation policy
+     * @return true         Success
+     * @return false        Failure
+     */
+    bool selectFile(const LoggingBuffer & logBuffer, const char * partDatas, size_t & partLength, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept;
+
+    /**
+     * @brief Write one buffer to the file (Called by the writer thread, or by the outputs if it failed to start)
+     *
+     * @param logBuffer     Output buffer
+     * @param rotatePolicy  Rotation policy
+     * @return size_t       Written bytes
+     */
+    size_t writeBuffer(LoggingBuffer & logBuffer, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept;
+
+    /**
+     * @brief Rotate the file (Renames the file and opens a new one; Called by the writer thread, or by the mapped chunk switch)
+     *
+     * @param fileDate      File date (Format: "yyyyMMdd"; Used in NR_DATE rule)
+     */
+    void rotateFile(const char * fileDate) noexcept;
+
+    /**
+     * @brief Maintain the rotated files (Removes the files over the retention, compresses the others; Called by the writer thread)
+     *
+     * @param rotatePolicy  Rotation policy
+     */
+    void maintainFiles(const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept;
+
+    /**
+     * @brief Open the lock file (Lock file: "<dir>/<name>.lock"; Shared by the rotation and the maintenance)
+     *
+     * @return true         Success
+     * @return false        Failure
+     */
+    bool openLock() noexcept;
+
+    /**
+     * @brief Reap the finished compressions
+     *
+     * @param isWait        Whether to wait for the running compressions
+     */
+    void reapCompress(const bool isWait) noexcept;
+
+    /**
+     * @brief Update the time cache (Hands the active buffer to the writer thread if the date changed in NR_DATE rule)
+     *
+     * @param timeTotal     Current time (Milliseconds since epoch)
+     */
+    void updateTime(const long long timeTotal) noexcept;
+
+    /**
+     * @brief Make sure the file of the date is opened (Reopens it if the date changed in NR_DATE rule, or if another process rotated it)
+     *
+     * @param fileDate      File date (Format: "yyyyMMdd")
+     * @param isSized       Whether to refresh the file size (Size rotation is enabled)
+     * @return true         Success
+     * @return false        Failure
+     */
+    bool prepareFile(const char * fileDate, const bool isSized) noexcept;
+
+    /**
+     * @brief Open the file (Kept open across lines; Creates the directory if it does not exist)
+     *
+     * @param fileDate      File date (Format: "yyyyMMdd"; Used in NR_DATE rule)
+     * @return true         Success
+     * @return false        Failure
+     */
+    bool openFile(const char * fileDate) noexcept;
+
+    /**
+     * @brief Close the file
+     */
+    void closeFile() noexcept;
+};
+
+/**
+ * @brief Logging file guard (Marks the instance whose internals run in current thread, routeSink() drops the debug logs they emit)
+ */
+struct LoggingFileGuard
+{
+    static thread_local const ZYLoggingFilePrivate * threadFile; // Instance of current thread (Debug logs routed back to it would lock its mutexes again, or wait for its writer thread)
+    const ZYLoggingFilePrivate *                     lastFile;   // Instance marked before the guard
+
+    explicit LoggingFileGuard(const ZYLoggingFilePrivate * filePrivate) noexcept : lastFile(threadFile) { threadFile = filePrivate; }
+    ~LoggingFileGuard() noexcept { threadFile = lastFile; }
+};
+
+//================================================================================
+// Initialize inside variable
+//================================================================================
+/**
+ * @brief Instances list mutex
+ */
+static std::mutex __LoggingListMutex;
+
+/**
+ * @brief Instances list head (Reset in the child process after fork)
+ */
+static ZYLoggingFilePrivate * __LoggingListHead = nullptr;
+
+/**
+ * @brief Time cache of current thread (Mapped outputs do not share the cache of the safe mutex)
+ */
+static thread_local LoggingTimeCache __LoggingThreadTime;
+
+/**
+ * @brief Logging file whose internals run in current thread (Nullptr: none)
+ */
+thread_local const ZYLoggingFilePrivate * LoggingFileGuard::threadFile = nullptr;
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Get line label
+ *
+ * @param logLevel      Log level (Use execute status level macros)
+ * @return const char*  Line label (Example: "[INFO]")
+ */
+static const char * __LoggingLabel(const int logLevel) noexcept
+{
+    if ((logLevel & ESL_FATAL))
+        return "[FATAL]";
+    else if ((logLevel & ESL_ERROR))
+        return "[ERROR]";
+    else if ((logLevel & ESL_WARNING))
+        return "[WARNING]";
+    else if ((logLevel & ESL_INFOMATION))
+        return "[INFO]";
+    else if ((logLevel & ESL_DEBUG))
+        return "[DEBUG]";
+
+    return "[NONE]";
+}
+
+/**
+ * @brief Get current time
+ *
+ * @return long long    Current time (Milliseconds since epoch)
+ */
+static inline long long __LoggingTime() noexcept
+{
+#if defined(_LINUX)
+    struct timespec time_spec;
+
+    clock_gettime(CLOCK_REALTIME, &time_spec);
+    return (long long)time_spec.tv_sec * 1000LL + time_spec.tv_nsec / 1000000;
+#elif defined(_WINDOWS)
+    FILETIME       file_time;
+    ULARGE_INTEGER time_value;
+
+    GetSystemTimeAsFileTime(&file_time);
+    time_value.LowPart  = file_time.dwLowDateTime;
+    time_value.HighPart = file_time.dwHighDateTime;
+    return (long long)(time_value.QuadPart / 10000ULL) - 11644473600000LL;
+#endif
+}
+
+/**
+ * @brief Update the time cache
+ *
+ * @param timeCache     Time cache
+ * @param timeTotal     Current time (Milliseconds since epoch)
+ * @return true         The second changed (Date may be changed)
+ * @return false        Same second
+ */
+static bool __LoggingUpdateTime(LoggingTimeCache & timeCache, const long long timeTotal) noexcept
+{
+    time_t time_second = (time_t)(timeTotal / 1000);
+    int    time_msec   = (int)(timeTotal % 1000);
+    bool   is_changed  = (time_second != timeCache.cacheSecond);
+
+    if (is_changed)
+    {
+        struct tm time_local;
+
+#if defined(_LINUX)
+        localtime_r(&time_second, &time_local);
+#elif defined(_WINDOWS)
+        localtime_s(&time_local, &time_second);
+#endif
+        strftime(timeCache.timeString, sizeof(timeCache.timeString), "%Y-%m-%d %H:%M:%S.000", &time_local);
+        strftime(timeCache.dateString, sizeof(timeCache.dateString), "%Y%m%d", &time_local);
+        timeCache.cacheSecond = time_second;
+    }
+
+    timeCache.timeString[20] = (char)('0' + time_msec / 100);
+    timeCache.timeString[21] = (char)('0' + time_msec / 10 % 10);
+    timeCache.timeString[22] = (char)('0' + time_msec % 10);
+
+    return is_changed;
+}
+
+/**
+ * @brief Build the line head ("yyyy-MM-dd hh:mm:ss.zzz [INFO] ")
+ *
+ * @param lineHead      Output line head (LOGGING_HEAD_LENGTH bytes)
+ * @param timeCache     Time cache
+ * @param logLevel      Log level (Use execute status level macros)
+ * @return size_t       Line head length
+ */
+static size_t __LoggingHead(char * lineHead, const LoggingTimeCache & timeCache, const int logLevel) noexcept
+{
+    const char * line_label = __LoggingLabel(logLevel);
+    size_t       label_len  = strlen(line_label);
+    size_t       head_len   = sizeof(timeCache.timeString) - 1;
+
+    memcpy(lineHead, timeCache.timeString, head_len);
+    lineHead[head_len++]  = ' ';
+    memcpy(lineHead + head_len, line_label, label_len);
+    head_len             += label_len;
+    lineHead[head_len++]  = ' ';
+
+    return head_len;
+}
+
+/**
+ * @brief Lock the safe mutex
+ *
+ * @param safeLock      Safe mutex
+ */
+static inline void __LoggingLock(ZYLoggingFile::SafeMutex * safeLock) noexcept
+{
+#if defined(_LINUX)
+    pthread_mutex_lock(&safeLock->mutexLock);
+#elif defined(_WINDOWS)
+    WaitForSingleObject(safeLock->mutexLock, INFINITE);
+#endif
+}
+
+/**
+ * @brief Try to lock the safe mutex
+ *
+ * @param safeLock      Safe mutex
+ * @return true         Locked
+ * @return false        Held by others
+ */
+static inline bool __LoggingTryLock(ZYLoggingFile::SafeMutex * safeLock) noexcept
+{
+#if defined(_LINUX)
+    return pthread_mutex_trylock(&safeLock->mutexLock) == 0;
+#elif defined(_WINDOWS)
+    return WaitForSingleObject(safeLock->mutexLock, 0) == WAIT_OBJECT_0;
+#endif
+}
+
+/**
+ * @brief Unlock the safe mutex
+ *
+ * @param safeLock      Safe mutex
+ */
+static inline void __LoggingUnlock(ZYLoggingFile::SafeMutex * safeLock) noexcept
+{
+#if defined(_LINUX)
+    pthread_mutex_unlock(&safeLock->mutexLock);
+#elif defined(_WINDOWS)
+    ReleaseMutex(safeLock->mutexLock);
+#endif
+}
+
+/**
+ * @brief Write all datas (Retries partial writes)
+ *
+ * @param fileHandle    File handle
+ * @param writeDatas    Write datas
+ * @param writeLengths  Write datas length
+ * @param datasCount    Write datas count
+ * @return true         Success
+ * @return false        Failure
+ */
+#if defined(_LINUX)
+static bool __LoggingWrite(const int fileHandle, const char * const * writeDatas, const size_t * writeLengths, const int datasCount) noexcept
+{
+    struct iovec io_vecs[4];
+    int          vecs_count = 0;
+    int          vecs_index = 0;
+
+    for (int datas_idx = 0; datas_idx < datasCount && vecs_count < 4; datas_idx++)
+    {
+        if (!writeLengths[datas_idx]) continue;
+        io_vecs[vecs_count].iov_base = (void *)writeDatas[datas_idx];
+        io_vecs[vecs_count].iov_len  = writeLengths[datas_idx];
+        vecs_count++;
+    }
+
+    while (vecs_index < vecs_count)
+    {
+        ssize_t write_len = writev(fileHandle, io_vecs + vecs_index, vecs_count - vecs_index);
+
+        if (write_len < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        while (vecs_index < vecs_count && (size_t)write_len >= io_vecs[vecs_index].iov_len)
+        {
+            write_len -= io_vecs[vecs_index].iov_len;
+            vecs_index++;
+        }
+        if (vecs_index < vecs_count)
+        {
+            io_vecs[vecs_index].iov_base  = (char *)io_vecs[vecs_index].iov_base + write_len;
+            io_vecs[vecs_index].iov_len  -= write_len;
+        }
+    }
+
+    return true;
+}
+#elif defined(_WINDOWS)
+static bool __LoggingWrite(const HANDLE fileHandle, const char * const * writeDatas, const size_t * writeLengths, const int datasCount) noexcept
+{
+    for (int datas_idx = 0; datas_idx < datasCount; datas_idx++)
+    {
+        const char * write_pos = writeDatas[datas_idx];
+        size_t       write_len = writeLengths[datas_idx];
+
+        while (write_len > 0)
+        {
+            DWORD written_len = 0;
+
+            if (!::WriteFile(fileHandle, write_pos, (DWORD)(write_len > 0x40000000 ? 0x40000000 : write_len), &written_len, NULL)) return false;
+            write_pos += written_len;
+            write_len -= written_len;
+        }
+    }
+
+    return true;
+}
+#endif
+
+/**
+ * @brief Read 4 bytes (Native byte order; Used to hash and compare the match candidates)
+ *
+ * @param srcDatas      Source datas
+ * @return uint32_t     Read value
+ */
+static inline uint32_t __LoggingGet32(const uchar * srcDatas) noexcept
+{
+    uint32_t read_value = 0;
+
+    memcpy(&read_value, srcDatas, sizeof(read_value));
+    return read_value;
+}
+
+/**
+ * @brief Read 8 bytes (Native byte order; Used to extend the matches)
+ *
+ * @param srcDatas      Source datas
+ * @return uint64_t     Read value
+ */
+static inline uint64_t __LoggingGet64(const uchar * srcDatas) noexcept
+{
+    uint64_t read_value = 0;
+
+    memcpy(&read_value, srcDatas, sizeof(read_value));
+    return read_value;
+}
+
+/**
+ * @brief Write 4 bytes in little endian (LZ4 frame fields)
+ *
+ * @param outDatas      Output datas
+ * @param writeValue    Write value
+ */
+static inline void __LoggingPut32(uchar * outDatas, const uint32_t writeValue) noexcept
+{
+    outDatas[0] = (uchar)writeValue;
+    outDatas[1] = (uchar)(writeValue >> 8);
+    outDatas[2] = (uchar)(writeValue >> 16);
+    outDatas[3] = (uchar)(writeValue >> 24);
+}
+
+/**
+ * @brief Compute XXH32 of short datas (Seed 0; Used by the LZ4 frame descriptor checksum)
+ *
+ * @param srcDatas      Source datas
+ * @param srcLength     Source length (Less than 16 bytes)
+ * @return uint32_t     XXH32 hash
+ */
+static uint32_t __LoggingXxh32(const uchar * srcDatas, const size_t srcLength) noexcept
+{
+    uint32_t hash_value = 374761393U + (uint32_t)srcLength;
+    size_t   src_idx    = 0;
+
+    for (; src_idx + 4 <= srcLength; src_idx += 4)
+    {
+        hash_value += ((uint32_t)srcDatas[src_idx] | (uint32_t)srcDatas[src_idx + 1] << 8 | (uint32_t)srcDatas[src_idx + 2] << 16 | (uint32_t)srcDatas[src_idx + 3] << 24) * 3266489917U;
+        hash_value  = ((hash_value << 17) | (hash_value >> 15)) * 668265263U;
+    }
+    for (; src_idx < srcLength; src_idx++)
+    {
+        hash_value += srcDatas[src_idx] * 374761393U;
+        hash_value  = ((hash_value << 11) | (hash_value >> 21)) * 2654435761U;
+    }
+
+    hash_value ^= hash_value >> 15;
+    hash_value *= 2246822519U;
+    hash_value ^= hash_value >> 13;
+    hash_value *= 3266489917U;
+    hash_value ^= hash_value >> 16;
+
+    return hash_value;
+}
+
+/**
+ * @brief Write one LZ4 sequence (Literals followed by a match)
+ *
+ * @param outPos        Output position
+ * @param litDatas      Literals
+ * @param litLength     Literals length
+ * @param matchOffset   Match offset (Unused if no match)
+ * @param matchLength   Match length (0: the last sequence, literals only)
+ * @return uchar*       Output position after the sequence
+ */
+static uchar * __LoggingLz4Sequence(uchar * outPos, const uchar * litDatas, const size_t litLength, const size_t matchOffset, const size_t matchLength) noexcept
+{
+    uchar * seq_token = outPos++;
+    size_t  rest_len  = 0;
+
+    *seq_token = (uchar)((litLength >= 15 ? 15 : litLength) << 4);
+    if (litLength >= 15)
+    {
+        for (rest_len = litLength - 15; rest_len >= 255; rest_len -= 255) *outPos++ = 255;
+        *outPos++ = (uchar)rest_len;
+    }
+    memcpy(outPos, litDatas, litLength);
+    outPos += litLength;
+
+    if (!matchLength) return outPos;
+
+    *outPos++   = (uchar)matchOffset;
+    *outPos++   = (uchar)(matchOffset >> 8);
+    rest_len    = matchLength - 4;
+    *seq_token |= (uchar)(rest_len >= 15 ? 15 : rest_len);
+    if (rest_len >= 15)
+    {
+        for (rest_len -= 15; rest_len >= 255; rest_len -= 255) *outPos++ = 255;
+        *outPos++ = (uchar)rest_len;
+    }
+
+    return outPos;
+}
+
+/**
+ * @brief Compress one LZ4 block (Greedy single-probe match finder, tuned for speed over ratio)
+ *
+ * @param blockDatas    Output block datas (At least srcLength + srcLength / 255 + 16 bytes)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source length (At most LOGGING_FRAME_BLOCK)
+ * @return size_t       Block length
+ */
+static size_t __LoggingLz4Block(uchar * blockDatas, const uchar * srcDatas, const size_t srcLength) noexcept
+{
+    uint32_t      hash_table[1 << LOGGING_FRAME_HASH];
+    const uchar * src_end     = srcDatas + srcLength;
+    const uchar * anchor_pos  = srcDatas;
+    const uchar * src_pos     = srcDatas + 1;
+    uchar *       out_pos     = blockDatas;
+    uint32_t      skip_count  = 1U << LOGGING_FRAME_SKIP;
+
+    // The last match starts 12 bytes before the block end and ends 5 bytes before it, shorter blocks are literals only
+    if (srcLength >= 13)
+    {
+        const uchar * match_limit = src_end - 12;
+        const uchar * match_end   = src_end - 5;
+
+        memset(hash_table, 0, sizeof(hash_table));
+        while (src_pos < match_limit)
+        {
+            uint32_t      hash_idx  = (__LoggingGet32(src_pos) * 2654435761U) >> (32 - LOGGING_FRAME_HASH);
+            const uchar * ref_pos   = srcDatas + hash_table[hash_idx];
+            size_t        match_len = 4;
+
+            hash_table[hash_idx] = (uint32_t)(src_pos - srcDatas);
+            if (ref_pos >= src_pos || src_pos - ref_pos > 0xFFFF || __LoggingGet32(ref_pos) != __LoggingGet32(src_pos))
+            {
+                src_pos += (skip_count++ >> LOGGING_FRAME_SKIP);
+                continue;
+            }
+
+            while (src_pos > anchor_pos && ref_pos > srcDatas && src_pos[-1] == ref_pos[-1])
+            {
+                src_pos--;
+                ref_pos--;
+                match_len++;
+            }
+            while (src_pos + match_len + 8 <= match_end && __LoggingGet64(src_pos + match_len) == __LoggingGet64(ref_pos + match_len)) match_len += 8;
+            while (src_pos + match_len < match_end && src_pos[match_len] == ref_pos[match_len]) match_len++;
+
+            out_pos    = __LoggingLz4Sequence(out_pos, anchor_pos, (size_t)(src_pos - anchor_pos), (size_t)(src_pos - ref_pos), match_len);
+            src_pos   += match_len;
+            anchor_pos = src_pos;
+            skip_count = 1U << LOGGING_FRAME_SKIP;
+            if (src_pos < match_limit) hash_table[(__LoggingGet32(src_pos - 2) * 2654435761U) >> (32 - LOGGING_FRAME_HASH)] = (uint32_t)(src_pos - 2 - srcDatas);
+        }
+    }
+
+    out_pos = __LoggingLz4Sequence(out_pos, anchor_pos, (size_t)(src_end - anchor_pos), 0, 0);
+
+    return (size_t)(out_pos - blockDatas);
+}
+
+/**
+ * @brief Get the max length of the LZ4 frame of the datas
+ *
+ * @param srcLength     Source length
+ * @return size_t       Frame max length
+ */
+static inline size_t __LoggingFrameBound(const size_t srcLength) noexcept
+{
+    return srcLength + srcLength / 255 + (srcLength / LOGGING_FRAME_BLOCK + 1) * 24 + 24;
+}
+
+/**
+ * @brief Compress datas into one LZ4 frame (Independent blocks, content size in the descriptor; Decodable without the previous frames)
+ *
+ * @param frameDatas    Output frame datas (At least __LoggingFrameBound() bytes)
+ * @param srcDatas      Source datas
+ * @param srcLength     Source length
+ * @return size_t       Frame length
+ */
+static size_t __LoggingFrame(char * frameDatas, const char * srcDatas, const size_t srcLength) noexcept
+{
+    uchar * frame_pos = (uchar *)frameDatas;
+
+    // Descriptor: version 1, independent blocks, content size, 1MB blocks (Readers skip a whole frame by its block sizes)
+    __LoggingPut32(frame_pos, LOGGING_FRAME_MAGIC);
+    frame_pos[4] = 0x68;
+    frame_pos[5] = 0x60;
+    __LoggingPut32(frame_pos + 6, (uint32_t)srcLength);
+    __LoggingPut32(frame_pos + 10, (uint32_t)((uint64_t)srcLength >> 32));
+    frame_pos[14]  = (uchar)(__LoggingXxh32(frame_pos + 4, 10) >> 8);
+    frame_pos     += 15;
+
+    for (size_t src_offset = 0; src_offset < srcLength;)
+    {
+        size_t block_len  = (srcLength - src_offset > LOGGING_FRAME_BLOCK ? LOGGING_FRAME_BLOCK : srcLength - src_offset);
+        size_t packed_len = __LoggingLz4Block(frame_pos + 4, (const uchar *)srcDatas + src_offset, block_len);
+
+        // Incompressible blocks are stored as they are
+        if (packed_len >= block_len)
+        {
+            memcpy(frame_pos + 4, srcDatas + src_offset, block_len);
+            __LoggingPut32(frame_pos, (uint32_t)block_len | 0x80000000U);
+            frame_pos += 4 + block_len;
+        }
+        else
+        {
+            __LoggingPut32(frame_pos, (uint32_t)packed_len);
+            frame_pos += 4 + packed_len;
+        }
+        src_offset += block_len;
+    }
+    __LoggingPut32(frame_pos, 0);
+    frame_pos += 4;
+
+    return (size_t)(frame_pos - (uchar *)frameDatas);
+}
+
+/**
+ * @brief Compress the parts of one line into one LZ4 frame (Used by the lines that do not fit in a buffer)
+ *
+ * @param partDatas     Line parts
+ * @param partLengths   Line parts length
+ * @param partsCount    Line parts count
+ * @param frameLength   Output frame length
+ * @return char*        Frame datas (Free it with free(); Nullptr: out of memory)
+ */
+static char * __LoggingPackParts(const char * const * partDatas, const size_t * partLengths, const int partsCount, size_t & frameLength) noexcept
+{
+    char * line_datas  = nullptr;
+    char * frame_datas = nullptr;
+    size_t line_length = 0;
+
+    for (int part_idx = 0; part_idx < partsCount; part_idx++) line_length += partLengths[part_idx];
+
+    line_datas  = (char *)malloc(line_length);
+    frame_datas = (line_datas ? (char *)malloc(__LoggingFrameBound(line_length)) : nullptr);
+    if (frame_datas)
+    {
+        size_t line_offset = 0;
+
+        for (int part_idx = 0; part_idx < partsCount; part_idx++)
+        {
+            memcpy(line_datas + line_offset, partDatas[part_idx], partLengths[part_idx]);
+            line_offset += partLengths[part_idx];
+        }
+        frameLength = __LoggingFrame(frame_datas, line_datas, line_length);
+    }
+    free(line_datas);
+
+    return frame_datas;
+}
+
+/**
+ * @brief Get the datas written for the buffer
+ *
+ * @param logBuffer     Output buffer
+ * @param outputLength  Output datas length
+ * @return const char*  Output datas (The compressed frame if the buffer is packed, otherwise the buffered lines)
+ */
+static inline const char * __LoggingOutput(const LoggingBuffer & logBuffer, size_t & outputLength) noexcept
+{
+    outputLength = (logBuffer.frameLength ? logBuffer.frameLength : logBuffer.bufferLength);
+    return (logBuffer.frameLength ? logBuffer.frameDatas : logBuffer.bufferDatas);
+}
+
+/**
+ * @brief Get the length of the whole lines that fit in the room
+ *
+ * @param lineDatas     Buffered lines
+ * @param lineLength    Buffered length
+ * @param roomLength    Room length
+ * @return size_t       Length of the lines (0: the first line is longer than the room)
+ */
+static inline size_t __LoggingFitLength(const char * lineDatas, const size_t lineLength, const size_t roomLength) noexcept
+{
+    if (lineLength <= roomLength) return lineLength;
+
+    for (size_t fit_len = roomLength; fit_len; fit_len--)
+    {
+        if (lineDatas[fit_len - 1] == '\n') return fit_len;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Check whether the path exists
+ *
+ * @param filePath      File path
+ * @return true         Exists
+ * @return false        Not exists
+ */
+static inline bool __LoggingExists(const char * filePath) noexcept
+{
+#if defined(_LINUX)
+    struct stat path_stat;
+
+    return stat(filePath, &path_stat) == 0;
+#elif defined(_WINDOWS)
+    return ::GetFileAttributesA(filePath) != INVALID_FILE_ATTRIBUTES;
+#endif
+}
+
+#if defined(_LINUX)
+/**
+ * @brief Lock or unlock one byte of the lock file (Record locks are owned by the process, forked processes exclude each other)
+ *
+ * @param lockHandle    Lock file descriptor
+ * @param lockByte      Locked byte offset
+ * @param lockType      Lock type (F_WRLCK: lock; F_UNLCK: unlock)
+ * @param isWait        Whether to wait for the lock
+ * @return true         Success
+ * @return false        Failure (Held by another process if not waiting)
+ */
+static bool __LoggingLockFile(const int lockHandle, const int lockByte, const short lockType, const bool isWait) noexcept
+{
+    struct flock file_lock;
+
+    memset(&file_lock, 0, sizeof(file_lock));
+    file_lock.l_type   = lockType;
+    file_lock.l_whence = SEEK_SET;
+    file_lock.l_start  = lockByte;
+    file_lock.l_len    = 1;
+
+    while (fcntl(lockHandle, isWait ? F_SETLKW : F_SETLK, &file_lock) != 0)
+    {
+        if (errno != EINTR) return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Compare rotated files (Newest first)
+ *
+ * @param leftFile      Left rotated file
+ * @param rightFile     Right rotated file
+ * @return int          Compare result
+ */
+static int __LoggingCompareRotated(const void * leftFile, const void * rightFile) noexcept
+{
+    long long left_time  = ((const LoggingRotated *)leftFile)->modifyTime;
+    long long right_time = ((const LoggingRotated *)rightFile)->modifyTime;
+
+    if (left_time != right_time) return left_time > right_time ? -1 : 1;
+    return -strcmp(((const LoggingRotated *)leftFile)->fileName, ((const LoggingRotated *)rightFile)->fileName);
+}
+
+/**
+ * @brief Find the valid end of a mapped file (Cuts the zero filled tail left by a crash, and closes a line cut by it)
+ *
+ * @param fileHandle    File descriptor (Opened for reading and writing)
+ * @return uint64_t     Valid end of the file
+ */
+static uint64_t __LoggingMappedEnd(const int fileHandle) noexcept
+{
+    struct stat file_stat;
+    char        block_datas[0x10000];
+    uint64_t    valid_end = 0;
+    uint64_t    block_end = 0;
+
+    if (fstat(fileHandle, &file_stat) != 0) return 0;
+
+    // The preallocated chunks are zero filled after the last copied line
+    block_end = (uint64_t)file_stat.st_size;
+    while (block_end > 0)
+    {
+        uint64_t block_start = (block_end > sizeof(block_datas) ? block_end - sizeof(block_datas) : 0);
+        ssize_t  read_len    = pread(fileHandle, block_datas, (size_t)(block_end - block_start), (off_t)block_start);
+
+        if (read_len != (ssize_t)(block_end - block_start))
+        {
+            valid_end = block_end;
+            break;
+        }
+        while (read_len > 0 && !block_datas[read_len - 1]) read_len--;
+        if (read_len > 0)
+        {
+            valid_end = block_start + read_len;
+            if (block_datas[read_len - 1] != '\n' && pwrite(fileHandle, "\n", 1, (off_t)valid_end) == 1) valid_end++;
+            break;
+        }
+        block_end = block_start;
+    }
+
+    if (valid_end != (uint64_t)file_stat.st_size && ftruncate(fileHandle, (off_t)valid_end) != 0) DBG_PERROR(ESL_WARNING, "Failed to cut mapped logging file:");
+
+    return valid_end;
+}
+
+/**
+ * @brief Unmap the chunk views
+ *
+ * @param chunkView     First chunk view (Linked by the next view)
+ */
+static void __LoggingUnmapViews(LoggingMappedView * chunkView) noexcept
+{
+    while (chunkView)
+    {
+        LoggingMappedView * next_view = chunkView->nextView;
+
+        munmap(chunkView->mapDatas, chunkView->mapLength);
+        delete chunkView;
+        chunkView = next_view;
+    }
+}
+#endif
+
+#if defined(LOGGING_URING_ENABLE)
+/**
+ * @brief Free the writer io_uring
+ *
+ * @param writerUring   Writer io_uring
+ */
+static void __LoggingFreeUring(LoggingUring * writerUring) noexcept
+{
+    if (!writerUring) return;
+
+    if (writerUring->sqEntries) munmap(writerUring->sqEntries, writerUring->sqLength);
+    if (writerUring->ringDatas) munmap(writerUring->ringDatas, writerUring->ringLength);
+    if (writerUring->ringHandle >= 0) close(writerUring->ringHandle);
+    delete writerUring;
+}
+#endif
+
+/**
+ * @brief Reset every instance in the child process after fork
+ */
+static void __LoggingAtForkChild() noexcept
+{
+    // Only the forking thread exists in the child, the list mutex may be held by a thread that is gone
+    new (&__LoggingListMutex) std::mutex();
+
+    for (ZYLoggingFilePrivate * file_private = __LoggingListHead; file_private; file_private = file_private->nextPrivate) file_private->resetAfterFork();
+}
+
+/**
+ * @brief Register the fork handler (Once per process)
+ */
+static void __LoggingRegisterAtFork() noexcept
+{
+#if defined(_LINUX)
+    static const int atfork_result = pthread_atfork(nullptr, nullptr, __LoggingAtForkChild);
+    (void)atfork_result;
+#endif
+}
+
+//================================================================================
+// Implementation inside method [ZYLoggingFilePrivate]
+//================================================================================
+/**
+ * @brief Construct function (Starts the writer thread)
+ *
+ * @param fileOwner     Logging file instance
+ */
+ZYLoggingFilePrivate::ZYLoggingFilePrivate(ZYLoggingFile * fileOwner) noexcept : fileOwner(fileOwner)
+{
+    for (int buffer_idx = 1; buffer_idx < LOGGING_BUFFER_COUNT; buffer_idx++) this->freeIndexes[this->freeCount++] = buffer_idx;
+
+    __LoggingRegisterAtFork();
+    {
+        std::lock_guard<std::mutex> list_locker(__LoggingListMutex);
+
+        this->nextPrivate = __LoggingListHead;
+        if (__LoggingListHead) __LoggingListHead->prevPrivate = this;
+        __LoggingListHead = this;
+    }
+
+    this->startWriter();
+}
+
+/**
+ * @brief Destruct function (Writes the buffered lines, stops the writer thread and closes the file)
+ */
+ZYLoggingFilePrivate::~ZYLoggingFilePrivate()
+{
+    this->flush();
+
+    if (this->writerThread)
+    {
+        {
+            std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+            this->writerStop = true;
+        }
+        this->wakeCond.notify_one();
+        this->writerThread->join();
+
+        delete this->writerThread;
+        this->writerThread = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> list_locker(__LoggingListMutex);
+
+        if (this->prevPrivate)
+            this->prevPrivate->nextPrivate = this->nextPrivate;
+        else
+            __LoggingListHead = this->nextPrivate;
+        if (this->nextPrivate) this->nextPrivate->prevPrivate = this->prevPrivate;
+    }
+
+#if defined(_LINUX)
+    this->closeMapped();
+#endif
+    this->closeFile();
+    this->closeUring();
+#if defined(_LINUX)
+    this->reapCompress(true);
+    if (this->lockHandle != LOGGING_INVALID_HANDLE) close(this->lockHandle);
+    this->lockHandle = LOGGING_INVALID_HANDLE;
+#endif
+    for (int buffer_idx = 0; buffer_idx < LOGGING_BUFFER_COUNT; buffer_idx++)
+    {
+        free(this->logBuffers[buffer_idx].bufferDatas);
+        free(this->logBuffers[buffer_idx].frameDatas);
+        this->logBuffers[buffer_idx].bufferDatas = nullptr;
+        this->logBuffers[buffer_idx].frameDatas  = nullptr;
+    }
+}
+
+/**
+ * @brief Start the writer thread (Buffers are written by the outputs if it fails)
+ */
+void ZYLoggingFilePrivate::startWriter() noexcept
+{
+    this->writerStart = false;
+
+    try
+    {
+        this->writerThread = new std::thread(&ZYLoggingFilePrivate::writeLoop, this);
+    }
+    catch (...)
+    {
+        this->writerThread = nullptr;
+        DBGLOG_WARNING("Failed to start logging file writer thread, buffers are written by the outputs.");
+    }
+
+    if (this->writerThread && this->uringWanted) this->openUring();
+}
+
+/**
+ * @brief Reset the instance in the child process after fork (The writer thread does not exist in the child, lines buffered by the parent are left to it)
+ */
+void ZYLoggingFilePrivate::resetAfterFork() noexcept
+{
+    ZYLoggingFile::SafeMutex * safe_lock = this->fileOwner->_safeLock;
+
+    // The mutexes may be held by threads that are gone, the writer thread object is abandoned
+#if defined(_LINUX)
+    pthread_mutex_init(&safe_lock->mutexLock, &safe_lock->mutexAttr);
+#endif
+    new (&this->fileMutex) std::mutex();
+    new (&this->waitMutex) std::mutex();
+    new (&this->wakeCond) std::condition_variable();
+    new (&this->idleCond) std::condition_variable();
+
+    // The file descriptor is shared with the parent, both append whole buffers to it
+    for (int buffer_idx = 0; buffer_idx < LOGGING_BUFFER_COUNT; buffer_idx++)
+    {
+        this->logBuffers[buffer_idx].bufferLength = 0;
+        this->logBuffers[buffer_idx].frameLength  = 0;
+    }
+    this->freeCount = 0;
+    for (int buffer_idx = 0; buffer_idx < LOGGING_BUFFER_COUNT; buffer_idx++)
+    {
+        if (buffer_idx != this->activeIndex) this->freeIndexes[this->freeCount++] = buffer_idx;
+    }
+    this->pendingHead  = 0;
+    this->pendingCount = 0;
+    this->submitCount   = 0;
+    this->writtenCount  = 0;
+    this->writtenTicket = 0;
+    this->syncedTicket  = 0;
+    this->syncTicket    = 0;
+    this->lostCount     = 0;
+    this->lineCount     = 0;
+    this->writerStats  = ZYLoggingFile::WriterStats();
+    this->writerStop   = false;
+    this->writerStart  = (this->writerThread != nullptr);
+    this->writerThread = nullptr;
+    this->closeUring();
+
+    // Compressions and record locks belong to the parent, the mapped chunks and the reservation cursor are shared with it
+#if defined(_LINUX)
+    this->compressCount  = 0;
+    this->maintainLocked = false;
+    if (this->mappedFile)
+    {
+        new (&this->mappedFile->mapMutex) std::mutex();
+        this->mappedFile->copyCount.store(0);
+        this->mappedFile->lineCount.store(0);
+        this->mappedFile->mappedState->attachCount.fetch_add(1);
+    }
+#endif
+}
+
+/**
+ * @brief Append one line (Locks the safe mutex)
+ *
+ * @param logLevel      Log level (Use execute status level macros)
+ * @param lineDatas     Line content (Without line break)
+ * @param lineLength    Line content length
+ * @param hasHead       Whether to write the line head (Lines formatted by the debug log have their own head)
+ */
+size_t ZYLoggingFilePrivate::appendLine(const int logLevel, const char * lineDatas, const size_t lineLength, const bool hasHead) noexcept
+{
+    ZYLoggingFile::SafeMutex * safe_lock   = this->fileOwner->_safeLock;
+    long long                  time_total  = __LoggingTime();
+    LoggingBuffer *            log_buffer  = nullptr;
+    char                       line_head[LOGGING_HEAD_LENGTH];
+    size_t                     head_len    = 0;
+    size_t                     total_len   = 0;
+    size_t                     line_ticket = 0;
+    LoggingFileGuard           file_guard(this);
+
+#if defined(_LINUX)
+    if (this->mappedFile)
+    {
+        this->appendMapped(logLevel, lineDatas, lineLength, hasHead);
+        return 0;
+    }
+#endif
+
+    __LoggingLock(safe_lock);
+
+    if (this->writerStart) this->startWriter();
+    this->updateTime(time_total);
+    line_ticket = ++this->lineCount;
+
+    head_len  = (hasHead ? __LoggingHead(line_head, this->timeCache, logLevel) : 0);
+    total_len = head_len + lineLength + 1;
+
+    if (total_len > LOGGING_BUFFER_LENGTH)
+    {
+        // The line does not fit in a buffer, write it here after the buffered lines (No buffer is submitted until the safe mutex is unlocked, the file mutex holds off the syncs and maintenance of the writer thread)
+        const char * line_parts[3]   = {line_head, lineDatas, "\n"};
+        size_t       part_lengths[3] = {head_len, lineLength, 1};
+        size_t       write_len       = total_len;
+        bool         is_written      = false;
+
+        this->waitWritten(this->submitBuffer());
+        std::lock_guard<std::mutex> file_locker(this->fileMutex);
+        if (this->compressFormat)
+        {
+            // Compressed files take the line as one frame of several blocks
+            char * frame_datas = __LoggingPackParts(line_parts, part_lengths, 3, write_len);
+
+            is_written = frame_datas && this->prepareFile(this->timeCache.dateString, false) && __LoggingWrite(this->fileHandle, &frame_datas, &write_len, 1);
+            free(frame_datas);
+        }
+        else
+        {
+            is_written = this->prepareFile(this->timeCache.dateString, false) && __LoggingWrite(this->fileHandle, line_parts, part_lengths, 3);
+        }
+
+        if (is_written)
+        {
+            std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+            this->fileSize               += write_len;
+            this->writerStats.writeBytes += write_len;
+            this->writerStats.lineBytes  += total_len;
+            this->writtenTicket           = line_ticket;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+            this->writtenTicket = line_ticket;
+            this->loseTickets(line_ticket, line_ticket);
+        }
+
+        __LoggingUnlock(safe_lock);
+        return line_ticket;
+    }
+
+    log_buffer = &this->logBuffers[this->activeIndex];
+    if (log_buffer->bufferLength + total_len > LOGGING_BUFFER_LENGTH)
+    {
+        this->submitBuffer();
+        log_buffer = &this->logBuffers[this->activeIndex];
+    }
+    if (!log_buffer->bufferDatas) log_buffer->bufferDatas = (char *)malloc(LOGGING_BUFFER_LENGTH);
+
+    if (log_buffer->bufferDatas)
+    {
+        char * buffer_pos = log_buffer->bufferDatas + log_buffer->bufferLength;
+
+        if (!log_buffer->bufferLength)
+        {
+            memcpy(log_buffer->bufferDate, this->timeCache.dateString, sizeof(log_buffer->bufferDate));
+            log_buffer->firstTicket = line_ticket;
+        }
+        memcpy(buffer_pos, line_head, head_len);
+        memcpy(buffer_pos + head_len, lineDatas, lineLength);
+        buffer_pos[head_len + lineLength]  = '\n';
+        log_buffer->bufferLength          += total_len;
+        log_buffer->lineTicket             = line_ticket;
+
+        // Fatal lines are written before returning, the process may exit right after them
+        if ((logLevel & ESL_FATAL))
+            this->waitWritten(this->submitBuffer());
+        else if (logLevel >= LOGGING_FLUSH_LEVEL)
+            this->submitBuffer();
+    }
+    else
+    {
+        line_ticket = 0;
+    }
+
+    __LoggingUnlock(safe_lock);
+
+    return line_ticket;
+}
+
+#if defined(_LINUX)
+/**
+ * @brief Switch to the mapped mode (Safe mutex must be locked; The first chunk is mapped at the valid end of the file)
+ *
+ * @return true         Success
+ * @return false        Failure (Lines were output)
+ */
+bool ZYLoggingFilePrivate::openMapped() noexcept
+{
+    LoggingMappedState * mapped_state = nullptr;
+    LoggingTimeCache     time_cache;
+    pthread_mutexattr_t  mutex_attr;
+    uint64_t             file_date    = 0;
+
+    if (this->mappedFile) return true;
+    if (this->lineCount) return false;
+
+    // The state is shared with the processes forked later, like the file descriptor
+    mapped_state = (LoggingMappedState *)mmap(nullptr, sizeof(LoggingMappedState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapped_state == MAP_FAILED)
+    {
+        DBG_PERROR(ESL_WARNING, "Failed to map logging file state:");
+        return false;
+    }
+    this->mappedFile = new (std::nothrow) LoggingMappedFile();
+    if (!this->mappedFile)
+    {
+        munmap(mapped_state, sizeof(LoggingMappedState));
+        return false;
+    }
+    this->mappedFile->mappedState = new (mapped_state) LoggingMappedState();
+    for (int ring_idx = 0; ring_idx < LOGGING_MAPPED_RING; ring_idx++) this->mappedFile->chunkViews[ring_idx].store(nullptr);
+    this->mappedFile->copyCount.store(0);
+    this->mappedFile->lineCount.store(0);
+    mapped_state->attachCount.store(1);
+
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&mapped_state->switchMutex, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+
+    // The file is reopened for mapping, the lines of a crashed run are kept
+    __LoggingUpdateTime(time_cache, __LoggingTime());
+    memcpy(&file_date, time_cache.dateString, sizeof(file_date));
+    this->closeFile();
+    if (this->openFile(time_cache.dateString))
+    {
+        memcpy(mapped_state->filePath, this->filePath, sizeof(mapped_state->filePath));
+        mapped_state->fileDate.store(file_date);
+        if (this->allocChunk(0, __LoggingMappedEnd(this->fileHandle), LOGGING_MAPPED_CHUNK)) return true;
+    }
+
+    this->closeMapped();
+    this->closeFile();
+    return false;
+}
+
+/**
+ * @brief Close the mapped mode (The last process cuts the unused part of the chunk)
+ */
+void ZYLoggingFilePrivate::closeMapped() noexcept
+{
+    LoggingMappedFile *  mapped_file  = this->mappedFile;
+    LoggingMappedState * mapped_state = (mapped_file ? mapped_file->mappedState : nullptr);
+
+    if (!mapped_file) return;
+
+    // Processes that crashed or exited without it leave the preallocated zeros, they are cut when the file is mapped again
+    if (mapped_state->attachCount.fetch_sub(1) == 1)
+    {
+        pthread_mutex_lock(&mapped_state->switchMutex);
+        {
+            uint64_t reserve_cursor = mapped_state->reserveCursor.load();
+            int      ring_idx       = (int)((reserve_cursor >> LOGGING_MAPPED_SHIFT) % LOGGING_MAPPED_RING);
+            uint64_t chunk_used     = ((reserve_cursor & LOGGING_MAPPED_MASK) >= LOGGING_MAPPED_CLOSED ? mapped_state->closedLength : reserve_cursor & LOGGING_MAPPED_MASK);
+            int      file_handle    = open(mapped_state->filePath, O_RDWR | O_CLOEXEC);
+
+            if (chunk_used > mapped_state->chunkLengths[ring_idx]) chunk_used = mapped_state->chunkLengths[ring_idx];
+            if (file_handle != LOGGING_INVALID_HANDLE)
+            {
+                if (mapped_state->chunkLengths[ring_idx] && ftruncate(file_handle, (off_t)(mapped_state->chunkOffsets[ring_idx] + chunk_used)) != 0) DBG_PERROR(ESL_WARNING, "Failed to cut mapped logging file:");
+                close(file_handle);
+            }
+        }
+        pthread_mutex_unlock(&mapped_state->switchMutex);
+        pthread_mutex_destroy(&mapped_state->switchMutex);
+    }
+
+    for (int ring_idx = 0; ring_idx < LOGGING_MAPPED_RING; ring_idx++) __LoggingUnmapViews(mapped_file->chunkViews[ring_idx].exchange(nullptr));
+    __LoggingUnmapViews(mapped_file->retiredViews);
+    if (mapped_file->mapHandle != LOGGING_INVALID_HANDLE) close(mapped_file->mapHandle);
+
+    mapped_state->~LoggingMappedState();
+    munmap(mapped_state, sizeof(LoggingMappedState));
+    delete mapped_file;
+    this->mappedFile = nullptr;
+}
+
+/**
+ * @brief Append one line to a mapped chunk (Lock free, the bytes are reserved by the reservation cursor)
+ *
+ * @param logLevel      Log level (Use execute status level macros)
+ * @param lineDatas     Line content (Without line break)
+ * @param lineLength    Line content length
+ * @param hasHead       Whether to write the line head
+ */
+void ZYLoggingFilePrivate::appendMapped(const int logLevel, const char * lineDatas, const size_t lineLength, const bool hasHead) noexcept
+{
+    LoggingMappedFile *  mapped_file  = this->mappedFile;
+    LoggingMappedState * mapped_state = mapped_file->mappedState;
+    LoggingTimeCache &   time_cache   = __LoggingThreadTime;
+    char                 line_head[LOGGING_HEAD_LENGTH];
+    size_t               head_len     = 0;
+    size_t               total_len    = 0;
+
+    __LoggingUpdateTime(time_cache, __LoggingTime());
+    head_len  = (hasHead ? __LoggingHead(line_head, time_cache, logLevel) : 0);
+    total_len = head_len + lineLength + 1;
+
+    // The first line of a new date switches the file (Lines of the previous date racing with it stay in the new file)
+    if (this->fileOwner->_namingRule == ZYLoggingFile::NR_DATE)
+    {
+        uint64_t file_date = mapped_state->fileDate.load(std::memory_order_relaxed);
+
+        if (memcmp(time_cache.dateString, &file_date, sizeof(file_date)) > 0) this->switchChunk((uint32_t)(mapped_state->reserveCursor.load() >> LOGGING_MAPPED_SHIFT), total_len, time_cache.dateString);
+    }
+
+    mapped_file->copyCount.fetch_add(1);
+    for (;;)
+    {
+        uint64_t reserve_cursor = mapped_state->reserveCursor.fetch_add(total_len);
+        uint32_t chunk_gen      = (uint32_t)(reserve_cursor >> LOGGING_MAPPED_SHIFT);
+        uint64_t chunk_offset   = (reserve_cursor & LOGGING_MAPPED_MASK);
+        int      ring_idx       = (int)(chunk_gen % LOGGING_MAPPED_RING);
+        uint64_t chunk_length   = mapped_state->chunkLengths[ring_idx];
+        char *   chunk_datas    = nullptr;
+
+        if (chunk_offset < chunk_length)
+        {
+            // A failed mapping drops the line, its reserved bytes stay zero
+            if (mapped_state->chunkGens[ring_idx] != chunk_gen || !(chunk_datas = this->mapChunk(chunk_gen))) break;
+
+            if (chunk_offset + total_len <= chunk_length)
+            {
+                char * line_pos = chunk_datas + chunk_offset;
+
+                memcpy(line_pos, line_head, head_len);
+                memcpy(line_pos + head_len, lineDatas, lineLength);
+                line_pos[head_len + lineLength] = '\n';
+                mapped_file->lineCount.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            // Lines never span chunks, the rest of the chunk is padded as a blank line
+            memset(chunk_datas + chunk_offset, ' ', (size_t)(chunk_length - chunk_offset - 1));
+            chunk_datas[chunk_length - 1] = '\n';
+        }
+
+        // The chunk is full, reserve again in the next one
+        mapped_file->copyCount.fetch_sub(1);
+        if (!this->switchChunk(chunk_gen, total_len, time_cache.dateString)) return;
+        mapped_file->copyCount.fetch_add(1);
+    }
+    mapped_file->copyCount.fetch_sub(1);
+}
+
+/**
+ * @brief Get the mapped chunk of the generation (Maps it in this process if not mapped yet)
+ *
+ * @param chunkGen      Chunk generation
+ * @return char*        Chunk datas (Nullptr: failure)
+ */
+char * ZYLoggingFilePrivate::mapChunk(const uint32_t chunkGen) noexcept
+{
+    LoggingMappedFile *  mapped_file  = this->mappedFile;
+    LoggingMappedState * mapped_state = mapped_file->mappedState;
+    int                  ring_idx     = (int)(chunkGen % LOGGING_MAPPED_RING);
+    LoggingMappedView *  chunk_view   = mapped_file->chunkViews[ring_idx].load();
+    LoggingMappedView *  new_view     = nullptr;
+    uint64_t             page_size    = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t             map_offset   = 0;
+    void *               map_datas    = nullptr;
+
+    if (chunk_view && chunk_view->chunkGen == chunkGen) return chunk_view->chunkDatas;
+
+    std::lock_guard<std::mutex> map_locker(mapped_file->mapMutex);
+
+    chunk_view = mapped_file->chunkViews[ring_idx].load();
+    if (chunk_view && chunk_view->chunkGen == chunkGen) return chunk_view->chunkDatas;
+
+    new_view = new (std::nothrow) LoggingMappedView();
+    if (!new_view) return nullptr;
+
+    // A file switched by another process is opened by its path (The line is dropped if it was switched again before the copy)
+    pthread_mutex_lock(&mapped_state->switchMutex);
+    if (mapped_state->chunkGens[ring_idx] == chunkGen && (mapped_file->mapSerial != mapped_state->chunkSerials[ring_idx] || mapped_file->mapHandle == LOGGING_INVALID_HANDLE) && mapped_state->chunkSerials[ring_idx] == mapped_state->fileSerial)
+    {
+        if (mapped_file->mapHandle != LOGGING_INVALID_HANDLE) close(mapped_file->mapHandle);
+        mapped_file->mapHandle = open(mapped_state->filePath, O_RDWR | O_CLOEXEC);
+        mapped_file->mapSerial = mapped_state->fileSerial;
+    }
+    if (mapped_state->chunkGens[ring_idx] == chunkGen && mapped_file->mapSerial == mapped_state->chunkSerials[ring_idx] && mapped_file->mapHandle != LOGGING_INVALID_HANDLE)
+    {
+        map_offset          = mapped_state->chunkOffsets[ring_idx] / page_size * page_size;
+        new_view->chunkGen  = chunkGen;
+        new_view->mapLength = (size_t)(mapped_state->chunkOffsets[ring_idx] - map_offset + mapped_state->chunkLengths[ring_idx]);
+        map_datas           = mmap(nullptr, new_view->mapLength, PROT_READ | PROT_WRITE, MAP_SHARED, mapped_file->mapHandle, (off_t)map_offset);
+        if (map_datas == MAP_FAILED) DBG_PERROR(ESL_WARNING, "Failed to map logging file chunk:");
+    }
+    pthread_mutex_unlock(&mapped_state->switchMutex);
+
+    if (!new_view->mapLength || map_datas == MAP_FAILED)
+    {
+        delete new_view;
+        return nullptr;
+    }
+    new_view->mapDatas   = (char *)map_datas;
+    new_view->chunkDatas = new_view->mapDatas + (mapped_state->chunkOffsets[ring_idx] - map_offset);
+
+    // The replaced view may still be copied into, it is unmapped when this output is the only one copying
+    if (chunk_view)
+    {
+        chunk_view->nextView      = mapped_file->retiredViews;
+        mapped_file->retiredViews = chunk_view;
+    }
+    mapped_file->chunkViews[ring_idx].store(new_view);
+    if (mapped_file->retiredViews && mapped_file->copyCount.load() == 1)
+    {
+        __LoggingUnmapViews(mapped_file->retiredViews);
+        mapped_file->retiredViews = nullptr;
+    }
+
+    return new_view->chunkDatas;
+}
+
+/**
+ * @brief Switch from the full chunk to the next one (Rotates the file if it is over the size, or if the date changed in NR_DATE rule)
+ *
+ * @param chunkGen      Generation of the full chunk
+ * @param minLength     Min length of the next chunk
+ * @param fileDate      Date of the line (Format: "yyyyMMdd")
+ * @return true         Switched (By this or another output)
+ * @return false        Failure
+ */
+bool ZYLoggingFilePrivate::switchChunk(const uint32_t chunkGen, const size_t minLength, const char * fileDate) noexcept
+{
+    LoggingMappedFile *         mapped_file  = this->mappedFile;
+    LoggingMappedState *        mapped_state = mapped_file->mappedState;
+    int                         ring_idx     = (int)(chunkGen % LOGGING_MAPPED_RING);
+    uint64_t                    file_date    = 0;
+    uint64_t                    open_date    = 0;
+    uint64_t                    chunk_offset = 0;
+    uint64_t                    chunk_length = LOGGING_MAPPED_CHUNK;
+    bool                        is_dated     = false;
+    bool                        is_switched  = true;
+    char                        date_string[9];
+    ZYLoggingFile::RotatePolicy rotate_policy;
+
+    memcpy(&file_date, fileDate, sizeof(file_date));
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        rotate_policy = this->rotatePolicy;
+    }
+
+    pthread_mutex_lock(&mapped_state->switchMutex);
+
+    // Another output switched the chunk already
+    if ((uint32_t)(mapped_state->reserveCursor.load() >> LOGGING_MAPPED_SHIFT) != chunkGen)
+    {
+        pthread_mutex_unlock(&mapped_state->switchMutex);
+        return true;
+    }
+
+    // Closed chunk: later reservations are over its end, the reserved bytes before are copied by their outputs
+    {
+        uint64_t reserve_cursor = mapped_state->reserveCursor.load();
+
+        if ((reserve_cursor & LOGGING_MAPPED_MASK) < LOGGING_MAPPED_CLOSED) mapped_state->closedLength = (mapped_state->reserveCursor.fetch_add(LOGGING_MAPPED_CLOSED) & LOGGING_MAPPED_MASK);
+        chunk_offset = mapped_state->chunkOffsets[ring_idx] + (mapped_state->closedLength < mapped_state->chunkLengths[ring_idx] ? mapped_state->closedLength : mapped_state->chunkLengths[ring_idx]);
+    }
+
+    // The file handle of this process follows the switches of the others
+    if (mapped_file->fileSerial != mapped_state->fileSerial || this->fileHandle == LOGGING_INVALID_HANDLE)
+    {
+        struct stat file_stat;
+
+        this->closeFile();
+        memcpy(this->filePath, mapped_state->filePath, sizeof(this->filePath));
+        this->fileHandle = open(this->filePath, O_RDWR | O_CLOEXEC);
+        if (this->fileHandle != LOGGING_INVALID_HANDLE && fstat(this->fileHandle, &file_stat) == 0) this->fileInode = file_stat.st_ino;
+        mapped_file->fileSerial = mapped_state->fileSerial;
+    }
+
+    open_date = mapped_state->fileDate.load();
+    memcpy(date_string, &open_date, sizeof(open_date));
+    date_string[8] = '\0';
+    is_dated       = (this->fileOwner->_namingRule == ZYLoggingFile::NR_DATE && memcmp(fileDate, date_string, sizeof(open_date)) > 0);
+
+    if (is_dated || (rotate_policy.maxFileSize && chunk_offset >= rotate_policy.maxFileSize))
+    {
+        // The preallocated part is cut before the file is switched, the new file may be left by a crashed run
+        if (this->fileHandle != LOGGING_INVALID_HANDLE && ftruncate(this->fileHandle, (off_t)chunk_offset) != 0) DBG_PERROR(ESL_WARNING, "Failed to cut mapped logging file:");
+        if (is_dated)
+        {
+            this->closeFile();
+            this->openFile(fileDate);
+        }
+        else
+        {
+            this->rotateFile(date_string);
+        }
+        chunk_offset = (this->fileHandle != LOGGING_INVALID_HANDLE ? __LoggingMappedEnd(this->fileHandle) : 0);
+
+        memcpy(mapped_state->filePath, this->filePath, sizeof(mapped_state->filePath));
+        if (is_dated) mapped_state->fileDate.store(file_date);
+        mapped_state->fileSerial++;
+        mapped_file->fileSerial = mapped_state->fileSerial;
+        {
+            std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+            this->maintainNeeded = true;
+        }
+    }
+
+    // The chunk ends at the rotation size, a longer line gets a chunk of its own
+    if (rotate_policy.maxFileSize > chunk_offset && rotate_policy.maxFileSize - chunk_offset < chunk_length) chunk_length = rotate_policy.maxFileSize - chunk_offset;
+    if (chunk_length < minLength) chunk_length = minLength;
+
+    // Chunk generations wrap within the high bits of the reservation cursor
+    is_switched = (this->fileHandle != LOGGING_INVALID_HANDLE && this->allocChunk((uint32_t)(((uint64_t)chunkGen + 1) << LOGGING_MAPPED_SHIFT >> LOGGING_MAPPED_SHIFT), chunk_offset, chunk_length));
+    pthread_mutex_unlock(&mapped_state->switchMutex);
+
+    return is_switched;
+}
+
+/**
+ * @brief Preallocate the next chunk and publish it to the outputs (Switch mutex must be locked, or the state is not shared yet)
+ *
+ * @param chunkGen      Chunk generation
+ * @param chunkOffset   File offset of the chunk
+ * @param chunkLength   Chunk length
+ * @return true         Success
+ * @return false        Failure
+ */
+bool ZYLoggingFilePrivate::allocChunk(const uint32_t chunkGen, const uint64_t chunkOffset, const uint64_t chunkLength) noexcept
+{
+    LoggingMappedState * mapped_state = this->mappedFile->mappedState;
+    int                  ring_idx     = (int)(chunkGen % LOGGING_MAPPED_RING);
+    uint64_t             page_size    = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t             map_offset   = chunkOffset / page_size * page_size;
+    int                  alloc_result = 0;
+
+    // Preallocated blocks read as zeros, a crash leaves them after the last copied line
+    alloc_result = posix_fallocate(this->fileHandle, (off_t)map_offset, (off_t)(chunkOffset - map_offset + chunkLength));
+    if (alloc_result != 0 && ftruncate(this->fileHandle, (off_t)(chunkOffset + chunkLength)) != 0)
+    {
+        DBGLOG_WARNING("Failed to allocate mapped logging file chunk: %s", strerror(alloc_result));
+        return false;
+    }
+
+    mapped_state->chunkGens[ring_idx]    = chunkGen;
+    mapped_state->chunkSerials[ring_idx] = mapped_state->fileSerial;
+    mapped_state->chunkOffsets[ring_idx] = chunkOffset;
+    mapped_state->chunkLengths[ring_idx] = chunkLength;
+    mapped_state->closedLength           = 0;
+    mapped_state->reserveCursor.store((uint64_t)chunkGen << LOGGING_MAPPED_SHIFT);
+
+    return true;
+}
+#endif
+
+/**
+ * @brief Open the io_uring of the writer thread (Safe mutex must be locked; Every buffer is allocated and registered)
+ *
+ * @return true         Success
+ * @return false        Failure (Buffers are written by blocking writes)
+ */
+bool ZYLoggingFilePrivate::openUring() noexcept
+{
+    this->uringWanted = true;
+
+#if defined(LOGGING_URING_ENABLE)
+    LoggingUring *         writer_uring = nullptr;
+    struct io_uring_params uring_params;
+    struct iovec           buffer_vecs[LOGGING_BUFFER_COUNT];
+    bool                   is_opened    = false;
+
+    if (this->writerUring) return true;
+    if (!this->writerThread) return false;
+
+    // Registered buffers are pinned once, the free buffers are not used by the writer thread
+    for (int buffer_idx = 0; buffer_idx < LOGGING_BUFFER_COUNT; buffer_idx++)
+    {
+        if (!this->logBuffers[buffer_idx].bufferDatas) this->logBuffers[buffer_idx].bufferDatas = (char *)malloc(LOGGING_BUFFER_LENGTH);
+        if (!this->logBuffers[buffer_idx].bufferDatas) return false;
+        buffer_vecs[buffer_idx].iov_base = this->logBuffers[buffer_idx].bufferDatas;
+        buffer_vecs[buffer_idx].iov_len  = LOGGING_BUFFER_LENGTH;
+    }
+
+    writer_uring = new (std::nothrow) LoggingUring();
+    if (!writer_uring) return false;
+
+    // Detected at runtime: kernels before 5.4 have no single rings mapping, io_uring may be disabled by the system
+    memset(&uring_params, 0, sizeof(uring_params));
+    writer_uring->ringHandle = (int)syscall(__NR_io_uring_setup, LOGGING_BUFFER_COUNT, &uring_params);
+    if (writer_uring->ringHandle >= 0 && (uring_params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        size_t sq_length = uring_params.sq_off.array + uring_params.sq_entries * sizeof(unsigned);
+        size_t cq_length = uring_params.cq_off.cqes + uring_params.cq_entries * sizeof(struct io_uring_cqe);
+        void * map_datas = nullptr;
+
+        writer_uring->ringLength = (sq_length > cq_length ? sq_length : cq_length);
+        map_datas                = mmap(nullptr, writer_uring->ringLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, writer_uring->ringHandle, IORING_OFF_SQ_RING);
+        writer_uring->ringDatas  = (map_datas == MAP_FAILED ? nullptr : map_datas);
+        writer_uring->sqLength   = uring_params.sq_entries * sizeof(struct io_uring_sqe);
+        map_datas                = mmap(nullptr, writer_uring->sqLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, writer_uring->ringHandle, IORING_OFF_SQES);
+        writer_uring->sqEntries  = (map_datas == MAP_FAILED ? nullptr : (struct io_uring_sqe *)map_datas);
+    }
+    if (writer_uring->ringDatas && writer_uring->sqEntries)
+    {
+        char * ring_datas = (char *)writer_uring->ringDatas;
+
+        writer_uring->sqTail    = (unsigned *)(ring_datas + uring_params.sq_off.tail);
+        writer_uring->sqMask    = (unsigned *)(ring_datas + uring_params.sq_off.ring_mask);
+        writer_uring->sqArray   = (unsigned *)(ring_datas + uring_params.sq_off.array);
+        writer_uring->cqHead    = (unsigned *)(ring_datas + uring_params.cq_off.head);
+        writer_uring->cqTail    = (unsigned *)(ring_datas + uring_params.cq_off.tail);
+        writer_uring->cqMask    = (unsigned *)(ring_datas + uring_params.cq_off.ring_mask);
+        writer_uring->cqEntries = (struct io_uring_cqe *)(ring_datas + uring_params.cq_off.cqes);
+        is_opened               = syscall(__NR_io_uring_register, writer_uring->ringHandle, IORING_REGISTER_BUFFERS, buffer_vecs, LOGGING_BUFFER_COUNT) == 0;
+    }
+
+    if (!is_opened)
+    {
+        DBGLOG_INFOMATION("io_uring is not available for logging file (%s), buffers are written by blocking writes.", strerror(errno));
+        __LoggingFreeUring(writer_uring);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        this->writerUring = writer_uring;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Close the io_uring of the writer thread (The writes must be completed, or the process is the child after fork)
+ */
+void ZYLoggingFilePrivate::closeUring() noexcept
+{
+#if defined(LOGGING_URING_ENABLE)
+    __LoggingFreeUring(this->writerUring);
+    this->writerUring = nullptr;
+#endif
+}
+
+/**
+ * @brief Queue one buffer to the io_uring (Called by the writer thread; The buffer is freed by its completion)
+ *
+ * @param bufferIndex   Buffer index
+ * @param rotatePolicy  Rotation policy
+ * @return true         Queued
+ * @return false        Not queued (Write it by blocking write)
+ */
+bool ZYLoggingFilePrivate::queueBuffer(const int bufferIndex, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept
+{
+#if defined(LOGGING_URING_ENABLE)
+    LoggingUring *        writer_uring = this->writerUring;
+    LoggingBuffer &       log_buffer   = this->logBuffers[bufferIndex];
+    const char *          write_datas  = nullptr;
+    size_t                write_len    = 0;
+    size_t                part_len     = 0;
+    unsigned              sq_tail      = 0;
+    unsigned              sq_index     = 0;
+    struct io_uring_sqe * sq_entry     = nullptr;
+
+    if (!writer_uring || !log_buffer.bufferLength) return false;
+    if (this->compressFormat && !this->packBuffer(log_buffer)) return false;
+    write_datas = __LoggingOutput(log_buffer, write_len);
+    part_len    = write_len;
+    if (!this->selectFile(log_buffer, write_datas, part_len, rotatePolicy)) return false;
+
+    // A buffer crossing the rotation size is written in parts by blocking writes, after the queued buffers complete
+    if (part_len < write_len)
+    {
+        this->reapUring(true);
+        return false;
+    }
+
+    // Drained writes start after the previous ones complete, the buffers are appended in order (O_APPEND ignores the offset)
+    sq_tail             = *writer_uring->sqTail;
+    sq_index            = sq_tail & *writer_uring->sqMask;
+    sq_entry            = &writer_uring->sqEntries[sq_index];
+    memset(sq_entry, 0, sizeof(struct io_uring_sqe));
+    sq_entry->opcode    = (log_buffer.frameLength ? IORING_OP_WRITE : IORING_OP_WRITE_FIXED); // Frames are not in the registered buffers
+    sq_entry->flags     = IOSQE_IO_DRAIN;
+    sq_entry->fd        = this->fileHandle;
+    sq_entry->addr      = (uint64_t)(uintptr_t)write_datas;
+    sq_entry->len       = (uint32_t)write_len;
+    sq_entry->buf_index = (uint16_t)(log_buffer.frameLength ? 0 : bufferIndex);
+    sq_entry->user_data = (uint64_t)bufferIndex;
+
+    writer_uring->sqArray[sq_index] = sq_index;
+    __atomic_store_n(writer_uring->sqTail, sq_tail + 1, __ATOMIC_RELEASE);
+    writer_uring->preparedCount++;
+    this->fileSize += write_len;
+
+    if (this->maintainTime && __LoggingTime() >= this->maintainTime) this->maintainFiles(rotatePolicy);
+
+    return true;
+#else
+    (void)bufferIndex;
+    (void)rotatePolicy;
+    return false;
+#endif
+}
+
+/**
+ * @brief Submit the queued buffers and free the written ones (Called by the writer thread without the wait mutex)
+ *
+ * @param isAll         Whether to wait for every write (Otherwise waits for one)
+ */
+void ZYLoggingFilePrivate::reapUring(const bool isAll) noexcept
+{
+#if defined(LOGGING_URING_ENABLE)
+    LoggingUring * writer_uring = this->writerUring;
+
+    while (writer_uring && (writer_uring->preparedCount || writer_uring->inflightCount))
+    {
+        unsigned wait_count = (isAll ? writer_uring->preparedCount + writer_uring->inflightCount : 1);
+        long     submit_len = syscall(__NR_io_uring_enter, writer_uring->ringHandle, writer_uring->preparedCount, wait_count, IORING_ENTER_GETEVENTS, nullptr, 0);
+        int      done_indexes[LOGGING_BUFFER_COUNT];
+        size_t   done_bytes[LOGGING_BUFFER_COUNT];
+        int      done_count = 0;
+
+        // One call submits the queued buffers and waits for the completions
+        if (submit_len >= 0)
+        {
+            writer_uring->preparedCount -= (unsigned)submit_len;
+            writer_uring->inflightCount += (unsigned)submit_len;
+        }
+        else if (errno != EINTR && errno != EAGAIN && errno != EBUSY && writer_uring->preparedCount)
+        {
+            unsigned sq_tail = *writer_uring->sqTail;
+
+            // The queued buffers are taken back from the ring and written by blocking writes
+            DBG_PERROR(ESL_WARNING, "Failed to submit logging file buffers:");
+            for (unsigned sq_pos = sq_tail - writer_uring->preparedCount; sq_pos != sq_tail; sq_pos++)
+            {
+                int          buffer_idx  = (int)writer_uring->sqEntries[sq_pos & *writer_uring->sqMask].user_data;
+                size_t       write_len   = 0;
+                const char * write_datas = __LoggingOutput(this->logBuffers[buffer_idx], write_len);
+
+                done_indexes[done_count] = buffer_idx;
+                done_bytes[done_count++] = (this->fileHandle != LOGGING_INVALID_HANDLE && __LoggingWrite(this->fileHandle, &write_datas, &write_len, 1) ? write_len : 0);
+            }
+            __atomic_store_n(writer_uring->sqTail, sq_tail - writer_uring->preparedCount, __ATOMIC_RELEASE);
+            writer_uring->preparedCount = 0;
+        }
+
+        {
+            unsigned cq_head = *writer_uring->cqHead;
+            unsigned cq_tail = __atomic_load_n(writer_uring->cqTail, __ATOMIC_ACQUIRE);
+
+            for (; cq_head != cq_tail && done_count < LOGGING_BUFFER_COUNT; cq_head++)
+            {
+                struct io_uring_cqe * cq_entry     = &writer_uring->cqEntries[cq_head & *writer_uring->cqMask];
+                int                   buffer_idx   = (int)cq_entry->user_data;
+                size_t                output_len   = 0;
+                const char *          output_datas = __LoggingOutput(this->logBuffers[buffer_idx], output_len);
+                size_t                write_len    = (cq_entry->res > 0 ? (size_t)cq_entry->res : 0);
+
+                // A short or failed write is finished by a blocking write (The file is not switched until the writes complete)
+                if (write_len < output_len)
+                {
+                    const char * rest_datas = output_datas + write_len;
+                    size_t       rest_len   = output_len - write_len;
+
+                    if (this->fileHandle != LOGGING_INVALID_HANDLE && __LoggingWrite(this->fileHandle, &rest_datas, &rest_len, 1)) write_len = output_len;
+                }
+                done_indexes[done_count] = buffer_idx;
+                done_bytes[done_count++] = write_len;
+                writer_uring->inflightCount--;
+            }
+            __atomic_store_n(writer_uring->cqHead, cq_head, __ATOMIC_RELEASE);
+        }
+
+        if (done_count)
+        {
+            std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+
+            for (int done_idx = 0; done_idx < done_count; done_idx++)
+            {
+                LoggingBuffer & log_buffer = this->logBuffers[done_indexes[done_idx]];
+
+                this->doneBuffer(log_buffer, log_buffer.bufferLength, done_bytes[done_idx]);
+                this->freeIndexes[this->freeCount++] = done_indexes[done_idx];
+                this->writerStats.uringCount++;
+            }
+            this->idleCond.notify_all();
+        }
+
+        if (!isAll) break;
+    }
+#else
+    (void)isAll;
+#endif
+}
+
+/**
+ * @brief Hand the active buffer to the writer thread and take a free one (Safe mutex must be locked; Waits if no buffer is free)
+ *
+ * @return size_t       Submitted buffers count including the active buffer (Used to wait for it)
+ */
+size_t ZYLoggingFilePrivate::submitBuffer() noexcept
+{
+    std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+    size_t                       submit_count = ++this->submitCount;
+
+    if (!this->writerThread)
+    {
+        ZYLoggingFile::RotatePolicy rotate_policy;
+        LoggingBuffer &             log_buffer  = this->logBuffers[this->activeIndex];
+        size_t                      buffer_len  = log_buffer.bufferLength;
+        size_t                      write_bytes = 0;
+
+        this->takePolicy(rotate_policy);
+        write_bytes = this->writeBuffer(log_buffer, rotate_policy);
+        this->doneBuffer(log_buffer, buffer_len, write_bytes);
+        return submit_count;
+    }
+
+    this->pendBuffer();
+    this->wakeCond.notify_one();
+
+    if (!this->freeCount)
+    {
+        // Back-pressure: every other buffer is waiting for the writer thread
+        std::chrono::steady_clock::time_point stall_time = std::chrono::steady_clock::now();
+
+        while (!this->freeCount) this->idleCond.wait(wait_locker);
+        this->writerStats.stallCount++;
+        this->writerStats.stallTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stall_time).count();
+    }
+    this->activeIndex = this->freeIndexes[--this->freeCount];
+
+    return submit_count;
+}
+
+/**
+ * @brief Queue the active buffer for the writer thread (Safe and wait mutexes must be locked; The caller takes the next active buffer)
+ */
+void ZYLoggingFilePrivate::pendBuffer() noexcept
+{
+    this->pendingIndexes[(this->pendingHead + this->pendingCount) % LOGGING_BUFFER_COUNT] = this->activeIndex;
+    this->pendingCount++;
+    if ((size_t)this->pendingCount > this->writerStats.pendingMax) this->writerStats.pendingMax = this->pendingCount;
+}
+
+/**
+ * @brief Wait until the writer thread has written the buffers
+ *
+ * @param submitCount   Submitted buffers count to wait for
+ */
+void ZYLoggingFilePrivate::waitWritten(const size_t submitCount) noexcept
+{
+    std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+    while (this->writtenCount < submitCount) this->idleCond.wait(wait_locker);
+}
+
+/**
+ * @brief Account one written buffer (Wait mutex must be locked)
+ *
+ * @param logBuffer     Written buffer
+ * @param bufferLength  Buffered length before the write
+ * @param writeBytes    Written bytes
+ */
+void ZYLoggingFilePrivate::doneBuffer(LoggingBuffer & logBuffer, const size_t bufferLength, const size_t writeBytes) noexcept
+{
+    size_t output_len = (logBuffer.frameLength ? logBuffer.frameLength : bufferLength);
+
+    logBuffer.bufferLength = 0;
+    logBuffer.frameLength  = 0;
+    this->writtenCount++;
+    this->writerStats.writeCount++;
+    this->writerStats.writeBytes += writeBytes;
+    if (writeBytes) this->writerStats.lineBytes += bufferLength;
+
+    // Dropped lines are counted as written, a sync does not make them durable
+    if (logBuffer.lineTicket > this->writtenTicket) this->writtenTicket = logBuffer.lineTicket;
+    if (writeBytes < output_len) this->loseTickets(logBuffer.firstTicket, logBuffer.lineTicket);
+}
+
+/**
+ * @brief Record lost lines (Wait mutex must be locked)
+ *
+ * @param firstTicket   Ticket of the first lost line
+ * @param lastTicket    Ticket of the last lost line
+ */
+void ZYLoggingFilePrivate::loseTickets(const size_t firstTicket, const size_t lastTicket) noexcept
+{
+    LoggingLostRange * last_range = (this->lostCount ? &this->lostRanges[this->lostCount - 1] : nullptr);
+
+    if (!firstTicket || firstTicket > lastTicket) return;
+
+    // Losses come mostly in ticket order, a range touching the last one extends it
+    if (last_range && firstTicket <= last_range->lastTicket + 1 && lastTicket + 1 >= last_range->firstTicket)
+    {
+        if (firstTicket < last_range->firstTicket) last_range->firstTicket = firstTicket;
+        if (lastTicket > last_range->lastTicket) last_range->lastTicket = lastTicket;
+        return;
+    }
+
+    // A full list merges its two oldest ranges, a line between them is reported lost rather than durable
+    if (this->lostCount == LOGGING_LOST_COUNT)
+    {
+        if (this->lostRanges[1].firstTicket > this->lostRanges[0].firstTicket) this->lostRanges[1].firstTicket = this->lostRanges[0].firstTicket;
+        if (this->lostRanges[1].lastTicket < this->lostRanges[0].lastTicket) this->lostRanges[1].lastTicket = this->lostRanges[0].lastTicket;
+        memmove(this->lostRanges, this->lostRanges + 1, (LOGGING_LOST_COUNT - 1) * sizeof(LoggingLostRange));
+        this->lostCount--;
+    }
+    this->lostRanges[this->lostCount++] = { firstTicket, lastTicket };
+}
+
+/**
+ * @brief Check whether a line is lost (Wait mutex must be locked)
+ *
+ * @param lineTicket    Line ticket
+ * @return true         The write or sync of the line failed
+ * @return false        No loss recorded for the line
+ */
+bool ZYLoggingFilePrivate::isLost(const size_t lineTicket) const noexcept
+{
+    for (int range_idx = 0; range_idx < this->lostCount; range_idx++)
+    {
+        if (lineTicket >= this->lostRanges[range_idx].firstTicket && lineTicket <= this->lostRanges[range_idx].lastTicket) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Compress the buffered lines into one frame (Called by the writer before the buffer is written; CF_LZ4 only)
+ *
+ * @param logBuffer     Output buffer
+ * @return true         Success
+ * @return false        Failure (Out of memory; The lines are dropped, a text buffer would corrupt the file)
+ */
+bool ZYLoggingFilePrivate::packBuffer(LoggingBuffer & logBuffer) noexcept
+{
+    if (!logBuffer.frameDatas) logBuffer.frameDatas = (char *)malloc(__LoggingFrameBound(LOGGING_BUFFER_LENGTH));
+    if (!logBuffer.frameDatas) return false;
+
+    logBuffer.frameLength = __LoggingFrame(logBuffer.frameDatas, logBuffer.bufferDatas, logBuffer.bufferLength);
+
+    return true;
+}
+
+/**
+ * @brief Hand the active buffer to the writer thread and wait until it is written (Locks the safe mutex)
+ */
+void ZYLoggingFilePrivate::flush() noexcept
+{
+    ZYLoggingFile::SafeMutex * safe_lock    = this->fileOwner->_safeLock;
+    size_t                     submit_count = 0;
+
+    __LoggingLock(safe_lock);
+    if (this->logBuffers[this->activeIndex].bufferLength)
+    {
+        submit_count = this->submitBuffer();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        submit_count = this->submitCount;
+    }
+    __LoggingUnlock(safe_lock);
+
+    this->waitWritten(submit_count);
+}
+
+/**
+ * @brief Wait until the line is synced (Locks the safe mutex)
+ *
+ * @param lineTicket    Line ticket
+ * @return true         The line is on the disk
+ * @return false        The line may be lost
+ */
+bool ZYLoggingFilePrivate::waitDurable(const size_t lineTicket) noexcept
+{
+    ZYLoggingFile::SafeMutex * safe_lock  = this->fileOwner->_safeLock;
+    LoggingBuffer *            log_buffer = nullptr;
+    bool                       is_direct  = false;
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        if (this->syncLevel == ZYLoggingFile::DL_NONE) return false;
+    }
+
+    // The line may still be in the active buffer
+    __LoggingLock(safe_lock);
+    if (!lineTicket || lineTicket > this->lineCount)
+    {
+        __LoggingUnlock(safe_lock);
+        return false;
+    }
+    log_buffer = &this->logBuffers[this->activeIndex];
+    if (log_buffer->bufferLength && log_buffer->lineTicket >= lineTicket) this->submitBuffer();
+
+    // Buffers are written by the outputs if the writer thread failed to start, the sync is done here too
+    is_direct = !this->writerThread;
+    if (is_direct) this->syncFile();
+    __LoggingUnlock(safe_lock);
+
+    {
+        std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+        // Callers that wait during a sync are covered together by the next one
+        if (!is_direct && this->syncLevel == ZYLoggingFile::DL_GROUP && this->syncTicket < lineTicket)
+        {
+            this->syncTicket = lineTicket;
+            this->wakeCond.notify_one();
+        }
+        while (!is_direct && this->syncedTicket < lineTicket && this->syncLevel != ZYLoggingFile::DL_NONE) this->idleCond.wait(wait_locker);
+
+        return this->syncedTicket >= lineTicket && !this->isLost(lineTicket);
+    }
+}
+
+/**
+ * @brief Sync the written lines (Called by the writer thread without the wait mutex, or by the outputs if it failed to start)
+ */
+void ZYLoggingFilePrivate::syncFile() noexcept
+{
+    std::chrono::steady_clock::time_point sync_time   = std::chrono::steady_clock::now();
+    size_t                                sync_ticket = 0;
+    bool                                  is_synced   = !this->syncLost;
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+        sync_ticket = this->writtenTicket;
+    }
+
+#if defined(_LINUX)
+    if (this->fileHandle != LOGGING_INVALID_HANDLE && fdatasync(this->fileHandle) != 0) is_synced = false;
+
+    // A new file is found after a crash only if its directory entry is synced too
+    if (!this->dirSynced && this->fileHandle != LOGGING_INVALID_HANDLE)
+    {
+        int dir_handle = open(this->fileOwner->_dirPath ? this->fileOwner->_dirPath : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+        this->dirSynced = (dir_handle != LOGGING_INVALID_HANDLE && fsync(dir_handle) == 0);
+        if (dir_handle != LOGGING_INVALID_HANDLE) close(dir_handle);
+        if (!this->dirSynced) is_synced = false;
+    }
+#elif defined(_WINDOWS)
+    if (this->fileHandle != LOGGING_INVALID_HANDLE && !::FlushFileBuffers(this->fileHandle)) is_synced = false;
+#endif
+    this->syncLost = false;
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->waitMutex);
+
+        // A failed sync loses only the lines written since the last one, earlier lines are already on the disk
+        if (!is_synced) this->loseTickets(this->syncedTicket + 1, sync_ticket);
+        if (sync_ticket > this->syncedTicket) this->syncedTicket = sync_ticket;
+        this->syncDue = __LoggingTime() + this->syncInterval;
+        this->writerStats.syncCount++;
+        this->writerStats.syncTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sync_time).count();
+        this->idleCond.notify_all();
+    }
+}
+
+/**
+ * @brief Writer thread (Writes the waiting buffers in order)
+ */
+void ZYLoggingFilePrivate::writeLoop() noexcept
+{
+    LoggingFileGuard             file_guard(this);
+    std::unique_lock<std::mutex> wait_locker(this->waitMutex);
+
+    for (;;)
+    {
+        if (this->pendingCount)
+        {
+            int                         buffer_idx  = this->pendingIndexes[this->pendingHead];
+            size_t                      buffer_len  = this->logBuffers[buffer_idx].bufferLength;
+            size_t                      write_bytes = 0;
+            ZYLoggingFile::RotatePolicy rotate_policy;
+
+            this->pendingHead = (this->pendingHead + 1) % LOGGING_BUFFER_COUNT;
+            this->pendingCount--;
+            this->takePolicy(rotate_policy);
+
+            // Queued buffers are submitted together when no other buffer is waiting
+            wait_locker.unlock();
+            if (this->queueBuffer(buffer_idx, rotate_policy))
+            {
+                wait_locker.lock();
+                continue;
+            }
+            write_bytes = this->writeBuffer(this->logBuffers[buffer_idx], rotate_policy);
+            wait_locker.lock();
+
+            this->doneBuffer(this->logBuffers[buffer_idx], buffer_len, write_bytes);
+            this->freeIndexes[this->freeCount++] = buffer_idx;
+            this->idleCond.notify_all();
+        }
+#if defined(LOGGING_URING_ENABLE)
+        else if (this->writerUring && (this->writerUring->preparedCount || this->writerUring->inflightCount))
+        {
+            wait_locker.unlock();
+            {
+                std::lock_guard<std::mutex> file_locker(this->fileMutex);
+                this->reapUring(false);
+            }
+            wait_locker.lock();
+        }
+#endif
+        else if (this->syncLevel != ZYLoggingFile::DL_NONE && this->writtenTicket > this->syncedTicket && (this->syncTicket > this->syncedTicket || (this->syncLevel == ZYLoggingFile::DL_PERIODIC && __LoggingTime() >= this->syncDue)))
+        {
+            // Every submitted buffer is written, one sync covers the callers waiting for them
+            wait_locker.unlock();
+            {
+                std::lock_guard<std::mutex> file_locker(this->fileMutex);
+                this->syncFile();
+            }
+            wait_locker.lock();
+        }
+        else if (this->writerStop)
+        {
+            break;
+        }
+        else if (this->wakeCond.wait_for(wait_locker, std::chrono::milliseconds(this->syncLevel == ZYLoggingFile::DL_PERIODIC && this->syncInterval < LOGGING_FLUSH_INTERVAL ? this->syncInterval : LOGGING_FLUSH_INTERVAL)) == std::cv_status::timeout && !this->pendingCount && !this->writerStop)
+        {
+            ZYLoggingFile::RotatePolicy rotate_policy;
+
+            this->takePolicy(rotate_policy);
+
+            // Idle for the flush interval, take the partly filled buffer (Skipped if an output holds the safe mutex, it may be waiting for this thread)
+            wait_locker.unlock();
+            if (__LoggingTryLock(this->fileOwner->_safeLock))
+            {
+                // Only this thread frees buffers, so it never waits for one; If outputs filled the others meanwhile, they are written first
+                wait_locker.lock();
+                if (this->logBuffers[this->activeIndex].bufferLength && this->freeCount)
+                {
+                    this->submitCount++;
+                    this->pendBuffer();
+                    this->activeIndex = this->freeIndexes[--this->freeCount];
+                }
+                wait_locker.unlock();
+                __LoggingUnlock(this->fileOwner->_safeLock);
+            }
+            if (this->maintainTime && __LoggingTime() >= this->maintainTime)
+            {
+                std::lock_guard<std::mutex> file_locker(this->fileMutex);
+
+                // The opened file is switched by the mapped outputs under the switch mutex
+#if defined(_LINUX)
+                if (this->mappedFile) pthread_mutex_lock(&this->mappedFile->mappedState->switchMutex);
+                this->maintainFiles(rotate_policy);
+                if (this->mappedFile) pthread_mutex_unlock(&this->mappedFile->mappedState->switchMutex);
+#else
+                this->maintainFiles(rotate_policy);
+#endif
+            }
+            wait_locker.lock();
+        }
+    }
+}
+
+/**
+ * @brief Copy the rotation policy for the writer thread (Wait mutex must be locked)
+ *
+ * @param rotatePolicy  Output rotation policy
+ */
+void ZYLoggingFilePrivate::takePolicy(ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept
+{
+    rotatePolicy   = this->rotatePolicy;
+    this->fileSync = (this->syncLevel != ZYLoggingFile::DL_NONE);
+
+    // A new retention applies to the existing rotated files, a file rotated by a mapped chunk switch is maintained here too
+    if (this->maintainNeeded)
+    {
+        this->maintainNeeded = false;
+        this->maintainTime  = __LoggingTime();
+    }
+}
+
+/**
+ * @brief Open or rotate the file for the next part of one buffer (Called before the part is written)
+ *
+ * @param logBuffer     Output buffer
+ * @param partDatas     Part datas (Rest of the buffered lines, or the compressed frame)
+ * @param partLength    Part length (Cut to the lines that fit the file; A frame is not cut)
+ * @param rotatePolicy  Rotation policy
+ * @return true         The file is opened
+ * @return false        No file is opened (The lines are dropped)
+ */
+bool ZYLoggingFilePrivate::selectFile(const LoggingBuffer & logBuffer, const char * partDatas, size_t & partLength, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept
+{
+    size_t max_size = rotatePolicy.maxFileSize;
+    size_t fit_len  = partLength;
+
+    // The new file is opened here, outputs never wait for the rotation
+    if (!this->prepareFile(logBuffer.bufferDate, max_size != 0) || !max_size) return this->fileHandle != LOGGING_INVALID_HANDLE;
+
+    // Text lines fill the file up to the size, the rest goes to the next file (Compressed frames count by their length and are not cut)
+    if (!logBuffer.frameLength) fit_len = __LoggingFitLength(partDatas, partLength, (max_size > this->fileSize ? max_size - this->fileSize : 0));
+    if (this->fileSize && (!fit_len || this->fileSize + fit_len > max_size))
+    {
+        this->rotateFile(logBuffer.bufferDate);
+        this->maintainTime = __LoggingTime();
+        if (!logBuffer.frameLength) fit_len = __LoggingFitLength(partDatas, partLength, max_size);
+    }
+
+    // A line longer than the size is a file of its own
+    if (!fit_len)
+    {
+        const char * line_end = (const char *)memchr(partDatas, '\n', partLength);
+
+        fit_len = (line_end ? (size_t)(line_end - partDatas) + 1 : partLength);
+    }
+    partLength = fit_len;
+
+    return this->fileHandle != LOGGING_INVALID_HANDLE;
+}
+
+/**
+ * @brief Write one buffer to the file (Called by the writer thread, or by the outputs if it failed to start)
+ *
+ * @param logBuffer     Output buffer
+ * @param rotatePolicy  Rotation policy
+ * @return size_t       Written bytes
+ */
+size_t ZYLoggingFilePrivate::writeBuffer(LoggingBuffer & logBuffer, const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept
+{
+    size_t write_bytes = 0;
+
+    if (logBuffer.bufferLength)
+    {
+        const char * write_datas = nullptr;
+        size_t       output_len  = 0;
+
+        // A failed write drops the lines without logging, a full disk would log every buffer (A buffer packed by queueBuffer() is not packed again)
+        if (!this->compressFormat || logBuffer.frameLength || this->packBuffer(logBuffer))
+        {
+            write_datas = __LoggingOutput(logBuffer, output_len);
+
+            // Lines crossing the rotation size are written in parts, each file ends at a whole line
+            while (write_bytes < output_len)
+            {
+                const char * part_datas = write_datas + write_bytes;
+                size_t       part_len   = output_len - write_bytes;
+
+                if (!this->selectFile(logBuffer, part_datas, part_len, rotatePolicy) || !__LoggingWrite(this->fileHandle, &part_datas, &part_len, 1)) break;
+                write_bytes    += part_len;
+                this->fileSize += part_len;
+            }
+        }
+        logBuffer.bufferLength = 0;
+    }
+
+    if (this->maintainTime && __LoggingTime() >= this->maintainTime) this->maintainFiles(rotatePolicy);
+
+    return write_bytes;
+}
+
+/**
+ * @brief Rotate the file (Renames the file and opens a new one; Called by the writer thread, or by the mapped chunk switch)
+ *
+ * @param fileDate      File date (Format: "yyyyMMdd"; Used in NR_DATE rule)
+ */
+void ZYLoggingFilePrivate::rotateFile(const char * fileDate) noexcept
+{
+    char         rotate_path[LOGGING_PATH_LENGTH];
+    char         rotate_time[16];
+    const char * file_suffix = (this->compressFormat == ZYLoggingFile::CF_LZ4 ? ".log.lz4" : ".log");
+    int          stem_length = (int)(strlen(this->filePath) - strlen(file_suffix)); // File path without the suffix
+    long long    time_total  = __LoggingTime();
+    time_t       time_second = (time_t)(time_total / 1000);
+    struct tm    time_local;
+
+#if defined(_LINUX)
+    localtime_r(&time_second, &time_local);
+#elif defined(_WINDOWS)
+    localtime_s(&time_local, &time_second);
+#endif
+    strftime(rotate_time, sizeof(rotate_time), "%Y%m%d-%H%M%S", &time_local);
+
+    // Rotated file name: "<name>.<yyyyMMdd-hhmmss.zzz>[-n].log[.lz4]"
+    for (int name_idx = 0; name_idx < 100; name_idx++)
+    {
+        char gzip_path[LOGGING_PATH_LENGTH + 3];
+
+        if (name_idx)
+            snprintf(rotate_path, sizeof(rotate_path), "%.*s.%s.%03d-%d%s", stem_length, this->filePath, rotate_time, (int)(time_total % 1000), name_idx, file_suffix);
+        else
+            snprintf(rotate_path, sizeof(rotate_path), "%.*s.%s.%03d%s", stem_length, this->filePath, rotate_time, (int)(time_total % 1000), file_suffix);
+        snprintf(gzip_path, sizeof(gzip_path), "%s.gz", rotate_path);
+        if (!__LoggingExists(rotate_path) && !__LoggingExists(gzip_path)) break;
+    }
+
+#if defined(_LINUX)
+    {
+        bool        is_locked = this->openLock() && __LoggingLockFile(this->lockHandle, 0, F_WRLCK, true);
+        struct stat path_stat;
+
+        // The rotation lock lets one process rotate the file, the others see another inode and reopen it
+        if (stat(this->filePath, &path_stat) == 0 && path_stat.st_ino == this->fileInode && rename(this->filePath, rotate_path) != 0) DBG_PERROR(ESL_WARNING, "Failed to rotate logging file:");
+        this->closeFile();
+        this->openFile(fileDate);
+
+        if (is_locked) __LoggingLockFile(this->lockHandle, 0, F_UNLCK, false);
+    }
+#elif defined(_WINDOWS)
+    this->closeFile();
+    if (!::MoveFileExA(this->filePath, rotate_path, 0)) DBG_PERROR(ESL_WARNING, "Failed to rotate logging file:");
+    this->openFile(fileDate);
+#endif
+}
+
+/**
+ * @brief Maintain the rotated files (Removes the files over the retention, compresses the others; Called by the writer thread)
+ *
+ * @param rotatePolicy  Rotation policy
+ */
+void ZYLoggingFilePrivate::maintainFiles(const ZYLoggingFile::RotatePolicy & rotatePolicy) noexcept
+{
+    this->maintainTime = 0;
+
+#if defined(_LINUX)
+    const char *     dir_path     = (this->fileOwner->_dirPath ? this->fileOwner->_dirPath : ".");
+    const char *     file_name    = this->fileOwner->_fileName;
+    size_t           name_length  = strlen(file_name);
+    const char *     open_name    = strrchr(this->filePath, PATH_SEPARATOR);
+    LoggingRotated * rotated_list = nullptr;
+    size_t           list_count   = 0;
+    size_t           list_length  = 0;
+    size_t           kept_bytes   = 0;
+    long long        time_total   = __LoggingTime();
+    bool             is_compress  = false;
+    DIR *            dir_handle   = nullptr;
+    struct dirent *  dir_entry    = nullptr;
+
+    this->reapCompress(false);
+    if (!rotatePolicy.keepFiles && !rotatePolicy.keepBytes && !rotatePolicy.compressFiles) return;
+
+    // The maintenance lock lets one process maintain the rotated files, it is held while the compressions run
+    if (!this->maintainLocked)
+    {
+        if (!this->openLock() || !__LoggingLockFile(this->lockHandle, 1, F_WRLCK, false)) return;
+        this->maintainLocked = true;
+    }
+    open_name   = (open_name ? open_name + 1 : this->filePath);
+    is_compress = (rotatePolicy.compressFiles && !this->compressCount); // Running compressions are waited for first, their files are still listed
+
+    // Rotated files: "<name>.<yyyyMMdd-hhmmss.zzz>[-n].log[.gz|.lz4]" and "<name>_<yyyyMMdd>[...].log[.gz|.lz4]" except the opened file
+    dir_handle = opendir(dir_path);
+    while (dir_handle && (dir_entry = readdir(dir_handle)))
+    {
+        const char * entry_name  = dir_entry->d_name;
+        size_t       entry_len   = strlen(entry_name);
+        char         entry_path[LOGGING_PATH_LENGTH];
+        struct stat  entry_stat;
+
+        if (entry_len <= name_length + 5 || entry_len >= sizeof(rotated_list->fileName) || strncmp(entry_name, file_name, name_length) != 0) continue;
+        if ((entry_name[name_length] != '.' && entry_name[name_length] != '_') || entry_name[name_length + 1] < '0' || entry_name[name_length + 1] > '9') continue;
+        if (strcmp(entry_name + entry_len - 4, ".log") != 0 && (entry_len < 7 || strcmp(entry_name + entry_len - 7, ".log.gz") != 0) && (entry_len < 8 || strcmp(entry_name + entry_len - 8, ".log.lz4") != 0)) continue;
+        if (strcmp(entry_name, open_name) == 0) continue;
+
+        snprintf(entry_path, sizeof(entry_path), "%s%c%s", dir_path, PATH_SEPARATOR, entry_name);
+        if (stat(entry_path, &entry_stat) != 0 || !S_ISREG(entry_stat.st_mode)) continue;
+
+        if (list_count == list_length)
+        {
+            LoggingRotated * new_list = (LoggingRotated *)realloc(rotated_list, (list_length + 64) * sizeof(LoggingRotated));
+
+            if (!new_list) break;
+            rotated_list  = new_list;
+            list_length  += 64;
+        }
+        memcpy(rotated_list[list_count].fileName, entry_name, entry_len + 1);
+        rotated_list[list_count].modifyTime = (long long)entry_stat.st_mtim.tv_sec * 1000000000LL + entry_stat.st_mtim.tv_nsec;
+        rotated_list[list_count].fileSize   = (size_t)entry_stat.st_size;
+        list_count++;
+    }
+    if (dir_handle) closedir(dir_handle);
+    if (list_count) qsort(rotated_list, list_count, sizeof(LoggingRotated), __LoggingCompareRotated);
+
+    for (size_t list_idx = 0; list_idx < list_count; list_idx++)
+    {
+        LoggingRotated & rotated_file = rotated_list[list_idx];
+        char             rotated_path[LOGGING_PATH_LENGTH];
+        size_t           name_len     = strlen(rotated_file.fileName);
+        bool             is_packed    = strcmp(rotated_file.fileName + name_len - 3, ".gz") == 0 || strcmp(rotated_file.fileName + name_len - 4, ".lz4") == 0;
+
+        snprintf(rotated_path, sizeof(rotated_path), "%s%c%s", dir_path, PATH_SEPARATOR, rotated_file.fileName);
+
+        // Retention: the newest files within the count and the bytes are kept
+        if ((rotatePolicy.keepFiles > 0 && list_idx >= (size_t)rotatePolicy.keepFiles) || (rotatePolicy.keepBytes && kept_bytes + rotated_file.fileSize > rotatePolicy.keepBytes))
+        {
+            unlink(rotated_path);
+            continue;
+        }
+        kept_bytes += rotated_file.fileSize;
+
+        if (!rotatePolicy.compressFiles || is_packed) continue;
+
+        // Other processes may still append their last buffer to a recently rotated file, it is compressed later
+        if (!is_compress || this->compressCount >= LOGGING_COMPRESS_COUNT || rotated_file.modifyTime / 1000000LL + LOGGING_COMPRESS_DELAY > time_total)
+        {
+            if (!this->maintainTime) this->maintainTime = time_total + LOGGING_FLUSH_INTERVAL;
+            continue;
+        }
+
+        {
+            char *  spawn_args[] = {(char *)"gzip", (char *)"-f", (char *)"--", rotated_path, nullptr};
+            pid_t   spawn_pid    = 0;
+            int     spawn_result = posix_spawnp(&spawn_pid, "gzip", nullptr, nullptr, spawn_args, environ);
+
+            if (spawn_result == 0)
+                this->compressPids[this->compressCount++] = spawn_pid;
+            else
+                DBGLOG_WARNING("Failed to start gzip for rotated logging file: %s", strerror(spawn_result));
+        }
+    }
+    free(rotated_list);
+
+    // Compressions started above are waited for by the next maintenance
+    if (this->compressCount && !this->maintainTime) this->maintainTime = time_total + LOGGING_FLUSH_INTERVAL;
+    if (!this->compressCount && !this->maintainTime)
+    {
+        __LoggingLockFile(this->lockHandle, 1, F_UNLCK, false);
+        this->maintainLocked = false;
+    }
+#else
+    (void)rotatePolicy;
+#endif
+}
+
+/**
+ * @brief Open the lock file (Lock file: "<dir>/<name>.lock"; Shared by the rotation and the maintenance)
+ *
+ * @return true         Success
+ * @return false        Failure
+ */
+bool ZYLoggingFilePrivate::openLock() noexcept
+{
+#if defined(_LINUX)
+    if (this->lockHandle == LOGGING_INVALID_HANDLE)
+    {
+        char lock_path[LOGGING_PATH_LENGTH];
+
+        snprintf(lock_path, sizeof(lock_path), "%s%c%s.lock", this->fileOwner->_dirPath ? this->fileOwner->_dirPath : ".", PATH_SEPARATOR, this->fileOwner->_fileName);
+        this->lockHandle = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    }
+
+    return this->lockHandle != LOGGING_INVALID_HANDLE;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Reap the finished compressions
+ *
+ * @param isWait        Whether to wait for the running compressions
+ */
+void ZYLoggingFilePrivate::reapCompress(const bool isWait) noexcept
+{
+#if defined(_LINUX)
+    for (int compress_idx = 0; compress_idx < this->compressCount;)
+    {
+        int   wait_status = 0;
+        pid_t wait_pid    = waitpid(this->compressPids[compress_idx], &wait_status, isWait ? 0 : WNOHANG);
+
+        if (wait_pid == 0 || (wait_pid < 0 && errno == EINTR))
+        {
+            compress_idx++;
+            continue;
+        }
+
+        // Finished, or reaped by a SIGCHLD handler of the process (ECHILD)
+        this->compressPids[compress_idx] = this->compressPids[--this->compressCount];
+    }
+#else
+    (void)isWait;
+#endif
+}
+
+/**
+ * @brief Update the time cache (Hands the active buffer to the writer thread if the date changed in NR_DATE rule)
+ *
+ * @param timeTotal     Current time (Milliseconds since epoch)
+ */
+void ZYLoggingFilePrivate::updateTime(const long long timeTotal) noexcept
+{
+    LoggingBuffer & log_buffer = this->logBuffers[this->activeIndex];
+
+    if (__LoggingUpdateTime(this->timeCache, timeTotal) && this->fileOwner->_namingRule == ZYLoggingFile::NR_DATE && log_buffer.bufferLength && memcmp(log_buffer.bufferDate, this->timeCache.dateString, sizeof(log_buffer.bufferDate)) != 0) this->submitBuffer();
+}
+
+/**
+ * @brief Make sure the file of the date is opened (Reopens it if the date changed in NR_DATE rule, or if another process rotated it)
+ *
+ * @param fileDate      File date (Format: "yyyyMMdd")
+ * @param isSized       Whether to refresh the file size (Size rotation is enabled)
+ * @return true         Success
+ * @return false        Failure
+ */
+bool ZYLoggingFilePrivate::prepareFile(const char * fileDate, const bool isSized) noexcept
+{
+    if (this->fileOwner->_namingRule == ZYLoggingFile::NR_DATE && this->fileHandle != LOGGING_INVALID_HANDLE && memcmp(this->fileDate, fileDate, sizeof(this->fileDate)) != 0)
+    {
+        // The file of the previous date is rotated
+        this->closeFile();
+        this->maintainTime = __LoggingTime();
+    }
+#if defined(_LINUX)
+    else if (isSized && this->fileHandle != LOGGING_INVALID_HANDLE)
+    {
+        struct stat path_stat;
+
+        // Other processes append to the file too, and one of them may have rotated it
+        if (stat(this->filePath, &path_stat) != 0 || path_stat.st_ino != this->fileInode)
+            this->closeFile();
+        else
+            this->fileSize = (size_t)path_stat.st_size;
+    }
+#endif
+    if (this->fileHandle == LOGGING_INVALID_HANDLE) return this->openFile(fileDate);
+
+    return true;
+}
+
+/**
+ * @brief Open the file (Kept open across lines; Creates the directory if it does not exist)
+ *
+ * @param fileDate      File date (Format: "yyyyMMdd"; Used in NR_DATE rule)
+ * @return true         Success
+ * @return false        Failure
+ */
+bool ZYLoggingFilePrivate::openFile(const char * fileDate) noexcept
+{
+    char *       file_path   = this->filePath;
+    const char * dir_path    = (this->fileOwner->_dirPath ? this->fileOwner->_dirPath : ".");
+    const char * file_suffix = (this->compressFormat == ZYLoggingFile::CF_LZ4 ? ".log.lz4" : ".log");
+
+    if (this->fileOwner->_namingRule == ZYLoggingFile::NR_DATE)
+    {
+        snprintf(file_path, sizeof(this->filePath), "%s%c%s_%s%s", dir_path, PATH_SEPARATOR, this->fileOwner->_fileName, fileDate, file_suffix);
+        memcpy(this->fileDate, fileDate, sizeof(this->fileDate));
+    }
+    else
+    {
+        snprintf(file_path, sizeof(this->filePath), "%s%c%s%s", dir_path, PATH_SEPARATOR, this->fileOwner->_fileName, file_suffix);
+    }
+
+    this->fileSize = 0;
+
+#if defined(_LINUX)
+    {
+        // Mapped chunks need a readable descriptor, they are not appended
+        int open_flags = (this->mappedFile ? O_RDWR | O_CREAT | O_CLOEXEC : O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC);
+
+        this->fileHandle = open(file_path, open_flags, 0644);
+        if (this->fileHandle == LOGGING_INVALID_HANDLE && errno == ENOENT && (mkdir(dir_path, 0755) == 0 || errno == EEXIST)) this->fileHandle = open(file_path, open_flags, 0644);
+    }
+    if (this->fileHandle != LOGGING_INVALID_HANDLE)
+    {
+        struct stat file_stat;
+
+        if (fstat(this->fileHandle, &file_stat) == 0)
+        {
+            this->fileSize  = (size_t)file_stat.st_size;
+            this->fileInode = file_stat.st_ino;
+        }
+        this->dirSynced = false;
+    }
+#elif defined(_WINDOWS)
+    this->fileHandle = ::CreateFileA(file_path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (this->fileHandle == LOGGING_INVALID_HANDLE && GetLastError() == ERROR_PATH_NOT_FOUND && ::CreateDirectoryA(dir_path, NULL))
+    {
+        this->fileHandle = ::CreateFileA(file_path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    }
+    if (this->fileHandle != LOGGING_INVALID_HANDLE)
+    {
+        LARGE_INTEGER file_size;
+
+        if (::GetFileSizeEx(this->fileHandle, &file_size)) this->fileSize = (size_t)file_size.QuadPart;
+    }
+#endif
+
+    return this->fileHandle != LOGGING_INVALID_HANDLE;
+}
+
+/**
+ * @brief Close the file
+ */
+void ZYLoggingFilePrivate::closeFile() noexcept
+{
+    if (this->fileHandle == LOGGING_INVALID_HANDLE) return;
+
+    // Queued writes resolve the descriptor when they start, they complete before it is closed
+    this->reapUring(true);
+
+    // Lines written before a rotation are synced with the old file
+#if defined(_LINUX)
+    if (this->fileSync && fdatasync(this->fileHandle) != 0) this->syncLost = true;
+    close(this->fileHandle);
+#elif defined(_WINDOWS)
+    if (this->fileSync && !::FlushFileBuffers(this->fileHandle)) this->syncLost = true;
+    ::CloseHandle(this->fileHandle);
+#endif
+    this->fileHandle = LOGGING_INVALID_HANDLE;
+}
+
+//================================================================================
+// Implementation export method [ZYLoggingFile]
+//================================================================================
+/**
+ * @brief Construct function
+ *
+ * @param safeLevel  Object safe level (Use object safe level macros; TSL_PROCESS: processes forked later append whole buffers to the same file without a shared lock)
+ * @param dirPath    File directory path (Must end with '\\0')
+ * @param fileName   File name (Must end with '\\0'; No file suffix name)
+ * @param namingRule File naming rule
+ */
+ZYLoggingFile::ZYLoggingFile(const int safeLevel, const char *dirPath, const char *fileName, const NAMING_RULE namingRule) noexcept : _dirPath(nullptr), _fileName(nullptr), _namingRule(namingRule), _safeLock(nullptr), _filePrivate(nullptr)
+{
+    if (dirPath)
+    {
+        this->_dirPath = new char[strlen(dirPath) + 1];
+        strcpy(this->_dirPath, dirPath);
+    }
+    this->_fileName = new char[strlen(fileName ? fileName : "") + 1];
+    strcpy(this->_fileName, fileName ? fileName : "");
+
+    // Processes do not share the safe mutex, each appends whole buffers to the file (O_APPEND keeps the lines of a buffer together)
+#if defined(_LINUX)
+    this->_safeLock            = new SafeMutex();
+    this->_safeLock->safeLevel = safeLevel;
+
+    pthread_mutexattr_init(&this->_safeLock->mutexAttr);
+    if (pthread_mutex_init(&this->_safeLock->mutexLock, &this->_safeLock->mutexAttr) != 0) DBG_PERROR(ESL_WARNING, "Failed to initialize logging file lock:");
+#elif defined(_WINDOWS)
+    this->_safeLock            = new SafeMutex();
+    this->_safeLock->safeLevel = safeLevel;
+    this->_safeLock->mutexLock = CreateMutex(NULL, FALSE, NULL);
+    if (!this->_safeLock->mutexLock) DBG_PERROR(ESL_WARNING, "Failed to create logging file lock:");
+#endif
+
+    this->_filePrivate = new ZYLoggingFilePrivate(this);
+}
+
+/**
+ * @brief Destruct function
+ */
+ZYLoggingFile::~ZYLoggingFile()
+{
+    delete this->_filePrivate;
+    this->_filePrivate = nullptr;
+
+#if defined(_LINUX)
+    pthread_mutex_destroy(&this->_safeLock->mutexLock);
+    pthread_mutexattr_destroy(&this->_safeLock->mutexAttr);
+    delete this->_safeLock;
+#elif defined(_WINDOWS)
+    ::CloseHandle(this->_safeLock->mutexLock);
+    delete this->_safeLock;
+#endif
+    this->_safeLock = nullptr;
+
+    delete[] this->_dirPath;
+    delete[] this->_fileName;
+    this->_dirPath  = nullptr;
+    this->_fileName = nullptr;
+}
+
+/**
+ * @brief Output one line (Content is written as is, without formatting)
+ *
+ * @param logLevel   Log level (Use execute status level macros)
+ * @param logContent Log content (Must end with '\\0')
+ * @return size_t    Line ticket (Waited by waitDurable(); 0: no ticket in WM_MAPPED mode)
+ */
+size_t ZYLoggingFile::outputText(const int logLevel, const char *logContent) const noexcept
+{
+    return this->_filePrivate->appendLine(logLevel, logContent ? logContent : "", logContent ? strlen(logContent) : 0, true);
+}
+
+/**
+ * @brief Output one line
+ *
+ * @param logLevel  Log level (Use execute status level macros)
+ * @param fmtString Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
+ * @param ...       Format arguments ("%X|%x|%B|%b" must use std::make_unique<::HexOrBitArg>("123", 3).get() type argument)
+ * @return size_t   Line ticket (Waited by waitDurable(); 0: no ticket in WM_MAPPED mode or the format failed)
+ */
+size_t ZYLoggingFile::outputLine(const int logLevel, const char *fmtString, ...) const noexcept
+{
+    const char * line_datas  = nullptr;
+    size_t       line_length = 0;
+    va_list      arg_list;
+
+    // HexOrBitArg is passed on to the debug log formatter as dbg_log_datas_t
+    static_assert(sizeof(HexOrBitArg) == sizeof(dbg_log_datas_t) && offsetof(HexOrBitArg, length) == offsetof(dbg_log_datas_t, length), "HexOrBitArg must match dbg_log_datas_t.");
+
+    va_start(arg_list, fmtString);
+    line_datas = DbgFormatString(line_length, fmtString, arg_list);
+    va_end(arg_list);
+
+    return (line_datas ? this->_filePrivate->appendLine(logLevel, line_datas, line_length, true) : 0);
+}
+
+/**
+ * @brief Write the buffered lines to the file (Waits until the writer thread has written them)
+ */
+void ZYLoggingFile::flush() const noexcept
+{
+    this->_filePrivate->flush();
+}
+
+/**
+ * @brief Wait until the line is synced to the disk (Hands the buffered line to the writer thread)
+ *
+ * @param lineTicket Line ticket (Returned by outputLine() or outputText(); Tickets of a process are counted from its fork)
+ * @return true      The line is on the disk
+ * @return false     The line may be lost (No durability level is set, or the write or sync failed)
+ */
+bool ZYLoggingFile::waitDurable(const size_t lineTicket) const noexcept
+{
+    return this->_filePrivate->waitDurable(lineTicket);
+}
+
+/**
+ * @brief Set file write mode (WM_MAPPED must be set before the first output)
+ *
+ * @param writeMode File write mode
+ * @return true     Success (WM_URING falls back to blocking writes if the kernel does not support it)
+ * @return false    Failure (Lines were output, another mode or compression is set, or the mode is not supported)
+ */
+bool ZYLoggingFile::setWriteMode(const WRITE_MODE writeMode) noexcept
+{
+#if defined(_LINUX)
+    bool             is_success = false;
+    LoggingFileGuard file_guard(this->_filePrivate);
+
+    __LoggingLock(this->_safeLock);
+    if (writeMode == WM_MAPPED)
+    {
+        {
+            std::lock_guard<std::mutex> wait_locker(this->_filePrivate->waitMutex);
+            is_success = (this->_filePrivate->syncLevel == DL_NONE);
+        }
+        is_success = is_success && !this->_filePrivate->uringWanted && !this->_filePrivate->compressFormat && this->_filePrivate->openMapped();
+    }
+    else if (writeMode == WM_URING)
+    {
+        is_success = !this->_filePrivate->mappedFile;
+        if (is_success) this->_filePrivate->openUring();
+    }
+    else
+    {
+        is_success = !this->_filePrivate->mappedFile && !this->_filePrivate->uringWanted;
+    }
+    __LoggingUnlock(this->_safeLock);
+
+    return is_success;
+#else
+    return writeMode != WM_MAPPED;
+#endif
+}
+
+/**
+ * @brief Set rotation policy (Applied by the writer thread from the next written buffer)
+ *
+ * @param rotatePolicy Rotation policy
+ */
+void ZYLoggingFile::setRotation(const RotatePolicy &rotatePolicy) noexcept
+{
+    std::lock_guard<std::mutex> wait_locker(this->_filePrivate->waitMutex);
+
+    this->_filePrivate->rotatePolicy   = rotatePolicy;
+    this->_filePrivate->maintainNeeded = true;
+}
+
+/**
+ * @brief Set durability level
+ *
+ * @param durabilityLevel Durability level
+ * @param syncInterval    Sync interval (Units: milliseconds; Used in DL_PERIODIC level)
+ * @return true           Success
+ * @return false          Failure (WM_MAPPED mode is set, or the interval is invalid)
+ */
+bool ZYLoggingFile::setDurability(const DURABILITY_LEVEL durabilityLevel, const int syncInterval) noexcept
+{
+    bool is_success = (durabilityLevel != DL_PERIODIC || syncInterval > 0);
+
+    // Mapped lines are not written by the writer thread, they have no tickets
+    __LoggingLock(this->_safeLock);
+#if defined(_LINUX)
+    if (this->_filePrivate->mappedFile) is_success = false;
+#endif
+    if (is_success)
+    {
+        std::lock_guard<std::mutex> wait_locker(this->_filePrivate->waitMutex);
+
+        this->_filePrivate->syncLevel    = durabilityLevel;
+        this->_filePrivate->syncInterval = (durabilityLevel == DL_PERIODIC ? syncInterval : 0);
+        this->_filePrivate->syncDue      = __LoggingTime() + this->_filePrivate->syncInterval;
+        this->_filePrivate->wakeCond.notify_one();
+        this->_filePrivate->idleCond.notify_all();
+    }
+    __LoggingUnlock(this->_safeLock);
+
+    return is_success;
+}
+
+/**
+ * @brief Set file compression format (Must be set before the first output; Buffers are compressed by the writer thread)
+ *
+ * @param compressFormat File compression format
+ * @return true          Success
+ * @return false         Failure (Lines were output, or WM_MAPPED mode is set)
+ */
+bool ZYLoggingFile::setCompression(const COMPRESS_FORMAT compressFormat) noexcept
+{
+    bool is_success = false;
+
+    // The file name suffix follows the format, so the file must not be opened yet
+    __LoggingLock(this->_safeLock);
+    is_success = !this->_filePrivate->lineCount;
+#if defined(_LINUX)
+    if (this->_filePrivate->mappedFile) is_success = false;
+#endif
+    if (is_success) this->_filePrivate->compressFormat = compressFormat;
+    __LoggingUnlock(this->_safeLock);
+
+    return is_success;
+}
+
+/**
+ * @brief Get writer statistics
+ *
+ * @param writerStats Output writer statistics
+ */
+void ZYLoggingFile::getStats(WriterStats &writerStats) const noexcept
+{
+    size_t line_count = 0;
+
+    __LoggingLock(this->_safeLock);
+    line_count = this->_filePrivate->lineCount;
+#if defined(_LINUX)
+    if (this->_filePrivate->mappedFile) line_count += this->_filePrivate->mappedFile->lineCount.load(std::memory_order_relaxed);
+#endif
+    __LoggingUnlock(this->_safeLock);
+
+    {
+        std::lock_guard<std::mutex> wait_locker(this->_filePrivate->waitMutex);
+        writerStats = this->_filePrivate->writerStats;
+    }
+    writerStats.lineCount = line_count;
+}
+
+/**
+ * @brief Debug log routing sink (Pass it to DbgAddRoute() with the logging file as the sink context; The formatted log is written as is, debug logs emitted by the file itself are dropped)
+ *
+ * @param sinkContext Logging file (ZYLoggingFile *)
+ * @param logRecord   Log record
+ */
+void ZYLoggingFile::routeSink(void *sinkContext, const dbg_log_record_t *logRecord) noexcept
+{
+    const ZYLoggingFile * logging_file = (const ZYLoggingFile *)sinkContext;
+    size_t                line_length  = logRecord->logLength;
+
+    // Debug logs of the file itself (Its writer thread, or an output switching the file) are dropped, the routed thread holds its mutexes
+    if (LoggingFileGuard::threadFile == logging_file->_filePrivate) return;
+
+    // The record ends with "\r\n", the line break is written by the logging file
+    while (line_length > 0 && (logRecord->logContent[line_length - 1] == '\n' || logRecord->logContent[line_length - 1] == '\r')) line_length--;
+
+    logging_file->_filePrivate->appendLine(logRecord->logType & 0xff, logRecord->logContent, line_length, false);
+}
\ No newline at end of file
@@ -19,6 +19,7 @@
 // Define preset type
 //================================================================================
 class ZYLoggingFilePrivate;
+struct dbg_log_record_t;
 
 //================================================================================
 // Define export type
@@ -40,6 +41,35 @@ public:
         NR_DATE  = 1  // Date suffix name
     };
 
+    /**
+     * @brief File write mode
+     */
+    enum WRITE_MODE
+    {
+        WM_BUFFERED = 0, // Lines are buffered and written by the writer thread
+        WM_MAPPED   = 1, // Lines are copied into memory-mapped chunks of the file (Survive a process crash, LoggingRecover extracts the valid lines; Linux only)
+        WM_URING    = 2  // Lines are buffered, the writer thread submits the buffers by io_uring (Falls back to WM_BUFFERED if the kernel does not support it; Linux only)
+    };
+
+    /**
+     * @brief File durability level (Not supported in WM_MAPPED mode)
+     */
+    enum DURABILITY_LEVEL
+    {
+        DL_NONE     = 0, // Written lines are left to the system cache
+        DL_PERIODIC = 1, // Written lines are synced every sync interval (The partly filled buffer is taken every sync interval too)
+        DL_GROUP    = 2  // Written lines are synced when a caller waits for them (Callers waiting together share one sync)
+    };
+
+    /**
+     * @brief File compression format (Not supported in WM_MAPPED mode)
+     */
+    enum COMPRESS_FORMAT
+    {
+        CF_NONE = 0, // Lines are written as text
+        CF_LZ4  = 1  // Every written buffer is one independent LZ4 frame (Files are named "<name>.log.lz4"; Readable by "lz4 -dc" and LoggingCat while the file is written)
+    };
+
     /**
      * @brief Hex or Binary argument (Used to format argument)
      */
@@ -60,20 +90,50 @@ public:
         mutable pthread_mutex_t     mutexLock; // Mutex lock
         mutable pthread_mutexattr_t mutexAttr; // Mutex lock attribute
 #elif defined(_WINDOWS)
+        HANDLE                      mutexLock; // Mutex lock
 #endif
     };
 
+    /**
+     * @brief Writer statistics (Lines are written by the writer thread of the instance)
+     */
+    struct WriterStats
+    {
+        size_t    lineCount  = 0; // Output lines count
+        size_t    writeBytes = 0; // Written bytes
+        size_t    writeCount = 0; // Buffers written by the writer thread
+        size_t    pendingMax = 0; // Max buffers waiting for the writer thread
+        size_t    stallCount = 0; // Times that an output waited for a free buffer (Back-pressure)
+        long long stallTime  = 0; // Total wait time for a free buffer (Units: microseconds)
+        size_t    uringCount = 0; // Buffers written by io_uring (WM_URING)
+        size_t    syncCount  = 0; // File syncs (DL_PERIODIC and DL_GROUP)
+        long long syncTime   = 0; // Total time of the file syncs (Units: microseconds)
+        size_t    lineBytes  = 0; // Line bytes of the written buffers (Written bytes are the frame bytes in CF_LZ4 format)
+    };
+
+    /**
+     * @brief Rotation policy (Date rotation uses NR_DATE rule; Rotated files are named "<name>.<yyyyMMdd-hhmmss.zzz>.log[.lz4]")
+     */
+    struct RotatePolicy
+    {
+        size_t maxFileSize   = 0;     // Rotate the file before it grows over the size (Units: bytes; 0: no size rotation; A line or a CF_LZ4 frame longer than the size is a file of its own)
+        int    keepFiles     = 0;     // Rotated files kept, older are removed (0: no limit; Linux only)
+        size_t keepBytes     = 0;     // Total size of rotated files kept, older are removed (Units: bytes; 0: no limit; Linux only)
+        bool   compressFiles = false; // Compress rotated files with gzip in background (Linux only; Files in CF_LZ4 format are kept as they are)
+    };
+
 private:
-    char *      _dirPath;    // File directory path
-    char *      _fileName;   // File name (No file suffix name)
-    NAMING_RULE _namingRule; // File naming rule
-    SafeMutex * _safeLock;   // Safe mutex
+    char *                 _dirPath;     // File directory path
+    char *                 _fileName;    // File name (No file suffix name)
+    NAMING_RULE            _namingRule;  // File naming rule
+    SafeMutex *            _safeLock;    // Safe mutex
+    ZYLoggingFilePrivate * _filePrivate; // File handle and output buffer
 
 public:
     /**
      * @brief Construct function
      *
-     * @param safeLevel  Object safe level (Use object safe level macros)
+     * @param safeLevel  Object safe level (Use object safe level macros; TSL_PROCESS: processes forked later append whole buffers to the same file without a shared lock)
      * @param dirPath    File directory path (Must end with '\\0')
      * @param fileName   File name (Must end with '\\0'; No file suffix name)
      * @param namingRule File naming rule
@@ -86,13 +146,13 @@ public:
     ~ZYLoggingFile();
 
     /**
-     * @brief Output one line
+     * @brief Output one line (Content is written as is, without formatting)
      *
      * @param logLevel   Log level (Use execute status level macros)
      * @param logContent Log content (Must end with '\\0')
-     * @param ...        Log format content (Format parameters)
+     * @return size_t    Line ticket (Waited by waitDurable(); 0: no ticket in WM_MAPPED mode)
      */
-    void outputLine(const int logLevel, const char *logContent) const noexcept;
+    size_t outputText(const int logLevel, const char *logContent) const noexcept;
 
     /**
      * @brief Output one line
@@ -100,6 +160,71 @@ public:
      * @param logLevel  Log level (Use execute status level macros)
      * @param fmtString Format string (Must end with '\\0'; Format: "%%"="%", "%X|%x"=Hex string, %B|%b"=Binary string, Other=Reference sprintf() specifier)
      * @param ...       Format arguments ("%X|%x|%B|%b" must use std::make_unique<::HexOrBitArg>("123", 3).get() type argument)
+     * @return size_t   Line ticket (Waited by waitDurable(); 0: no ticket in WM_MAPPED mode or the format failed)
+     */
+    size_t outputLine(const int logLevel, const char *fmtString, ...) const noexcept;
+
+    /**
+     * @brief Write the buffered lines to the file (Waits until the writer thread has written them)
+     */
+    void flush() const noexcept;
+
+    /**
+     * @brief Wait until the line is synced to the disk (Hands the buffered line to the writer thread)
+     *
+     * @param lineTicket Line ticket (Returned by outputLine() or outputText(); Tickets of a process are counted from its fork)
+     * @return true      The line is on the disk
+     * @return false     The line may be lost (No durability level is set, or the write or sync failed)
+     */
+    bool waitDurable(const size_t lineTicket) const noexcept;
+
+    /**
+     * @brief Set file write mode (WM_MAPPED must be set before the first output)
+     *
+     * @param writeMode File write mode
+     * @return true     Success (WM_URING falls back to blocking writes if the kernel does not support it)
+     * @return false    Failure (Lines were output, another mode or compression is set, or the mode is not supported)
+     */
+    bool setWriteMode(const WRITE_MODE writeMode) noexcept;
+
+    /**
+     * @brief Set rotation policy (Applied by the writer thread from the next written buffer)
+     *
+     * @param rotatePolicy Rotation policy
+     */
+    void setRotation(const RotatePolicy &rotatePolicy) noexcept;
+
+    /**
+     * @brief Set durability level
+     *
+     * @param durabilityLevel Durability level
+     * @param syncInterval    Sync interval (Units: milliseconds; Used in DL_PERIODIC level)
+     * @return true           Success
+     * @return false          Failure (WM_MAPPED mode is set, or the interval is invalid)
+     */
+    bool setDurability(const DURABILITY_LEVEL durabilityLevel, const int syncInterval) noexcept;
+
+    /**
+     * @brief Set file compression format (Must be set before the first output; Buffers are compressed by the writer thread)
+     *
+     * @param compressFormat File compression format
+     * @return true          Success
+     * @return false         Failure (Lines were output, or WM_MAPPED mode is set)
+     */
+    bool setCompression(const COMPRESS_FORMAT compressFormat) noexcept;
+
+    /**
+     * @brief Get writer statistics
+     *
+     * @param writerStats Output writer statistics
+     */
+    void getStats(WriterStats &writerStats) const noexcept;
+
+    /**
+     * @brief Debug log routing sink (Pass it to DbgAddRoute() with the logging file as the sink context; The formatted log is written as is, debug logs emitted by the file itself are dropped)
+     *
+     * @param sinkContext Logging file (ZYLoggingFile *)
+     * @param logRecord   Log record
      */
-    void outputLine(const int logLevel, const char *fmtString, ...) const noexcept;
+    static void routeSink(void *sinkContext, const dbg_log_record_t *logRecord) noexcept;
 };
\ No newline at end of file
@@ -14,77 +14,1141 @@
 #include "../Base/BaseDefine.h"
 #include "../Common/SysHelper.h"
 #include "../Common/DbgHelper.h"
-#if defined(_WINDOWS)
-    #include "../Library/HashLibrary/md5.h"
-#elif defined(_LINUX)
+#include "../Library/HashLibrary/md5.h"
+#if defined(_LINUX)
+    #include <fcntl.h>
+    #include <linux/futex.h>
+    #include <signal.h>
     #include <sys/mman.h>
-    #include <semaphore.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <atomic>
+    #include <chrono>
+    #include <new>
 #endif
 #include "ThreadSafe.h"
 
-//================================================================================
-// Define inside macro
-//================================================================================
-#define LOCK_STATUS_IDLE  0x00
-#define LOCK_STATUS_READ  0x01
-#define LOCK_STATUS_WRITE 0x02
+//================================================================================
+// Define inside macro
+//================================================================================
+#define LOCK_STATUS_IDLE  0x00
+#define LOCK_STATUS_READ  0x01
+#define LOCK_STATUS_WRITE 0x02
+
+#define LOCK_SPIN_LIMIT   100  // Default max spin count of a contended acquisition
+#define LOCK_SPIN_MIN     8    // Spins tried beyond the learned budget (The budget can grow back after it shrank)
+
+#define LOCK_RECOVER_WAIT 100  // Wait time of a process lock waiter before it checks for dead owners (Units: milliseconds)
+
+#if defined(_LINUX)
+    #define INIT_STATUS_NONE       0x00
+    #define INIT_STATUS_ATTRINITED 0x01
+    #define INIT_STATUS_LOCKINITED 0x02
+
+    #define SHM_STATUS_NONE        0x00 // The creator has not initialized the lock in the segment yet
+    #define SHM_STATUS_READY       0x01 // The lock in the segment is initialized
+    #define SHM_STATUS_STALE       0x02 // The creator died before the lock was ready (The process that found it unlinks the segment)
+    #define SHM_CACHE_LINE         64   // Cache line length (The segment head is aligned to it, the lock datas start in the line after the head)
+    #define SHM_OPEN_MODE          0660 // Segment permissions (Processes of the owner and of the group open the lock)
+    #define SHM_OPEN_WAIT          1000 // Time an attaching process waits for a creator that has not stamped the segment (Units: milliseconds)
+    #define SHM_ATTACH_SLOTS       64   // Processes whose references are tracked by process stamp (The references of a dead process are dropped by the next opener or releaser)
+    #define SHM_ATTACH_RECLAIM     (~0ULL) // Stamp of an attach slot dropped by a sweeping process
+
+    #define PROCESS_STAMP_PID_BITS 22   // Process ID bits of a process stamp (The start time is in the upper bits, a reused process ID makes another stamp)
+
+    #define RWLOCK_STATE_READERS   0x00000000000FFFFFULL // Holding readers count of the read/write lock state
+    #define RWLOCK_STATE_RWAITING  0x000000FFFFF00000ULL // Waiting readers count (Admitted together when the writer leaves)
+    #define RWLOCK_STATE_WWAITING  0x00FFFF0000000000ULL // Waiting writers count (New readers wait for the next writer phase)
+    #define RWLOCK_STATE_PHASE     0x3F00000000000000ULL // Reader phase (Increased when the waiting readers are admitted)
+    #define RWLOCK_STATE_GRANT     0x4000000000000000ULL // The lock is handed to a waiting writer that has not taken it yet
+    #define RWLOCK_STATE_WRITER    0x8000000000000000ULL // The lock is held by a writer
+    #define RWLOCK_RWAITING_ONE    (1ULL << 20)          // One waiting reader
+    #define RWLOCK_WWAITING_ONE    (1ULL << 40)          // One waiting writer
+    #define RWLOCK_PHASE_SHIFT     56                    // Reader phase shift
+
+    #define RWLOCK_PROC_OWNER      0x00000000000000FFULL // Owner slot of the writer of a process lock (Slot index + 1; The readers of a process lock are counted in their owner slots)
+    #define RWLOCK_PROC_DRAIN      0x0000000000000100ULL // The writer of a process lock waits for the counted readers to leave
+    #define RWLOCK_PROC_RWAITING   0x0000000000000200ULL // Readers wait for the process lock (Admitted together when the writer leaves)
+    #define RWLOCK_PROC_WWAITING   0x0000000000000400ULL // Writers wait for the process lock (New readers wait for the next writer; Rebuilt from the owner slots)
+    #define RWLOCK_PROC_TURN       0x0000000000000800ULL // The admitted readers enter before the writers (Ends when all of them have entered)
+    #define RWLOCK_PROC_GRANT      0x0000000000001000ULL // The process lock is handed to a waiting writer (New readers and writers wait)
+    #define RWLOCK_OWNER_SLOTS     64                    // Processes using a process read/write lock at the same time (More share one untracked slot)
+    #define RWLOCK_SLOT_READERS    0x00000000000FFFFFULL // Read locks held by the lock object of an owner slot
+    #define RWLOCK_SLOT_WAITING    0x0FFFFFFFFFF00000ULL // Readers of the lock object waiting (Counted by the parity of the reader phase they wait in)
+    #define RWLOCK_SLOT_WAIT_SHIFT 20                    // Waiting readers shift of the even reader phase (The odd phase is RWLOCK_SLOT_WAIT_SHIFT bits higher)
+    #define RWLOCK_SLOT_RECLAIM    (~0ULL)               // Stamp of an owner slot dropped by a recovering process
+#endif
+
+//================================================================================
+// Define inside type
+//================================================================================
+#if defined(_WINDOWS)
+    struct threadsafe_rwlock_t
+    {
+        struct MmapDatas
+        {
+            uchar     lockStatus    = LOCK_STATUS_IDLE;
+            uint      lockedCount   = 0;
+            uint      rwaitingCount = 0;
+            uint      wwaitingCount = 0;
+            pthread_t writeThreadID = 0;
+        };
+        HANDLE     mmapFile   = nullptr;
+        MmapDatas *mmapDatas  = nullptr;
+        HANDLE     innerLock  = nullptr;
+        HANDLE     innerEvent = nullptr;
+    };
+#elif defined(_LINUX)
+    struct threadsafe_shm_t
+    {
+        struct alignas(SHM_CACHE_LINE) ShmHead
+        {
+            std::atomic<uint32_t> shmStatus;                      // Segment status (Zero filled by ftruncate)
+            std::atomic<uint32_t> refCount;                       // Attached lock objects of all processes (0: the segment is being unlinked)
+            std::atomic<uint64_t> creatorStamp;                   // Process stamp of the creator (0: not stamped yet)
+            std::atomic<uint64_t> attachStamps[SHM_ATTACH_SLOTS]; // Process stamps of the references (0: free slot; A process keeps its slot until it dies)
+            std::atomic<uint32_t> attachCounts[SHM_ATTACH_SLOTS]; // References of the processes (Lock objects of the process attached to the segment)
+        };
+        ShmHead *shmHead     = nullptr; // Mapped segment (The lock datas follow the head)
+        size_t   shmSize     = 0;       // Mapped segment length
+        pid_t    ownerPid    = 0;       // Process holding the reference (Forked children use the inherited mapping without a reference)
+        int      attachSlot  = -1;      // Attach slot of the process (-1: not tracked, all slots were used by other live processes)
+        char     shmName[48] = "";      // Segment name (Format: "/ZY<lock type>_<MD5 of the lock name>")
+    };
+    struct threadsafe_mutex_t
+    {
+        struct MmapDatas
+        {
+            uint                   lockedCount = 0;
+            std::atomic<pthread_t> ownerThreadID{0}; // Native thread ID of the owner (0: no owner)
+            pthread_mutexattr_t    lockAttr;
+            pthread_mutex_t        lockObj;
+        };
+        uchar             initStatus  = INIT_STATUS_NONE;
+        pid_t             creatorPid  = 0;
+        MmapDatas        *mmapDatas   = nullptr;
+        threadsafe_shm_t *lockShm     = nullptr; // Named segment of the process lock
+        std::atomic<uint> spinBudget{0}; // Learned spin budget (Process local)
+    };
+    struct threadsafe_rwlock_t
+    {
+        struct alignas(SHM_CACHE_LINE) OwnerSlot
+        {
+            std::atomic<uint64_t> ownerStamp;   // Process stamp of the lock object using the slot (0: free slot)
+            std::atomic<uint64_t> readState;    // Read locks held and waited by the lock object (Use RWLOCK_SLOT_* macros)
+            std::atomic<uint32_t> writeWaiting; // Write locks waited by the lock object
+
+            OwnerSlot() : ownerStamp(0), readState(0), writeWaiting(0) {}
+        };
+        struct MmapDatas
+        {
+            std::atomic<uint64_t>  lockState;     // Holding and waiting counts, reader phase, grant and writer bits (Process lock: RWLOCK_PROC_* bits and the reader phase)
+            std::atomic<uint32_t>  readPhase;     // Reader wait channel (Futex word; Reader phase of the state once the readers are admitted)
+            std::atomic<uint32_t>  writeSeq;      // Writer wait channel (Futex word; Increased by every handoff to a writer)
+            std::atomic<uint32_t>  drainSeq;      // Drain wait channel (Futex word; Increased by the readers leaving a draining writer; Process lock only)
+            std::atomic<uint32_t>  slotsUsed;     // Owner slots ever used (Process lock only; The slots scanned by the writers)
+            uint                   lockedCount;   // Write lock depth (Only changed by the writer thread)
+            std::atomic<pthread_t> writeThreadID; // Native thread ID of the writer (0: no writer)
+
+            MmapDatas() : lockState(0), readPhase(0), writeSeq(0), drainSeq(0), slotsUsed(0), lockedCount(0), writeThreadID(0) {}
+        };
+        struct ShmDatas : MmapDatas
+        {
+            OwnerSlot ownerSlots[RWLOCK_OWNER_SLOTS + 1]; // Owner slots of the processes (A dead process is dropped with its slot; The last one is shared untracked by the processes over the limit)
+        };
+        MmapDatas        *mmapDatas  = nullptr;
+        ShmDatas         *shmDatas   = nullptr; // Lock datas with the owner slots (Process lock only)
+        threadsafe_shm_t *lockShm    = nullptr; // Named segment of the process lock
+        uint              slotIndex  = 0;       // Owner slot of the process (Process lock only; Shared by the lock objects of the process)
+        uint64_t          slotStamp  = 0;       // Process stamp the owner slot was taken with (A forked child takes another slot)
+        std::atomic<uint> spinBudget{0}; // Learned spin budget (Process local)
+    };
+#endif
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+#if defined(_LINUX)
+/**
+ * @brief Native thread ID of current thread (Fetched once per thread, and again in the child after fork)
+ */
+static thread_local pthread_t __ThreadNativeID = 0;
+
+/**
+ * @brief Process ID of current process (Fetched once, and again in the child after fork)
+ */
+static std::atomic<pid_t> __ThreadProcessID{0};
+
+/**
+ * @brief Process stamp of current process (Fetched once, and again in the child after fork)
+ */
+static std::atomic<uint64_t> __ThreadProcessStamp{0};
+
+/**
+ * @brief Reset the native thread and process IDs in the child process after fork (Only the forking thread exists in the child)
+ */
+static void __ThreadAtForkChild() noexcept
+{
+    __ThreadNativeID = 0;
+    __ThreadProcessID.store(0, std::memory_order_relaxed);
+    __ThreadProcessStamp.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Register the fork handler (Once per process)
+ */
+static void __ThreadRegisterAtFork() noexcept
+{
+    static const int atfork_result = pthread_atfork(nullptr, nullptr, __ThreadAtForkChild);
+    (void)atfork_result;
+}
+
+/**
+ * @brief Get the native thread ID of current thread (The write lock owner, unique across processes)
+ *
+ * @return pthread_t Native thread ID
+ */
+static pthread_t __ThreadGetNativeID() noexcept
+{
+    if (!__ThreadNativeID)
+    {
+        __ThreadRegisterAtFork();
+        __ThreadNativeID = SELF_NATIVE_THREAD_ID;
+    }
+
+    return __ThreadNativeID;
+}
+
+/**
+ * @brief Get the process ID of current process (The owner of the process lock slots)
+ *
+ * @return pid_t Process ID
+ */
+static pid_t __ThreadGetProcessID() noexcept
+{
+    pid_t process_id = __ThreadProcessID.load(std::memory_order_relaxed);
+
+    if (!process_id)
+    {
+        __ThreadRegisterAtFork();
+        process_id = SELF_PROCESS_ID;
+        __ThreadProcessID.store(process_id, std::memory_order_relaxed);
+    }
+
+    return process_id;
+}
+
+/**
+ * @brief Read the state and the start time of a process
+ *
+ * @param processId Process ID
+ * @param procState Output process state ('Z': zombie; 'X': dead or no such process; '\0': unknown)
+ * @return uint64_t Start time after boot (Units: clock ticks; 0: unknown)
+ */
+static uint64_t __ThreadReadProcessStat(const pid_t processId, char &procState) noexcept
+{
+    char               stat_path[32]   = {0};
+    char               stat_datas[512] = {0};
+    char              *state_pos       = nullptr;
+    int                stat_handle     = -1;
+    ssize_t            read_size       = 0;
+    unsigned long long start_time      = 0;
+
+    procState = '\0';
+    snprintf(stat_path, sizeof(stat_path), "/proc/%d/stat", (int)processId);
+    stat_handle = open(stat_path, O_RDONLY);
+    if (stat_handle < 0)
+    {
+        if (errno == ENOENT) procState = 'X';
+        return 0;
+    }
+    read_size = read(stat_handle, stat_datas, sizeof(stat_datas) - 1);
+    close(stat_handle);
+
+    // Format: "<pid> (<comm>) <state> <ppid> ... <starttime> ...", the start time is field 22 and the command name may contain ')'
+    state_pos = (read_size > 0 ? strrchr(stat_datas, ')') : nullptr);
+    if (!state_pos || sscanf(state_pos + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &procState, &start_time) != 2) return 0;
+
+    return start_time;
+}
+
+/**
+ * @brief Get the process stamp of current process (The owner of the segment references and of the process lock slots)
+ *
+ * @return uint64_t Process stamp (Format: start time << PROCESS_STAMP_PID_BITS | process ID)
+ */
+static uint64_t __ThreadGetProcessStamp() noexcept
+{
+    uint64_t process_stamp = __ThreadProcessStamp.load(std::memory_order_relaxed);
+
+    if (!process_stamp)
+    {
+        pid_t process_id = __ThreadGetProcessID();
+        char  proc_state = '\0';
+
+        process_stamp = (__ThreadReadProcessStat(process_id, proc_state) << PROCESS_STAMP_PID_BITS) | (uint64_t)process_id;
+        __ThreadProcessStamp.store(process_stamp, std::memory_order_relaxed);
+    }
+
+    return process_stamp;
+}
+
+/**
+ * @brief Check whether the process of the stamp is dead
+ *
+ * @param processStamp Process stamp (Without start time: the process ID is checked only)
+ * @return true        The process exited or was killed (A zombie that is not reaped yet is dead too, and so is a process ID reused by a later process)
+ * @return false       The process is alive, or it can not be checked
+ */
+static bool __ThreadIsDeadProcess(const uint64_t processStamp) noexcept
+{
+    pid_t    process_id = (pid_t)(processStamp & ((1ULL << PROCESS_STAMP_PID_BITS) - 1));
+    uint64_t start_time = processStamp >> PROCESS_STAMP_PID_BITS;
+    uint64_t proc_start = 0;
+    char     proc_state = '\0';
+
+    if (kill(process_id, 0) != 0 && errno == ESRCH) return true;
+
+    proc_start = __ThreadReadProcessStat(process_id, proc_state);
+    return proc_state == 'Z' || proc_state == 'X' || (start_time && proc_start && proc_start != start_time);
+}
+
+/**
+ * @brief Drop the segment references of dead processes (Called by a process holding a reference, the count does not drop to zero)
+ *
+ * @param lockShm Lock segment
+ */
+static void __ThreadSweepShm(threadsafe_shm_t *lockShm) noexcept
+{
+    for (uint slot_idx = 0; slot_idx < SHM_ATTACH_SLOTS; slot_idx++)
+    {
+        uint64_t slot_stamp = lockShm->shmHead->attachStamps[slot_idx].load(std::memory_order_relaxed);
+        uint32_t ref_count  = 0;
+
+        // Only the process that reclaims the slot drops the references, so they are dropped once; The slot is freed after its count
+        if (!slot_stamp || slot_stamp == SHM_ATTACH_RECLAIM || !__ThreadIsDeadProcess(slot_stamp)) continue;
+        if (!lockShm->shmHead->attachStamps[slot_idx].compare_exchange_strong(slot_stamp, SHM_ATTACH_RECLAIM, std::memory_order_relaxed)) continue;
+
+        ref_count = lockShm->shmHead->attachCounts[slot_idx].exchange(0, std::memory_order_relaxed);
+        lockShm->shmHead->attachStamps[slot_idx].store(0, std::memory_order_release);
+        if (ref_count) lockShm->shmHead->refCount.fetch_sub(ref_count, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief Track the segment reference of the lock object by the process stamp (Dropped by another process if this process dies)
+ *
+ * The lock objects of a process count their references in the attach slot of the process, so any number of them is tracked.
+ * Past SHM_ATTACH_SLOTS live processes the reference is not tracked: it is released by its lock object only, a process that dies
+ * with it keeps the segment from being unlinked.
+ *
+ * @param lockShm Lock segment
+ */
+static void __ThreadTrackShm(threadsafe_shm_t *lockShm) noexcept
+{
+    uint64_t process_stamp = __ThreadGetProcessStamp();
+
+    for (uint slot_idx = 0; slot_idx < SHM_ATTACH_SLOTS && lockShm->attachSlot < 0; slot_idx++)
+    {
+        if (lockShm->shmHead->attachStamps[slot_idx].load(std::memory_order_acquire) == process_stamp) lockShm->attachSlot = (int)slot_idx;
+    }
+    for (uint slot_idx = 0; slot_idx < SHM_ATTACH_SLOTS && lockShm->attachSlot < 0; slot_idx++)
+    {
+        uint64_t slot_stamp = 0;
+
+        if (lockShm->shmHead->attachStamps[slot_idx].compare_exchange_strong(slot_stamp, process_stamp, std::memory_order_acquire)) lockShm->attachSlot = (int)slot_idx;
+    }
+
+    if (lockShm->attachSlot >= 0) lockShm->shmHead->attachCounts[lockShm->attachSlot].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Wait for the creator to initialize the lock in the segment
+ *
+ * The creator stamps the segment as soon as it is mapped. A segment whose creator died before the lock was ready, or that is
+ * not stamped by the deadline, is marked stale by one waiting process, which unlinks the name; every waiting process opens it again.
+ *
+ * @param lockShm      Lock segment
+ * @param waitDeadline Deadline for the creator to stamp the segment
+ * @return true        The lock is ready
+ * @return false       The segment is stale
+ */
+static bool __ThreadWaitShm(threadsafe_shm_t *lockShm, const std::chrono::steady_clock::time_point &waitDeadline) noexcept
+{
+    threadsafe_shm_t::ShmHead *shm_head   = lockShm->shmHead;
+    uint32_t                   shm_status = shm_head->shmStatus.load(std::memory_order_acquire);
+    auto                       check_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(LOCK_RECOVER_WAIT);
+
+    while (shm_status == SHM_STATUS_NONE)
+    {
+        auto now_time = std::chrono::steady_clock::now();
+
+        // The creator is checked every LOCK_RECOVER_WAIT, it reads the /proc entry of the creator
+        if (now_time >= check_time)
+        {
+            uint64_t creator_stamp = shm_head->creatorStamp.load(std::memory_order_relaxed);
+
+            check_time = now_time + std::chrono::milliseconds(LOCK_RECOVER_WAIT);
+            if ((creator_stamp ? __ThreadIsDeadProcess(creator_stamp) : now_time >= waitDeadline) && shm_head->shmStatus.compare_exchange_strong(shm_status, SHM_STATUS_STALE, std::memory_order_acq_rel))
+            {
+                shm_unlink(lockShm->shmName);
+                return false;
+            }
+        }
+
+        SysSwitchToThread();
+        shm_status = shm_head->shmStatus.load(std::memory_order_acquire);
+    }
+
+    return shm_status == SHM_STATUS_READY;
+}
+
+/**
+ * @brief Open the named segment of a process lock
+ *
+ * The first process creates the segment exclusively and initializes the lock, the others attach after it is ready.
+ * A segment whose reference count dropped to zero is being unlinked, and a stale segment is unlinked by the process that found it:
+ * attaching processes retry until they create a new one. The reference belongs to the opening process and is tracked by its
+ * process stamp, the last release of all live processes destroys the lock and unlinks the name.
+ *
+ * @param shmPrefix  Segment name prefix (Lock type)
+ * @param lockName   Lock name
+ * @param datasSize  Lock datas length
+ * @param isCreator  Output whether the segment is created (The creator initializes the lock, then calls __ThreadReadyShm())
+ * @return threadsafe_shm_t* Lock segment (Nullptr: failure)
+ */
+static threadsafe_shm_t *__ThreadOpenShm(const char *shmPrefix, const char *lockName, const size_t datasSize, bool &isCreator) noexcept
+{
+    threadsafe_shm_t *lock_shm      = new (std::nothrow) threadsafe_shm_t();
+    uint64_t          process_stamp = __ThreadGetProcessStamp();
+    MD5               md5_object;
+
+    if (!lock_shm) return nullptr;
+    md5_object.add(lockName, strlen(lockName));
+    snprintf(lock_shm->shmName, sizeof(lock_shm->shmName), "/ZY%s_%s", shmPrefix, md5_object.getHash().c_str());
+    lock_shm->shmSize  = sizeof(threadsafe_shm_t::ShmHead) + datasSize;
+    lock_shm->ownerPid = SELF_PROCESS_ID;
+
+    while (true)
+    {
+        struct stat shm_stat;
+        void       *shm_datas     = MAP_FAILED;
+        uint32_t    ref_count     = 0;
+        bool        is_sized      = false;
+        auto        wait_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SHM_OPEN_WAIT);
+        int         shm_handle    = shm_open(lock_shm->shmName, O_RDWR | O_CREAT | O_EXCL, SHM_OPEN_MODE);
+
+        isCreator = (shm_handle >= 0);
+        if (!isCreator && errno == EEXIST) shm_handle = shm_open(lock_shm->shmName, O_RDWR, 0);
+        if (shm_handle < 0)
+        {
+            // Unlinked by the last detaching process between the two opens
+            if (errno == ENOENT) continue;
+            break;
+        }
+
+        // Attaching processes wait for the creator to size the segment; After the deadline they size it, it is found stale unstamped
+        if (isCreator) is_sized = (ftruncate(shm_handle, (off_t)lock_shm->shmSize) == 0);
+        while (!isCreator && fstat(shm_handle, &shm_stat) == 0)
+        {
+            is_sized = ((size_t)shm_stat.st_size >= lock_shm->shmSize);
+            if (!is_sized && std::chrono::steady_clock::now() >= wait_deadline) is_sized = (ftruncate(shm_handle, (off_t)lock_shm->shmSize) == 0);
+            if (is_sized) break;
+            SysSwitchToThread();
+        }
+        if (is_sized) shm_datas = mmap(NULL, lock_shm->shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, shm_handle, 0);
+        close(shm_handle);
+        if (shm_datas == MAP_FAILED)
+        {
+            if (isCreator) shm_unlink(lock_shm->shmName);
+            break;
+        }
+
+        lock_shm->shmHead = (threadsafe_shm_t::ShmHead *)shm_datas;
+        if (isCreator)
+        {
+            lock_shm->shmHead->creatorStamp.store(process_stamp, std::memory_order_relaxed);
+            return lock_shm;
+        }
+
+        if (__ThreadWaitShm(lock_shm, wait_deadline))
+        {
+            ref_count = lock_shm->shmHead->refCount.load(std::memory_order_relaxed);
+            while (ref_count && !lock_shm->shmHead->refCount.compare_exchange_weak(ref_count, ref_count + 1, std::memory_order_acquire, std::memory_order_relaxed)) {}
+            if (ref_count)
+            {
+                __ThreadSweepShm(lock_shm);
+                __ThreadTrackShm(lock_shm);
+                return lock_shm;
+            }
+        }
+
+        munmap(shm_datas, lock_shm->shmSize);
+        lock_shm->shmHead = nullptr;
+        SysSwitchToThread();
+    }
+
+    delete lock_shm;
+    return nullptr;
+}
+
+/**
+ * @brief Publish the lock initialized by the creator of the segment
+ *
+ * @param lockShm Lock segment
+ */
+static void __ThreadReadyShm(threadsafe_shm_t *lockShm) noexcept
+{
+    lockShm->shmHead->refCount.store(1, std::memory_order_relaxed);
+    __ThreadTrackShm(lockShm);
+    lockShm->shmHead->shmStatus.store(SHM_STATUS_READY, std::memory_order_release);
+}
+
+/**
+ * @brief Release the reference of the lock object to the segment
+ *
+ * @param lockShm Lock segment
+ * @return true   The last lock object of all live processes is released (The caller destroys the lock, the segment is unlinked when closed)
+ * @return false  Other lock objects are still attached, or the lock object is inherited by fork
+ */
+static bool __ThreadReleaseShm(threadsafe_shm_t *lockShm) noexcept
+{
+    if (lockShm->ownerPid != SELF_PROCESS_ID) return false;
+
+    // References left by dead processes are dropped first, so the last live process unlinks the segment
+    __ThreadSweepShm(lockShm);
+    if (lockShm->attachSlot >= 0) lockShm->shmHead->attachCounts[lockShm->attachSlot].fetch_sub(1, std::memory_order_relaxed);
+    return lockShm->shmHead->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+/**
+ * @brief Close the segment
+ *
+ * @param lockShm Lock segment
+ * @param isLast  Whether the last lock object is released (The segment name is unlinked)
+ */
+static void __ThreadCloseShm(threadsafe_shm_t *lockShm, const bool isLast) noexcept
+{
+    munmap(lockShm->shmHead, lockShm->shmSize);
+    if (isLast) shm_unlink(lockShm->shmName);
+    delete lockShm;
+}
+
+/**
+ * @brief Get the max spin count of a contended acquisition
+ *
+ * @param spinBudget Learned spin budget of the lock
+ * @param spinLimit  Spin limit of the lock
+ * @return uint      Max spin count (0: wait in the kernel at once)
+ */
+static uint __ThreadSpinCount(const std::atomic<uint> &spinBudget, const uint spinLimit) noexcept
+{
+    uint spin_count = spinBudget.load(std::memory_order_relaxed) * 2 + LOCK_SPIN_MIN;
+
+    return spin_count < spinLimit ? spin_count : spinLimit;
+}
+
+/**
+ * @brief Learn the spin budget from a contended acquisition
+ *
+ * The spins an acquisition needed measure how long the holder kept the lock after the waiter came, the budget follows
+ * their moving average. Waiting in the kernel means the hold was longer than spinning pays off, the budget shrinks.
+ *
+ * @param spinBudget Learned spin budget of the lock
+ * @param spinCount  Spins done by the acquisition
+ * @param isParked   Whether the acquisition waited in the kernel
+ */
+static void __ThreadSpinLearn(std::atomic<uint> &spinBudget, const uint spinCount, const bool isParked) noexcept
+{
+    int spin_budget = (int)spinBudget.load(std::memory_order_relaxed);
+
+    if (isParked)
+        spin_budget -= spin_budget / 4 + 1;
+    else
+        spin_budget += ((int)spinCount - spin_budget) / 8;
+
+    spinBudget.store(spin_budget > 0 ? (uint)spin_budget : 0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Wait on the futex word while it holds the expected value
+ *
+ * @param futexWord   Futex word
+ * @param expectValue Expected value (Returns at once if the word has changed)
+ * @param isShared    Whether the word is in memory shared by processes (Shared waits time out after LOCK_RECOVER_WAIT)
+ * @return true       Woken, or the word has changed
+ * @return false      Timed out (The waiter checks for dead owners)
+ */
+static bool __ThreadFutexWait(std::atomic<uint32_t> *futexWord, const uint32_t expectValue, const bool isShared) noexcept
+{
+    struct timespec wait_time = {LOCK_RECOVER_WAIT / 1000, (LOCK_RECOVER_WAIT % 1000) * 1000000L};
+
+    return syscall(SYS_futex, (uint32_t *)futexWord, isShared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expectValue, isShared ? &wait_time : nullptr, nullptr, 0) == 0 || errno != ETIMEDOUT;
+}
+
+/**
+ * @brief Wake the threads waiting on the futex word
+ *
+ * @param futexWord Futex word
+ * @param wakeCount Max woken threads count
+ * @param isShared  Whether the word is in memory shared by processes
+ */
+static void __ThreadFutexWake(std::atomic<uint32_t> *futexWord, const int wakeCount, const bool isShared) noexcept
+{
+    syscall(SYS_futex, (uint32_t *)futexWord, isShared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, wakeCount, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Get the waiting readers count one of the reader phase in an owner slot
+ *
+ * @param lockState Process read/write lock state (Its reader phase)
+ * @return uint64_t Waiting readers count one
+ */
+static uint64_t __ThreadWaitingOne(const uint64_t lockState) noexcept
+{
+    return 1ULL << (RWLOCK_SLOT_WAIT_SHIFT + ((lockState >> RWLOCK_PHASE_SHIFT) & 1) * RWLOCK_SLOT_WAIT_SHIFT);
+}
+
+/**
+ * @brief Check whether a reader waits for the process read/write lock in the state
+ *
+ * @param lockState Process read/write lock state
+ * @return true     A writer holds the lock, the lock is handed to a writer, or writers wait out of a readers turn
+ * @return false    The reader enters
+ */
+static bool __ThreadIsReadBlocked(const uint64_t lockState) noexcept
+{
+    return (lockState & (RWLOCK_PROC_OWNER | RWLOCK_PROC_GRANT)) || (lockState & (RWLOCK_PROC_WWAITING | RWLOCK_PROC_TURN)) == RWLOCK_PROC_WWAITING;
+}
+
+/**
+ * @brief Check whether a writer waits for the process read/write lock in the state
+ *
+ * @param lockState Process read/write lock state
+ * @param isWaiting Whether the writer waits already (Waiting writers take the grant)
+ * @return true     A writer holds the lock, the admitted readers have not entered yet, or the lock is handed to a waiting writer
+ * @return false    The writer takes the lock
+ */
+static bool __ThreadIsWriteBlocked(const uint64_t lockState, const bool isWaiting) noexcept
+{
+    return (lockState & (RWLOCK_PROC_OWNER | RWLOCK_PROC_TURN)) || (!isWaiting && (lockState & RWLOCK_PROC_GRANT));
+}
+
+/**
+ * @brief Check the owner slots in use
+ *
+ * @param shmDatas   Process read/write lock datas
+ * @param readMask   Read state bits checked (Use RWLOCK_SLOT_* macros)
+ * @param isWriters  Whether the waiting writers are checked too
+ * @return true      Some slot has the read state bits or waiting writers
+ * @return false     No slot has
+ */
+static bool __ThreadScanSlots(threadsafe_rwlock_t::ShmDatas *shmDatas, const uint64_t readMask, const bool isWriters) noexcept
+{
+    uint32_t slots_used = shmDatas->slotsUsed.load();
+
+    for (uint slot_idx = 0; slot_idx < slots_used; slot_idx++)
+    {
+        if (shmDatas->ownerSlots[slot_idx].readState.load() & readMask) return true;
+        if (isWriters && shmDatas->ownerSlots[slot_idx].writeWaiting.load()) return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Drop an owner slot of a dead process
+ *
+ * @param shmDatas Process read/write lock datas
+ * @param slotIndex Owner slot index
+ * @param slotStamp Process stamp of the dead process
+ * @return true     The slot is dropped (Its holds and waits are gone)
+ * @return false    The slot is dropped by another process, or it is the owner slot of the writer
+ */
+static bool __ThreadDropSlot(threadsafe_rwlock_t::ShmDatas *shmDatas, const uint slotIndex, uint64_t slotStamp) noexcept
+{
+    threadsafe_rwlock_t::OwnerSlot *owner_slot = &shmDatas->ownerSlots[slotIndex];
+    uint64_t                        dead_stamp = slotStamp;
+
+    if (!owner_slot->ownerStamp.compare_exchange_strong(slotStamp, RWLOCK_SLOT_RECLAIM)) return false;
+
+    // The write lock of a dead writer is taken over first, its slot index may not be reused before
+    if ((shmDatas->lockState.load() & RWLOCK_PROC_OWNER) == slotIndex + 1)
+    {
+        owner_slot->ownerStamp.store(dead_stamp);
+        return false;
+    }
+
+    owner_slot->readState.store(0);
+    owner_slot->writeWaiting.store(0);
+    owner_slot->ownerStamp.store(0);
+    return true;
+}
+
+/**
+ * @brief Drop the owner slots of dead processes (Reads the /proc entries of the other processes, called by waiters that timed out)
+ *
+ * @param shmDatas Process read/write lock datas
+ * @return true     Some slots are dropped
+ * @return false    No slot is dropped
+ */
+static bool __ThreadRobustSweep(threadsafe_rwlock_t::ShmDatas *shmDatas) noexcept
+{
+    uint64_t process_stamp = __ThreadGetProcessStamp();
+    uint32_t slots_used    = shmDatas->slotsUsed.load();
+    bool     is_dropped    = false;
+
+    for (uint slot_idx = 0; slot_idx < slots_used; slot_idx++)
+    {
+        uint64_t slot_stamp = shmDatas->ownerSlots[slot_idx].ownerStamp.load();
+
+        if (!slot_stamp || slot_stamp == RWLOCK_SLOT_RECLAIM || slot_stamp == process_stamp) continue;
+        if (__ThreadIsDeadProcess(slot_stamp) && __ThreadDropSlot(shmDatas, slot_idx, slot_stamp)) is_dropped = true;
+    }
+
+    return is_dropped;
+}
+
+/**
+ * @brief Take the owner slot of the process for the lock object
+ *
+ * The lock objects of a process share its slot, a forked child takes another slot for the inherited lock object. The slot is kept
+ * until the process dies. Past RWLOCK_OWNER_SLOTS live processes the lock object uses the shared untracked slot: it locks as usual,
+ * but the holds and waits of a process that dies with it are not recovered.
+ *
+ * @param lockObject    Read/write lock
+ * @param processStamp  Process stamp of current process
+ * @return threadsafe_rwlock_t::OwnerSlot* Owner slot
+ */
+static threadsafe_rwlock_t::OwnerSlot *__ThreadTakeSlot(threadsafe_rwlock_t *lockObject, const uint64_t processStamp) noexcept
+{
+    threadsafe_rwlock_t::ShmDatas *shm_datas  = lockObject->shmDatas;
+    uint                           slot_index = RWLOCK_OWNER_SLOTS;
+    uint32_t                       slots_used = 0;
+
+    for (uint slot_idx = 0; slot_idx < RWLOCK_OWNER_SLOTS && slot_index == RWLOCK_OWNER_SLOTS; slot_idx++)
+    {
+        if (shm_datas->ownerSlots[slot_idx].ownerStamp.load() == processStamp) slot_index = slot_idx;
+    }
+
+    // All slots are used: the slots of dead processes are dropped once, otherwise the shared slot is used
+    for (int sweep_idx = 0; sweep_idx < 2 && slot_index == RWLOCK_OWNER_SLOTS; sweep_idx++)
+    {
+        for (uint slot_idx = 0; slot_idx < RWLOCK_OWNER_SLOTS && slot_index == RWLOCK_OWNER_SLOTS; slot_idx++)
+        {
+            uint64_t slot_stamp = 0;
+
+            if (shm_datas->ownerSlots[slot_idx].ownerStamp.compare_exchange_strong(slot_stamp, processStamp)) slot_index = slot_idx;
+        }
+        if (slot_index == RWLOCK_OWNER_SLOTS && !__ThreadRobustSweep(shm_datas)) break;
+    }
+
+    slots_used = shm_datas->slotsUsed.load();
+    while (slots_used <= slot_index && !shm_datas->slotsUsed.compare_exchange_weak(slots_used, slot_index + 1)) {}
+    lockObject->slotIndex = slot_index;
+    lockObject->slotStamp = processStamp;
+    return &shm_datas->ownerSlots[slot_index];
+}
+
+/**
+ * @brief Get the owner slot of the lock object (Taken at the first lock of the process)
+ *
+ * @param lockObject Read/write lock
+ * @return threadsafe_rwlock_t::OwnerSlot* Owner slot
+ */
+static threadsafe_rwlock_t::OwnerSlot *__ThreadOwnerSlot(threadsafe_rwlock_t *lockObject) noexcept
+{
+    uint64_t process_stamp = __ThreadGetProcessStamp();
+
+    if (lockObject->slotStamp == process_stamp) return &lockObject->shmDatas->ownerSlots[lockObject->slotIndex];
+    return __ThreadTakeSlot(lockObject, process_stamp);
+}
+
+/**
+ * @brief Rebuild the waiting writers bit from the owner slots (A writer that stops waiting, or a dead one, may leave it set)
+ *
+ * @param shmDatas Process read/write lock datas
+ * @return true     The bit is cleared
+ * @return false    Writers still wait
+ */
+static bool __ThreadRobustRewait(threadsafe_rwlock_t::ShmDatas *shmDatas) noexcept
+{
+    if (__ThreadScanSlots(shmDatas, 0, true)) return false;
+
+    // A writer that starts to wait meanwhile sets the bit again after it is counted in its slot
+    shmDatas->lockState.fetch_and(~RWLOCK_PROC_WWAITING);
+    if (__ThreadScanSlots(shmDatas, 0, true)) shmDatas->lockState.fetch_or(RWLOCK_PROC_WWAITING);
+
+    return true;
+}
+
+/**
+ * @brief End the readers turn once all the admitted readers have entered (The lock is handed to a waiting writer then)
+ *
+ * @param shmDatas Process read/write lock datas
+ */
+static void __ThreadRobustEndTurn(threadsafe_rwlock_t::ShmDatas *shmDatas) noexcept
+{
+    uint64_t lock_state = shmDatas->lockState.load();
+    uint64_t next_state = 0;
+
+    // The admitted readers wait in the phase before the turn, the parity of which differs
+    while (lock_state & RWLOCK_PROC_TURN)
+    {
+        if (__ThreadScanSlots(shmDatas, __ThreadWaitingOne(lock_state ^ (1ULL << RWLOCK_PHASE_SHIFT)) * RWLOCK_SLOT_READERS, false)) return;
+
+        next_state = lock_state & ~RWLOCK_PROC_TURN;
+        if (lock_state & RWLOCK_PROC_WWAITING) next_state |= RWLOCK_PROC_GRANT;
+        if (shmDatas->lockState.compare_exchange_weak(lock_state, next_state)) break;
+    }
+
+    if (next_state & RWLOCK_PROC_GRANT)
+    {
+        shmDatas->writeSeq.fetch_add(1, std::memory_order_release);
+        __ThreadFutexWake(&shmDatas->writeSeq, 1, true);
+    }
+}
+
+/**
+ * @brief Get the process read/write lock state that starts the readers turn (The reader phase is increased, the waiting readers of the phase before enter)
+ *
+ * @param lockState Process read/write lock state with waiting readers
+ * @return uint64_t State of the readers turn
+ */
+static uint64_t __ThreadTurnState(const uint64_t lockState) noexcept
+{
+    return (lockState & ~(RWLOCK_PROC_RWAITING | RWLOCK_STATE_PHASE)) | RWLOCK_PROC_TURN | ((lockState + (1ULL << RWLOCK_PHASE_SHIFT)) & RWLOCK_STATE_PHASE);
+}
+
+/**
+ * @brief Admit the waiting readers of the readers turn together (Called by the thread that set the turn)
+ *
+ * @param shmDatas  Process read/write lock datas
+ * @param lockState State the turn was set with
+ */
+static void __ThreadRobustAdmit(threadsafe_rwlock_t::ShmDatas *shmDatas, const uint64_t lockState) noexcept
+{
+    shmDatas->readPhase.store((uint32_t)((lockState & RWLOCK_STATE_PHASE) >> RWLOCK_PHASE_SHIFT), std::memory_order_release);
+    __ThreadFutexWake(&shmDatas->readPhase, INT_MAX, true);
+    __ThreadRobustEndTurn(shmDatas);
+}
+
+/**
+ * @brief Release the write lock of the process read/write lock (The waiting readers are admitted first, otherwise the lock is handed to a waiting writer)
+ *
+ * @param shmDatas Process read/write lock datas
+ */
+static void __ThreadRobustRelease(threadsafe_rwlock_t::ShmDatas *shmDatas) noexcept
+{
+    uint64_t lock_state = shmDatas->lockState.load(std::memory_order_relaxed);
+    uint64_t next_state = 0;
+
+    do
+    {
+        next_state = lock_state & ~(RWLOCK_PROC_OWNER | RWLOCK_PROC_DRAIN);
+        if (lock_state & RWLOCK_PROC_RWAITING)
+            next_state = __ThreadTurnState(next_state);
+        else if (lock_state & RWLOCK_PROC_WWAITING)
+            next_state |= RWLOCK_PROC_GRANT;
+    } while (!shmDatas->lockState.compare_exchange_weak(lock_state, next_state));
+
+    if (next_state & RWLOCK_PROC_TURN)
+    {
+        __ThreadRobustAdmit(shmDatas, next_state);
+    }
+    else if (next_state & RWLOCK_PROC_GRANT)
+    {
+        shmDatas->writeSeq.fetch_add(1, std::memory_order_release);
+        __ThreadFutexWake(&shmDatas->writeSeq, 1, true);
+    }
+}
+
+/**
+ * @brief Leave the read lock counted in the owner slot (A writer draining the readers is woken)
+ *
+ * @param shmDatas Process read/write lock datas
+ * @param ownerSlot Owner slot
+ * @param leaveDiff Read state difference (Negative read state bits, wrapped)
+ */
+static void __ThreadRobustLeave(threadsafe_rwlock_t::ShmDatas *shmDatas, threadsafe_rwlock_t::OwnerSlot *ownerSlot, const uint64_t leaveDiff) noexcept
+{
+    ownerSlot->readState.fetch_add(leaveDiff);
+    if (shmDatas->lockState.load() & RWLOCK_PROC_DRAIN)
+    {
+        shmDatas->drainSeq.fetch_add(1, std::memory_order_release);
+        __ThreadFutexWake(&shmDatas->drainSeq, 1, true);
+    }
+}
+
+/**
+ * @brief Wait for the readers counted in the owner slots to leave (Called by the writer after it took the lock)
+ *
+ * @param shmDatas Process read/write lock datas
+ */
+static void __ThreadRobustDrain(threadsafe_rwlock_t::ShmDatas *shmDatas) noexcept
+{
+    while (__ThreadScanSlots(shmDatas, RWLOCK_SLOT_READERS, false))
+    {
+        uint32_t drain_seq = shmDatas->drainSeq.load(std::memory_order_acquire);
+
+        // The readers count themselves before they check the writer, so the readers counted after the scan leave again
+        shmDatas->lockState.fetch_or(RWLOCK_PROC_DRAIN);
+        if (!__ThreadScanSlots(shmDatas, RWLOCK_SLOT_READERS, false)) break;
+        if (!__ThreadFutexWait(&shmDatas->drainSeq, drain_seq, true)) __ThreadRobustSweep(shmDatas);
+    }
+
+    if (shmDatas->lockState.load(std::memory_order_relaxed) & RWLOCK_PROC_DRAIN) shmDatas->lockState.fetch_and(~RWLOCK_PROC_DRAIN);
+}
+
+/**
+ * @brief Recover the process read/write lock from dead processes (Called by the waiters that timed out)
+ *
+ * The slots of dead processes are dropped with their holds and waits, the write lock of a dead writer is taken over by the caller,
+ * the waiting writers bit and the turns left by dead waiters are rebuilt from the live slots, then all the waiters check the lock again.
+ *
+ * @param lockObject Read/write lock
+ * @return true      The write lock of a dead writer is taken over (The caller drains the readers and calls the recover handler)
+ * @return false     Otherwise
+ */
+static bool __ThreadRobustRecover(threadsafe_rwlock_t *lockObject) noexcept
+{
+    threadsafe_rwlock_t::ShmDatas  *shm_datas  = lockObject->shmDatas;
+    bool                            is_dropped = __ThreadRobustSweep(shm_datas);
+    bool                            is_taken   = false;
+    uint64_t                        lock_state = shm_datas->lockState.load();
+    uint                            owner_idx  = (uint)(lock_state & RWLOCK_PROC_OWNER);
+
+    if (owner_idx && owner_idx != lockObject->slotIndex + 1)
+    {
+        uint64_t owner_stamp = shm_datas->ownerSlots[owner_idx - 1].ownerStamp.load();
+
+        while (owner_stamp && owner_stamp != RWLOCK_SLOT_RECLAIM && (lock_state & RWLOCK_PROC_OWNER) == owner_idx && __ThreadIsDeadProcess(owner_stamp))
+        {
+            if (!shm_datas->lockState.compare_exchange_weak(lock_state, (lock_state & ~RWLOCK_PROC_OWNER) | (lockObject->slotIndex + 1))) continue;
+
+            shm_datas->writeThreadID.store(__ThreadGetNativeID(), std::memory_order_relaxed);
+            shm_datas->lockedCount = 1;
+            __ThreadDropSlot(shm_datas, owner_idx - 1, owner_stamp);
+            is_taken = true;
+            break;
+        }
+    }
+
+    lock_state = shm_datas->lockState.load();
+    if ((lock_state & (RWLOCK_PROC_WWAITING | RWLOCK_PROC_GRANT)) && __ThreadRobustRewait(shm_datas))
+    {
+        if (lock_state & RWLOCK_PROC_GRANT) shm_datas->lockState.fetch_and(~RWLOCK_PROC_GRANT);
+        is_dropped = true;
+    }
+    if (lock_state & RWLOCK_PROC_TURN) __ThreadRobustEndTurn(shm_datas);
+
+    if (is_dropped)
+    {
+        shm_datas->writeSeq.fetch_add(1, std::memory_order_release);
+        shm_datas->drainSeq.fetch_add(1, std::memory_order_release);
+        __ThreadFutexWake(&shm_datas->readPhase, INT_MAX, true);
+        __ThreadFutexWake(&shm_datas->writeSeq, INT_MAX, true);
+        __ThreadFutexWake(&shm_datas->drainSeq, INT_MAX, true);
+    }
+
+    return is_taken;
+}
+
+/**
+ * @brief Read lock the process read/write lock
+ *
+ * Readers are counted in the owner slot of their lock object, so the holds of a process die with it. A reader counts itself first,
+ * then checks the writer: the uncontended read lock is one atomic add on the own slot. A blocked reader counts its wait in the reader
+ * phase before it spins, so the leaving writer admits the spinning readers together with the parked ones, before the next writer.
+ *
+ * @param lockObject     Read/write lock
+ * @param spinLimit      Max spin count of a contended acquisition
+ * @param recoverHandler Recover handler (Called by the thread that takes the write lock over)
+ * @param recoverContext Recover handler context
+ */
+static void __ThreadRobustReadLock(threadsafe_rwlock_t *lockObject, const uint spinLimit, const ThreadLock::RecoverHandler recoverHandler, void *recoverContext) noexcept
+{
+    threadsafe_rwlock_t::ShmDatas  *shm_datas  = lockObject->shmDatas;
+    threadsafe_rwlock_t::OwnerSlot *owner_slot = __ThreadOwnerSlot(lockObject);
+    uint64_t                        wait_one   = 0;
+    uint64_t                        wait_phase = 0;
+    uint64_t                        lock_state = 0;
+    uint                            spin_max   = 0;
+    uint                            spin_idx   = 0;
+    bool                            is_parked  = false;
+
+    while (true)
+    {
+        bool is_admitted = false;
+
+        // A waiting reader turns its wait into the read lock by the same add
+        owner_slot->readState.fetch_add(1 - wait_one);
+        lock_state  = shm_datas->lockState.load();
+        is_admitted = wait_one && (lock_state & RWLOCK_STATE_PHASE) != wait_phase;
+        wait_one    = 0;
+        if (!(lock_state & RWLOCK_PROC_OWNER) && (is_admitted || !__ThreadIsReadBlocked(lock_state)))
+        {
+            if (is_admitted && (lock_state & RWLOCK_PROC_TURN)) __ThreadRobustEndTurn(shm_datas);
+            break;
+        }
+
+        // The read lock turns into a wait counted in the phase seen, the readers of the phase are admitted together when the writer leaves
+        wait_one   = __ThreadWaitingOne(lock_state);
+        wait_phase = lock_state & RWLOCK_STATE_PHASE;
+        __ThreadRobustLeave(shm_datas, owner_slot, wait_one - 1);
+        if ((lock_state & RWLOCK_PROC_OWNER) == lockObject->slotIndex + 1 && shm_datas->writeThreadID.load(std::memory_order_relaxed) == __ThreadGetNativeID()) DBGLOG_FATAL("Thread deadlock.");
 
-#if defined(_LINUX)
-    #define INIT_STATUS_NONE       0x00
-    #define INIT_STATUS_ATTRINITED 0x01
-    #define INIT_STATUS_LOCKINITED 0x02
-    #define INIT_STATUS_SEMINITED  0x04
-#endif
+        if (!spin_idx) spin_max = __ThreadSpinCount(lockObject->spinBudget, spinLimit);
+        while (true)
+        {
+            lock_state = shm_datas->lockState.load();
+            if ((lock_state & RWLOCK_STATE_PHASE) != wait_phase || !__ThreadIsReadBlocked(lock_state)) break;
+            if (!(lock_state & RWLOCK_PROC_RWAITING) && !shm_datas->lockState.compare_exchange_weak(lock_state, lock_state | RWLOCK_PROC_RWAITING)) continue;
 
-//================================================================================
-// Define inside type
-//================================================================================
-#if defined(_WINDOWS)
-    struct threadsafe_rwlock_t
+            // Contended: spin with the learned budget before waiting in the futex
+            if (spin_idx < spin_max)
+            {
+                spin_idx++;
+                SysYieldProcessor();
+                continue;
+            }
+
+            is_parked = true;
+            if (__ThreadFutexWait(&shm_datas->readPhase, (uint32_t)(wait_phase >> RWLOCK_PHASE_SHIFT), true) || !__ThreadRobustRecover(lockObject)) continue;
+
+            // Took the write lock over from the dead writer: the handler repairs the protected datas, then the reader starts over
+            owner_slot->readState.fetch_sub(wait_one);
+            wait_one = 0;
+            __ThreadRobustDrain(shm_datas);
+            if (recoverHandler) recoverHandler(recoverContext);
+            shm_datas->writeThreadID.store(0, std::memory_order_relaxed);
+            shm_datas->lockedCount = 0;
+            __ThreadRobustRelease(shm_datas);
+            break;
+        }
+    }
+
+    if (spin_max) __ThreadSpinLearn(lockObject->spinBudget, spin_idx, is_parked);
+}
+
+/**
+ * @brief Write lock the process read/write lock
+ *
+ * The writer takes the lock by one CAS of the owner slot into the state, then waits for the counted readers to leave.
+ * Waiting writers are counted in their owner slots, the lock is handed to one of them when the holder leaves.
+ * Waiters time out to check for dead processes: the write lock of a dead writer is taken over by the waiter that found it.
+ *
+ * @param lockObject     Read/write lock
+ * @param spinLimit      Max spin count of a contended acquisition
+ * @param recoverHandler Recover handler (Called by the thread that takes the write lock over)
+ * @param recoverContext Recover handler context
+ */
+static void __ThreadRobustWriteLock(threadsafe_rwlock_t *lockObject, const uint spinLimit, const ThreadLock::RecoverHandler recoverHandler, void *recoverContext) noexcept
+{
+    threadsafe_rwlock_t::ShmDatas  *shm_datas        = lockObject->shmDatas;
+    threadsafe_rwlock_t::OwnerSlot *owner_slot       = __ThreadOwnerSlot(lockObject);
+    pthread_t                       current_threadid = __ThreadGetNativeID();
+    uint64_t                        owner_bits       = lockObject->slotIndex + 1;
+    uint64_t                        lock_state       = shm_datas->lockState.load(std::memory_order_relaxed);
+    uint                            spin_max         = 0;
+    uint                            spin_idx         = 0;
+    bool                            is_waiting       = false;
+    bool                            is_taken         = false;
+
+    if ((lock_state & RWLOCK_PROC_OWNER) == owner_bits && shm_datas->writeThreadID.load(std::memory_order_relaxed) == current_threadid)
     {
-        struct MmapDatas
-        {
-            uchar     lockStatus    = LOCK_STATUS_IDLE;
-            uint      lockedCount   = 0;
-            uint      rwaitingCount = 0;
-            uint      wwaitingCount = 0;
-            pthread_t writeThreadID = 0;
-        };
-        HANDLE     mmapFile   = nullptr;
-        MmapDatas *mmapDatas  = nullptr;
-        HANDLE     innerLock  = nullptr;
-        HANDLE     innerEvent = nullptr;
-    };
-#elif defined(_LINUX)
-    struct threadsafe_mutex_t
+        shm_datas->lockedCount++;
+        return;
+    }
+
+    while (true)
     {
-        struct MmapDatas
+        uint32_t write_seq = 0;
+
+        if (!__ThreadIsWriteBlocked(lock_state, is_waiting))
         {
-            uint                lockedCount = 0;
-            pthread_mutexattr_t lockAttr;
-            pthread_mutex_t     lockObj;
-        };
-        uchar      initStatus = INIT_STATUS_NONE;
-        pid_t      creatorPid = 0;
-        MmapDatas *mmapDatas  = nullptr;
-    };
-    struct threadsafe_rwlock_t
+            // Readers left waiting on a free lock take their turn before the writer (Only a granted writer goes first, the readers came after the grant)
+            if ((lock_state & (RWLOCK_PROC_RWAITING | RWLOCK_PROC_GRANT)) == RWLOCK_PROC_RWAITING)
+            {
+                uint64_t turn_state = __ThreadTurnState(lock_state);
+
+                if (shm_datas->lockState.compare_exchange_weak(lock_state, turn_state))
+                {
+                    __ThreadRobustAdmit(shm_datas, turn_state);
+                    lock_state = shm_datas->lockState.load();
+                }
+                continue;
+            }
+            if (shm_datas->lockState.compare_exchange_weak(lock_state, (lock_state & ~RWLOCK_PROC_GRANT) | owner_bits)) break;
+            continue;
+        }
+
+        // Contended: spin with the learned budget before waiting in the futex
+        if (!spin_idx) spin_max = __ThreadSpinCount(lockObject->spinBudget, spinLimit);
+        if (spin_idx < spin_max)
+        {
+            spin_idx++;
+            SysYieldProcessor();
+            lock_state = shm_datas->lockState.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        if (!is_waiting)
+        {
+            owner_slot->writeWaiting.fetch_add(1);
+            is_waiting = true;
+            lock_state = shm_datas->lockState.load();
+            continue;
+        }
+        if (!(lock_state & RWLOCK_PROC_WWAITING) && !shm_datas->lockState.compare_exchange_weak(lock_state, lock_state | RWLOCK_PROC_WWAITING)) continue;
+
+        // The handoff sequence is read before the state is checked again, a handoff after the check changes it
+        write_seq  = shm_datas->writeSeq.load(std::memory_order_acquire);
+        lock_state = shm_datas->lockState.load();
+        if (!__ThreadIsWriteBlocked(lock_state, is_waiting)) continue;
+        if (!__ThreadFutexWait(&shm_datas->writeSeq, write_seq, true) && __ThreadRobustRecover(lockObject))
+        {
+            is_taken = true;
+            break;
+        }
+        lock_state = shm_datas->lockState.load();
+    }
+
+    if (is_waiting)
     {
-        struct MmapDatas
+        owner_slot->writeWaiting.fetch_sub(1);
+        __ThreadRobustRewait(shm_datas);
+    }
+    shm_datas->writeThreadID.store(current_threadid, std::memory_order_relaxed);
+    shm_datas->lockedCount = 1;
+    __ThreadRobustDrain(shm_datas);
+
+    if (is_taken && recoverHandler) recoverHandler(recoverContext);
+    if (spin_max) __ThreadSpinLearn(lockObject->spinBudget, spin_idx, is_waiting);
+}
+
+/**
+ * @brief Unlock the process read/write lock
+ *
+ * @param lockObject Read/write lock
+ */
+static void __ThreadRobustUnlock(threadsafe_rwlock_t *lockObject) noexcept
+{
+    threadsafe_rwlock_t::ShmDatas *shm_datas  = lockObject->shmDatas;
+    uint64_t                       lock_state = shm_datas->lockState.load(std::memory_order_relaxed);
+
+    if ((lock_state & RWLOCK_PROC_OWNER) == lockObject->slotIndex + 1 && shm_datas->writeThreadID.load(std::memory_order_relaxed) == __ThreadGetNativeID())
+    {
+        if (--shm_datas->lockedCount == 0)
         {
-            uchar               lockStatus    = LOCK_STATUS_IDLE;
-            uint                lockedCount   = 0;
-            uint                rwaitingCount = 0;
-            uint                wwaitingCount = 0;
-            pthread_t           writeThreadID = 0;
-            pthread_mutexattr_t innerAttr;
-            pthread_mutex_t     innerLock;
-            sem_t               innerSem;
-        };
-        uchar      initStatus = INIT_STATUS_NONE;
-        pid_t      creatorPid = 0;
-        MmapDatas *mmapDatas  = nullptr;
-    };
+            shm_datas->writeThreadID.store(0, std::memory_order_relaxed);
+            __ThreadRobustRelease(shm_datas);
+        }
+        return;
+    }
+
+    __ThreadRobustLeave(shm_datas, __ThreadOwnerSlot(lockObject), (uint64_t)-1);
+}
 #endif
 
 //================================================================================
@@ -96,7 +1160,7 @@
  * @param lockType Lock type
  * @param lockName Lock name (Nullptr: thread lock; Other: process lock)
  */
-ThreadLock::ThreadLock(const LockType lockType, const char *lockName) noexcept : _lockType(lockType), _isMultiProcess(lockName), _lockInstance(nullptr)
+ThreadLock::ThreadLock(const LockType lockType, const char *lockName) noexcept : _lockType(lockType), _isMultiProcess(lockName), _spinLimit(LOCK_SPIN_LIMIT), _recoverHandler(nullptr), _recoverContext(nullptr), _lockInstance(nullptr)
 {
     switch (this->_lockType)
     {
@@ -122,34 +1186,45 @@ ThreadLock::ThreadLock(const LockType lockType, const char *lockName) noexcept :
             this->_lockInstance = lock_object;
 #elif defined(_LINUX)
             threadsafe_mutex_t *lock_object = new threadsafe_mutex_t();
+            bool                is_creator  = true;
 
             lock_object->creatorPid = SELF_PROCESS_ID;
 
+            // Process locks live in a named segment, independent processes open the same lock by its name
             if (this->_isMultiProcess)
             {
-                lock_object->mmapDatas = (threadsafe_mutex_t::MmapDatas *)mmap(NULL, sizeof(threadsafe_mutex_t::MmapDatas), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-                if (lock_object->mmapDatas == MAP_FAILED) PERROR("Failed to map shared memory for mutex lock:");
-
+                lock_object->lockShm = __ThreadOpenShm("Mutex", lockName, sizeof(threadsafe_mutex_t::MmapDatas), is_creator);
+                if (!lock_object->lockShm)
                 {
-                    threadsafe_mutex_t::MmapDatas default_datas;
-                    memcpy(lock_object->mmapDatas, &default_datas, sizeof(threadsafe_mutex_t::MmapDatas));
+                    PERROR("Failed to open shared memory for mutex lock:");
+                    delete lock_object;
+                    break;
                 }
+
+                lock_object->mmapDatas = (threadsafe_mutex_t::MmapDatas *)((char *)lock_object->lockShm->shmHead + sizeof(threadsafe_shm_t::ShmHead));
+                if (is_creator) new (lock_object->mmapDatas) threadsafe_mutex_t::MmapDatas();
             }
             else
             {
                 lock_object->mmapDatas = new threadsafe_mutex_t::MmapDatas();
             }
 
-            if (pthread_mutexattr_init(&lock_object->mmapDatas->lockAttr) != 0) PERROR("Failed to initialize mutex lock attribute:");
-            lock_object->initStatus |= INIT_STATUS_ATTRINITED;
+            if (is_creator)
+            {
+                if (pthread_mutexattr_init(&lock_object->mmapDatas->lockAttr) != 0) PERROR("Failed to initialize mutex lock attribute:");
+                lock_object->initStatus |= INIT_STATUS_ATTRINITED;
+
+                if (pthread_mutexattr_setpshared(&lock_object->mmapDatas->lockAttr, this->_isMultiProcess ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE) != 0) PERROR("Failed to set mutex lock attribute:");
+                if (pthread_mutexattr_settype(&lock_object->mmapDatas->lockAttr, PTHREAD_MUTEX_ERRORCHECK_NP) != 0) PERROR("Failed to set mutex lock attribute:");
+                if (this->_isMultiProcess && pthread_mutexattr_setrobust(&lock_object->mmapDatas->lockAttr, PTHREAD_MUTEX_ROBUST) != 0) PERROR("Failed to set mutex lock attribute:");
 
-            if (pthread_mutexattr_setpshared(&lock_object->mmapDatas->lockAttr, this->_isMultiProcess ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE) != 0) PERROR("Failed to set mutex lock attribute:");
-            if (pthread_mutexattr_settype(&lock_object->mmapDatas->lockAttr, PTHREAD_MUTEX_ERRORCHECK_NP) != 0) PERROR("Failed to set mutex lock attribute:");
+                if (pthread_mutex_init(&lock_object->mmapDatas->lockObj, &lock_object->mmapDatas->lockAttr) != 0) PERROR("Failed to initialize mutex lock:");
+                lock_object->initStatus |= INIT_STATUS_LOCKINITED;
 
-            if (pthread_mutex_init(&lock_object->mmapDatas->lockObj, &lock_object->mmapDatas->lockAttr) != 0) PERROR("Failed to initialize mutex lock:");
-            lock_object->initStatus |= INIT_STATUS_LOCKINITED;
+                if (lock_object->lockShm) __ThreadReadyShm(lock_object->lockShm);
+            }
 
-            this->_lockInstance              = lock_object;
+            this->_lockInstance = lock_object;
 #endif
         }
         break;
@@ -197,17 +1272,25 @@ ThreadLock::ThreadLock(const LockType lockType, const char *lockName) noexcept :
             this->_lockInstance = lock_object;
 #elif defined(_LINUX)
             threadsafe_rwlock_t *lock_object = new threadsafe_rwlock_t();
+            bool                 is_creator  = false;
 
-            lock_object->creatorPid = SELF_PROCESS_ID;
-
+            // Shared futexes are keyed by the segment page, so every process attached by the name waits on the same channels
             if (this->_isMultiProcess)
             {
-                lock_object->mmapDatas = (threadsafe_rwlock_t::MmapDatas *)mmap(NULL, sizeof(threadsafe_rwlock_t::MmapDatas), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
-                if (lock_object->mmapDatas == MAP_FAILED) PERROR("Failed to map shared memory for read/write lock:");
+                lock_object->lockShm = __ThreadOpenShm("RwLock", lockName, sizeof(threadsafe_rwlock_t::ShmDatas), is_creator);
+                if (!lock_object->lockShm)
+                {
+                    PERROR("Failed to open shared memory for read/write lock:");
+                    delete lock_object;
+                    break;
+                }
 
+                lock_object->shmDatas  = (threadsafe_rwlock_t::ShmDatas *)((char *)lock_object->lockShm->shmHead + sizeof(threadsafe_shm_t::ShmHead));
+                lock_object->mmapDatas = lock_object->shmDatas;
+                if (is_creator)
                 {
-                    threadsafe_rwlock_t::MmapDatas default_datas;
-                    memcpy(lock_object->mmapDatas, &default_datas, sizeof(threadsafe_rwlock_t::MmapDatas));
+                    new (lock_object->shmDatas) threadsafe_rwlock_t::ShmDatas();
+                    __ThreadReadyShm(lock_object->lockShm);
                 }
             }
             else
@@ -215,18 +1298,6 @@ ThreadLock::ThreadLock(const LockType lockType, const char *lockName) noexcept :
                 lock_object->mmapDatas = new threadsafe_rwlock_t::MmapDatas();
             }
 
-            if (pthread_mutexattr_init(&lock_object->mmapDatas->innerAttr) != 0) PERROR("Failed to initialize inner lock attribute for read/write lock:");
-            lock_object->initStatus |= INIT_STATUS_ATTRINITED;
-
-            if (pthread_mutexattr_setpshared(&lock_object->mmapDatas->innerAttr, this->_isMultiProcess ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE) != 0) PERROR("Failed to set inner lock shared attribute for read/write lock:");
-            if (pthread_mutexattr_settype(&lock_object->mmapDatas->innerAttr, PTHREAD_MUTEX_TIMED_NP) != 0) PERROR("Failed to set inner lock type attribute for read/write lock:");
-
-            if (pthread_mutex_init(&lock_object->mmapDatas->innerLock, &lock_object->mmapDatas->innerAttr) != 0) PERROR("Failed to initialize inner lock for read/write lock:");
-            lock_object->initStatus |= INIT_STATUS_LOCKINITED;
-
-            if (sem_init(&lock_object->mmapDatas->innerSem, 1, 0) != 0) PERROR("Failed to create inner semaphore for read/write lock:");
-            lock_object->initStatus |= INIT_STATUS_SEMINITED;
-
             this->_lockInstance = lock_object;
 #endif
         }
@@ -250,17 +1321,28 @@ ThreadLock::~ThreadLock()
 #elif defined(_LINUX)
             threadsafe_mutex_t *lock_object = (threadsafe_mutex_t *)this->_lockInstance;
 
-            if (lock_object->mmapDatas)
+            if (lock_object->lockShm)
+            {
+                // The last lock object of all processes destroys the lock, whichever process created it
+                bool is_last = __ThreadReleaseShm(lock_object->lockShm);
+
+                if (is_last)
+                {
+                    pthread_mutex_destroy(&lock_object->mmapDatas->lockObj);
+                    pthread_mutexattr_destroy(&lock_object->mmapDatas->lockAttr);
+                }
+                __ThreadCloseShm(lock_object->lockShm, is_last);
+                lock_object->lockShm   = nullptr;
+                lock_object->mmapDatas = nullptr;
+            }
+            else if (lock_object->mmapDatas)
             {
                 if (lock_object->creatorPid == SELF_PROCESS_ID)
                 {
                     if (lock_object->initStatus & INIT_STATUS_LOCKINITED) pthread_mutex_destroy(&lock_object->mmapDatas->lockObj);
                     if (lock_object->initStatus & INIT_STATUS_ATTRINITED) pthread_mutexattr_destroy(&lock_object->mmapDatas->lockAttr);
                 }
-                if (this->_isMultiProcess)
-                    munmap(lock_object->mmapDatas, sizeof(threadsafe_mutex_t::MmapDatas));
-                else
-                    delete lock_object->mmapDatas;
+                delete lock_object->mmapDatas;
                 lock_object->mmapDatas = nullptr;
             }
 
@@ -304,18 +1386,20 @@ ThreadLock::~ThreadLock()
 #elif defined(_LINUX)
             threadsafe_rwlock_t *lock_object = (threadsafe_rwlock_t *)this->_lockInstance;
 
-            if (lock_object->mmapDatas)
+            if (lock_object->lockShm)
             {
-                if (lock_object->creatorPid == SELF_PROCESS_ID)
-                {
-                    if (lock_object->initStatus & INIT_STATUS_LOCKINITED) pthread_mutex_destroy(&lock_object->mmapDatas->innerLock);
-                    if (lock_object->initStatus & INIT_STATUS_ATTRINITED) pthread_mutexattr_destroy(&lock_object->mmapDatas->innerAttr);
-                    if (lock_object->initStatus & INIT_STATUS_SEMINITED) sem_destroy(&lock_object->mmapDatas->innerSem);
-                }
-                if (this->_isMultiProcess)
-                    munmap(lock_object->mmapDatas, sizeof(threadsafe_rwlock_t::MmapDatas));
-                else
-                    delete lock_object;
+                bool is_last = false;
+
+                // The owner slot is shared by the lock objects of the process, it is freed once the process dies
+                is_last = __ThreadReleaseShm(lock_object->lockShm);
+                __ThreadCloseShm(lock_object->lockShm, is_last);
+                lock_object->lockShm   = nullptr;
+                lock_object->mmapDatas = nullptr;
+                lock_object->shmDatas  = nullptr;
+            }
+            else if (lock_object->mmapDatas)
+            {
+                delete lock_object->mmapDatas;
                 lock_object->mmapDatas = nullptr;
             }
 
@@ -328,6 +1412,28 @@ ThreadLock::~ThreadLock()
     this->_lockInstance = nullptr;
 }
 
+/**
+ * @brief Set the spin limit (Linux only; Contended acquisitions spin with SysYieldProcessor before waiting in the kernel)
+ *
+ * @param spinLimit Max spin count (0: wait in the kernel at once)
+ */
+void ThreadLock::setSpinLimit(const uint spinLimit) noexcept
+{
+    this->_spinLimit = spinLimit;
+}
+
+/**
+ * @brief Set the recover handler (Process locks only; Mutex on all platforms, RwLock on Linux, where the write lock of a dead process is taken over)
+ *
+ * @param recoverHandler Recover handler (Nullptr: the lock is taken over silently)
+ * @param handlerContext Recover handler context
+ */
+void ThreadLock::setRecoverHandler(const RecoverHandler recoverHandler, void *handlerContext) noexcept
+{
+    this->_recoverHandler = recoverHandler;
+    this->_recoverContext = handlerContext;
+}
+
 /**
  * @brief Relock
  */
@@ -340,10 +1446,47 @@ void ThreadLock::_reLock(const LockMode lockMode) noexcept
         case LockType::Mutex:
         {
 #if defined(_WINDOWS)
-            WaitForSingleObject((HANDLE)this->_lockInstance, INFINITE);
+            // The owner process died holding the lock: the new owner repairs the protected state
+            if (WaitForSingleObject((HANDLE)this->_lockInstance, INFINITE) == WAIT_ABANDONED && this->_recoverHandler) this->_recoverHandler(this->_recoverContext);
 #elif defined(_LINUX)
-            threadsafe_mutex_t *lock_object = (threadsafe_mutex_t *)this->_lockInstance;
-            pthread_mutex_lock(&lock_object->mmapDatas->lockObj);
+            threadsafe_mutex_t *lock_object      = (threadsafe_mutex_t *)this->_lockInstance;
+            pthread_t           current_threadid = __ThreadGetNativeID();
+            int                 lock_result      = pthread_mutex_trylock(&lock_object->mmapDatas->lockObj);
+
+            // Relocked by the owner: the lock is held by the current thread, nothing to wait for
+            if (lock_result == EBUSY && lock_object->mmapDatas->ownerThreadID.load(std::memory_order_relaxed) == current_threadid)
+            {
+                lock_object->mmapDatas->lockedCount++;
+                break;
+            }
+
+            // Contended: spin with the learned budget before waiting in the kernel
+            if (lock_result == EBUSY)
+            {
+                uint spin_max  = __ThreadSpinCount(lock_object->spinBudget, this->_spinLimit);
+                uint spin_idx  = 0;
+                bool is_parked = false;
+
+                while (spin_idx < spin_max)
+                {
+                    spin_idx++;
+                    SysYieldProcessor();
+                    lock_result = pthread_mutex_trylock(&lock_object->mmapDatas->lockObj);
+                    if (lock_result != EBUSY) break;
+                }
+                is_parked = (lock_result == EBUSY);
+                if (is_parked) lock_result = pthread_mutex_lock(&lock_object->mmapDatas->lockObj);
+                if (spin_max) __ThreadSpinLearn(lock_object->spinBudget, spin_idx, is_parked);
+            }
+
+            // The owner process died holding the lock: the new owner repairs the protected state
+            if (lock_result == EOWNERDEAD)
+            {
+                pthread_mutex_consistent(&lock_object->mmapDatas->lockObj);
+                lock_object->mmapDatas->lockedCount = 0;
+                if (this->_recoverHandler) this->_recoverHandler(this->_recoverContext);
+            }
+            lock_object->mmapDatas->ownerThreadID.store(current_threadid, std::memory_order_relaxed);
             lock_object->mmapDatas->lockedCount++;
 #endif
         }
@@ -427,80 +1570,113 @@ void ThreadLock::_reLock(const LockMode lockMode) noexcept
             }
 #elif defined(_LINUX)
             threadsafe_rwlock_t *lock_object = (threadsafe_rwlock_t *)this->_lockInstance;
-            bool                 wait_return = false;
+            uint64_t             lock_state  = lock_object->mmapDatas->lockState.load(std::memory_order_relaxed);
+            uint                 spin_max    = 0;
+            uint                 spin_idx    = 0;
+            bool                 is_parked   = false;
+
+            // Process locks count their owners in the owner slots, so the lock survives a process that dies holding it
+            if (this->_isMultiProcess)
+            {
+                if (lockMode == LockMode::Read)
+                    __ThreadRobustReadLock(lock_object, this->_spinLimit, this->_recoverHandler, this->_recoverContext);
+                else
+                    __ThreadRobustWriteLock(lock_object, this->_spinLimit, this->_recoverHandler, this->_recoverContext);
+                break;
+            }
 
             if (lockMode == LockMode::Read)
             {
+                // Uncontended readers add themselves by one CAS, readers wait while a writer holds or waits for the lock
                 while (true)
                 {
-                    pthread_mutex_lock(&lock_object->mmapDatas->innerLock);
-                    if (wait_return) lock_object->mmapDatas->rwaitingCount--;
+                    if (!(lock_state & (RWLOCK_STATE_WRITER | RWLOCK_STATE_WWAITING)))
+                    {
+                        if (lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, lock_state + 1, std::memory_order_acquire, std::memory_order_relaxed)) break;
+                        continue;
+                    }
 
-                    if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_IDLE)
+                    if ((lock_state & RWLOCK_STATE_WRITER) && lock_object->mmapDatas->writeThreadID.load(std::memory_order_relaxed) == __ThreadGetNativeID()) DBGLOG_FATAL("Thread deadlock.");
+
+                    // Contended: spin with the learned budget before waiting in the futex
+                    if (!spin_idx) spin_max = __ThreadSpinCount(lock_object->spinBudget, this->_spinLimit);
+                    if (spin_idx < spin_max)
                     {
-                        lock_object->mmapDatas->lockStatus = LOCK_STATUS_READ;
-                        lock_object->mmapDatas->lockedCount++;
-                        pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                        break;
+                        spin_idx++;
+                        SysYieldProcessor();
+                        lock_state = lock_object->mmapDatas->lockState.load(std::memory_order_relaxed);
+                        continue;
                     }
-                    else if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_READ)
+
+                    // The leaving writer admits the waiting readers of the phase together, the readers only wait for the phase to change
+                    if (lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, lock_state + RWLOCK_RWAITING_ONE, std::memory_order_relaxed))
                     {
-                        if (lock_object->mmapDatas->wwaitingCount > 0)
-                        {
-                            lock_object->mmapDatas->rwaitingCount++;
-                            pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                            sem_wait(&lock_object->mmapDatas->innerSem);
-                            wait_return = true;
-                        }
-                        else
+                        uint64_t wait_phase = lock_state & RWLOCK_STATE_PHASE;
+
+                        while ((lock_object->mmapDatas->lockState.load(std::memory_order_acquire) & RWLOCK_STATE_PHASE) == wait_phase)
                         {
-                            lock_object->mmapDatas->lockedCount++;
-                            pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                            break;
+                            __ThreadFutexWait(&lock_object->mmapDatas->readPhase, (uint32_t)(wait_phase >> RWLOCK_PHASE_SHIFT), this->_isMultiProcess);
                         }
-                    }
-                    else if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_WRITE)
-                    {
-                        if (lock_object->mmapDatas->writeThreadID == SELF_NATIVE_THREAD_ID) DBGLOG_FATAL("Thread deadlock.");
-                        lock_object->mmapDatas->rwaitingCount++;
-                        pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                        sem_wait(&lock_object->mmapDatas->innerSem);
-                        wait_return = true;
+                        is_parked = true;
+                        break;
                     }
                 }
             }
             else if (lockMode == LockMode::Write)
             {
-                pthread_t current_threadid = SELF_NATIVE_THREAD_ID;
+                pthread_t current_threadid = __ThreadGetNativeID();
 
-                while (true)
+                if ((lock_state & RWLOCK_STATE_WRITER) && lock_object->mmapDatas->writeThreadID.load(std::memory_order_relaxed) == current_threadid)
                 {
-                    pthread_mutex_lock(&lock_object->mmapDatas->innerLock);
-                    if (wait_return) lock_object->mmapDatas->wwaitingCount--;
-
-                    if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_IDLE)
-                    {
-                        lock_object->mmapDatas->lockStatus = LOCK_STATUS_WRITE;
-                        lock_object->mmapDatas->lockedCount++;
-                        lock_object->mmapDatas->writeThreadID = current_threadid;
-                        pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                        break;
-                    }
-                    else if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_WRITE && lock_object->mmapDatas->writeThreadID == current_threadid)
-                    {
-                        lock_object->mmapDatas->lockedCount++;
-                        pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                        break;
-                    }
-                    else
+                    lock_object->mmapDatas->lockedCount++;
+                }
+                else
+                {
+                    // Uncontended writers take the lock by one CAS, contended writers wait until the lock is handed to one of them
+                    while (true)
                     {
-                        lock_object->mmapDatas->wwaitingCount++;
-                        pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
-                        sem_wait(&lock_object->mmapDatas->innerSem);
-                        wait_return = true;
+                        if (!(lock_state & (RWLOCK_STATE_WRITER | RWLOCK_STATE_READERS)))
+                        {
+                            if (lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, lock_state | RWLOCK_STATE_WRITER, std::memory_order_acquire, std::memory_order_relaxed)) break;
+                            continue;
+                        }
+
+                        // Contended: spin with the learned budget before waiting in the futex
+                        if (!spin_idx) spin_max = __ThreadSpinCount(lock_object->spinBudget, this->_spinLimit);
+                        if (spin_idx < spin_max)
+                        {
+                            spin_idx++;
+                            SysYieldProcessor();
+                            lock_state = lock_object->mmapDatas->lockState.load(std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        if (lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, lock_state + RWLOCK_WWAITING_ONE, std::memory_order_relaxed))
+                        {
+                            // One writer is woken per handoff, whichever waiter takes the grant owns the lock (The writer bit is already set)
+                            while (true)
+                            {
+                                uint32_t write_seq = lock_object->mmapDatas->writeSeq.load(std::memory_order_acquire);
+
+                                lock_state = lock_object->mmapDatas->lockState.load(std::memory_order_relaxed);
+                                if (lock_state & RWLOCK_STATE_GRANT)
+                                {
+                                    if (lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, lock_state & ~RWLOCK_STATE_GRANT, std::memory_order_acquire, std::memory_order_relaxed)) break;
+                                    continue;
+                                }
+                                __ThreadFutexWait(&lock_object->mmapDatas->writeSeq, write_seq, this->_isMultiProcess);
+                            }
+                            is_parked = true;
+                            break;
+                        }
                     }
+
+                    lock_object->mmapDatas->lockedCount = 1;
+                    lock_object->mmapDatas->writeThreadID.store(current_threadid, std::memory_order_relaxed);
                 }
             }
+
+            if (spin_max) __ThreadSpinLearn(lock_object->spinBudget, spin_idx, is_parked);
 #endif
         }
         break;
@@ -523,7 +1699,11 @@ void ThreadLock::_unLock() noexcept
 #elif defined(_LINUX)
             threadsafe_mutex_t *lock_object = (threadsafe_mutex_t *)this->_lockInstance;
             lock_object->mmapDatas->lockedCount--;
-            if (lock_object->mmapDatas->lockedCount == 0) pthread_mutex_unlock(&lock_object->mmapDatas->lockObj);
+            if (lock_object->mmapDatas->lockedCount == 0)
+            {
+                lock_object->mmapDatas->ownerThreadID.store(0, std::memory_order_relaxed);
+                pthread_mutex_unlock(&lock_object->mmapDatas->lockObj);
+            }
 #endif
         }
         break;
@@ -543,18 +1723,67 @@ void ThreadLock::_unLock() noexcept
             }
             ReleaseMutex(lock_object->innerLock);
 #elif defined(_LINUX)
-            threadsafe_rwlock_t *lock_object      = (threadsafe_rwlock_t *)this->_lockInstance;
-            pthread_t            current_threadid = SELF_NATIVE_THREAD_ID;
+            threadsafe_rwlock_t *lock_object = (threadsafe_rwlock_t *)this->_lockInstance;
+            uint64_t             lock_state  = lock_object->mmapDatas->lockState.load(std::memory_order_relaxed);
+            uint64_t             next_state  = 0;
 
-            pthread_mutex_lock(&lock_object->mmapDatas->innerLock);
-            if (lock_object->mmapDatas->lockedCount > 0) lock_object->mmapDatas->lockedCount--;
-            if (lock_object->mmapDatas->lockedCount == 0)
+            if (this->_isMultiProcess)
             {
-                if (lock_object->mmapDatas->lockStatus == LOCK_STATUS_WRITE) lock_object->mmapDatas->writeThreadID = 0;
-                lock_object->mmapDatas->lockStatus = LOCK_STATUS_IDLE;
-                if (lock_object->mmapDatas->wwaitingCount > 0 || lock_object->mmapDatas->rwaitingCount > 0) sem_post(&lock_object->mmapDatas->innerSem);
+                __ThreadRobustUnlock(lock_object);
+                break;
+            }
+
+            if (lock_state & RWLOCK_STATE_WRITER)
+            {
+                // Only the writer thread unlocks a write lock: the waiting readers are admitted first, otherwise the next writer takes the lock
+                if (--lock_object->mmapDatas->lockedCount == 0)
+                {
+                    lock_object->mmapDatas->writeThreadID.store(0, std::memory_order_relaxed);
+                    do
+                    {
+                        if (lock_state & RWLOCK_STATE_RWAITING)
+                        {
+                            next_state  = lock_state & ~(RWLOCK_STATE_WRITER | RWLOCK_STATE_RWAITING | RWLOCK_STATE_PHASE);
+                            next_state += (lock_state & RWLOCK_STATE_RWAITING) / RWLOCK_RWAITING_ONE;
+                            next_state |= (lock_state + (1ULL << RWLOCK_PHASE_SHIFT)) & RWLOCK_STATE_PHASE;
+                        }
+                        else if (lock_state & RWLOCK_STATE_WWAITING)
+                        {
+                            next_state = (lock_state - RWLOCK_WWAITING_ONE) | RWLOCK_STATE_GRANT;
+                        }
+                        else
+                        {
+                            next_state = lock_state & ~RWLOCK_STATE_WRITER;
+                        }
+                    } while (!lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, next_state, std::memory_order_release, std::memory_order_relaxed));
+
+                    if (lock_state & RWLOCK_STATE_RWAITING)
+                    {
+                        lock_object->mmapDatas->readPhase.store((uint32_t)((next_state & RWLOCK_STATE_PHASE) >> RWLOCK_PHASE_SHIFT), std::memory_order_release);
+                        __ThreadFutexWake(&lock_object->mmapDatas->readPhase, INT_MAX, this->_isMultiProcess);
+                    }
+                    else if (next_state & RWLOCK_STATE_GRANT)
+                    {
+                        lock_object->mmapDatas->writeSeq.fetch_add(1, std::memory_order_release);
+                        __ThreadFutexWake(&lock_object->mmapDatas->writeSeq, 1, this->_isMultiProcess);
+                    }
+                }
+            }
+            else if (lock_state & RWLOCK_STATE_READERS)
+            {
+                // The last reader of the phase hands the lock to a waiting writer
+                do
+                {
+                    next_state = lock_state - 1;
+                    if (!(next_state & RWLOCK_STATE_READERS) && (next_state & RWLOCK_STATE_WWAITING)) next_state = (next_state - RWLOCK_WWAITING_ONE) | RWLOCK_STATE_WRITER | RWLOCK_STATE_GRANT;
+                } while (!lock_object->mmapDatas->lockState.compare_exchange_weak(lock_state, next_state, std::memory_order_release, std::memory_order_relaxed));
+
+                if (next_state & RWLOCK_STATE_GRANT)
+                {
+                    lock_object->mmapDatas->writeSeq.fetch_add(1, std::memory_order_release);
+                    __ThreadFutexWake(&lock_object->mmapDatas->writeSeq, 1, this->_isMultiProcess);
+                }
             }
-            pthread_mutex_unlock(&lock_object->mmapDatas->innerLock);
 #endif
         }
         break;
@@ -48,6 +48,11 @@ public:
         Write // Write lock
     };
 
+    /**
+     * @brief Recover handler (Called by the thread that takes a process lock over from a dead owner, while it holds the lock exclusively; The protected state may be inconsistent)
+     */
+    typedef void (*RecoverHandler)(void *handlerContext);
+
 private:
     /**
      * @brief Lock type
@@ -59,6 +64,21 @@ private:
      */
     bool _isMultiProcess;
 
+    /**
+     * @brief Max spin count of a contended acquisition (Linux only; The lock spins up to a budget learned from recent hold times)
+     */
+    uint _spinLimit;
+
+    /**
+     * @brief Recover handler of the process lock (Nullptr: the lock is taken over silently)
+     */
+    RecoverHandler _recoverHandler;
+
+    /**
+     * @brief Recover handler context
+     */
+    void *_recoverContext;
+
     /**
      * @brief Lock instance
      */
@@ -69,7 +89,7 @@ public:
      * @brief Construct function
      *
      * @param lockType Lock type
-     * @param lockName Lock name (Nullptr: thread lock; Other: process lock)
+     * @param lockName Lock name (Nullptr: thread lock; Other: process lock, locks of the same type and name in any process are one lock; Linux tracks up to 64 live processes per name, each with any number of lock objects, a process over the limit still locks but its death is not recovered and leaves the name linked)
      */
     ThreadLock(const LockType lockType, const char *lockName = nullptr) noexcept;
 
@@ -78,6 +98,21 @@ public:
      */
     ~ThreadLock();
 
+    /**
+     * @brief Set the spin limit (Linux only; Contended acquisitions spin with SysYieldProcessor before waiting in the kernel)
+     *
+     * @param spinLimit Max spin count (0: wait in the kernel at once)
+     */
+    void setSpinLimit(const uint spinLimit) noexcept;
+
+    /**
+     * @brief Set the recover handler (Process locks only; Mutex on all platforms, RwLock on Linux, where the write lock of a dead process is taken over)
+     *
+     * @param recoverHandler Recover handler (Nullptr: the lock is taken over silently)
+     * @param handlerContext Recover handler context
+     */
+    void setRecoverHandler(const RecoverHandler recoverHandler, void *handlerContext) noexcept;
+
 private:
     /**
      * @brief Relock
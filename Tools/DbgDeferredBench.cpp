@@ -0,0 +1,319 @@
+/**
+ * @brief Debug Log Deferred Benchmark (Compares the caller cost of the deferred binary records with the text path)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Common/DbgHelper.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_QUEUE_CAPACITY 8192   // Async queue capacity
+#define BENCH_LOOP_COUNT     400000 // Default logs of a sustained benchmark case (All threads)
+#define BENCH_BURST_COUNT    4000   // Logs of a burst (Fits in the async queue)
+#define BENCH_BURST_ROUNDS   50     // Bursts of a burst benchmark case (The best one is reported)
+#define BENCH_BURST_RATIO    4      // Minimum times the deferred paths are cheaper than the async text path in a burst
+#define BENCH_CLOCK_COUNT    100000 // Clock reads to measure the timestamp cost of a record
+
+// Benchmark path
+#define BENCH_PATH_SYNC   0 // Formatted and written by the caller
+#define BENCH_PATH_TEXT   1 // Formatted by the caller, written by the consumer thread
+#define BENCH_PATH_RENDER 2 // Deferred, rendered by the consumer thread
+#define BENCH_PATH_STREAM 3 // Deferred, written as binary stream by the consumer thread
+
+//================================================================================
+// Define inside variable
+//================================================================================
+static std::mutex               __BenchLogsLock;   // Lock of the captured logs
+static std::vector<std::string> __BenchLogs;       // Captured logs (Time of the header removed)
+static std::string              __BenchStream;     // Captured binary stream
+static std::atomic<size_t>      __BenchSinkLength; // Discarded output length
+
+static const char *BENCH_PATH_NAMES[] = {"sync text", "async text", "deferred render", "deferred stream"};
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Capture a log (Time of the header removed, the deferred path stamps it on the caller thread too)
+ *
+ * @param logDate       Log date (Unused)
+ * @param logContent    Log content
+ * @param logLength     Log content length
+ */
+static void __BenchCaptureLog(const char * logDate, const char * logContent, const size_t logLength)
+{
+    std::string                 log_string(logContent, logLength);
+    size_t                      time_begin = log_string.find("Time: ");
+    size_t                      time_end   = log_string.find(", ProcessID", time_begin);
+    std::lock_guard<std::mutex> logs_guard(__BenchLogsLock);
+
+    (void)logDate;
+    if (time_begin != std::string::npos && time_end != std::string::npos) log_string.erase(time_begin, time_end - time_begin);
+    __BenchLogs.push_back(log_string);
+}
+
+/**
+ * @brief Capture the binary stream
+ *
+ * @param streamDatas   Stream datas
+ * @param streamLength  Stream datas length
+ */
+static void __BenchCaptureStream(const void * streamDatas, const size_t streamLength)
+{
+    __BenchStream.append((const char *)streamDatas, streamLength);
+}
+
+/**
+ * @brief Discard a log
+ *
+ * @param logDate       Log date (Unused)
+ * @param logContent    Log content (Unused)
+ * @param logLength     Log content length
+ */
+static void __BenchDiscardLog(const char * logDate, const char * logContent, const size_t logLength)
+{
+    (void)logDate;
+    (void)logContent;
+    __BenchSinkLength += logLength;
+}
+
+/**
+ * @brief Discard the binary stream
+ *
+ * @param streamDatas   Stream datas (Unused)
+ * @param streamLength  Stream datas length
+ */
+static void __BenchDiscardStream(const void * streamDatas, const size_t streamLength)
+{
+    (void)streamDatas;
+    __BenchSinkLength += streamLength;
+}
+
+/**
+ * @brief Take the captured logs
+ *
+ * @return std::vector<std::string> Captured logs
+ */
+static std::vector<std::string> __BenchTakeLogs()
+{
+    std::vector<std::string>    taken_logs;
+    std::lock_guard<std::mutex> logs_guard(__BenchLogsLock);
+
+    taken_logs.swap(__BenchLogs);
+
+    return taken_logs;
+}
+
+/**
+ * @brief Output the sample logs (Every argument kind the records carry)
+ */
+static void __BenchSampleLogs()
+{
+    uchar           raw_bytes[40];
+    dbg_log_datas_t hex_arg(raw_bytes, sizeof(raw_bytes));
+    dbg_log_datas_t bit_arg(raw_bytes, 13);
+    const char *    null_string = nullptr;
+
+    for (size_t loop_idx = 0; loop_idx < sizeof(raw_bytes); loop_idx++) raw_bytes[loop_idx] = (uchar)(loop_idx * 37 + 5);
+
+    DBGLOG_INFOMATION("ints %d %i %u %o %hhd %hu %ld %lld %zu", -5, 7, 4000000000u, 8, (signed char)-3, (unsigned short)65000, -123456789012L, -9000000000000LL, (size_t)77);
+    DBGLOG_WARNING("star [%*d] [%-*.*s] [%.3s] [%s]", 6, 42, 10, 2, "abcdef", "xyzw", null_string);
+    DBGLOG_INFOMATION("fp %f %.3e %g %Lf %10.2f", 3.14159, 12345.678, 0.0001, (long double)2.5L, -1.0);
+    DBGLOG_INFOMATION("chr %c %lc %ls %p", 'Q', (wint_t)L'W', L"wide str", (const void *)0x1234);
+    DBGLOG_ERROR("dump %X | %x | %B", &hex_arg, &hex_arg, &bit_arg);
+}
+
+/**
+ * @brief Check that a path outputs the same logs as the text path
+ *
+ * @param pathName      Path name
+ * @param refLogs       Logs of the text path
+ * @param pathLogs      Logs of the path
+ * @return true         Same logs
+ * @return false        Different logs
+ */
+static bool __BenchCheckLogs(const char * pathName, const std::vector<std::string> & refLogs, const std::vector<std::string> & pathLogs)
+{
+    bool is_same = (refLogs.size() == pathLogs.size());
+
+    for (size_t loop_idx = 0; is_same && loop_idx < refLogs.size(); loop_idx++)
+    {
+        if (refLogs[loop_idx] == pathLogs[loop_idx]) continue;
+
+        fprintf(stderr, "%s: log %zu differs\n%s\n%s\n", pathName, loop_idx, refLogs[loop_idx].c_str(), pathLogs[loop_idx].c_str());
+        is_same = false;
+    }
+
+    printf("check %-16s %s (%zu logs)\n", pathName, (is_same ? "same as text path" : "DIFFERENT"), pathLogs.size());
+
+    return is_same;
+}
+
+/**
+ * @brief Switch the logging path
+ *
+ * @param benchPath     Benchmark path (Use BENCH_PATH_* macros)
+ */
+static void __BenchSetPath(const int benchPath)
+{
+    DbgFlush();
+    DbgSetDeferredMode(benchPath >= BENCH_PATH_RENDER, (benchPath == BENCH_PATH_STREAM ? __BenchDiscardStream : nullptr));
+    DbgSetAsyncMode((benchPath == BENCH_PATH_SYNC ? 0 : BENCH_QUEUE_CAPACITY), DBGLOG_ASYNC_BLOCK);
+}
+
+/**
+ * @brief Output the benchmark logs of a thread
+ *
+ * @param threadIndex   Thread index
+ * @param logsCount     Logs count
+ */
+static void __BenchLogThread(const int threadIndex, const int logsCount)
+{
+    for (int loop_idx = 0; loop_idx < logsCount; loop_idx++) DBGLOG_INFOMATION("T=%d I=%d payload %s value %f", threadIndex, loop_idx, "abcdefghijklmnop", 1.5 * loop_idx);
+}
+
+/**
+ * @brief Get the caller nanoseconds per log of a burst (Logs from the calling thread, whose ring stays attached)
+ *
+ * @return double       Caller nanoseconds per log
+ */
+static double __BenchBurstCost()
+{
+    auto begin_time = std::chrono::steady_clock::now();
+
+    __BenchLogThread(0, BENCH_BURST_COUNT);
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / BENCH_BURST_COUNT;
+}
+
+/**
+ * @brief Get the nanoseconds of a timestamp (The deferred path stamps every record with system_clock)
+ *
+ * @return double       Nanoseconds per clock read
+ */
+static double __BenchClockCost()
+{
+    int64_t time_sum   = 0;
+    auto    begin_time = std::chrono::steady_clock::now();
+
+    for (int loop_idx = 0; loop_idx < BENCH_CLOCK_COUNT; loop_idx++) time_sum += std::chrono::system_clock::now().time_since_epoch().count();
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / BENCH_CLOCK_COUNT + (time_sum == 0 ? 1 : 0);
+}
+
+/**
+ * @brief Get the caller nanoseconds per log
+ *
+ * @param threadsCount  Logging threads count
+ * @param logsCount     Logs count of all threads
+ * @return double       Caller nanoseconds per log
+ */
+static double __BenchCallerCost(const int threadsCount, const int logsCount)
+{
+    std::vector<std::thread> log_threads;
+    auto                     begin_time = std::chrono::steady_clock::now();
+
+    for (int thread_idx = 0; thread_idx < threadsCount; thread_idx++) log_threads.emplace_back(__BenchLogThread, thread_idx, logsCount / threadsCount);
+    for (std::thread & log_thread : log_threads) log_thread.join();
+
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / logsCount;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    std::vector<std::string> ref_logs;
+    std::vector<std::string> decode_logs;
+    double                   burst_costs[BENCH_PATH_STREAM + 1];
+    int                      loop_count = BENCH_LOOP_COUNT;
+    bool                     is_passed  = true;
+
+    if (argc > 1) loop_count = atoi(argv[1]);
+    if (loop_count <= 0)
+    {
+        fprintf(stderr, "Usage: %s [logs count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Both deferred paths must output exactly what the text path outputs
+    DbgSetHandle(__BenchCaptureLog);
+    __BenchSampleLogs();
+    ref_logs = __BenchTakeLogs();
+
+    DbgSetAsyncMode(BENCH_QUEUE_CAPACITY, DBGLOG_ASYNC_BLOCK);
+    DbgSetDeferredMode(true, nullptr);
+    __BenchSampleLogs();
+    DbgFlush();
+    is_passed = __BenchCheckLogs(BENCH_PATH_NAMES[BENCH_PATH_RENDER], ref_logs, __BenchTakeLogs()) && is_passed;
+
+    DbgSetDeferredMode(true, __BenchCaptureStream);
+    __BenchSampleLogs();
+    DbgFlush();
+    DbgDecodeStream(__BenchStream.data(), __BenchStream.size(), __BenchCaptureLog);
+    is_passed = __BenchCheckLogs("decoded stream", ref_logs, __BenchTakeLogs()) && is_passed;
+
+    // Sustained: the queue fills up, the caller cost includes waiting for the consumer thread
+    DbgSetHandle(__BenchDiscardLog);
+    for (int threads_count : {1, 4})
+    {
+        printf("sustained, %d thread(s), caller ns/log:", threads_count);
+        for (int bench_path = BENCH_PATH_SYNC; bench_path <= BENCH_PATH_STREAM; bench_path++)
+        {
+            __BenchSetPath(bench_path);
+            __BenchCallerCost(threads_count, BENCH_BURST_COUNT);
+            printf(" %s %.0f%s", BENCH_PATH_NAMES[bench_path], __BenchCallerCost(threads_count, loop_count), (bench_path == BENCH_PATH_STREAM ? "\n" : ","));
+        }
+    }
+
+    // Burst: the logs fit in the queue, the caller cost is the formatting or encoding and the hand-off only
+    printf("burst of %d, 1 thread, caller ns/log:", BENCH_BURST_COUNT);
+    for (int bench_path = BENCH_PATH_SYNC; bench_path <= BENCH_PATH_STREAM; bench_path++)
+    {
+        double & best_cost = burst_costs[bench_path];
+
+        __BenchSetPath(bench_path);
+        for (int round_idx = 0; round_idx < BENCH_BURST_ROUNDS; round_idx++)
+        {
+            double round_cost = 0;
+
+            DbgFlush();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            round_cost = __BenchBurstCost();
+            if (round_idx == 0 || round_cost < best_cost) best_cost = round_cost;
+        }
+        printf(" %s %.0f%s", BENCH_PATH_NAMES[bench_path], best_cost, (bench_path == BENCH_PATH_STREAM ? "\n" : ","));
+    }
+    printf("timestamp of a deferred record: %.0f ns\n", __BenchClockCost());
+
+    // The deferred paths only encode and hand the record to the ring of the thread
+    if (burst_costs[BENCH_PATH_RENDER] * BENCH_BURST_RATIO > burst_costs[BENCH_PATH_TEXT] || burst_costs[BENCH_PATH_STREAM] * BENCH_BURST_RATIO > burst_costs[BENCH_PATH_TEXT])
+    {
+        fprintf(stderr, "The deferred paths must cost the caller less than 1/%d of the async text path in a burst\n", BENCH_BURST_RATIO);
+        is_passed = false;
+    }
+
+    __BenchSetPath(BENCH_PATH_SYNC);
+    DbgSetDeferredMode(false, nullptr);
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
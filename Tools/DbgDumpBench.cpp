@@ -0,0 +1,178 @@
+/**
+ * @brief Debug Log Dump Benchmark (Compares the "%X|%x|%B|%b" dump kernels with the per-character string append)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "../Common/DbgHelper.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_DATAS_LENGTH 4096   // Dump payload length (Bytes)
+#define BENCH_LOOP_COUNT   20000  // Default dump calls of a benchmark case
+#define BENCH_SPEEDUP_MIN  10.0   // Expected speedup over the per-character append
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Format string by the debug log format engine
+ *
+ * @param fmtLength     Output formatted string length
+ * @param fmtString     Format string
+ * @param ...           Format arguments
+ * @return const char*  Formatted string (Buffer of current thread)
+ */
+static const char * __BenchEngineFormat(size_t & fmtLength, const char * fmtString, ...)
+{
+    const char * fmt_result = nullptr;
+    va_list      arg_list;
+
+    va_start(arg_list, fmtString);
+    fmt_result = DbgFormatString(fmtLength, fmtString, arg_list);
+    va_end(arg_list);
+
+    return fmt_result;
+}
+
+/**
+ * @brief Dump hex datas by the per-character append replaced by the dump kernels (Reference of the benchmark)
+ *
+ * @param outString     Output string
+ * @param hexArg        Hex datas (Length units: bytes)
+ * @param isUpper       Use upper hex digits
+ */
+static void __BenchLegacyHex(std::string & outString, const dbg_log_datas_t * hexArg, const bool isUpper)
+{
+    const char * HEX_TABLE_UPPER = "0123456789ABCDEF";
+    const char * HEX_TABLE_LOWER = "0123456789abcdef";
+    const char * hex_bytes_pos   = hexArg->datas;
+
+    outString.clear();
+    for (uint loop_idx = 0; loop_idx < hexArg->length; loop_idx++)
+    {
+        if (loop_idx != 0)
+        {
+            hex_bytes_pos++;
+            outString += ' ';
+        }
+        outString += (isUpper ? HEX_TABLE_UPPER[(*hex_bytes_pos & 0xf0) >> 4] : HEX_TABLE_LOWER[(*hex_bytes_pos & 0xf0) >> 4]);
+        outString += (isUpper ? HEX_TABLE_UPPER[(*hex_bytes_pos & 0x0f) >> 0] : HEX_TABLE_LOWER[(*hex_bytes_pos & 0x0f) >> 0]);
+    }
+}
+
+/**
+ * @brief Dump binary datas by the per-character append replaced by the dump kernels (Reference of the benchmark)
+ *
+ * @param outString     Output string
+ * @param bitArg        Binary datas (Length units: bits)
+ */
+static void __BenchLegacyBit(std::string & outString, const dbg_log_datas_t * bitArg)
+{
+    const char * bit_bytes_pos   = bitArg->datas;
+    uint         bit_bytes_count = (bitArg->length / 8) + (bitArg->length % 8 == 0 ? 0 : 1);
+
+    outString.clear();
+    for (uint loop_bytes_idx = 0; loop_bytes_idx < bit_bytes_count; loop_bytes_idx++)
+    {
+        if (loop_bytes_idx != 0)
+        {
+            bit_bytes_pos++;
+            outString += ' ';
+        }
+
+        for (uint loop_bits_idx = 0; loop_bits_idx < 8 && loop_bytes_idx * 8 + loop_bits_idx < bitArg->length; loop_bits_idx++)
+        {
+            outString += ((*bit_bytes_pos >> (7 - loop_bits_idx)) & 0x01 ? '1' : '0');
+        }
+    }
+}
+
+/**
+ * @brief Run one dump benchmark case
+ *
+ * @param fmtString     Format string ("%X|%x|%B|%b")
+ * @param datasArg      Dump datas
+ * @param loopCount     Loop count
+ * @return true         Output matches the reference and reaches the expected speedup
+ * @return false        Output mismatched or too slow
+ */
+static bool __BenchDumpCase(const char * fmtString, const dbg_log_datas_t * datasArg, const size_t loopCount)
+{
+    std::string  legacy_str;
+    size_t       fmt_length  = 0;
+    size_t       sink_length = 0;
+    const char * fmt_result  = nullptr;
+    double       engine_ns   = 0;
+    double       legacy_ns   = 0;
+    auto         begin_time  = std::chrono::steady_clock::now();
+
+    for (size_t loop_idx = 0; loop_idx < loopCount; loop_idx++) sink_length += __BenchEngineFormat(fmt_length, fmtString, datasArg)[fmt_length / 2];
+    engine_ns  = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / loopCount;
+    begin_time = std::chrono::steady_clock::now();
+    for (size_t loop_idx = 0; loop_idx < loopCount; loop_idx++)
+    {
+        if (fmtString[1] == 'X' || fmtString[1] == 'x')
+            __BenchLegacyHex(legacy_str, datasArg, fmtString[1] == 'X');
+        else
+            __BenchLegacyBit(legacy_str, datasArg);
+        sink_length += legacy_str[legacy_str.size() / 2];
+    }
+    legacy_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / loopCount;
+
+    fmt_result = __BenchEngineFormat(fmt_length, fmtString, datasArg);
+    if (!fmt_result || fmt_length != legacy_str.size() || memcmp(fmt_result, legacy_str.data(), fmt_length) != 0)
+    {
+        fprintf(stderr, "%s: output mismatched with the per-character append\n", fmtString);
+        return false;
+    }
+
+    printf("%s %u %s: kernel %8.1f ns, per-character append %8.1f ns (%.1fx)%s\n", fmtString, datasArg->length, ((fmtString[1] == 'X' || fmtString[1] == 'x') ? "bytes" : "bits"), engine_ns, legacy_ns,
+           legacy_ns / engine_ns, (sink_length == 0 ? " " : ""));
+
+    return legacy_ns / engine_ns >= BENCH_SPEEDUP_MIN;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    std::vector<char> datas_bytes(BENCH_DATAS_LENGTH);
+    dbg_log_datas_t   hex_arg(datas_bytes.data(), BENCH_DATAS_LENGTH);
+    dbg_log_datas_t   bit_arg(datas_bytes.data(), BENCH_DATAS_LENGTH * 8);
+    size_t            loop_count = BENCH_LOOP_COUNT;
+    bool              is_passed  = true;
+
+    if (argc > 1) loop_count = strtoul(argv[1], nullptr, 10);
+    if (loop_count == 0)
+    {
+        fprintf(stderr, "Usage: %s [loop count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t loop_idx = 0; loop_idx < datas_bytes.size(); loop_idx++) datas_bytes[loop_idx] = (char)(loop_idx * 131 + 7);
+
+    is_passed = __BenchDumpCase("%X", &hex_arg, loop_count) && is_passed;
+    is_passed = __BenchDumpCase("%x", &hex_arg, loop_count) && is_passed;
+    is_passed = __BenchDumpCase("%B", &bit_arg, loop_count) && is_passed;
+
+    if (!is_passed) fprintf(stderr, "Expected matched output and at least %.0fx speedup\n", BENCH_SPEEDUP_MIN);
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
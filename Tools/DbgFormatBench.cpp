@@ -0,0 +1,418 @@
+/**
+ * @brief Debug Log Format Benchmark (Checks the format engine against snprintf and compares it with the per-specifier snprintf loop)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "../Common/DbgHelper.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_CHECK_LENGTH 512     // Max output length of a checked case
+#define BENCH_LOOP_COUNT   1000000 // Default format calls of a benchmark case
+#define BENCH_ALLOC_WARMUP 1000    // Logs of a path before its allocations are counted (The buffers grow to their steady size)
+#define BENCH_ALLOC_COUNT  100000  // Logs of a path while its allocations are counted
+#define BENCH_ALLOC_QUEUE  1024    // Async queue capacity of the allocation check
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Differential check statistics
+ */
+struct bench_check_t
+{
+    size_t caseCount  = 0; // Checked cases
+    size_t failCount  = 0; // Mismatched cases
+    size_t printCount = 0; // Mismatched cases to print
+};
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Format string by the debug log format engine
+ *
+ * @param fmtLength     Output formatted string length
+ * @param fmtString     Format string
+ * @param ...           Format arguments
+ * @return const char*  Formatted string (Buffer of current thread)
+ */
+static const char * __BenchEngineFormat(size_t & fmtLength, const char * fmtString, ...)
+{
+    const char * fmt_result = nullptr;
+    va_list      arg_list;
+
+    va_start(arg_list, fmtString);
+    fmt_result = DbgFormatString(fmtLength, fmtString, arg_list);
+    va_end(arg_list);
+
+    return fmt_result;
+}
+
+/**
+ * @brief Check one case against snprintf
+ *
+ * @param checkStats    Check statistics
+ * @param fmtString     Format string
+ * @param argValue      Format argument
+ */
+template <typename TValue>
+static void __BenchCheckCase(bench_check_t & checkStats, const char * fmtString, const TValue argValue)
+{
+    char         want_str[BENCH_CHECK_LENGTH];
+    int          want_len = snprintf(want_str, sizeof(want_str), fmtString, argValue);
+    size_t       got_len  = 0;
+    const char * got_str  = __BenchEngineFormat(got_len, fmtString, argValue);
+
+    if (want_len < 0 || (size_t)want_len >= sizeof(want_str)) return;
+
+    checkStats.caseCount++;
+    if (got_str && got_len == (size_t)want_len && memcmp(got_str, want_str, got_len) == 0) return;
+
+    checkStats.failCount++;
+    if (checkStats.printCount == 0) return;
+    checkStats.printCount--;
+    fprintf(stderr, "Mismatch \"%s\": got \"%.*s\", want \"%s\"\n", fmtString, (int)(got_str ? got_len : 0), (got_str ? got_str : ""), want_str);
+}
+
+/**
+ * @brief Check the values of one conversion over all flags, widths and precisions
+ *
+ * @param checkStats    Check statistics
+ * @param lengthMod     Length modifier
+ * @param convChar      Conversion character
+ * @param argValues     Format arguments
+ * @param valuesCount   Format arguments count
+ */
+template <typename TValue>
+static void __BenchCheckValues(bench_check_t & checkStats, const char * lengthMod, const char convChar, const TValue * argValues, const size_t valuesCount)
+{
+    const char * WIDTH_LIST[]     = {"", "1", "8", "20"};
+    const char * PRECISION_LIST[] = {"", ".", ".0", ".1", ".5", ".6", ".12", ".19", ".20"};
+    const char * FLAG_CHARS       = "-+ #0";
+
+    for (uint flags_mask = 0; flags_mask < 32; flags_mask++)
+    {
+        char flags_str[8] = {0};
+        int  flags_len    = 0;
+
+        for (int flag_idx = 0; flag_idx < 5; flag_idx++)
+        {
+            if (flags_mask & (1 << flag_idx)) flags_str[flags_len++] = FLAG_CHARS[flag_idx];
+        }
+
+        for (const char * width_str : WIDTH_LIST)
+        {
+            for (const char * precision_str : PRECISION_LIST)
+            {
+                char fmt_str[32];
+
+                snprintf(fmt_str, sizeof(fmt_str), "[%%%s%s%s%s%c]", flags_str, width_str, precision_str, lengthMod, convChar);
+                for (size_t value_idx = 0; value_idx < valuesCount; value_idx++) __BenchCheckCase(checkStats, fmt_str, argValues[value_idx]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Check the format engine against snprintf (The "%X|%x|%B|%b" dumps are extensions and not checked)
+ *
+ * @param printCount    Mismatched cases to print
+ * @return bench_check_t Check statistics
+ */
+static bench_check_t __BenchCheckEngine(const size_t printCount)
+{
+    const int                SIGNED_VALUES[]   = {0, 1, -1, 7, 42, -42, 255, -32768, 2147483647, -2147483647 - 1};
+    const long long          LONG_VALUES[]     = {0LL, -1LL, 123456789012LL, 9223372036854775807LL, -9223372036854775807LL - 1};
+    const unsigned long long ULONG_VALUES[]    = {0ULL, 1ULL, 18446744073709551615ULL, 4294967296ULL};
+    const double             DOUBLE_VALUES[]   = {0.0, -0.0, -0.5, 2.5, 0.125, 0.05, 3.14159, 1e300, -1e-10, 4.9e-324, 123456.789, 1e19, 18446744073709549568.0};
+    const long double        LDOUBLE_VALUES[]  = {0.0L, 2.5L, -1e-100L};
+    const int                CHAR_VALUES[]     = {'a', 'Z', ' '};
+    const char *             STRING_VALUES[]   = {"", "a", "hello", "hello world long", nullptr};
+    const void *             POINTER_VALUES[]  = {nullptr, (const void *)0x1, (const void *)0x1234, (const void *)0xdeadbeefUL, (const void *)~(uintptr_t)0};
+    bench_check_t            check_stats;
+
+    check_stats.printCount = printCount;
+
+    for (const char conv_char : {'d', 'i', 'u', 'o'})
+    {
+        __BenchCheckValues(check_stats, "", conv_char, SIGNED_VALUES, sizeof(SIGNED_VALUES) / sizeof(SIGNED_VALUES[0]));
+        __BenchCheckValues(check_stats, "h", conv_char, SIGNED_VALUES, sizeof(SIGNED_VALUES) / sizeof(SIGNED_VALUES[0]));
+        __BenchCheckValues(check_stats, "hh", conv_char, SIGNED_VALUES, sizeof(SIGNED_VALUES) / sizeof(SIGNED_VALUES[0]));
+        __BenchCheckValues(check_stats, "ll", conv_char, LONG_VALUES, sizeof(LONG_VALUES) / sizeof(LONG_VALUES[0]));
+        __BenchCheckValues(check_stats, "z", conv_char, ULONG_VALUES, sizeof(ULONG_VALUES) / sizeof(ULONG_VALUES[0]));
+    }
+    for (const char conv_char : {'f', 'e', 'E', 'g', 'G', 'a', 'A'})
+    {
+        __BenchCheckValues(check_stats, "", conv_char, DOUBLE_VALUES, sizeof(DOUBLE_VALUES) / sizeof(DOUBLE_VALUES[0]));
+        __BenchCheckValues(check_stats, "L", conv_char, LDOUBLE_VALUES, sizeof(LDOUBLE_VALUES) / sizeof(LDOUBLE_VALUES[0]));
+    }
+    __BenchCheckValues(check_stats, "", 'c', CHAR_VALUES, sizeof(CHAR_VALUES) / sizeof(CHAR_VALUES[0]));
+    __BenchCheckValues(check_stats, "", 's', STRING_VALUES, sizeof(STRING_VALUES) / sizeof(STRING_VALUES[0]));
+    __BenchCheckValues(check_stats, "", 'p', POINTER_VALUES, sizeof(POINTER_VALUES) / sizeof(POINTER_VALUES[0]));
+    __BenchCheckValues(check_stats, "", '%', SIGNED_VALUES, 1);
+
+    return check_stats;
+}
+
+/**
+ * @brief Append one specifier segment like the per-specifier loop did (Sized by one snprintf, written by another)
+ *
+ * @param outString     Output string
+ * @param segmentString Segment string (Literal text and one specifier)
+ * @param argValue      Format argument
+ */
+template <typename TValue>
+static void __BenchLegacySegment(std::string & outString, const char * segmentString, const TValue argValue)
+{
+    size_t                  add_length  = snprintf(NULL, 0, segmentString, argValue);
+    std::unique_ptr<char[]> temp_strptr = std::make_unique<char[]>(add_length + 1);
+
+    snprintf(temp_strptr.get(), add_length + 1, segmentString, argValue);
+    outString += temp_strptr.get();
+}
+
+/**
+ * @brief Format string by the per-specifier snprintf loop replaced by the format engine (Reference of the benchmark)
+ *
+ * @param outString     Output string
+ * @param fmtString     Format string (Conversions: "diuscpfeg", length modifiers: "l|ll|z")
+ * @param ...           Format arguments
+ */
+static void __BenchLegacyFormat(std::string & outString, const char * fmtString, ...)
+{
+    std::unique_ptr<char[]> fmt_strptr      = std::make_unique<char[]>(strlen(fmtString) + 1);
+    char *                  specifier_begin = fmt_strptr.get();
+    char *                  segment_begin   = specifier_begin;
+    va_list                 arg_list;
+
+    strcpy(specifier_begin, fmtString);
+    outString.clear();
+
+    va_start(arg_list, fmtString);
+    while ((specifier_begin = strchr(specifier_begin, '%')))
+    {
+        char * specifier_end = specifier_begin + 1;
+        char   old_char      = '\0';
+        bool   is_long       = false;
+
+        if (*specifier_end == '%')
+        {
+            specifier_begin += 2;
+            continue;
+        }
+        while (*specifier_end != '\0' && !strchr("diuoxXfFeEgGaAcsp", *specifier_end)) is_long = is_long || strchr("lz", *specifier_end++);
+        if (*specifier_end == '\0') break;
+
+        old_char         = specifier_end[1];
+        specifier_end[1] = '\0';
+        switch (*specifier_end)
+        {
+            case 'd':
+            case 'i':
+                if (is_long)
+                    __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, long long));
+                else
+                    __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, int));
+                break;
+            case 's':
+                __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, const char *));
+                break;
+            case 'p':
+                __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, const void *));
+                break;
+            case 'f':
+            case 'e':
+            case 'g':
+                __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, double));
+                break;
+            default:
+                if (is_long)
+                    __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, unsigned long long));
+                else
+                    __BenchLegacySegment(outString, segment_begin, va_arg(arg_list, uint));
+                break;
+        }
+        specifier_end[1] = old_char;
+        specifier_begin  = segment_begin = specifier_end + 1;
+    }
+    va_end(arg_list);
+
+    outString += segment_begin;
+}
+
+/**
+ * @brief Discard a log (Handling function of the allocation check)
+ *
+ * @param logDate       Log date (Unused)
+ * @param logContent    Log content (Unused)
+ * @param logLength     Log length (Unused)
+ */
+static void __BenchDiscardLog(const char * logDate, const char * logContent, const size_t logLength)
+{
+    (void)logDate;
+    (void)logContent;
+    (void)logLength;
+}
+
+/**
+ * @brief Output the logs of the allocation check (Lines of varying length, within the length of the warmup lines)
+ *
+ * @param logsCount     Logs count
+ */
+static void __BenchAllocLogs(const size_t logsCount)
+{
+    for (size_t loop_idx = 0; loop_idx < logsCount; loop_idx++)
+    {
+        DBGLOG_INFOMATION("request id=%zu user=%.*s size=%lu ratio=%.3f", loop_idx, (int)(loop_idx % 6), "admin1", (unsigned long)loop_idx * 4096UL, loop_idx / 7.0);
+        DBGLOG_WARNING("slow request id=%zu path=%.*s", loop_idx, (int)(loop_idx % 32), "/api/v1/items/0123456789abcdef0123456789");
+    }
+}
+
+/**
+ * @brief Check that the logging paths make no heap allocations in steady state
+ *
+ * @param logsCount     Logs counted of a path
+ * @return size_t       Allocations made by all paths after their warmup (0: steady)
+ */
+static size_t __BenchCheckAlloc(const size_t logsCount)
+{
+    const char * PATH_NAMES[] = {"sync text", "async text", "deferred render"};
+    size_t       alloc_sum    = 0;
+
+    DbgSetHandle(__BenchDiscardLog);
+    for (int path_idx = 0; path_idx < 3; path_idx++)
+    {
+        size_t alloc_count = 0;
+
+        DbgSetDeferredMode(path_idx == 2, nullptr);
+        DbgSetAsyncMode((path_idx == 0 ? 0 : BENCH_ALLOC_QUEUE), DBGLOG_ASYNC_BLOCK);
+        __BenchAllocLogs(BENCH_ALLOC_WARMUP);
+        DbgFlush();
+
+        alloc_count = DbgGetAllocCount();
+        __BenchAllocLogs(logsCount);
+        DbgFlush();
+        alloc_count = DbgGetAllocCount() - alloc_count;
+
+        printf("alloc: %-16s %zu logs, %zu allocations\n", PATH_NAMES[path_idx], logsCount * 2, alloc_count);
+        alloc_sum += alloc_count;
+    }
+    DbgSetDeferredMode(false, nullptr);
+    DbgSetAsyncMode(0, DBGLOG_ASYNC_BLOCK);
+    DbgSetHandle(nullptr);
+
+    return alloc_sum;
+}
+
+/**
+ * @brief Get the nanoseconds per call of a benchmark loop
+ *
+ * @param beginTime     Loop begin time
+ * @param loopCount     Loop count
+ * @return double       Nanoseconds per call
+ */
+static double __BenchElapsed(const std::chrono::steady_clock::time_point & beginTime, const size_t loopCount)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - beginTime).count() / loopCount;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    size_t        loop_count  = BENCH_LOOP_COUNT;
+    bench_check_t check_stats = __BenchCheckEngine(20);
+    size_t        alloc_count = 0;
+    std::string   legacy_str;
+    size_t        fmt_length  = 0;
+    size_t        sink_length = 0;
+    int           value_idx   = 0;
+
+    if (argc > 1) loop_count = strtoul(argv[1], nullptr, 10);
+    if (loop_count == 0)
+    {
+        fprintf(stderr, "Usage: %s [loop count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("check: %zu cases against snprintf, %zu mismatched\n", check_stats.caseCount, check_stats.failCount);
+
+    // The log buffers only grow during the warmup, then every path formats and hands the logs over without the heap
+    alloc_count = __BenchCheckAlloc(BENCH_ALLOC_COUNT);
+
+    // Every case formats the same arguments by both paths, the outputs are compared once
+    {
+        const char * FMT_STRING = "request id=%d user=%s size=%lu status=%d latency=%u addr=%p";
+        auto         begin_time = std::chrono::steady_clock::now();
+        double       engine_ns  = 0;
+        double       legacy_ns  = 0;
+
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++) sink_length += __BenchEngineFormat(fmt_length, FMT_STRING, value_idx++, "admin", 4096UL, 200, 1234U, &loop_count)[0];
+        engine_ns  = __BenchElapsed(begin_time, loop_count);
+        begin_time = std::chrono::steady_clock::now();
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++)
+        {
+            __BenchLegacyFormat(legacy_str, FMT_STRING, value_idx++, "admin", 4096UL, 200, 1234U, &loop_count);
+            sink_length += legacy_str.size();
+        }
+        legacy_ns = __BenchElapsed(begin_time, loop_count);
+        printf("%-60s engine %7.1f ns, snprintf loop %7.1f ns (%.1fx)\n", FMT_STRING, engine_ns, legacy_ns, legacy_ns / engine_ns);
+    }
+    {
+        const char * FMT_STRING = "%d %d %d %d %d %d %d %d";
+        auto         begin_time = std::chrono::steady_clock::now();
+        double       engine_ns  = 0;
+        double       legacy_ns  = 0;
+
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++) sink_length += __BenchEngineFormat(fmt_length, FMT_STRING, value_idx++, 1, -22, 333, -4444, 55555, -666666, 7777777)[0];
+        engine_ns  = __BenchElapsed(begin_time, loop_count);
+        begin_time = std::chrono::steady_clock::now();
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++)
+        {
+            __BenchLegacyFormat(legacy_str, FMT_STRING, value_idx++, 1, -22, 333, -4444, 55555, -666666, 7777777);
+            sink_length += legacy_str.size();
+        }
+        legacy_ns = __BenchElapsed(begin_time, loop_count);
+        printf("%-60s engine %7.1f ns, snprintf loop %7.1f ns (%.1fx)\n", FMT_STRING, engine_ns, legacy_ns, legacy_ns / engine_ns);
+    }
+    {
+        const char * FMT_STRING = "name=%-12s|id=%08d|ratio=%.3f";
+        auto         begin_time = std::chrono::steady_clock::now();
+        double       engine_ns  = 0;
+        double       legacy_ns  = 0;
+
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++) sink_length += __BenchEngineFormat(fmt_length, FMT_STRING, "worker", value_idx++, 0.25)[0];
+        engine_ns  = __BenchElapsed(begin_time, loop_count);
+        begin_time = std::chrono::steady_clock::now();
+        for (size_t loop_idx = 0; loop_idx < loop_count; loop_idx++)
+        {
+            __BenchLegacyFormat(legacy_str, FMT_STRING, "worker", value_idx++, 0.25);
+            sink_length += legacy_str.size();
+        }
+        legacy_ns = __BenchElapsed(begin_time, loop_count);
+        printf("%-60s engine %7.1f ns, snprintf loop %7.1f ns (%.1fx)\n", FMT_STRING, engine_ns, legacy_ns, legacy_ns / engine_ns);
+    }
+
+    // Keeps the formatted results alive
+    if (sink_length == 0) printf("\n");
+
+    return (check_stats.failCount == 0 && alloc_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
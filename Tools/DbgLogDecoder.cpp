@@ -0,0 +1,113 @@
+/**
+ * @brief Debug Log Decoder (Decodes the binary stream written in debug log deferred mode)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../Common/DbgHelper.h"
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Output decoded log to stdout
+ *
+ * @param logDate       Log local date (Format: "yyyyMMdd"; Unused, the content carries the time)
+ * @param logContent    Log content
+ * @param logLength     Log content length
+ */
+static void __DecoderOutput(const char * logDate, const char * logContent, const size_t logLength)
+{
+    (void)logDate;
+    fwrite(logContent, 1, logLength, stdout);
+}
+
+/**
+ * @brief Read whole file
+ *
+ * @param filePath      File path
+ * @param fileLength    Output file length
+ * @return char*        File datas (Free it with free(); Nullptr: failure)
+ */
+static char * __DecoderReadFile(const char * filePath, size_t & fileLength)
+{
+    FILE * file_handle = fopen(filePath, "rb");
+    char * file_datas  = nullptr;
+    size_t file_size   = 0;
+
+    if (!file_handle) return nullptr;
+
+    for (;;)
+    {
+        char * new_datas = (char *)realloc(file_datas, file_size + 0x100000);
+        size_t read_size = 0;
+
+        if (!new_datas) break;
+        file_datas  = new_datas;
+        read_size   = fread(file_datas + file_size, 1, 0x100000, file_handle);
+        file_size  += read_size;
+        if (read_size < 0x100000)
+        {
+            fclose(file_handle);
+            fileLength = file_size;
+            return file_datas;
+        }
+    }
+
+    fclose(file_handle);
+    free(file_datas);
+    return nullptr;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    int file_idx = 1;
+
+    // Output encoder option (Default: text)
+    if (argc > 1 && strcmp(argv[1], "--json") == 0)
+    {
+        DbgSetEncoder(DBGLOG_ENCODER_JSON);
+        file_idx++;
+    }
+    else if (argc > 1 && strcmp(argv[1], "--logfmt") == 0)
+    {
+        DbgSetEncoder(DBGLOG_ENCODER_LOGFMT);
+        file_idx++;
+    }
+
+    if (argc <= file_idx)
+    {
+        fprintf(stderr, "Usage: %s [--json|--logfmt] <stream file> [stream file ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int arg_idx = file_idx; arg_idx < argc; arg_idx++)
+    {
+        size_t file_length = 0;
+        char * file_datas  = __DecoderReadFile(argv[arg_idx], file_length);
+
+        if (!file_datas)
+        {
+            fprintf(stderr, "Unable to read \"%s\".\n", argv[arg_idx]);
+            return EXIT_FAILURE;
+        }
+
+        fprintf(stderr, "%s: %zu records decoded.\n", argv[arg_idx], DbgDecodeStream(file_datas, file_length, __DecoderOutput));
+        free(file_datas);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
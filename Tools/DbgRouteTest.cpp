@@ -0,0 +1,366 @@
+/**
+ * @brief Debug Log Route Test (Changes the handling functions and the routes while the routing sinks run)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Base/BaseDefine.h"
+#include "../Common/DbgHelper.h"
+#include "../Module/LoggingFile.h"
+#if defined(_LINUX)
+    #include <sys/resource.h>
+#endif
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define ROUTE_BURST_COUNT  70  // Routed logs queued behind the batched log (More than one consumer batch)
+#define ROUTE_SWITCH_INDEX 10  // Routed log whose sink switches to the single handling function
+#define ROUTE_SINK_SLEEP   100 // Time the slow sink runs (Units: milliseconds)
+#define ROUTE_STRESS_COUNT 200 // Route changes of the stress case
+#define ROUTE_STRESS_TASKS 4   // Logging threads of the stress case
+#define ROUTE_FILE_LIMIT   0x1000000 // File size limit of the logging file case (The first mapped chunk, the next one fails to allocate)
+#define ROUTE_FILE_LINE    1000      // Line length of the logging file case
+#define ROUTE_FILE_WAIT    10000     // Time the logging file case may run (Units: milliseconds; A deadlocked output never returns)
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Sink context freed by the route owner after DbgRemoveRoute()
+ */
+struct route_context_t
+{
+    std::atomic<bool> isValid;   // Cleared when the route owner frees the context
+    std::atomic<long> sinkCount; // Records received
+
+    route_context_t() : isValid(true), sinkCount(0) {}
+};
+
+//================================================================================
+// Define inside variable
+//================================================================================
+static std::atomic<bool> __RouteQueued(false);     // Whether the burst is queued (The sink holds the consumer until then, so it drains the whole burst at once)
+static std::atomic<long> __RouteSinkCount(0);      // Records received by the sink
+static std::atomic<long> __RouteBatchCount(0);     // Records received by the batch handling function
+static std::atomic<long> __RouteSingleCount(0);    // Records received by the single handling function
+static std::atomic<bool> __RouteEntered(false);    // Whether the slow sink has started
+static std::atomic<bool> __RouteReturned(false);   // Whether the slow sink has returned
+static std::atomic<long> __RouteBadCount(0);       // Records received with a freed context
+static std::atomic<int>  __RouteSelfId(-1);        // Route removed by its own sink
+static std::atomic<long> __RouteSelfCount(0);      // Records received by the sink removing its own route
+static std::atomic<long> __RouteFileCount(0);      // Records received by the logging file sink
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Count the batched records (Batch handling function)
+ *
+ * @param logRecords    Log records
+ * @param recordsCount  Log records count
+ */
+static void __RouteBatchHandle(const dbg_log_record_t * logRecords, const size_t recordsCount)
+{
+    (void)logRecords;
+    __RouteBatchCount += (long)recordsCount;
+}
+
+/**
+ * @brief Count the single records (Handling function)
+ *
+ * @param logDate       Log date
+ * @param logContent    Log content
+ * @param logLength     Log content length
+ */
+static void __RouteSingleHandle(const char * logDate, const char * logContent, const size_t logLength)
+{
+    (void)logDate;
+    (void)logContent;
+    (void)logLength;
+    __RouteSingleCount++;
+}
+
+/**
+ * @brief Count the routed records and switch the handling function in the middle of the drain (Routing sink)
+ *
+ * @param sinkContext   Sink context (Unused)
+ * @param logRecord     Log record
+ */
+static void __RouteSwitchSink(void * sinkContext, const dbg_log_record_t * logRecord)
+{
+    long sink_count = ++__RouteSinkCount;
+
+    (void)sinkContext;
+    (void)logRecord;
+    while (!__RouteQueued) std::this_thread::yield();
+    if (sink_count == ROUTE_SWITCH_INDEX) DbgSetHandle(__RouteSingleHandle);
+}
+
+/**
+ * @brief Switch the handling function while the consumer holds a partial batch
+ *
+ * The first routed log holds the consumer until every log is queued. The batched log behind it opens a batch, and the routed logs
+ * behind that reach the point where the consumer picks up the current handling function. The partial batch must go to the batch handling function it was collected for, not to the replaced one.
+ *
+ * @return true         Every record reached the expected function
+ * @return false        Some record is lost or misrouted
+ */
+static bool __RouteSwitchCase()
+{
+    int  route_id  = DbgAddRoute(ESL_WARNING, nullptr, __RouteSwitchSink, nullptr);
+    bool is_passed = false;
+
+    DbgSetBatchHandle(__RouteBatchHandle);
+    DbgSetAsyncMode(1024, DBGLOG_ASYNC_BLOCK);
+
+    DBGLOG_WARNING("holding %d", 0);
+    DBGLOG_INFOMATION("batched %d", 0);
+    for (int log_idx = 0; log_idx < ROUTE_BURST_COUNT; log_idx++) DBGLOG_WARNING("routed %d", log_idx);
+    __RouteQueued = true;
+    DbgFlush();
+    DBGLOG_INFOMATION("single %d", 0);
+    DbgFlush();
+
+    DbgSetAsyncMode(0, 0);
+    DbgRemoveRoute(route_id);
+    DbgSetHandle(nullptr);
+
+    is_passed = __RouteSinkCount == ROUTE_BURST_COUNT + 1 && __RouteBatchCount == 1 && __RouteSingleCount == 1;
+    printf("%-32s %ld routed, %ld batched, %ld single%s\n", "switch handler in routed drain", __RouteSinkCount.load(), __RouteBatchCount.load(), __RouteSingleCount.load(), (is_passed ? "" : ", failed"));
+
+    return is_passed;
+}
+
+/**
+ * @brief Run for a while after the log came (Routing sink)
+ *
+ * @param sinkContext   Sink context (Unused)
+ * @param logRecord     Log record
+ */
+static void __RouteSlowSink(void * sinkContext, const dbg_log_record_t * logRecord)
+{
+    (void)sinkContext;
+    (void)logRecord;
+    __RouteEntered = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(ROUTE_SINK_SLEEP));
+    __RouteReturned = true;
+}
+
+/**
+ * @brief Remove the own route (Routing sink; Must not wait for itself)
+ *
+ * @param sinkContext   Sink context (Unused)
+ * @param logRecord     Log record
+ */
+static void __RouteSelfSink(void * sinkContext, const dbg_log_record_t * logRecord)
+{
+    (void)sinkContext;
+    (void)logRecord;
+    __RouteSelfCount++;
+    DbgRemoveRoute(__RouteSelfId);
+}
+
+/**
+ * @brief Check the context is not freed yet (Routing sink)
+ *
+ * @param sinkContext   Route context
+ * @param logRecord     Log record
+ */
+static void __RouteCheckSink(void * sinkContext, const dbg_log_record_t * logRecord)
+{
+    route_context_t * route_context = (route_context_t *)sinkContext;
+
+    (void)logRecord;
+    if (!route_context->isValid) __RouteBadCount++;
+    route_context->sinkCount++;
+}
+
+/**
+ * @brief Remove a route while its sink runs in another thread, and a route from its own sink
+ *
+ * @return true         The removal returned after the running sink, and the own removal did not wait for itself
+ * @return false        The removal returned while the sink ran, or the own removal failed
+ */
+static bool __RouteRemoveCase()
+{
+    int         route_id   = DbgAddRoute(ESL_WARNING, nullptr, __RouteSlowSink, nullptr);
+    std::thread log_thread = std::thread([] { DBGLOG_WARNING("slow %d", 0); });
+    auto        begin_time = std::chrono::steady_clock::now();
+    bool        is_waited  = false;
+    bool        is_removed = false;
+    double      wait_time  = 0;
+
+    while (!__RouteEntered) std::this_thread::yield();
+    DbgRemoveRoute(route_id);
+    is_waited = __RouteReturned;
+    wait_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_time).count();
+    log_thread.join();
+
+    __RouteSelfId = DbgAddRoute(ESL_WARNING, nullptr, __RouteSelfSink, nullptr);
+    DbgSetHandle(__RouteSingleHandle);
+    DBGLOG_WARNING("self %d", 0);
+    DBGLOG_WARNING("self %d", 1);
+    DbgSetHandle(nullptr);
+    is_removed = __RouteSelfCount == 1;
+
+    printf("%-32s %4.0f ms, %s, %s\n", "remove a running route", wait_time, (is_waited ? "waited for the sink" : "returned before the sink, failed"), (is_removed ? "removed by own sink" : "own sink removal failed"));
+
+    return is_waited && is_removed;
+}
+
+/**
+ * @brief Add and remove routes while other threads log through them, freeing the context after every removal
+ *
+ * @return true         No sink ran with a freed context
+ * @return false        Some sink ran after DbgRemoveRoute() returned
+ */
+static bool __RouteStressCase()
+{
+    std::atomic<bool>        is_stopped(false);
+    std::atomic<long>        logs_count(0);
+    std::vector<std::thread> log_threads;
+    long                     sinks_count = 0;
+    auto                     begin_time  = std::chrono::steady_clock::now();
+
+    DbgSetHandle(__RouteSingleHandle);
+    for (int task_idx = 0; task_idx < ROUTE_STRESS_TASKS; task_idx++)
+    {
+        log_threads.emplace_back([&is_stopped, &logs_count] {
+            while (!is_stopped)
+            {
+                DBGLOG_WARNING("stress %d", 0);
+                logs_count++;
+            }
+        });
+    }
+
+    for (int change_idx = 0; change_idx < ROUTE_STRESS_COUNT; change_idx++)
+    {
+        route_context_t * route_context = new route_context_t();
+        int               route_id      = DbgAddRoute(ESL_WARNING, nullptr, __RouteCheckSink, route_context);
+        long              sink_count    = 0;
+
+        std::this_thread::yield();
+        DbgRemoveRoute(route_id);
+        route_context->isValid = false;
+        sink_count             = route_context->sinkCount;
+        std::this_thread::yield();
+        if (route_context->sinkCount != sink_count) __RouteBadCount++;
+        sinks_count += sink_count;
+        delete route_context;
+    }
+
+    is_stopped = true;
+    for (std::thread & log_thread : log_threads) log_thread.join();
+    DbgSetHandle(nullptr);
+
+    printf("%-32s %4.0f ms, %d changes, %ld logs, %ld routed, %ld bad sinks\n", "change routes while logging", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_time).count(), ROUTE_STRESS_COUNT,
+           logs_count.load(), sinks_count, __RouteBadCount.load());
+
+    return __RouteBadCount == 0;
+}
+
+#if defined(_LINUX)
+/**
+ * @brief Count the records and write them to the logging file (Routing sink)
+ *
+ * @param sinkContext   Logging file (ZYLoggingFile *)
+ * @param logRecord     Log record
+ */
+static void __RouteFileSink(void * sinkContext, const dbg_log_record_t * logRecord)
+{
+    __RouteFileCount++;
+    ZYLoggingFile::routeSink(sinkContext, logRecord);
+}
+
+/**
+ * @brief Route the warnings to a mapped logging file whose chunk switch fails and logs a warning under its switch mutex
+ *
+ * @return true         The outputs returned, the warning of the file was dropped by its own sink
+ * @return false        The outputs deadlocked, or the warning was not emitted
+ */
+static bool __RouteFileCase()
+{
+    ZYLoggingFile     log_file(TSL_THREAD, "/tmp", "DbgRouteTest", ZYLoggingFile::NR_FIXED);
+    std::string       file_path  = "/tmp/DbgRouteTest.log";
+    std::string       line_datas(ROUTE_FILE_LINE, 'x');
+    struct rlimit     last_limit;
+    struct rlimit     file_limit;
+    int               route_id   = -1;
+    bool              is_passed  = false;
+    std::future<void> output_future;
+
+    remove(file_path.c_str());
+    if (!log_file.setWriteMode(ZYLoggingFile::WM_MAPPED) || getrlimit(RLIMIT_FSIZE, &last_limit) != 0)
+    {
+        printf("%-32s skipped\n", "route to a failing logging file");
+        return true;
+    }
+
+    // Growing the file over the limit fails with EFBIG instead of raising SIGXFSZ
+    signal(SIGXFSZ, SIG_IGN);
+    file_limit          = last_limit;
+    file_limit.rlim_cur = ROUTE_FILE_LIMIT;
+    setrlimit(RLIMIT_FSIZE, &file_limit);
+    route_id = DbgAddRoute(ESL_WARNING, nullptr, __RouteFileSink, &log_file);
+
+    output_future = std::async(std::launch::async, [&log_file, &line_datas] {
+        for (int line_idx = 0; line_idx <= ROUTE_FILE_LIMIT / ROUTE_FILE_LINE; line_idx++) log_file.outputText(ESL_INFOMATION, line_datas.c_str());
+    });
+    if (output_future.wait_for(std::chrono::milliseconds(ROUTE_FILE_WAIT)) != std::future_status::ready)
+    {
+        // The output thread holds the switch mutex forever, the process cannot clean up
+        printf("%-32s deadlocked, failed\n", "route to a failing logging file");
+        fflush(stdout);
+        _Exit(EXIT_FAILURE);
+    }
+
+    DbgRemoveRoute(route_id);
+    setrlimit(RLIMIT_FSIZE, &last_limit);
+    remove(file_path.c_str());
+
+    is_passed = __RouteFileCount > 0;
+    printf("%-32s %ld file warnings dropped%s\n", "route to a failing logging file", __RouteFileCount.load(), (is_passed ? "" : ", failed"));
+
+    return is_passed;
+}
+#endif
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    bool is_passed = true;
+
+    (void)argc;
+    (void)argv;
+    setvbuf(stdout, nullptr, _IONBF, 0);
+
+    is_passed = __RouteSwitchCase() && is_passed;
+    is_passed = __RouteRemoveCase() && is_passed;
+    is_passed = __RouteStressCase() && is_passed;
+#if defined(_LINUX)
+    is_passed = __RouteFileCase() && is_passed;
+#endif
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,389 @@
+/**
+ * @brief Logging Cat (Outputs the lines of a compressed logging file, also while the file is still written)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../Base/GlobalType.h"
+
+//================================================================================
+// Macro definition
+//================================================================================
+#define CAT_FRAME_MAGIC    0x184D2204    // LZ4 frame magic number
+#define CAT_SKIP_MAGIC     0x184D2A50    // LZ4 skippable frame magic number (Low 4 bits are free)
+#define CAT_FOLLOW_SLEEP   200           // Sleep time before reading the file again (Units: milliseconds; "--follow" option)
+
+//================================================================================
+// Type definition
+//================================================================================
+/**
+ * @brief LZ4 frame read result
+ */
+enum CAT_FRAME_RESULT
+{
+    CFR_DONE       = 0, // Frame decoded
+    CFR_INCOMPLETE = 1, // Frame is cut by the file end (Still written)
+    CFR_CORRUPTED  = 2  // Frame is not valid
+};
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Read 4 bytes in little endian
+ *
+ * @param srcDatas      Source datas
+ * @return uint32_t     Read value
+ */
+static uint32_t __CatGet32(const uchar * srcDatas)
+{
+    return (uint32_t)srcDatas[0] | (uint32_t)srcDatas[1] << 8 | (uint32_t)srcDatas[2] << 16 | (uint32_t)srcDatas[3] << 24;
+}
+
+/**
+ * @brief Read the file from the offset
+ *
+ * @param filePath      File path
+ * @param fileOffset    Read offset
+ * @param fileLength    Output read length
+ * @return char*        File datas (Free it with free(); Nullptr: failure)
+ */
+static uchar * __CatReadFile(const char * filePath, const long long fileOffset, size_t & fileLength)
+{
+    FILE *  file_handle = fopen(filePath, "rb");
+    uchar * file_datas  = nullptr;
+    size_t  file_size   = 0;
+
+    if (!file_handle) return nullptr;
+#if defined(_LINUX)
+    if (fseeko(file_handle, (off_t)fileOffset, SEEK_SET) != 0)
+#elif defined(_WINDOWS)
+    if (_fseeki64(file_handle, fileOffset, SEEK_SET) != 0)
+#endif
+    {
+        fclose(file_handle);
+        return nullptr;
+    }
+
+    for (;;)
+    {
+        uchar * new_datas = (uchar *)realloc(file_datas, file_size + 0x100000);
+        size_t  read_size = 0;
+
+        if (!new_datas) break;
+        file_datas  = new_datas;
+        read_size   = fread(file_datas + file_size, 1, 0x100000, file_handle);
+        file_size  += read_size;
+        if (read_size < 0x100000)
+        {
+            fclose(file_handle);
+            fileLength = file_size;
+            return file_datas;
+        }
+    }
+
+    fclose(file_handle);
+    free(file_datas);
+    return nullptr;
+}
+
+/**
+ * @brief Decode one LZ4 block (Matches may refer to the previous blocks of the frame)
+ *
+ * @param outDatas      Output datas (The previous blocks are before the output position)
+ * @param outOffset     Output position (Moved after the block)
+ * @param outLength     Output datas length
+ * @param blockDatas    Block datas
+ * @param blockLength   Block length
+ * @return true         Success
+ * @return false        Failure (The block is corrupted)
+ */
+static bool __CatLz4Block(uchar * outDatas, size_t & outOffset, const size_t outLength, const uchar * blockDatas, const size_t blockLength)
+{
+    size_t block_idx = 0;
+
+    while (block_idx < blockLength)
+    {
+        uchar  seq_token   = blockDatas[block_idx++];
+        size_t lit_len     = seq_token >> 4;
+        size_t match_len   = (seq_token & 0x0F) + 4;
+        size_t match_shift = 0;
+
+        if (lit_len == 15)
+        {
+            for (uchar add_len = 255; add_len == 255; lit_len += add_len)
+            {
+                if (block_idx >= blockLength) return false;
+                add_len = blockDatas[block_idx++];
+            }
+        }
+        if (lit_len > blockLength - block_idx || lit_len > outLength - outOffset) return false;
+        memcpy(outDatas + outOffset, blockDatas + block_idx, lit_len);
+        block_idx += lit_len;
+        outOffset += lit_len;
+
+        // The last sequence has literals only
+        if (block_idx == blockLength) break;
+
+        if (blockLength - block_idx < 2) return false;
+        match_shift  = (size_t)blockDatas[block_idx] | (size_t)blockDatas[block_idx + 1] << 8;
+        block_idx   += 2;
+        if (!match_shift || match_shift > outOffset) return false;
+        if (match_len == 19)
+        {
+            for (uchar add_len = 255; add_len == 255; match_len += add_len)
+            {
+                if (block_idx >= blockLength) return false;
+                add_len = blockDatas[block_idx++];
+            }
+        }
+        if (match_len > outLength - outOffset) return false;
+
+        // Overlapped matches repeat the bytes, copy them one by one
+        for (size_t match_idx = 0; match_idx < match_len; match_idx++, outOffset++) outDatas[outOffset] = outDatas[outOffset - match_shift];
+    }
+
+    return true;
+}
+
+/**
+ * @brief Read one LZ4 frame
+ *
+ * @param fileDatas     File datas from the frame
+ * @param fileLength    File datas length
+ * @param frameLength   Output frame length
+ * @param contentSize   Output content size (-1: unknown, the frame has no content size field)
+ * @param outDatas      Output decoded datas (Free it with free(); Nullptr: the frame is only measured)
+ * @param outLength     Output decoded length
+ * @return CAT_FRAME_RESULT Read result
+ */
+static CAT_FRAME_RESULT __CatReadFrame(const uchar * fileDatas, const size_t fileLength, size_t & frameLength, long long & contentSize, uchar ** outDatas, size_t & outLength)
+{
+    size_t  frame_idx  = 0;
+    uchar   frame_flag = 0;
+    size_t  block_max  = 0;
+    uchar * out_datas  = nullptr;
+    size_t  out_size   = 0;
+    size_t  out_offset = 0;
+
+    if (fileLength < 4) return CFR_INCOMPLETE;
+
+    // Skippable frames: magic number and length, the datas are not decoded
+    if ((__CatGet32(fileDatas) & 0xFFFFFFF0) == CAT_SKIP_MAGIC)
+    {
+        if (fileLength < 8) return CFR_INCOMPLETE;
+        frameLength = 8 + (size_t)__CatGet32(fileDatas + 4);
+        contentSize = 0;
+        outLength   = 0;
+        if (outDatas) *outDatas = nullptr;
+        return (frameLength > fileLength ? CFR_INCOMPLETE : CFR_DONE);
+    }
+
+    if (__CatGet32(fileDatas) != CAT_FRAME_MAGIC) return CFR_CORRUPTED;
+    if (fileLength < 7) return CFR_INCOMPLETE;
+
+    // Descriptor: FLG, BD, [content size], [dictionary ID], HC
+    frame_flag = fileDatas[4];
+    if ((frame_flag >> 6) != 1 || (frame_flag & 0x02)) return CFR_CORRUPTED;
+    if (((fileDatas[5] >> 4) & 0x07) < 4) return CFR_CORRUPTED;
+    block_max   = (size_t)1 << (8 + 2 * ((fileDatas[5] >> 4) & 0x07));
+    frame_idx   = 6 + ((frame_flag & 0x08) ? 8 : 0) + ((frame_flag & 0x01) ? 4 : 0) + 1;
+    contentSize = -1;
+    if (fileLength < frame_idx) return CFR_INCOMPLETE;
+    if (frame_flag & 0x08)
+    {
+        contentSize = (long long)((uint64_t)__CatGet32(fileDatas + 6) | (uint64_t)__CatGet32(fileDatas + 10) << 32);
+        if (contentSize < 0) return CFR_CORRUPTED;
+    }
+
+    // Blocks: length (High bit: stored as they are), datas, [block checksum]; The end mark is a zero length
+    for (;;)
+    {
+        uint32_t block_len = 0;
+        size_t   data_len  = 0;
+
+        if (fileLength - frame_idx < 4)
+        {
+            free(out_datas);
+            return CFR_INCOMPLETE;
+        }
+        block_len  = __CatGet32(fileDatas + frame_idx);
+        frame_idx += 4;
+        if (!block_len) break;
+
+        data_len = (size_t)(block_len & 0x7FFFFFFF);
+        if (data_len > block_max)
+        {
+            free(out_datas);
+            return CFR_CORRUPTED;
+        }
+        if (fileLength - frame_idx < data_len + ((frame_flag & 0x10) ? 4 : 0))
+        {
+            free(out_datas);
+            return CFR_INCOMPLETE;
+        }
+
+        if (outDatas)
+        {
+            // All blocks of the frame are decoded into one buffer, so linked blocks find their matches
+            if (out_size - out_offset < block_max)
+            {
+                uchar * new_datas = (uchar *)realloc(out_datas, out_offset + block_max);
+
+                if (!new_datas)
+                {
+                    free(out_datas);
+                    return CFR_CORRUPTED;
+                }
+                out_datas = new_datas;
+                out_size  = out_offset + block_max;
+            }
+
+            if (block_len & 0x80000000U)
+            {
+                memcpy(out_datas + out_offset, fileDatas + frame_idx, data_len);
+                out_offset += data_len;
+            }
+            else
+            {
+                if (!__CatLz4Block(out_datas, out_offset, out_size, fileDatas + frame_idx, data_len))
+                {
+                    free(out_datas);
+                    return CFR_CORRUPTED;
+                }
+            }
+        }
+        frame_idx += data_len + ((frame_flag & 0x10) ? 4 : 0);
+    }
+
+    // Content checksum after the end mark
+    if (frame_flag & 0x04)
+    {
+        if (fileLength - frame_idx < 4)
+        {
+            free(out_datas);
+            return CFR_INCOMPLETE;
+        }
+        frame_idx += 4;
+    }
+
+    frameLength = frame_idx;
+    outLength   = out_offset;
+    if (outDatas) *outDatas = out_datas;
+
+    return CFR_DONE;
+}
+
+/**
+ * @brief Sleep before reading the file again
+ */
+static void __CatSleep()
+{
+#if defined(_LINUX)
+    usleep(CAT_FOLLOW_SLEEP * 1000);
+#elif defined(_WINDOWS)
+    Sleep(CAT_FOLLOW_SLEEP);
+#endif
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    bool      is_follow   = false;
+    long long skip_length = 0;
+    long long file_offset = 0;
+    size_t    frame_count = 0;
+    int       arg_idx     = 1;
+
+    // Options: "--follow" waits for the frames written later, "--from <offset>" skips the lines before the uncompressed offset
+    for (; arg_idx < argc && strncmp(argv[arg_idx], "--", 2) == 0; arg_idx++)
+    {
+        if (strcmp(argv[arg_idx], "--follow") == 0)
+            is_follow = true;
+        else if (strcmp(argv[arg_idx], "--from") == 0 && arg_idx + 1 < argc)
+            skip_length = strtoll(argv[++arg_idx], nullptr, 10);
+        else
+            break;
+    }
+
+    if (arg_idx + 1 != argc || skip_length < 0)
+    {
+        fprintf(stderr, "Usage: %s [--follow] [--from <offset>] <log file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (;;)
+    {
+        size_t           file_length  = 0;
+        uchar *          file_datas   = __CatReadFile(argv[arg_idx], file_offset, file_length);
+        size_t           datas_idx    = 0;
+        CAT_FRAME_RESULT frame_result = CFR_DONE;
+
+        if (!file_datas)
+        {
+            fprintf(stderr, "Unable to read \"%s\".\n", argv[arg_idx]);
+            return EXIT_FAILURE;
+        }
+
+        while (datas_idx < file_length)
+        {
+            size_t    frame_len    = 0;
+            long long content_size = 0;
+            uchar *   out_datas    = nullptr;
+            size_t    out_len      = 0;
+
+            // Frames before the offset are passed by their content size without decoding
+            frame_result = __CatReadFrame(file_datas + datas_idx, file_length - datas_idx, frame_len, content_size, nullptr, out_len);
+            if (frame_result == CFR_DONE && content_size >= 0 && content_size <= skip_length)
+            {
+                skip_length -= content_size;
+                datas_idx   += frame_len;
+                frame_count++;
+                continue;
+            }
+
+            if (frame_result == CFR_DONE) frame_result = __CatReadFrame(file_datas + datas_idx, file_length - datas_idx, frame_len, content_size, &out_datas, out_len);
+            if (frame_result != CFR_DONE) break;
+
+            if ((size_t)skip_length < out_len) fwrite(out_datas + skip_length, 1, out_len - (size_t)skip_length, stdout);
+            skip_length = ((size_t)skip_length < out_len ? 0 : skip_length - (long long)out_len);
+            free(out_datas);
+            datas_idx += frame_len;
+            frame_count++;
+        }
+        free(file_datas);
+        file_offset += (long long)datas_idx;
+        fflush(stdout);
+
+        if (frame_result == CFR_CORRUPTED)
+        {
+            fprintf(stderr, "%s: frame %zu at offset %lld is corrupted.\n", argv[arg_idx], frame_count, file_offset);
+            return EXIT_FAILURE;
+        }
+        if (!is_follow)
+        {
+            // The last frame is still written, or was cut by a crash
+            if (frame_result == CFR_INCOMPLETE) fprintf(stderr, "%s: frame %zu at offset %lld is incomplete.\n", argv[arg_idx], frame_count, file_offset);
+            break;
+        }
+
+        // The incomplete frame is read again with the frames written after it
+        __CatSleep();
+    }
+
+    fprintf(stderr, "%s: %zu frames decoded, %lld bytes read.\n", argv[arg_idx], frame_count, file_offset);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+/**
+ * @brief Logging Durable Benchmark (Measures the latency and throughput of ZYLoggingFile per durability level)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Base/BaseDefine.h"
+#include "../Module/LoggingFile.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_SYNC_INTERVAL 50 // Sync interval of DL_PERIODIC (Units: milliseconds)
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Benchmark case
+ */
+struct bench_case_t
+{
+    const char *                    caseName;        // Case name
+    ZYLoggingFile::DURABILITY_LEVEL durabilityLevel; // Durability level
+    int                             threadsCount;    // Output threads count
+    int                             linesCount;      // Lines count of every thread
+    bool                            isWaiting;       // Whether every line waits until it is durable
+    bool                            isDurable;       // Whether waitDurable() should succeed
+};
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Output the benchmark lines of a thread
+ *
+ * @param logFile       Logging file
+ * @param benchCase     Benchmark case
+ * @param threadIndex   Thread index
+ * @param lineLatency   Output latency of every line (Units: microseconds)
+ * @param failCount     Lines whose waitDurable() result was unexpected
+ */
+static void __BenchOutputThread(const ZYLoggingFile * logFile, const bench_case_t * benchCase, const int threadIndex, std::vector<double> * lineLatency, std::atomic<int> * failCount)
+{
+    lineLatency->reserve(benchCase->linesCount);
+
+    for (int loop_idx = 0; loop_idx < benchCase->linesCount; loop_idx++)
+    {
+        auto   begin_time  = std::chrono::steady_clock::now();
+        size_t line_ticket = logFile->outputLine(ESL_INFOMATION, "audit thread=%d seq=%d account=%d amount=%d", threadIndex, loop_idx, loop_idx * 7, loop_idx % 1000);
+
+        if (benchCase->isWaiting && logFile->waitDurable(line_ticket) != benchCase->isDurable) (*failCount)++;
+        lineLatency->push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin_time).count());
+    }
+}
+
+/**
+ * @brief Run one benchmark case (The file is removed afterwards)
+ *
+ * @param dirPath       Log directory path
+ * @param benchCase     Benchmark case
+ * @return true         Every line got the expected durability
+ * @return false        Some lines did not
+ */
+static bool __BenchDurableCase(const char * dirPath, const bench_case_t & benchCase)
+{
+    std::vector<std::vector<double>> thread_latency(benchCase.threadsCount);
+    std::vector<double>              line_latency;
+    std::vector<std::thread>         output_threads;
+    std::atomic<int>                 fail_count(0);
+    ZYLoggingFile::WriterStats       write_stats;
+    double                           lines_rate = 0;
+
+    {
+        ZYLoggingFile log_file(TSL_THREAD, dirPath, "bench_durable", ZYLoggingFile::NR_FIXED);
+        auto          begin_time = std::chrono::steady_clock::now();
+
+        log_file.setDurability(benchCase.durabilityLevel, BENCH_SYNC_INTERVAL);
+        for (int thread_idx = 0; thread_idx < benchCase.threadsCount; thread_idx++)
+        {
+            output_threads.emplace_back(__BenchOutputThread, &log_file, &benchCase, thread_idx, &thread_latency[thread_idx], &fail_count);
+        }
+        for (std::thread & output_thread : output_threads) output_thread.join();
+
+        lines_rate = benchCase.threadsCount * benchCase.linesCount / std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_time).count();
+        log_file.flush();
+        log_file.getStats(write_stats);
+    }
+    remove((std::string(dirPath) + "/bench_durable.log").c_str());
+
+    for (const std::vector<double> & latency_list : thread_latency) line_latency.insert(line_latency.end(), latency_list.begin(), latency_list.end());
+    std::sort(line_latency.begin(), line_latency.end());
+
+    printf("%-30s %9.0f lines/s, p50 %8.1f us, p99 %8.1f us, max %8.1f us, %5zu syncs (avg %6.0f us), %d failed\n", benchCase.caseName, lines_rate, line_latency[line_latency.size() / 2],
+           line_latency[line_latency.size() * 99 / 100], line_latency.back(), write_stats.syncCount, (write_stats.syncCount ? (double)write_stats.syncTime / write_stats.syncCount : 0.0), fail_count.load());
+
+    return fail_count == 0;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    const bench_case_t BENCH_CASES[] = {
+        {"none, 1 thread",                ZYLoggingFile::DL_NONE,     1,  1000000, false, false},
+        {"none, 1 thread, wait",          ZYLoggingFile::DL_NONE,     1,  1000,    true,  false},
+        {"periodic, 1 thread",            ZYLoggingFile::DL_PERIODIC, 1,  1000000, false, true },
+        {"periodic, 1 thread, wait",      ZYLoggingFile::DL_PERIODIC, 1,  100,     true,  true },
+        {"periodic, 4 threads, wait",     ZYLoggingFile::DL_PERIODIC, 4,  100,     true,  true },
+        {"group, 1 thread",               ZYLoggingFile::DL_GROUP,    1,  1000000, false, true },
+        {"group, 1 thread, wait",         ZYLoggingFile::DL_GROUP,    1,  2000,    true,  true },
+        {"group, 4 threads, wait",        ZYLoggingFile::DL_GROUP,    4,  2000,    true,  true },
+        {"group, 16 threads, wait",       ZYLoggingFile::DL_GROUP,    16, 500,     true,  true },
+    };
+    bool is_passed = true;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <log directory>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Periodic syncs every BENCH_SYNC_INTERVAL ms, a waiting line of it waits for the next sync; A group sync is shared by the lines waiting together
+    for (const bench_case_t & bench_case : BENCH_CASES) is_passed = __BenchDurableCase(argv[1], bench_case) && is_passed;
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
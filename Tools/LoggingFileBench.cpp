@@ -0,0 +1,126 @@
+/**
+ * @brief Logging File Benchmark (Measures the lines per second of ZYLoggingFile)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Base/BaseDefine.h"
+#include "../Module/LoggingFile.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_LINES_COUNT 1000000 // Default lines of a benchmark case (All threads)
+#define BENCH_TARGET_RATE 1e6     // Expected lines per second of one thread
+
+// Benchmark case
+#define BENCH_CASE_FORMAT 0 // outputLine() with a formatted line
+#define BENCH_CASE_TEXT   1 // outputText() with a fixed line
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Output the benchmark lines of a thread
+ *
+ * @param logFile       Logging file
+ * @param benchCase     Benchmark case (Use BENCH_CASE_* macros)
+ * @param threadIndex   Thread index
+ * @param linesCount    Lines count
+ */
+static void __BenchOutputThread(const ZYLoggingFile * logFile, const int benchCase, const int threadIndex, const int linesCount)
+{
+    for (int loop_idx = 0; loop_idx < linesCount; loop_idx++)
+    {
+        if (benchCase == BENCH_CASE_FORMAT)
+            logFile->outputLine(ESL_INFOMATION, "request id=%d thread=%d path=%s status=%d", loop_idx, threadIndex, "/api/v1/items", 200);
+        else
+            logFile->outputText(ESL_INFOMATION, "request id path status fixed content line");
+    }
+}
+
+/**
+ * @brief Run one benchmark case (The file is removed afterwards)
+ *
+ * @param dirPath       Log directory path
+ * @param caseName      Case name (Also the file name)
+ * @param benchCase     Benchmark case (Use BENCH_CASE_* macros)
+ * @param threadsCount  Output threads count
+ * @param linesCount    Lines count of all threads
+ * @param writeMode     File write mode
+ * @return double       Lines per second (0: lines lost)
+ */
+static double __BenchOutputCase(const char * dirPath, const char * caseName, const int benchCase, const int threadsCount, const int linesCount, const ZYLoggingFile::WRITE_MODE writeMode)
+{
+    std::string                file_path   = std::string(dirPath) + "/" + caseName + ".log";
+    ZYLoggingFile::WriterStats write_stats;
+    double                     lines_rate  = 0;
+    struct stat                file_stat;
+
+    {
+        ZYLoggingFile            log_file(TSL_THREAD, dirPath, caseName, ZYLoggingFile::NR_FIXED);
+        std::vector<std::thread> output_threads;
+        auto                     begin_time = std::chrono::steady_clock::now();
+
+        log_file.setWriteMode(writeMode);
+        for (int thread_idx = 0; thread_idx < threadsCount; thread_idx++) output_threads.emplace_back(__BenchOutputThread, &log_file, benchCase, thread_idx, linesCount / threadsCount);
+        for (std::thread & output_thread : output_threads) output_thread.join();
+        log_file.flush();
+
+        lines_rate = linesCount / std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_time).count();
+        log_file.getStats(write_stats);
+    }
+
+    // Every line must be on the file, the writer thread may not drop any
+    if (write_stats.lineCount != (size_t)(linesCount / threadsCount * threadsCount) || stat(file_path.c_str(), &file_stat) != 0 || (size_t)file_stat.st_size != write_stats.writeBytes)
+    {
+        fprintf(stderr, "%s: %zu of %d lines written, %zu bytes\n", caseName, write_stats.lineCount, linesCount, write_stats.writeBytes);
+        lines_rate = 0;
+    }
+    remove(file_path.c_str());
+
+    printf("%-24s %d thread(s): %6.2f M lines/s, %7.1f MB/s, %zu buffers, %zu stalls\n", caseName, threadsCount, lines_rate / 1e6, (lines_rate ? write_stats.writeBytes / (linesCount / lines_rate) / 1e6 : 0),
+           write_stats.writeCount, write_stats.stallCount);
+
+    return lines_rate;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    int  lines_count = BENCH_LINES_COUNT;
+    bool is_passed   = true;
+
+    if (argc > 2) lines_count = atoi(argv[2]);
+    if (argc < 2 || lines_count <= 0)
+    {
+        fprintf(stderr, "Usage: %s <log directory> [lines count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    is_passed = (__BenchOutputCase(argv[1], "bench_format", BENCH_CASE_FORMAT, 1, lines_count, ZYLoggingFile::WM_BUFFERED) >= BENCH_TARGET_RATE) && is_passed;
+    is_passed = (__BenchOutputCase(argv[1], "bench_text", BENCH_CASE_TEXT, 1, lines_count, ZYLoggingFile::WM_BUFFERED) >= BENCH_TARGET_RATE) && is_passed;
+    is_passed = (__BenchOutputCase(argv[1], "bench_format_threads", BENCH_CASE_FORMAT, 4, lines_count, ZYLoggingFile::WM_BUFFERED) > 0) && is_passed;
+    is_passed = (__BenchOutputCase(argv[1], "bench_format_uring", BENCH_CASE_FORMAT, 1, lines_count, ZYLoggingFile::WM_URING) > 0) && is_passed;
+
+    if (!is_passed) fprintf(stderr, "Expected no lost lines and at least %.0f lines/s from one thread\n", BENCH_TARGET_RATE);
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,151 @@
+/**
+ * @brief Logging File Recover (Recovers the valid lines of a mapped logging file after a crash)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../Base/BaseDefine.h"
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Read whole file
+ *
+ * @param filePath      File path
+ * @param fileLength    Output file length
+ * @return char*        File datas (Free it with free(); Nullptr: failure)
+ */
+static char * __RecoverReadFile(const char * filePath, size_t & fileLength)
+{
+    FILE * file_handle = fopen(filePath, "rb");
+    char * file_datas  = nullptr;
+    size_t file_size   = 0;
+
+    if (!file_handle) return nullptr;
+
+    for (;;)
+    {
+        char * new_datas = (char *)realloc(file_datas, file_size + 0x100000);
+        size_t read_size = 0;
+
+        if (!new_datas) break;
+        file_datas  = new_datas;
+        read_size   = fread(file_datas + file_size, 1, 0x100000, file_handle);
+        file_size  += read_size;
+        if (read_size < 0x100000)
+        {
+            fclose(file_handle);
+            fileLength = file_size;
+            return file_datas;
+        }
+    }
+
+    fclose(file_handle);
+    free(file_datas);
+    return nullptr;
+}
+
+/**
+ * @brief Get the length of the complete lines before the first zero byte (Reserved bytes that were not copied before the crash are zeros)
+ *
+ * @param fileDatas     File datas
+ * @param fileLength    File length
+ * @return size_t       Complete lines length
+ */
+static size_t __RecoverLinesLength(const char * fileDatas, const size_t fileLength)
+{
+    const char * zero_pos  = (const char *)memchr(fileDatas, '\0', fileLength);
+    size_t       lines_len = (zero_pos ? (size_t)(zero_pos - fileDatas) : fileLength);
+
+    // A line cut by the crash has no line break
+    while (lines_len > 0 && fileDatas[lines_len - 1] != '\n') lines_len--;
+
+    return lines_len;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    bool is_skip  = false;
+    bool is_cut   = false;
+    int  file_idx = 1;
+
+    // Options: "--skip-holes" outputs the complete lines after the holes too, "--truncate" cuts the file to the valid prefix
+    for (; file_idx < argc && strncmp(argv[file_idx], "--", 2) == 0; file_idx++)
+    {
+        if (strcmp(argv[file_idx], "--skip-holes") == 0)
+            is_skip = true;
+        else if (strcmp(argv[file_idx], "--truncate") == 0)
+            is_cut = true;
+        else
+            break;
+    }
+
+    if (argc <= file_idx || (is_skip && is_cut))
+    {
+        fprintf(stderr, "Usage: %s [--skip-holes|--truncate] <log file> [log file ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int arg_idx = file_idx; arg_idx < argc; arg_idx++)
+    {
+        size_t file_length = 0;
+        char * file_datas  = __RecoverReadFile(argv[arg_idx], file_length);
+        size_t valid_len   = 0;
+        size_t lines_count = 0;
+
+        if (!file_datas)
+        {
+            fprintf(stderr, "Unable to read \"%s\".\n", argv[arg_idx]);
+            return EXIT_FAILURE;
+        }
+
+        valid_len = __RecoverLinesLength(file_datas, file_length);
+        for (size_t datas_idx = 0; datas_idx < file_length;)
+        {
+            size_t lines_len = __RecoverLinesLength(file_datas + datas_idx, file_length - datas_idx);
+
+            if (!is_cut) fwrite(file_datas + datas_idx, 1, lines_len, stdout);
+            for (size_t line_idx = 0; line_idx < lines_len; line_idx++) lines_count += (file_datas[datas_idx + line_idx] == '\n');
+            if (!is_skip) break;
+
+            // Skip the cut line and the hole, the next line starts after the zeros
+            datas_idx += lines_len;
+            while (datas_idx < file_length && file_datas[datas_idx]) datas_idx++;
+            while (datas_idx < file_length && !file_datas[datas_idx]) datas_idx++;
+        }
+        free(file_datas);
+
+        if (is_cut)
+        {
+#if defined(_LINUX)
+            if (truncate(argv[arg_idx], (off_t)valid_len) != 0)
+            {
+                fprintf(stderr, "Unable to truncate \"%s\": %s\n", argv[arg_idx], strerror(errno));
+                return EXIT_FAILURE;
+            }
+#else
+            fprintf(stderr, "Truncating is not supported on this platform.\n");
+            return EXIT_FAILURE;
+#endif
+        }
+
+        fprintf(stderr, "%s: %zu lines recovered, valid prefix %zu of %zu bytes.\n", argv[arg_idx], lines_count, valid_len, file_length);
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,318 @@
+/**
+ * @brief Thread Lock Benchmark (Compares the futex read/write lock with the mutex and semaphore state machine it replaced)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../Base/BaseDefine.h"
+#include "../Base/GlobalType.h"
+#include "../Module/ThreadSafe.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define BENCH_LOOP_COUNT  1000000 // Default lock operations of a benchmark case (All threads)
+#define BENCH_HOLD_SPINS  20      // Loops done while holding the lock
+#define BENCH_PROCS_COUNT 4       // Processes of the process case
+
+// Reference lock status
+#define BENCH_STATUS_IDLE  0 // Not locked
+#define BENCH_STATUS_READ  1 // Read locked
+#define BENCH_STATUS_WRITE 2 // Write locked
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Reference read/write lock (The mutex and semaphore state machine of the previous implementation)
+ */
+struct bench_old_rwlock_t
+{
+    uchar           lockStatus;    // Lock status (Use BENCH_STATUS_* macros)
+    uint            lockedCount;   // Read lock count or write lock depth
+    uint            rwaitingCount; // Waiting readers
+    uint            wwaitingCount; // Waiting writers
+    pid_t           writeThreadID; // Native thread ID of the writer
+    pthread_mutex_t innerLock;     // Lock of the status
+    sem_t           innerSem;      // Waiting readers and writers
+};
+
+/**
+ * @brief Datas protected by the benchmark lock (Shared by the processes)
+ */
+struct bench_shared_t
+{
+    volatile long writeBegin; // Writes begun
+    volatile long writeEnd;   // Writes ended (Differs from writeBegin only inside a write lock)
+    long          badCount;   // Reads that saw a write in progress
+};
+
+/**
+ * @brief Benchmark target (One of the locks)
+ */
+struct bench_target_t
+{
+    ThreadLock *         threadLock;  // Futex lock (Nullptr: reference lock)
+    bench_old_rwlock_t * oldLock;     // Reference lock
+    bench_shared_t *     sharedDatas; // Protected datas
+};
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Create the reference lock
+ *
+ * @param isMultiProcess Whether to share the lock with forked processes
+ * @return bench_old_rwlock_t* Reference lock (Mapped shared memory)
+ */
+static bench_old_rwlock_t * __BenchOldCreate(const bool isMultiProcess)
+{
+    bench_old_rwlock_t * old_lock = (bench_old_rwlock_t *)mmap(NULL, sizeof(bench_old_rwlock_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    pthread_mutexattr_t  inner_attr;
+
+    if (old_lock == MAP_FAILED) return nullptr;
+
+    pthread_mutexattr_init(&inner_attr);
+    pthread_mutexattr_setpshared(&inner_attr, isMultiProcess ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE);
+    pthread_mutex_init(&old_lock->innerLock, &inner_attr);
+    pthread_mutexattr_destroy(&inner_attr);
+    sem_init(&old_lock->innerSem, 1, 0);
+
+    return old_lock;
+}
+
+/**
+ * @brief Destroy the reference lock
+ *
+ * @param oldLock       Reference lock
+ */
+static void __BenchOldDestroy(bench_old_rwlock_t * oldLock)
+{
+    pthread_mutex_destroy(&oldLock->innerLock);
+    sem_destroy(&oldLock->innerSem);
+    munmap(oldLock, sizeof(bench_old_rwlock_t));
+}
+
+/**
+ * @brief Lock the reference lock (Every acquire takes the inner mutex, waiters share one semaphore)
+ *
+ * @param oldLock       Reference lock
+ * @param isWrite       Whether to write lock
+ */
+static void __BenchOldLock(bench_old_rwlock_t * oldLock, const bool isWrite)
+{
+    pid_t current_threadid = (isWrite ? (pid_t)syscall(SYS_gettid) : 0);
+    bool  wait_return      = false;
+
+    while (true)
+    {
+        pthread_mutex_lock(&oldLock->innerLock);
+        if (wait_return) (isWrite ? oldLock->wwaitingCount-- : oldLock->rwaitingCount--);
+
+        if (oldLock->lockStatus == BENCH_STATUS_IDLE)
+        {
+            oldLock->lockStatus = (isWrite ? BENCH_STATUS_WRITE : BENCH_STATUS_READ);
+            oldLock->lockedCount++;
+            if (isWrite) oldLock->writeThreadID = current_threadid;
+            pthread_mutex_unlock(&oldLock->innerLock);
+            break;
+        }
+        else if ((!isWrite && oldLock->lockStatus == BENCH_STATUS_READ && oldLock->wwaitingCount == 0) || (isWrite && oldLock->lockStatus == BENCH_STATUS_WRITE && oldLock->writeThreadID == current_threadid))
+        {
+            oldLock->lockedCount++;
+            pthread_mutex_unlock(&oldLock->innerLock);
+            break;
+        }
+
+        (isWrite ? oldLock->wwaitingCount++ : oldLock->rwaitingCount++);
+        pthread_mutex_unlock(&oldLock->innerLock);
+        sem_wait(&oldLock->innerSem);
+        wait_return = true;
+    }
+}
+
+/**
+ * @brief Unlock the reference lock (Wakes one waiter, which retries)
+ *
+ * @param oldLock       Reference lock
+ */
+static void __BenchOldUnlock(bench_old_rwlock_t * oldLock)
+{
+    // The previous implementation read the native thread ID on every unlock
+    (void)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&oldLock->innerLock);
+    if (oldLock->lockedCount > 0) oldLock->lockedCount--;
+    if (oldLock->lockedCount == 0)
+    {
+        if (oldLock->lockStatus == BENCH_STATUS_WRITE) oldLock->writeThreadID = 0;
+        oldLock->lockStatus = BENCH_STATUS_IDLE;
+        if (oldLock->wwaitingCount > 0 || oldLock->rwaitingCount > 0) sem_post(&oldLock->innerSem);
+    }
+    pthread_mutex_unlock(&oldLock->innerLock);
+}
+
+/**
+ * @brief Access the protected datas
+ *
+ * @param sharedDatas   Protected datas
+ * @param isWrite       Whether the write lock is held
+ */
+static void __BenchCritical(bench_shared_t * sharedDatas, const bool isWrite)
+{
+    if (isWrite) sharedDatas->writeBegin++;
+    if (!isWrite && sharedDatas->writeBegin != sharedDatas->writeEnd) sharedDatas->badCount++;
+    for (int loop_idx = 0; loop_idx < BENCH_HOLD_SPINS; loop_idx++) __asm__ volatile("");
+    if (isWrite) sharedDatas->writeEnd++;
+}
+
+/**
+ * @brief Lock and unlock in a loop (Write locks are taken twice to cover re-entrancy)
+ *
+ * @param benchTarget   Benchmark target
+ * @param loopCount     Lock operations count
+ * @param writePercent  Percent of write locks
+ * @param randomSeed    Random seed
+ */
+static void __BenchLockThread(const bench_target_t * benchTarget, const int loopCount, const int writePercent, uint randomSeed)
+{
+    for (int loop_idx = 0; loop_idx < loopCount; loop_idx++)
+    {
+        bool is_write = false;
+
+        randomSeed = randomSeed * 1103515245 + 12345;
+        is_write   = (int)((randomSeed >> 16) % 100) < writePercent;
+
+        if (benchTarget->threadLock)
+        {
+            LockGuard lock_guard(benchTarget->threadLock, (is_write ? ThreadLock::Write : ThreadLock::Read), true);
+
+            if (is_write)
+            {
+                LockGuard nested_guard(benchTarget->threadLock, ThreadLock::Write, true);
+                __BenchCritical(benchTarget->sharedDatas, true);
+            }
+            else
+            {
+                __BenchCritical(benchTarget->sharedDatas, false);
+            }
+        }
+        else
+        {
+            __BenchOldLock(benchTarget->oldLock, is_write);
+            if (is_write) __BenchOldLock(benchTarget->oldLock, true);
+            __BenchCritical(benchTarget->sharedDatas, is_write);
+            if (is_write) __BenchOldUnlock(benchTarget->oldLock);
+            __BenchOldUnlock(benchTarget->oldLock);
+        }
+    }
+}
+
+/**
+ * @brief Run one benchmark case
+ *
+ * @param benchTarget   Benchmark target
+ * @param threadsCount  Lock threads count (Negative: forked processes count)
+ * @param loopCount     Lock operations count of all threads
+ * @param writePercent  Percent of write locks
+ * @return double       Nanoseconds per lock operation (Negative: the lock failed to exclude)
+ */
+static double __BenchLockCase(const bench_target_t * benchTarget, const int threadsCount, const int loopCount, const int writePercent)
+{
+    std::vector<std::thread> lock_threads;
+    bench_shared_t *         shared_datas = benchTarget->sharedDatas;
+    auto                     begin_time   = std::chrono::steady_clock::now();
+    double                   lock_cost    = 0;
+
+    shared_datas->writeBegin = shared_datas->writeEnd = shared_datas->badCount = 0;
+
+    if (threadsCount > 0)
+    {
+        for (int thread_idx = 0; thread_idx < threadsCount; thread_idx++) lock_threads.emplace_back(__BenchLockThread, benchTarget, loopCount / threadsCount, writePercent, thread_idx * 77 + 1);
+        for (std::thread & lock_thread : lock_threads) lock_thread.join();
+    }
+    else
+    {
+        for (int proc_idx = 0; proc_idx < -threadsCount; proc_idx++)
+        {
+            if (fork() != 0) continue;
+            __BenchLockThread(benchTarget, loopCount / -threadsCount, writePercent, proc_idx * 13 + 5);
+            _exit(EXIT_SUCCESS);
+        }
+        for (int proc_idx = 0; proc_idx < -threadsCount; proc_idx++) wait(nullptr);
+    }
+
+    lock_cost = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin_time).count() / loopCount;
+
+    return (shared_datas->badCount == 0 && shared_datas->writeBegin == shared_datas->writeEnd ? lock_cost : -lock_cost);
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    bench_shared_t * shared_datas = (bench_shared_t *)mmap(NULL, sizeof(bench_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int              loop_count   = BENCH_LOOP_COUNT;
+    bool             is_passed    = true;
+
+    if (argc > 1) loop_count = atoi(argv[1]);
+    if (loop_count <= 0 || shared_datas == MAP_FAILED)
+    {
+        fprintf(stderr, "Usage: %s [lock operations count]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int shared_idx = 0; shared_idx < 2; shared_idx++)
+    {
+        ThreadLock     thread_lock(ThreadLock::RwLock, (shared_idx ? "ThreadLockBench" : nullptr));
+        bench_target_t new_target = {&thread_lock, nullptr, shared_datas};
+        bench_target_t old_target = {nullptr, __BenchOldCreate(shared_idx != 0), shared_datas};
+
+        if (!old_target.oldLock) return EXIT_FAILURE;
+
+        for (int threads_count : {1, 4, -BENCH_PROCS_COUNT})
+        {
+            for (int write_percent : {0, 10, 50, 100})
+            {
+                double new_cost = 0;
+                double old_cost = 0;
+
+                // Forked processes share the process lock only, and run the mixed workload only
+                if (threads_count < 0 && (!shared_idx || write_percent != 50)) continue;
+
+                new_cost  = __BenchLockCase(&new_target, threads_count, loop_count, write_percent);
+                old_cost  = __BenchLockCase(&old_target, threads_count, loop_count, write_percent);
+                is_passed = is_passed && new_cost > 0 && old_cost > 0;
+
+                printf("%s %d %-9s write %3d%%: futex %7.1f ns/op, mutex+semaphore %7.1f ns/op (%.1fx)%s\n", (shared_idx ? "process" : "thread "), (threads_count > 0 ? threads_count : -threads_count),
+                       (threads_count > 0 ? "thread(s)" : "processes"), write_percent, new_cost, old_cost, old_cost / new_cost, (new_cost > 0 && old_cost > 0 ? "" : " EXCLUSION FAILED"));
+            }
+        }
+
+        __BenchOldDestroy(old_target.oldLock);
+    }
+
+    munmap(shared_datas, sizeof(bench_shared_t));
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
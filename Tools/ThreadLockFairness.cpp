@@ -0,0 +1,255 @@
+/**
+ * @brief Thread Lock Fairness Test (Measures the acquire latency and the share of every thread on RwLock under mixed workloads)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../Base/BaseDefine.h"
+#include "../Module/ThreadSafe.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define FAIR_RUN_MILLISECONDS 2000 // Default run time of a workload
+#define FAIR_RATIO_BOUND      3.0  // Max skew of the per thread read/write ratio (Checked both ways: a reader thread locks 1/3 to 3 times as often as a writer thread)
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Mixed workload
+ */
+struct fair_workload_t
+{
+    const char * workloadName; // Workload name
+    int          readersCount; // Reader threads
+    int          writersCount; // Writer threads
+    long         holdTime;     // Time every lock is held (Units: nanoseconds; The holder also yields inside)
+    long         readGap;      // Time a reader pauses between locks (Units: nanoseconds)
+    long         writeGap;     // Time a writer pauses between locks (Units: nanoseconds)
+    bool         ratioCheck;   // Whether the per thread read/write ratio is checked (Phase-fair handoff keeps it near the writers count)
+};
+
+/**
+ * @brief Datas of a worker thread
+ */
+struct fair_worker_t
+{
+    ThreadLock *            threadLock;  // Tested lock
+    const fair_workload_t * workLoad;    // Workload
+    bool                    isWrite;     // Whether the worker write locks
+    std::vector<double>     lockLatency; // Acquire latency of every lock (Units: microseconds)
+};
+
+//================================================================================
+// Define inside variable
+//================================================================================
+static std::atomic<bool> __FairStopFlag(false); // Whether the workers should stop
+static volatile long     __FairWriteBegin = 0;  // Writes begun
+static volatile long     __FairWriteEnd   = 0;  // Writes ended (Differs from the begun count only inside a write lock)
+static std::atomic<long> __FairBadCount(0);     // Reads that saw a write in progress
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Busy wait
+ *
+ * @param waitTime      Wait time (Units: nanoseconds)
+ */
+static void __FairBusyWait(const long waitTime)
+{
+    auto begin_time = std::chrono::steady_clock::now();
+
+    while (std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin_time).count() < waitTime) continue;
+}
+
+/**
+ * @brief Lock and unlock until stopped
+ *
+ * @param fairWorker    Worker datas
+ */
+static void __FairWorkerThread(fair_worker_t * fairWorker)
+{
+    fairWorker->lockLatency.reserve(1 << 20);
+
+    while (!__FairStopFlag.load(std::memory_order_relaxed))
+    {
+        auto      begin_time = std::chrono::steady_clock::now();
+        LockGuard lock_guard(fairWorker->threadLock, (fairWorker->isWrite ? ThreadLock::Write : ThreadLock::Read), true);
+
+        fairWorker->lockLatency.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin_time).count());
+        if (fairWorker->isWrite) __FairWriteBegin++;
+        if (!fairWorker->isWrite && __FairWriteBegin != __FairWriteEnd) __FairBadCount++;
+        __FairBusyWait(fairWorker->workLoad->holdTime);
+        std::this_thread::yield();
+        if (!fairWorker->isWrite && __FairWriteBegin != __FairWriteEnd) __FairBadCount++;
+        if (fairWorker->isWrite) __FairWriteEnd++;
+        lock_guard.unLock();
+
+        __FairBusyWait(fairWorker->isWrite ? fairWorker->workLoad->writeGap : fairWorker->workLoad->readGap);
+    }
+}
+
+/**
+ * @brief Report the acquisitions of one role
+ *
+ * @param roleName      Role name
+ * @param fairWorkers   Workers
+ * @param isWrite       Role of the reported workers
+ * @return true         Every worker of the role acquired the lock
+ * @return false        Some worker starved
+ */
+static bool __FairReport(const char * roleName, const std::vector<fair_worker_t> & fairWorkers, const bool isWrite)
+{
+    std::vector<double> lock_latency;
+    size_t              min_count = 0;
+    size_t              max_count = 0;
+    size_t              all_count = 0;
+    bool                is_first  = true;
+
+    for (const fair_worker_t & fair_worker : fairWorkers)
+    {
+        if (fair_worker.isWrite != isWrite) continue;
+
+        min_count = (is_first ? fair_worker.lockLatency.size() : std::min(min_count, fair_worker.lockLatency.size()));
+        max_count = std::max(max_count, fair_worker.lockLatency.size());
+        is_first  = false;
+        lock_latency.insert(lock_latency.end(), fair_worker.lockLatency.begin(), fair_worker.lockLatency.end());
+    }
+
+    all_count = lock_latency.size();
+    if (is_first) return true;
+    if (all_count == 0)
+    {
+        printf("    %s: no acquisition\n", roleName);
+        return false;
+    }
+
+    std::sort(lock_latency.begin(), lock_latency.end());
+    printf("    %s: %8zu locks (per thread %zu - %zu), p50 %7.1f us, p99 %7.1f us, p99.9 %7.1f us, max %8.1f us\n", roleName, all_count, min_count, max_count, lock_latency[all_count / 2],
+           lock_latency[all_count * 99 / 100], lock_latency[all_count * 999 / 1000], lock_latency[all_count - 1]);
+
+    return min_count > 0;
+}
+
+/**
+ * @brief Get the average acquisitions of a thread of one role
+ *
+ * @param fairWorkers   Workers
+ * @param isWrite       Role of the averaged workers
+ * @return double       Average acquisitions (0: no worker of the role)
+ */
+static double __FairAverage(const std::vector<fair_worker_t> & fairWorkers, const bool isWrite)
+{
+    size_t all_count    = 0;
+    size_t worker_count = 0;
+
+    for (const fair_worker_t & fair_worker : fairWorkers)
+    {
+        if (fair_worker.isWrite != isWrite) continue;
+
+        all_count += fair_worker.lockLatency.size();
+        worker_count++;
+    }
+
+    return (worker_count ? (double)all_count / worker_count : 0);
+}
+
+/**
+ * @brief Run one workload
+ *
+ * @param threadLock    Tested lock
+ * @param workLoad      Workload
+ * @param runTime       Run time (Units: milliseconds)
+ * @return true         No thread starved, the lock excluded and the read/write ratio is within the bound
+ * @return false        Some thread starved, a read saw a write in progress or one role got most of the lock
+ */
+static bool __FairRunWorkload(ThreadLock * threadLock, const fair_workload_t & workLoad, const int runTime)
+{
+    std::vector<fair_worker_t> fair_workers(workLoad.readersCount + workLoad.writersCount);
+    std::vector<std::thread>   worker_threads;
+    bool                       is_passed = true;
+
+    __FairStopFlag   = false;
+    __FairWriteBegin = __FairWriteEnd = 0;
+    __FairBadCount   = 0;
+
+    for (size_t worker_idx = 0; worker_idx < fair_workers.size(); worker_idx++)
+    {
+        fair_workers[worker_idx].threadLock = threadLock;
+        fair_workers[worker_idx].workLoad   = &workLoad;
+        fair_workers[worker_idx].isWrite    = (int)worker_idx >= workLoad.readersCount;
+        worker_threads.emplace_back(__FairWorkerThread, &fair_workers[worker_idx]);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(runTime));
+    __FairStopFlag = true;
+    for (std::thread & worker_thread : worker_threads) worker_thread.join();
+
+    printf("  %s: readers %d, writers %d, hold %ld ns, read gap %ld ns, write gap %ld ns, %ld bad reads\n", workLoad.workloadName, workLoad.readersCount, workLoad.writersCount, workLoad.holdTime,
+           workLoad.readGap, workLoad.writeGap, __FairBadCount.load());
+    is_passed = __FairReport("read ", fair_workers, false) && is_passed;
+    is_passed = __FairReport("write", fair_workers, true) && is_passed;
+
+    // Readers admitted one at a time while a writer keeps relocking (Or the reverse) skew the ratio far beyond the writers count
+    if (workLoad.ratioCheck)
+    {
+        double write_average = __FairAverage(fair_workers, true);
+        double lock_ratio    = (write_average > 0 ? __FairAverage(fair_workers, false) / write_average : 0);
+        bool   is_fair       = lock_ratio >= 1 / FAIR_RATIO_BOUND && lock_ratio <= FAIR_RATIO_BOUND;
+
+        printf("    ratio: %.2f reads of a reader per write of a writer (bound %.2f - %.2f)%s\n", lock_ratio, 1 / FAIR_RATIO_BOUND, FAIR_RATIO_BOUND, (is_fair ? "" : ", unfair"));
+        is_passed = is_fair && is_passed;
+    }
+
+    return is_passed && __FairBadCount == 0;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    const fair_workload_t FAIR_WORKLOADS[] = {
+        {"read heavy",          6, 2, 1000, 0,     0,     true },
+        {"read heavy, paced",   6, 2, 1000, 0,     20000, false},
+        {"write heavy",         2, 6, 1000, 0,     0,     false},
+        {"one writer",          8, 1, 1000, 0,     0,     true },
+        {"paced readers",       4, 4, 1000, 20000, 0,     false},
+    };
+    int  run_time  = FAIR_RUN_MILLISECONDS;
+    bool is_passed = true;
+
+    if (argc > 1) run_time = atoi(argv[1]);
+    if (run_time <= 0)
+    {
+        fprintf(stderr, "Usage: %s [run milliseconds of a workload]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Writers may not be starved by the readers, and every writer is followed by a batch of the waiting readers (Checked by the read/write ratio)
+    for (int shared_idx = 0; shared_idx < 2; shared_idx++)
+    {
+        ThreadLock thread_lock(ThreadLock::RwLock, (shared_idx ? "ThreadLockFairness" : nullptr));
+
+        printf("%s lock:\n", (shared_idx ? "Process" : "Thread"));
+        for (const fair_workload_t & work_load : FAIR_WORKLOADS) is_passed = __FairRunWorkload(&thread_lock, work_load, run_time) && is_passed;
+    }
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
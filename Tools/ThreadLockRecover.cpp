@@ -0,0 +1,485 @@
+/**
+ * @brief Thread Lock Recover Test (Kills the processes holding or waiting on process locks and checks that the survivors take the locks over)
+ *
+ * @author WindEagle <fy516a@gmail.com>
+ * @version 1.0.0
+ * @date 2020-01-01 00:00
+ * @copyright Copyright (c) 2020-2022 ZyTech Team
+ * @par Changelog:
+ * Date                 Version     Author          Description
+ */
+//================================================================================
+// Include head file
+//================================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include "../Base/BaseDefine.h"
+#include "../Module/ThreadSafe.h"
+
+//================================================================================
+// Define inside macro
+//================================================================================
+#define RECOVER_KILLS_COUNT   50   // Default kills of a stress run
+#define RECOVER_KILL_INTERVAL 20   // Default minimum time between two kills (Units: milliseconds)
+#define RECOVER_WORKERS_COUNT 4    // Worker processes of a stress run
+#define RECOVER_PROGRESS_TIME 300  // Time the workers run after the last kill (Units: milliseconds)
+#define RECOVER_TIMEOUT       5000 // Maximum time a survivor may wait for a dead process (Units: milliseconds)
+#define RECOVER_LIMIT_COUNT   65   // Lock objects of one process, and processes, of a limit case (One over the tracked processes)
+
+//================================================================================
+// Define inside type
+//================================================================================
+/**
+ * @brief Datas shared by the processes
+ */
+struct recover_shared_t
+{
+    volatile long     valueA;       // Incremented first by a writer
+    volatile long     valueB;       // Incremented last by a writer (Differs from valueA only inside a write lock, or after a writer died)
+    volatile pid_t    holderPid;    // Process inside the write lock
+    volatile bool     isHolding;    // Whether the killed process holds the lock
+    std::atomic<long> recoverCount; // Calls of the recover handler
+    std::atomic<long> badReads;     // Reads that saw a write in progress
+    std::atomic<long> opsCount;     // Locks of the stress workers
+    std::atomic<long> holdCount;    // Processes holding the read lock in a limit case
+    volatile bool     isReleased;   // Whether the processes of a limit case release the read lock
+};
+
+//================================================================================
+// Define inside variable
+//================================================================================
+static recover_shared_t *__RecoverShared = nullptr; // Shared datas (Anonymous shared mapping inherited by the children)
+
+//================================================================================
+// Implementation inside method
+//================================================================================
+/**
+ * @brief Get the milliseconds since a time point
+ *
+ * @param beginTime     Begin time
+ * @return double       Elapsed milliseconds
+ */
+static double __RecoverElapsed(const std::chrono::steady_clock::time_point & beginTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - beginTime).count();
+}
+
+/**
+ * @brief Repair the half-updated datas of a dead writer (Recover handler)
+ *
+ * @param handlerContext Shared datas
+ */
+static void __RecoverRepair(void * handlerContext)
+{
+    recover_shared_t * shared_datas = (recover_shared_t *)handlerContext;
+
+    shared_datas->recoverCount++;
+    shared_datas->valueB = shared_datas->valueA;
+}
+
+/**
+ * @brief Lock, half-update the datas and die (Child process)
+ *
+ * @param lockName      Lock name
+ * @param lockType      Lock type
+ * @param heldMode      Lock mode held at the death
+ */
+static void __RecoverHoldAndDie(const char * lockName, const ThreadLock::LockType lockType, const ThreadLock::LockMode heldMode)
+{
+    ThreadLock thread_lock(lockType, lockName);
+    LockGuard  lock_guard(&thread_lock, heldMode, true);
+
+    if (heldMode == ThreadLock::Write) __RecoverShared->valueA++;
+    __RecoverShared->isHolding = true;
+    raise(SIGKILL);
+}
+
+/**
+ * @brief Lock once and exit (Child process)
+ *
+ * @param lockName      Lock name
+ * @param lockMode      Lock mode
+ */
+static void __RecoverLockOnce(const char * lockName, const ThreadLock::LockMode lockMode)
+{
+    ThreadLock thread_lock(ThreadLock::RwLock, lockName);
+    LockGuard  lock_guard(&thread_lock, lockMode, true);
+
+    lock_guard.unLock();
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Kill a process holding the lock, then lock it from the survivor
+ *
+ * @param caseName      Case name
+ * @param lockName      Lock name
+ * @param lockType      Lock type
+ * @param heldMode      Lock mode the killed process holds
+ * @param waitMode      Lock mode the survivor waits for
+ * @return true         The survivor took the lock over and the handler repaired the datas of a dead writer
+ * @return false        The lock was lost, or the datas were left half-updated
+ */
+static bool __RecoverHolderCase(const char * caseName, const char * lockName, const ThreadLock::LockType lockType, const ThreadLock::LockMode heldMode, const ThreadLock::LockMode waitMode)
+{
+    ThreadLock thread_lock(lockType, lockName);
+    pid_t      child_pid = -1;
+    double     wait_time = 0;
+
+    thread_lock.setRecoverHandler(__RecoverRepair, __RecoverShared);
+    __RecoverShared->valueA = __RecoverShared->valueB = 0;
+    __RecoverShared->isHolding                        = false;
+    __RecoverShared->recoverCount                     = 0;
+
+    if ((child_pid = fork()) == 0)
+    {
+        __RecoverHoldAndDie(lockName, lockType, heldMode);
+        _exit(EXIT_FAILURE);
+    }
+    while (!__RecoverShared->isHolding) usleep(100);
+    waitpid(child_pid, nullptr, 0);
+
+    {
+        auto      begin_time = std::chrono::steady_clock::now();
+        LockGuard lock_guard(&thread_lock, waitMode, true);
+
+        wait_time = __RecoverElapsed(begin_time);
+    }
+    {
+        LockGuard lock_guard(&thread_lock, ThreadLock::Write, true);
+    }
+
+    printf("%-32s %4.0f ms, %ld recovered, a %ld, b %ld\n", caseName, wait_time, __RecoverShared->recoverCount.load(), __RecoverShared->valueA, __RecoverShared->valueB);
+
+    // Only the write lock of a dead process calls the handler, a dead reader is dropped silently
+    return wait_time < RECOVER_TIMEOUT && __RecoverShared->recoverCount == (heldMode == ThreadLock::Write ? 1 : 0) && __RecoverShared->valueA == __RecoverShared->valueB;
+}
+
+/**
+ * @brief Kill the processes waiting on the lock, then lock it from the holder and from a new process
+ *
+ * @param caseName      Case name
+ * @param lockName      Lock name
+ * @return true         The waiters left no count behind
+ * @return false        The lock was lost
+ */
+static bool __RecoverWaiterCase(const char * caseName, const char * lockName)
+{
+    ThreadLock thread_lock(ThreadLock::RwLock, lockName);
+    LockGuard  lock_guard(&thread_lock, ThreadLock::Write, true);
+    pid_t      reader_pid   = -1;
+    pid_t      writer_pid   = -1;
+    pid_t      child_pid    = -1;
+    int        child_status = 0;
+    double     wait_time    = 0;
+
+    std::chrono::steady_clock::time_point begin_time;
+
+    if ((reader_pid = fork()) == 0) __RecoverLockOnce(lockName, ThreadLock::Read);
+    if ((writer_pid = fork()) == 0) __RecoverLockOnce(lockName, ThreadLock::Write);
+    usleep(50000);
+    kill(reader_pid, SIGKILL);
+    kill(writer_pid, SIGKILL);
+    waitpid(reader_pid, nullptr, 0);
+    waitpid(writer_pid, nullptr, 0);
+    lock_guard.unLock();
+
+    begin_time = std::chrono::steady_clock::now();
+    {
+        LockGuard write_guard(&thread_lock, ThreadLock::Write, true);
+    }
+    {
+        LockGuard read_guard(&thread_lock, ThreadLock::Read, true);
+    }
+    if ((child_pid = fork()) == 0) __RecoverLockOnce(lockName, ThreadLock::Write);
+    waitpid(child_pid, &child_status, 0);
+    wait_time = __RecoverElapsed(begin_time);
+
+    printf("%-32s %4.0f ms\n", caseName, wait_time);
+
+    return wait_time < RECOVER_TIMEOUT && WIFEXITED(child_status) && WEXITSTATUS(child_status) == EXIT_SUCCESS;
+}
+
+/**
+ * @brief Lock until killed, a quarter of the locks write (Child process; A mutex always writes)
+ *
+ * @param lockName      Lock name
+ * @param lockType      Lock type
+ */
+static void __RecoverWorker(const char * lockName, const ThreadLock::LockType lockType)
+{
+    ThreadLock thread_lock(lockType, lockName);
+    uint       rand_seed = (uint)getpid();
+
+    thread_lock.setRecoverHandler(__RecoverRepair, __RecoverShared);
+    while (true)
+    {
+        bool      is_write = (lockType == ThreadLock::Mutex || rand_r(&rand_seed) % 4 == 0);
+        LockGuard lock_guard(&thread_lock, (is_write ? ThreadLock::Write : ThreadLock::Read), true);
+
+        if (is_write)
+        {
+            __RecoverShared->holderPid = getpid();
+            __RecoverShared->valueA++;
+            for (int loop_idx = 0; loop_idx < 200; loop_idx++) __asm__ volatile("");
+            __RecoverShared->valueB++;
+            __RecoverShared->holderPid = 0;
+        }
+        else if (__RecoverShared->valueA != __RecoverShared->valueB)
+        {
+            __RecoverShared->badReads++;
+        }
+        __RecoverShared->opsCount++;
+    }
+}
+
+/**
+ * @brief Kill random workers and respawn them while they lock
+ *
+ * @param caseName      Case name
+ * @param lockName      Lock name
+ * @param lockType      Lock type
+ * @param killsCount    Kills count
+ * @param killInterval  Minimum time between two kills (Units: milliseconds)
+ * @return true         No read saw a write in progress, and the workers still lock after the last kill
+ * @return false        The lock stopped excluding or was lost
+ */
+static bool __RecoverStressCase(const char * caseName, const char * lockName, const ThreadLock::LockType lockType, const int killsCount, const int killInterval)
+{
+    pid_t worker_pids[RECOVER_WORKERS_COUNT];
+    long  holder_kills   = 0;
+    long  progress_count = 0;
+    uint  rand_seed      = 1;
+    auto  begin_time     = std::chrono::steady_clock::now();
+
+    __RecoverShared->valueA = __RecoverShared->valueB = 0;
+    __RecoverShared->holderPid                        = 0;
+    __RecoverShared->recoverCount                     = 0;
+    __RecoverShared->badReads                         = 0;
+    __RecoverShared->opsCount                         = 0;
+
+    for (int worker_idx = 0; worker_idx < RECOVER_WORKERS_COUNT; worker_idx++)
+    {
+        if ((worker_pids[worker_idx] = fork()) == 0) __RecoverWorker(lockName, lockType);
+    }
+    for (int kill_idx = 0; kill_idx < killsCount; kill_idx++)
+    {
+        int worker_idx = rand_r(&rand_seed) % RECOVER_WORKERS_COUNT;
+
+        usleep((killInterval + rand_r(&rand_seed) % 5) * 1000);
+        kill(worker_pids[worker_idx], SIGKILL);
+        if (__RecoverShared->holderPid == worker_pids[worker_idx]) holder_kills++;
+        waitpid(worker_pids[worker_idx], nullptr, 0);
+        if ((worker_pids[worker_idx] = fork()) == 0) __RecoverWorker(lockName, lockType);
+    }
+
+    progress_count = __RecoverShared->opsCount;
+    usleep(RECOVER_PROGRESS_TIME * 1000);
+    progress_count = __RecoverShared->opsCount - progress_count;
+    for (pid_t worker_pid : worker_pids)
+    {
+        kill(worker_pid, SIGKILL);
+        waitpid(worker_pid, nullptr, 0);
+    }
+    {
+        ThreadLock thread_lock(lockType, lockName); // Drops the references of the killed workers, the segment is removed with the last one
+    }
+
+    printf("%-32s %4.0f ms, %d kills (%ld holding), %ld recovered, %ld locks (%ld after the last kill), %ld bad reads\n", caseName, __RecoverElapsed(begin_time), killsCount, holder_kills,
+           __RecoverShared->recoverCount.load(), __RecoverShared->opsCount.load(), progress_count, __RecoverShared->badReads.load());
+
+    return __RecoverShared->badReads == 0 && progress_count > 0;
+}
+
+/**
+ * @brief Count the segments of the process read/write locks
+ *
+ * @return int          Segments count (-1: the segments directory can not be read)
+ */
+static int __RecoverCountSegments()
+{
+    DIR *           shm_dir        = opendir("/dev/shm");
+    struct dirent * shm_entry      = nullptr;
+    int             segments_count = 0;
+
+    if (!shm_dir) return -1;
+    while ((shm_entry = readdir(shm_dir)) != nullptr)
+    {
+        if (strncmp(shm_entry->d_name, "ZYRwLock_", 9) == 0) segments_count++;
+    }
+    closedir(shm_dir);
+
+    return segments_count;
+}
+
+/**
+ * @brief Run the child of a limit case and wait for it
+ *
+ * @param childPid      Child process
+ * @return true         The child exited successfully before the timeout
+ * @return false        The child failed, or hung and was killed
+ */
+static bool __RecoverWaitChild(const pid_t childPid)
+{
+    auto begin_time   = std::chrono::steady_clock::now();
+    int  child_status = 0;
+
+    while (waitpid(childPid, &child_status, WNOHANG) == 0)
+    {
+        if (__RecoverElapsed(begin_time) >= RECOVER_TIMEOUT)
+        {
+            kill(childPid, SIGKILL);
+            waitpid(childPid, &child_status, 0);
+            return false;
+        }
+        usleep(1000);
+    }
+
+    return WIFEXITED(child_status) && WEXITSTATUS(child_status) == EXIT_SUCCESS;
+}
+
+/**
+ * @brief Hold the read lock from the lock objects at once (A guard per lock object, nested)
+ *
+ * @param threadLocks   Lock objects
+ * @param locksCount    Lock objects count
+ */
+static void __RecoverHoldReads(ThreadLock ** threadLocks, const int locksCount)
+{
+    if (locksCount == 0) return;
+
+    LockGuard lock_guard(threadLocks[0], ThreadLock::Read, true);
+
+    __RecoverHoldReads(threadLocks + 1, locksCount - 1);
+}
+
+/**
+ * @brief Open the lock objects of one process, hold the read lock from all of them, then write lock each (Child process)
+ *
+ * @param lockName      Lock name
+ */
+static void __RecoverManyObjects(const char * lockName)
+{
+    ThreadLock * thread_locks[RECOVER_LIMIT_COUNT];
+
+    for (ThreadLock *& thread_lock : thread_locks) thread_lock = new ThreadLock(ThreadLock::RwLock, lockName);
+    __RecoverHoldReads(thread_locks, RECOVER_LIMIT_COUNT);
+    for (ThreadLock * thread_lock : thread_locks)
+    {
+        LockGuard lock_guard(thread_lock, ThreadLock::Write, true);
+    }
+    for (ThreadLock * thread_lock : thread_locks) delete thread_lock;
+
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Hold the read lock until released, then write lock (Child process)
+ *
+ * @param lockName      Lock name
+ */
+static void __RecoverManyProcess(const char * lockName)
+{
+    {
+        ThreadLock thread_lock(ThreadLock::RwLock, lockName);
+        LockGuard  lock_guard(&thread_lock, ThreadLock::Read, true);
+
+        __RecoverShared->holdCount++;
+        while (!__RecoverShared->isReleased) usleep(1000);
+        lock_guard.unLock();
+        lock_guard.reLock(ThreadLock::Write);
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Use a process read/write lock past the tracked lock objects and processes
+ *
+ * @param caseName      Case name
+ * @param lockName      Lock name
+ * @return true         Every lock object locked and the segment was removed with the last one
+ * @return false        A lock hung, or the segment was left behind
+ */
+static bool __RecoverLimitCase(const char * caseName, const char * lockName)
+{
+    pid_t child_pids[RECOVER_LIMIT_COUNT];
+    int   segments_count = __RecoverCountSegments();
+    bool  is_objects     = false;
+    bool  is_processes   = true;
+    auto  begin_time     = std::chrono::steady_clock::now();
+
+    // One process with more lock objects than owner slots
+    if ((child_pids[0] = fork()) == 0) __RecoverManyObjects(lockName);
+    is_objects = __RecoverWaitChild(child_pids[0]);
+
+    // More processes than owner slots, the last ones share the untracked slot
+    __RecoverShared->holdCount  = 0;
+    __RecoverShared->isReleased = false;
+    for (pid_t & child_pid : child_pids)
+    {
+        if ((child_pid = fork()) == 0) __RecoverManyProcess(lockName);
+    }
+    while (__RecoverShared->holdCount < RECOVER_LIMIT_COUNT && __RecoverElapsed(begin_time) < RECOVER_TIMEOUT) usleep(1000);
+    __RecoverShared->isReleased = true;
+    for (pid_t child_pid : child_pids) is_processes = __RecoverWaitChild(child_pid) && is_processes;
+
+    printf("%-32s %4.0f ms, %d objects %s, %ld of %d processes held, %s\n", caseName, __RecoverElapsed(begin_time), RECOVER_LIMIT_COUNT, (is_objects ? "locked" : "HUNG"), __RecoverShared->holdCount.load(),
+           RECOVER_LIMIT_COUNT, (__RecoverCountSegments() == segments_count ? "segment removed" : "SEGMENT LEFT"));
+
+    return is_objects && is_processes && __RecoverShared->holdCount == RECOVER_LIMIT_COUNT && __RecoverCountSegments() == segments_count;
+}
+
+//================================================================================
+// Implementation export method
+//================================================================================
+int main(int argc, char * argv[])
+{
+    int  kills_count   = RECOVER_KILLS_COUNT;
+    int  kill_interval = RECOVER_KILL_INTERVAL;
+    bool is_passed     = true;
+
+    if (argc > 1) kills_count = atoi(argv[1]);
+    if (argc > 2) kill_interval = atoi(argv[2]);
+    if (kills_count < 0 || kill_interval < 0)
+    {
+        fprintf(stderr, "Usage: %s [kills count] [kill interval milliseconds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    __RecoverShared = (recover_shared_t *)mmap(nullptr, sizeof(recover_shared_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (__RecoverShared == MAP_FAILED)
+    {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+    new (__RecoverShared) recover_shared_t();
+    setvbuf(stdout, nullptr, _IONBF, 0);
+
+    // A dead owner is found when a waiter times out, the survivor takes the lock over and repairs the half-updated datas in the handler
+    is_passed = __RecoverHolderCase("mutex, writer killed", "ThreadLockRecover_m", ThreadLock::Mutex, ThreadLock::Write, ThreadLock::Write) && is_passed;
+    is_passed = __RecoverHolderCase("rwlock, writer killed, write", "ThreadLockRecover_ww", ThreadLock::RwLock, ThreadLock::Write, ThreadLock::Write) && is_passed;
+    is_passed = __RecoverHolderCase("rwlock, writer killed, read", "ThreadLockRecover_wr", ThreadLock::RwLock, ThreadLock::Write, ThreadLock::Read) && is_passed;
+    is_passed = __RecoverHolderCase("rwlock, reader killed, write", "ThreadLockRecover_rw", ThreadLock::RwLock, ThreadLock::Read, ThreadLock::Write) && is_passed;
+    is_passed = __RecoverWaiterCase("rwlock, waiters killed", "ThreadLockRecover_w") && is_passed;
+
+    // The owner and attach slots are tracked per process, lock objects and processes past them still lock
+    is_passed = __RecoverLimitCase("rwlock, 65 objects and processes", "ThreadLockRecover_l") && is_passed;
+
+    // Every killed worker may hold or wait, a dead reader or waiter costs the others one wait timeout
+    is_passed = __RecoverStressCase("mutex, stress", "ThreadLockRecover_sm", ThreadLock::Mutex, kills_count, kill_interval) && is_passed;
+    is_passed = __RecoverStressCase("rwlock, stress", "ThreadLockRecover_sr", ThreadLock::RwLock, kills_count, kill_interval) && is_passed;
+
+    munmap(__RecoverShared, sizeof(recover_shared_t));
+
+    return (is_passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}